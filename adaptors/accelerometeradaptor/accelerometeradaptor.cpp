@@ -41,7 +41,7 @@
 AccelerometerAdaptor::AccelerometerAdaptor(const QString& id) :
     InputDevAdaptor(id, 1)
 {
-    accelerometerBuffer_ = new DeviceAdaptorRingBuffer<OrientationData>(1);
+    accelerometerBuffer_ = new DeviceAdaptorRingBuffer<OrientationData>(BATCH_SIZE);
     setAdaptedSensor("accelerometer", "Internal accelerometer coordinates", accelerometerBuffer_);
     setDescription("Input device accelerometer adaptor");
     powerStatePath_ = SensorFrameworkConfig::configuration()->value("accelerometer/powerstate_path").toByteArray();
@@ -110,7 +110,6 @@ void AccelerometerAdaptor::commitOutput(struct input_event *ev)
 //    sensordLogT() << "Accelerometer reading: " << d->x_ << ", " << d->y_ << ", " << d->z_;
 
     accelerometerBuffer_->commit();
-    accelerometerBuffer_->wakeUpReaders();
 }
 
 unsigned int AccelerometerAdaptor::evaluateIntervalRequests(int& sessionId) const
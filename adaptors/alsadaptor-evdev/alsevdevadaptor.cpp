@@ -40,7 +40,7 @@
 ALSAdaptorEvdev::ALSAdaptorEvdev(const QString& id) :
     InputDevAdaptor(id, 1)
 {
-    alsBuffer_ = new DeviceAdaptorRingBuffer<TimedUnsigned>(1);
+    alsBuffer_ = new DeviceAdaptorRingBuffer<TimedUnsigned>(BATCH_SIZE);
     setAdaptedSensor("als", "Internal ambient light sensor lux values", alsBuffer_);
     setDescription("Input device als adaptor");
     powerStatePath_ = SensorFrameworkConfig::configuration()->value("als/powerstate_path").toByteArray();
@@ -82,7 +82,6 @@ void ALSAdaptorEvdev::commitOutput(struct input_event *ev)
     lux->timestamp_ = Utils::getTimeStamp(&(ev->time));
 
     alsBuffer_->commit();
-    alsBuffer_->wakeUpReaders();
 }
 
 unsigned int ALSAdaptorEvdev::evaluateIntervalRequests(int& sessionId) const
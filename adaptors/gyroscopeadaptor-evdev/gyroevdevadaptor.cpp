@@ -40,7 +40,7 @@
 GyroAdaptorEvdev::GyroAdaptorEvdev(const QString& id) :
     InputDevAdaptor(id, 1)
 {
-    gyroscopeBuffer_ = new DeviceAdaptorRingBuffer<TimedXyzData>(1);
+    gyroscopeBuffer_ = new DeviceAdaptorRingBuffer<TimedXyzData>(BATCH_SIZE);
     setAdaptedSensor("gyroscope", "Internal gyroscope values", gyroscopeBuffer_);
     setDescription("Input device gyroscope adaptor");
     powerStatePath_ = SensorFrameworkConfig::configuration()->value("gyroscope/powerstate_path").toByteArray();
@@ -91,7 +91,6 @@ void GyroAdaptorEvdev::commitOutput(struct input_event *ev)
     gyroData->timestamp_ = Utils::getTimeStamp(&(ev->time));
 
     gyroscopeBuffer_->commit();
-    gyroscopeBuffer_->wakeUpReaders();
 }
 
 unsigned int GyroAdaptorEvdev::evaluateIntervalRequests(int& sessionId) const
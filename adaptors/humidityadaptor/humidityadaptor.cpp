@@ -37,7 +37,7 @@
 HumidityAdaptor::HumidityAdaptor(const QString& id) :
     InputDevAdaptor(id, 1)
 {
-    humidityBuffer_ = new DeviceAdaptorRingBuffer<TimedUnsigned>(1);
+    humidityBuffer_ = new DeviceAdaptorRingBuffer<TimedUnsigned>(BATCH_SIZE);
     setAdaptedSensor("humidity", "Relative Humidity values", humidityBuffer_);
     setDescription("Input device humidity adaptor");
     powerStatePath_ = SensorFrameworkConfig::configuration()->value("humidity/powerstate_path").toByteArray();
@@ -79,7 +79,6 @@ void HumidityAdaptor::commitOutput(struct input_event *ev)
     rh->timestamp_ = Utils::getTimeStamp(&(ev->time));
 
     humidityBuffer_->commit();
-    humidityBuffer_->wakeUpReaders();
 }
 
 unsigned int HumidityAdaptor::evaluateIntervalRequests(int& sessionId) const
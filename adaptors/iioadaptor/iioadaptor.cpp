@@ -28,11 +28,12 @@
    </p>
 */
 #include <errno.h>
-
-#include <libudev.h>
+#include <string.h>
 
 #include <logging.h>
+#include <trace.h>
 #include <config.h>
+#include <devicediscovery.h>
 #include <datatypes/utils.h>
 #include <unistd.h>
 #include <time.h>
@@ -45,7 +46,6 @@
 #include <QTimer>
 #include <QDirIterator>
 #include <qmath.h>
-#include <QRegularExpression>
 
 #include <deviceadaptor.h>
 #include "datatypes/orientationdata.h"
@@ -65,6 +65,12 @@
 
 IioAdaptor::IioAdaptor(const QString &id) :
         SysfsAdaptor(id, SysfsAdaptor::IntervalMode, true),
+        devNodeNumber(-1),
+        proximityThreshold(0),
+        iioXyzBuffer_(NULL),
+        alsBuffer_(NULL),
+        magnetometerBuffer_(NULL),
+        proximityBuffer_(NULL),
         deviceId(id)
 {
     sensordLogD() << "Creating IioAdaptor with id: " << id;
@@ -87,85 +93,83 @@ void IioAdaptor::setup()
 {
     qDebug() << Q_FUNC_INFO << deviceId;
 
+    // The buffer is adapted even without a device, so that channels can
+    // connect and get data once the device is hotplugged.
+    QString name;
+    QString kind;
+    RingBufferBase* buffer = NULL;
     if (deviceId.startsWith("accel")) {
-        const QString name = "accelerometer";
-        const QString inputMatch = SensorFrameworkConfig::configuration()->value<QString>(name + "/input_match");
-        qDebug() << "input_match" << inputMatch;
-
+        name = "accelerometer";
+        kind = "accelerometer";
         iioDevice.channelTypeName = "accel";
-        devNodeNumber = findSensor(inputMatch);
-        if (devNodeNumber!= -1) {
-            const QString desc = "Industrial I/O accelerometer (" + iioDevice.name +")";
-            qDebug() << Q_FUNC_INFO << "Accelerometer found";
-            iioXyzBuffer_ = new DeviceAdaptorRingBuffer<TimedXyzData>(1);
-            setAdaptedSensor(name, desc, iioXyzBuffer_);
-
-            iioDevice.sensorType = IioAdaptor::IIO_ACCELEROMETER;
-        }
+        iioDevice.sensorType = IioAdaptor::IIO_ACCELEROMETER;
+        buffer = iioXyzBuffer_ = new DeviceAdaptorRingBuffer<TimedXyzData>(1);
     } else if (deviceId.startsWith("gyro")) {
-        const QString name = "gyroscope";
-        const QString inputMatch = SensorFrameworkConfig::configuration()->value<QString>(name + "/input_match");
-        qDebug() << "input_match" << inputMatch;
-
+        name = "gyroscope";
+        kind = "gyroscope";
         iioDevice.channelTypeName = "anglvel";
-        devNodeNumber = findSensor(inputMatch);
-        if (devNodeNumber!= -1) {
-            const QString desc = "Industrial I/O gyroscope (" + iioDevice.name +")";
-            iioXyzBuffer_ = new DeviceAdaptorRingBuffer<TimedXyzData>(1);
-            setAdaptedSensor(name, desc, iioXyzBuffer_);
-
-            iioDevice.sensorType = IioAdaptor::IIO_GYROSCOPE;
-        }
+        iioDevice.sensorType = IioAdaptor::IIO_GYROSCOPE;
+        buffer = iioXyzBuffer_ = new DeviceAdaptorRingBuffer<TimedXyzData>(1);
     } else if (deviceId.startsWith("mag")) {
-        const QString name = "magnetometer";
-        const QString inputMatch = SensorFrameworkConfig::configuration()->value<QString>(name + "/input_match");
-        qDebug() << "input_match" << inputMatch;
-
+        name = "magnetometer";
+        kind = "magnetometer";
         iioDevice.channelTypeName = "magn";
-        devNodeNumber = findSensor(inputMatch);
-        if (devNodeNumber!= -1) {
-            const QString desc = "Industrial I/O magnetometer (" + iioDevice.name +")";
-            magnetometerBuffer_ = new DeviceAdaptorRingBuffer<CalibratedMagneticFieldData>(1);
-            setAdaptedSensor(name, desc, magnetometerBuffer_);
-
-            iioDevice.sensorType = IioAdaptor::IIO_MAGNETOMETER;
-        }
+        iioDevice.sensorType = IioAdaptor::IIO_MAGNETOMETER;
+        buffer = magnetometerBuffer_ = new DeviceAdaptorRingBuffer<CalibratedMagneticFieldData>(1);
     } else if (deviceId.startsWith("als")) {
-        const QString name = "als";
-        const QString inputMatch = SensorFrameworkConfig::configuration()->value<QString>(name + "/input_match");
-
+        name = "als";
+        kind = "light sensor";
         iioDevice.channelTypeName = "illuminance";
-        devNodeNumber = findSensor(inputMatch);
-        if (devNodeNumber!= -1) {
-            QString desc = "Industrial I/O light sensor (" + iioDevice.name +")";
-            qDebug() << desc;
-            alsBuffer_ = new DeviceAdaptorRingBuffer<TimedUnsigned>(1);
-            setAdaptedSensor(name, desc, alsBuffer_);
-            iioDevice.sensorType = IioAdaptor::IIO_ALS;
-        }
+        iioDevice.sensorType = IioAdaptor::IIO_ALS;
+        buffer = alsBuffer_ = new DeviceAdaptorRingBuffer<TimedUnsigned>(1);
     } else if (deviceId.startsWith("prox")) {
-        const QString name = "proximity";
-        const QString inputMatch = SensorFrameworkConfig::configuration()->value<QString>(name + "/input_match");
-        qDebug() << name + ":" << "input_match" << inputMatch;
-
+        name = "proximity";
+        kind = "proximity sensor";
         iioDevice.channelTypeName = "proximity";
-        devNodeNumber = findSensor(inputMatch);
+        iioDevice.sensorType = IioAdaptor::IIO_PROXIMITY;
+        buffer = proximityBuffer_ = new DeviceAdaptorRingBuffer<ProximityData>(1);
         proximityThreshold = SensorFrameworkConfig::configuration()->value<QString>(name + "/threshold", QString(PROXIMITY_DEFAULT_THRESHOLD)).toInt();
-        if (devNodeNumber!= -1) {
-            QString desc = "Industrial I/O proximity sensor (" + iioDevice.name +")";
-            qDebug() << desc;
-            proximityBuffer_ = new DeviceAdaptorRingBuffer<ProximityData>(1);
-            setAdaptedSensor(name, desc, proximityBuffer_);
-            iioDevice.sensorType = IioAdaptor::IIO_PROXIMITY;
-        }
+    } else {
+        qDebug() << Q_FUNC_INFO << "unknown sensor type";
+        return;
     }
 
+    inputMatch_ = SensorFrameworkConfig::configuration()->value<QString>(name + "/input_match");
+    qDebug() << name + ":" << "input_match" << inputMatch_;
+
+    devNodeNumber = findSensor(inputMatch_);
+    QString desc = "Industrial I/O " + kind;
+    if (devNodeNumber != -1)
+        desc += " (" + iioDevice.name + ")";
+    qDebug() << desc;
+    setAdaptedSensor(name, desc, buffer);
+
+    introduceAvailableDataRange(DataRange(0, 65535, 1));
+    introduceAvailableInterval(DataRange(0, 586, 0));
+    setDefaultInterval(10);
+
     if (devNodeNumber == -1) {
         qDebug() << Q_FUNC_INFO << "sensor is invalid";
-//        setValid(false);
         return;
     }
 
+    for (int i = 0; i < channelAttributes_.size(); ++i)
+        addPath(iioDevice.devicePath + channelAttributes_.at(i), i);
+    setupDevice();
+}
+
+void IioAdaptor::init()
+{
+    SysfsAdaptor::init();
+
+    // Keep the adaptor without a device, but invalid until rebind()
+    // finds one.
+    if (devNodeNumber == -1)
+        setValid(false);
+}
+
+void IioAdaptor::setupDevice()
+{
     if (mode() != SysfsAdaptor::IntervalMode) {
         scanElementsEnable(devNodeNumber,1);
         scanElementsEnable(devNodeNumber,0);
@@ -178,101 +182,106 @@ void IioAdaptor::setup()
         sensordLogD() << "Overriding scale to" << scale_override;
         iioDevice.scale = scale_override;
     }
+}
 
-    introduceAvailableDataRange(DataRange(0, 65535, 1));
-    introduceAvailableInterval(DataRange(0, 586, 0));
-    setDefaultInterval(10);
+/**
+ * Does attribute name have channel type followed by suffix, like
+ * <tt>in_accel_x_raw</tt> for <tt>accel</tt> and <tt>raw</tt>.
+ */
+static bool isChannelAttribute(const QString& attribute, const QString& type, const char* suffix)
+{
+    int at = attribute.indexOf(type);
+    return at != -1 && attribute.endsWith(suffix) &&
+           at + type.length() <= attribute.length() - (int)strlen(suffix);
 }
 
 int IioAdaptor::findSensor(const QString &sensorName)
 {
-    udev_list_entry *devices;
-    udev_list_entry *dev_list_entry;
-    udev_device *dev = 0;
-    struct udev *udevice = 0;
-    struct udev_enumerate *enumerate = 0;
-
-    if (!udevice)
-        udevice = udev_new();
-
-    enumerate = udev_enumerate_new(udevice);
-    udev_enumerate_add_match_subsystem(enumerate, "iio");
-
-    udev_enumerate_scan_devices(enumerate);
-    devices = udev_enumerate_get_list_entry(enumerate);
-
-    bool ok2;
-
-    udev_list_entry_foreach(dev_list_entry, devices) {
-        const char *path;
-        path = udev_list_entry_get_name(dev_list_entry);
-
-        dev = udev_device_new_from_syspath(udevice, path);
-        if (qstrcmp(udev_device_get_subsystem(dev), "iio") == 0) {
-            iioDevice.name = QString::fromLatin1(udev_device_get_sysattr_value(dev,"name"));
-            if (iioDevice.name == sensorName) {
-                struct udev_list_entry *sysattr;
-                int j = 0;
-                QString eventName = QString::fromLatin1(udev_device_get_sysname(dev));
-                iioDevice.devicePath = QString::fromLatin1(udev_device_get_syspath(dev)) +"/";
-                iioDevice.index = eventName.right(1).toInt(&ok2);
-                // Default values
-                iioDevice.offset = 0.0;
-                iioDevice.scale = 1.0;
-                iioDevice.frequency = 1.0;
-                qDebug() << Q_FUNC_INFO << "Syspath for sensor (" + sensorName + "):" << iioDevice.devicePath;
-
-                udev_list_entry_foreach(sysattr, udev_device_get_sysattr_list_entry(dev)) {
-                    const char *name;
-                    const char *value;
-                    bool ok;
-                    name = udev_list_entry_get_name(sysattr);
-                    value = udev_device_get_sysattr_value(dev, name);
-                    if (value == NULL)
-                        continue;
-                    qDebug() << "attr" << name << value;
-
-                    QString attributeName(name);
-                    if (attributeName.contains(QRegularExpression(iioDevice.channelTypeName + ".*scale$"))) {
-                        iioDevice.scale = QString(value).toDouble(&ok);
-                        if (ok) {
-                            qDebug() << sensorName + ":" << "Scale is" << iioDevice.scale;
-                        }
-                    } else if (attributeName.contains(QRegularExpression(iioDevice.channelTypeName + ".*offset$"))) {
-                        iioDevice.offset = QString(value).toDouble(&ok);
-                        if (ok) {
-                            qDebug() << sensorName + ":" << "Offset is" << value;
-                        }
-                    } else if (attributeName.endsWith("frequency")) {
-                        iioDevice.frequency = QString(value).toDouble(&ok);
-                        if (ok) {
-                            qDebug() << sensorName + ":" << "Frequency is" << iioDevice.frequency;
-                        }
-                    } else if (attributeName.contains(QRegularExpression(iioDevice.channelTypeName + ".*raw$"))) {
-                        qDebug() << "adding to paths:" << iioDevice.devicePath
-                                   << attributeName << iioDevice.index;
-                        addPath(iioDevice.devicePath + attributeName, j);
-                        j++;
-                    }
-                }
-                iioDevice.channels = j;
-
-    // in_rot_from_north_magnetic_tilt_comp_raw ?
+    QSharedPointer<const DeviceIndex> index = DeviceDiscovery::instance().index();
+    const IioDeviceInfo *device = index->findIioDevice(sensorName);
+    if (!device)
+        return -1;
 
-                // type
-                break;
+    int j = 0;
+    iioDevice.name = device->name;
+    iioDevice.devicePath = device->sysPath + "/";
+    iioDevice.index = device->index;
+    // Default values
+    iioDevice.offset = 0.0;
+    iioDevice.scale = 1.0;
+    iioDevice.frequency = 1.0;
+    qDebug() << Q_FUNC_INFO << "Syspath for sensor (" + sensorName + "):" << iioDevice.devicePath;
+
+    // Attributes were read when the device was probed.
+    for (QMap<QString, QString>::const_iterator it = device->parameters.constBegin(); it != device->parameters.constEnd(); ++it) {
+        const QString& attributeName = it.key();
+        bool ok;
+        qDebug() << "attr" << attributeName << it.value();
+
+        if (isChannelAttribute(attributeName, iioDevice.channelTypeName, "scale")) {
+            iioDevice.scale = it.value().toDouble(&ok);
+            if (ok) {
+                qDebug() << sensorName + ":" << "Scale is" << iioDevice.scale;
+            }
+        } else if (isChannelAttribute(attributeName, iioDevice.channelTypeName, "offset")) {
+            iioDevice.offset = it.value().toDouble(&ok);
+            if (ok) {
+                qDebug() << sensorName + ":" << "Offset is" << it.value();
+            }
+        } else if (attributeName.endsWith("frequency")) {
+            iioDevice.frequency = it.value().toDouble(&ok);
+            if (ok) {
+                qDebug() << sensorName + ":" << "Frequency is" << iioDevice.frequency;
             }
         }
     }
-    if (dev)
-        udev_device_unref(dev);
-    udev_enumerate_unref(enumerate);
 
-    if (ok2)
-        return iioDevice.index;
-    else
-        return -1;
+    channelAttributes_.clear();
+    foreach (const QString& attributeName, device->rawChannels) {
+        if (!isChannelAttribute(attributeName, iioDevice.channelTypeName, "raw"))
+            continue;
+        qDebug() << "channel:" << iioDevice.devicePath
+                   << attributeName << iioDevice.index;
+        channelAttributes_.append(attributeName);
+        j++;
+    }
+    iioDevice.channels = j;
+
+    // in_rot_from_north_magnetic_tilt_comp_raw ?
+
+    return iioDevice.index;
 }
+
+bool IioAdaptor::findPaths(QStringList& paths, QList<int>& ids)
+{
+    // Without a device there are no paths in use and nothing reads the
+    // device parameters, so the device can be set up from scratch.
+    if (devNodeNumber == -1) {
+        if (iioDevice.channelTypeName.isEmpty())
+            return false;
+        devNodeNumber = findSensor(inputMatch_);
+        if (devNodeNumber == -1)
+            return false;
+        sensordLogD() << "IIO device" << iioDevice.name << "appeared for" << deviceId;
+        setupDevice();
+    }
+
+    QSharedPointer<const DeviceIndex> index = DeviceDiscovery::instance().index();
+    const IioDeviceInfo *device = index->findIioDevice(iioDevice.name);
+    if (!device)
+        return false;
+
+    for (int i = 0; i < channelAttributes_.size(); ++i) {
+        paths.append(device->sysPath + "/" + channelAttributes_.at(i));
+        ids.append(i);
+    }
+
+    iioDevice.devicePath = device->sysPath + "/";
+    iioDevice.index = device->index;
+    devNodeNumber = device->index;
+    return true;
+}
+
 /*
  * als
  * accel_3d
@@ -533,13 +542,16 @@ void IioAdaptor::processSample(int fileId, int fd)
                 uData->timestamp_ = Utils::getTimeStamp();
                 alsBuffer_->commit();
                 alsBuffer_->wakeUpReaders();
-                sensordLogT() << "ALS offset=" << iioDevice.offset << "scale=" << iioDevice.scale << "value=" << uData->value_ << "timestamp=" << uData->timestamp_;
+                sensordTrace("ALS offset=%g scale=%g value=%u timestamp=%llu",
+                             iioDevice.offset, iioDevice.scale, uData->value_, uData->timestamp_);
                 break;
             case IioAdaptor::IIO_PROXIMITY:
                 proximityData->timestamp_ = Utils::getTimeStamp();
                 proximityBuffer_->commit();
                 proximityBuffer_->wakeUpReaders();
-                sensordLogT() << "Proximity offset=" << iioDevice.offset << "scale=" << iioDevice.scale << "value=" << proximityData->value_ << "within proximity=" << proximityData->withinProximity_ << "timestamp=" << proximityData->timestamp_;
+                sensordTrace("Proximity offset=%g scale=%g value=%u within proximity=%d timestamp=%llu",
+                             iioDevice.offset, iioDevice.scale, proximityData->value_,
+                             proximityData->withinProximity_, proximityData->timestamp_);
                 break;
             default:
                 break;
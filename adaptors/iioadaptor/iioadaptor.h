@@ -84,6 +84,8 @@ public:
         return new IioAdaptor(id);
     }
 
+    virtual void init();
+
     virtual bool startSensor();
     virtual void stopSensor();
 //    virtual bool standby();
@@ -107,6 +109,18 @@ protected:
     bool setInterval(const unsigned int value, const int sessionId);
     //  unsigned int interval() const;
 
+    /**
+     * Find the IIO device again by name. Channels of a rebound device
+     * are expected to be the same, so the channel attributes found at
+     * setup are looked up from the new device directory. An adaptor
+     * that had no device matches the index again like at setup.
+     *
+     * @param paths Attribute paths, filled in.
+     * @param ids   Path IDs for the paths, filled in.
+     * @return was device found.
+     */
+    bool findPaths(QStringList& paths, QList<int>& ids);
+
 private:
 
     /**
@@ -120,6 +134,12 @@ private:
     void processSample(int pathId, int fd);
 
     int findSensor(const QString &name);
+
+    /**
+     * Apply device specific settings once the device has been found.
+     */
+    void setupDevice();
+
     bool deviceEnable(int device, int enable);
 
     bool sysfsWriteInt(QString filename, int val);
@@ -142,6 +162,12 @@ private:
 
     QString deviceId;
 
+    // Device name to look up from the device index
+    QString inputMatch_;
+
+    // Names of channel attributes, index is the path id
+    QStringList channelAttributes_;
+
     TimedXyzData* timedData;
     CalibratedMagneticFieldData *calData;
     TimedUnsigned *uData;
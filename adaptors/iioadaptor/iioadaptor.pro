@@ -8,8 +8,4 @@ SOURCES += iioadaptor.cpp \
 
 CONFIG += qt debug warn_on link_prl link_pkgconfig plugin
 
-CONFIG += link_pkgconfig
-PKGCONFIG += libudev
-LIBS += -ludev
-
 include( ../adaptor-config.pri )
@@ -39,7 +39,7 @@
 KeyboardSliderAdaptor::KeyboardSliderAdaptor(const QString& id) :
     InputDevAdaptor(id, 1), newKbEventRecorded_(false), currentState_(KeyboardSliderStateUnknown)
 {
-    kbstateBuffer_ = new DeviceAdaptorRingBuffer<KeyboardSliderState>(1);
+    kbstateBuffer_ = new DeviceAdaptorRingBuffer<KeyboardSliderState>(BATCH_SIZE);
     setAdaptedSensor("keyboardslider", "Device keyboard slider state", kbstateBuffer_);
     setDescription("Keyboard slider events (via input device)");
 }
@@ -95,7 +95,6 @@ void KeyboardSliderAdaptor::commitOutput()
     *state = currentState_;
 
     kbstateBuffer_->commit();
-    kbstateBuffer_->wakeUpReaders();
 }
 
 unsigned int KeyboardSliderAdaptor::interval() const
@@ -45,7 +45,7 @@ LidSensorAdaptorEvdev::LidSensorAdaptorEvdev(const QString& id) :
     lastValue(-1),
     usingFront(false)
 {
-    lidBuffer_ = new DeviceAdaptorRingBuffer<LidData>(1);
+    lidBuffer_ = new DeviceAdaptorRingBuffer<LidData>(BATCH_SIZE);
     setAdaptedSensor("lidsensor", "Lid state", lidBuffer_);
     powerStatePath_ = SensorFrameworkConfig::configuration()->value("lidsensor/powerstate_path").toByteArray();
 
@@ -133,7 +133,6 @@ void LidSensorAdaptorEvdev::commitOutput(struct input_event *ev)
                       << (currentValue_ == 0 ? "OPEN": "CLOSED");
 
         lidBuffer_->commit();
-        lidBuffer_->wakeUpReaders();
         lastValue = currentValue_;
         lastType = currentType_;
     }
@@ -39,7 +39,7 @@
 MagAdaptorEvdev::MagAdaptorEvdev(const QString& id) :
     InputDevAdaptor(id, 1)
 {
-    magnetometerBuffer_ = new DeviceAdaptorRingBuffer<CalibratedMagneticFieldData>(1);
+    magnetometerBuffer_ = new DeviceAdaptorRingBuffer<CalibratedMagneticFieldData>(BATCH_SIZE);
     setAdaptedSensor("magnetometer", "Internal magnetometer coordinates", magnetometerBuffer_);
     setDescription("Input device magnetometer adaptor");
     powerStatePath_ = SensorFrameworkConfig::configuration()->value("magnetometer/powerstate_path").toByteArray();
@@ -90,7 +90,6 @@ void MagAdaptorEvdev::commitOutput(struct input_event *ev)
     magData->timestamp_ = Utils::getTimeStamp(&(ev->time));
 
     magnetometerBuffer_->commit();
-    magnetometerBuffer_->wakeUpReaders();
 }
 
 unsigned int MagAdaptorEvdev::evaluateIntervalRequests(int& sessionId) const
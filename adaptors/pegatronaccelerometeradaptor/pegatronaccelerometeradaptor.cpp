@@ -80,7 +80,6 @@ void PegatronAccelerometerAdaptor::commitOutput(struct input_event *ev)
     d->z_ = orientationValue_.z_;
 
     accelerometerBuffer_->commit();
-    accelerometerBuffer_->wakeUpReaders();
 }
 
 unsigned int PegatronAccelerometerAdaptor::evaluateIntervalRequests(int& sessionId) const
@@ -37,7 +37,7 @@
 PressureAdaptor::PressureAdaptor(const QString& id) :
     InputDevAdaptor(id, 1)
 {
-    pressureBuffer_ = new DeviceAdaptorRingBuffer<TimedUnsigned>(1);
+    pressureBuffer_ = new DeviceAdaptorRingBuffer<TimedUnsigned>(BATCH_SIZE);
     setAdaptedSensor("pressure", "Pressure values", pressureBuffer_);
     setDescription("Input device pressure adaptor");
     powerStatePath_ = SensorFrameworkConfig::configuration()->value("pressure/powerstate_path").toByteArray();
@@ -79,7 +79,6 @@ void PressureAdaptor::commitOutput(struct input_event *ev)
     lux->timestamp_ = Utils::getTimeStamp(&(ev->time));
 
     pressureBuffer_->commit();
-    pressureBuffer_->wakeUpReaders();
 }
 
 unsigned int PressureAdaptor::evaluateIntervalRequests(int& sessionId) const
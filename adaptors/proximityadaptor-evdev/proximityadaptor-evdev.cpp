@@ -44,7 +44,7 @@ ProximityAdaptorEvdev::ProximityAdaptorEvdev(const QString& id) :
     InputDevAdaptor(id, 1),
     currentState_(ProximityStateUnknown)
 {
-    proximityBuffer_ = new DeviceAdaptorRingBuffer<ProximityData>(1);
+    proximityBuffer_ = new DeviceAdaptorRingBuffer<ProximityData>(BATCH_SIZE);
     setAdaptedSensor("proximity", "Proximity state", proximityBuffer_);
     powerStatePath_ = SensorFrameworkConfig::configuration()->value("proximity/powerstate_path").toByteArray();
 }
@@ -90,7 +90,6 @@ void ProximityAdaptorEvdev::commitOutput(struct input_event *ev)
         oldState = currentState_;
 
         proximityBuffer_->commit();
-        proximityBuffer_->wakeUpReaders();
     }
 }
 
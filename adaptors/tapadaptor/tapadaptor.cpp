@@ -36,7 +36,7 @@
 TapAdaptor::TapAdaptor(const QString& id) :
     InputDevAdaptor(id, 1)
 {
-    tapBuffer_ = new DeviceAdaptorRingBuffer<TapData>(1);
+    tapBuffer_ = new DeviceAdaptorRingBuffer<TapData>(BATCH_SIZE);
     setAdaptedSensor("tap", "Internal accelerometer tap events", tapBuffer_);
     setDescription("Device tap events (lis302d)");
 }
@@ -91,7 +91,6 @@ void TapAdaptor::commitOutput(const TapData& data)
     d->type_ = data.type_;
 
     tapBuffer_->commit();
-    tapBuffer_->wakeUpReaders();
 }
 
 bool TapAdaptor::setInterval(const unsigned int, const int)
@@ -37,7 +37,7 @@
 TemperatureAdaptor::TemperatureAdaptor(const QString& id) :
     InputDevAdaptor(id, 1)
 {
-    temperatureBuffer_ = new DeviceAdaptorRingBuffer<TimedUnsigned>(1);
+    temperatureBuffer_ = new DeviceAdaptorRingBuffer<TimedUnsigned>(BATCH_SIZE);
     setAdaptedSensor("temperature", "Temperature values", temperatureBuffer_);
     setDescription("Input device temperature adaptor");
     powerStatePath_ = SensorFrameworkConfig::configuration()->value("temperature/powerstate_path").toByteArray();
@@ -79,7 +79,6 @@ void TemperatureAdaptor::commitOutput(struct input_event *ev)
     temp->timestamp_ = Utils::getTimeStamp(&(ev->time));
 
     temperatureBuffer_->commit();
-    temperatureBuffer_->wakeUpReaders();
 }
 
 unsigned int TemperatureAdaptor::evaluateIntervalRequests(int& sessionId) const
@@ -37,7 +37,7 @@ const int TouchAdaptor::HARD_MAX_TOUCH_POINTS = 5;
 
 TouchAdaptor::TouchAdaptor(const QString& id) : InputDevAdaptor(id, HARD_MAX_TOUCH_POINTS)
 {
-    outputBuffer_ = new DeviceAdaptorRingBuffer<TouchData>(1);
+    outputBuffer_ = new DeviceAdaptorRingBuffer<TouchData>(BATCH_SIZE);
     setAdaptedSensor("touch", "Touch screen input", outputBuffer_);
     setDescription("Touch screen events");
 }
@@ -164,5 +164,4 @@ void TouchAdaptor::commitOutput(int src, struct input_event *ev)
     d->state_ = touchValues_[src].fingerState;
 
     outputBuffer_->commit();
-    outputBuffer_->wakeUpReaders();
 }
@@ -33,6 +33,7 @@
 #include "bufferreader.h"
 #include "config.h"
 #include "logging.h"
+#include "pipeline.h"
 
 #include "coordinatealignfilter.h"
 
@@ -61,15 +62,16 @@ AccelerometerChain::AccelerometerChain(const QString& id) :
         }
     }
 
-    accCoordinateAlignFilter_ = sm.instantiateFilter("coordinatealignfilter");
-    Q_ASSERT(accCoordinateAlignFilter_);
-    ((CoordinateAlignFilter*)accCoordinateAlignFilter_)->setMatrix(TMatrix(aconv_));
+    FusedFilter<Pipeline<CoordinateAlignStage> >* aligner = new FusedFilter<Pipeline<CoordinateAlignStage> >;
+    aligner->pipeline().stage().setMatrix(TMatrix(aconv_));
+    aligner->pipeline().stage().setFixedPoint(FixedPoint::enabled());
+    accCoordinateAlignFilter_ = aligner;
 
     outputBuffer_ = new RingBuffer<AccelerationData>(1);
     nameOutputBuffer("accelerometer", outputBuffer_);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(accelerometerReader_, "accelerometer");
     filterBin_->add(accCoordinateAlignFilter_, "acccoordinatealigner");
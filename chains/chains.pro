@@ -6,4 +6,5 @@ include( ../common-install.pri )
 SUBDIRS  = accelerometerchain \
            orientationchain \
            magcalibrationchain \
-           compasschain
+           compasschain \
+           stepdetectorchain
@@ -33,9 +33,13 @@
 #include "logging.h"
 #include "downsamplefilter.h"
 #include "avgaccfilter.h"
+#include "pipeline.h"
 
 #include "datatypes/orientationdata.h"
 
+/** Accelerometer smoothing and downsampling in front of compass filter. */
+typedef Pipeline<AvgAccStage, Pipeline<DownsampleStage> > AccelerometerPipeline;
+
 
 CompassChain::CompassChain(const QString& id) :
     AbstractChain(id),
@@ -79,11 +83,12 @@ CompassChain::CompassChain(const QString& id) :
         declinationFilter = sm.instantiateFilter("declinationfilter");
         Q_ASSERT(declinationFilter);
 
-        downsampleFilter = sm.instantiateFilter("downsamplefilter");
-        Q_ASSERT(downsampleFilter);
-
-        avgaccFilter = sm.instantiateFilter("avgaccfilter");
-        Q_ASSERT(avgaccFilter);
+        // Smoothing and downsampling are fixed, run them as one node.
+        FusedFilter<AccelerometerPipeline>* pipeline = new FusedFilter<AccelerometerPipeline>;
+        pipeline->pipeline().stage().setFactor(0.24);
+        pipeline->pipeline().stage().setFixedPoint(FixedPoint::enabled());
+        pipeline->pipeline().next().stage().setTimeout(3000);
+        accelerometerPipeline = pipeline;
     }
 
     trueNorthBuffer = new RingBuffer<CompassData>(1);
@@ -93,14 +98,13 @@ CompassChain::CompassChain(const QString& id) :
     nameOutputBuffer("magneticnorth", magneticNorthBuffer); //
 
     // Create buffers for filter chain
-    filterBin = new Bin;
+    filterBin = new Bin(id);
 
     if (!hasOrientationAdaptor) {
         filterBin->add(magReader, "magnetometer");
         filterBin->add(accelerometerReader, "accelerometer");
         filterBin->add(compassFilter, "compassfilter");
-        filterBin->add(avgaccFilter, "avgaccelerometer");
-        filterBin->add(downsampleFilter, "downsamplefilter");
+        filterBin->add(accelerometerPipeline, "accelerometerpipeline");
     } else {
         ////////////////////
         filterBin->add(orientationdataReader, "orientation");
@@ -113,19 +117,16 @@ CompassChain::CompassChain(const QString& id) :
 
     if (!hasOrientationAdaptor) {
         // magchain > compassfilter > magnorth/declination
-        // accelchain > avg filter > downsamplefilter > compassfilter
+        // accelchain > avg + downsample pipeline > compassfilter
 
         if (!filterBin->join("magnetometer", "source", "compassfilter", "magsink"))
             qDebug() << Q_FUNC_INFO << "magnetometer join failed";
 
-        if (!filterBin->join("accelerometer", "source", "avgaccelerometer", "sink"))
+        if (!filterBin->join("accelerometer", "source", "accelerometerpipeline", "sink"))
             qDebug() << Q_FUNC_INFO << "accelerometer join failed";
 
-        if (!filterBin->join("avgaccelerometer", "source", "downsamplefilter", "sink"))
-            qDebug() << Q_FUNC_INFO << "avgaccelerometer join failed";
-
-        if (!filterBin->join("downsamplefilter", "source", "compassfilter", "accsink"))
-            qDebug() << Q_FUNC_INFO << "downsamplefilter join failed";
+        if (!filterBin->join("accelerometerpipeline", "source", "compassfilter", "accsink"))
+            qDebug() << Q_FUNC_INFO << "accelerometerpipeline join failed";
 
         if (!filterBin->join("compassfilter", "magnorthangle", "magneticnorth", "sink"))
             qDebug() << Q_FUNC_INFO << "compassfilter/magnorth join failed";
@@ -164,14 +165,6 @@ CompassChain::CompassChain(const QString& id) :
     introduceAvailableDataRange(DataRange(0, 359, 1));
     introduceAvailableInterval(DataRange(50,200,0));
 
-    if (!hasOrientationAdaptor) {
-        DownsampleFilter *filter = static_cast<DownsampleFilter *>(downsampleFilter);
-        filter->setTimeout(3000);
-
-        AvgAccFilter *filter2 = static_cast<AvgAccFilter *>(avgaccFilter);
-        filter2->setFactor(0.24);
-    }
-
     if (!hasOrientationAdaptor) {
         setRangeSource(magChain);
         addStandbyOverrideSource(magChain);
@@ -194,6 +187,7 @@ CompassChain::~CompassChain()
         delete accelerometerReader;
         delete magReader;
         delete compassFilter;
+        delete accelerometerPipeline;
     } else {
         disconnectFromSource(orientAdaptor, "orientation", orientationdataReader);
         sm.releaseDeviceAdaptor("orientationadaptor");
@@ -81,8 +81,7 @@ private:
     FilterBase *orientationFilter;
     FilterBase *declinationFilter;
 
-    FilterBase *downsampleFilter;
-    FilterBase *avgaccFilter;
+    FilterBase *accelerometerPipeline; /**< averaging and downsampling, fused */
 
     RingBuffer<CompassData> *trueNorthBuffer;
     RingBuffer<CompassData> *magneticNorthBuffer;
@@ -39,8 +39,8 @@ void CompassChainPlugin::Register(class Loader&)
 QStringList CompassChainPlugin::Dependencies() {
     QByteArray orientationConfiguration = SensorFrameworkConfig::configuration()->value("plugins/orientationadaptor").toByteArray();
     if (orientationConfiguration.isEmpty()) {
-        return QString("accelerometerchain:magcalibrationchain:declinationfilter:downsamplefilter:avgaccfilter").split(":", QString::SkipEmptyParts);
+        return QString("accelerometerchain:magcalibrationchain:declinationfilter").split(":", QString::SkipEmptyParts);
     } else {
-        return QString("accelerometerchain:magcalibrationchain:declinationfilter:downsamplefilter:avgaccfilter:orientationadaptor").split(":", QString::SkipEmptyParts);
+        return QString("accelerometerchain:magcalibrationchain:declinationfilter:orientationadaptor").split(":", QString::SkipEmptyParts);
     }
 }
@@ -20,6 +20,8 @@
 #include <QDebug>
 #include "compassfilter.h"
 #include "config.h"
+#include "fastmath.h"
+#include "fixedpoint.h"
 
 #include <QtCore/qmath.h>
 
@@ -32,8 +34,19 @@
 CompassFilter::CompassFilter() :
         magDataSink(this, &CompassFilter::magDataAvailable),
         accelSink(this, &CompassFilter::accelDataAvailable),
+        magX(0),
+        magY(0),
+        magZ(0),
+        oldMagX(0),
+        oldMagY(0),
+        oldMagZ(0),
         level(0),
-        oldHeading(0)
+        oldHeading(0),
+        fixedPoint(FixedPoint::enabled()),
+        fixedMagX(0),
+        fixedMagY(0),
+        fixedMagZ(0),
+        fixedHeading(0)
 {
     addSink(&magDataSink, "magsink");
     addSink(&accelSink, "accsink");
@@ -42,6 +55,15 @@ CompassFilter::CompassFilter() :
 
 void CompassFilter::magDataAvailable(unsigned, const CalibratedMagneticFieldData *data)
 {
+    if (fixedPoint) {
+        const qint32 factor = FixedPoint::fromReal(FILTER_FACTOR);
+        level = data->level_;
+        fixedMagX += FixedPoint::truncate((qint64)factor * (data->y_ * 256 - fixedMagX));
+        fixedMagY += FixedPoint::truncate((qint64)factor * (data->x_ * 256 - fixedMagY));
+        fixedMagZ += FixedPoint::truncate((qint64)factor * (data->z_ * 256 - fixedMagZ));
+        return;
+    }
+
     magX = data->y_ * .001f;
     magY = data->x_ * .001f;
     magZ = data->z_ * .001f;
@@ -58,15 +80,20 @@ void CompassFilter::magDataAvailable(unsigned, const CalibratedMagneticFieldData
 
 void CompassFilter::accelDataAvailable(unsigned, const AccelerationData *data)
 {
+    if (fixedPoint) {
+        accelDataAvailableFixed(data);
+        return;
+    }
+
     // the x/y are switched as compass expects it in aero coordinates
     qreal Gx = data->y_ * .001f; //convert to g
     qreal Gy = data->x_ * .001f;
     qreal Gz = -data->z_ * .001f;
 
-    qreal divisor = qSqrt(Gx * Gx + Gy * Gy + Gz * Gz);
-    qreal normalizedGx = Gx / divisor;
-    qreal normalizedGy = Gy / divisor;
-    qreal normalizedGz = Gz / divisor;
+    qreal inverseNorm = FastMath::rsqrt(Gx * Gx + Gy * Gy + Gz * Gz);
+    qreal normalizedGx = Gx * inverseNorm;
+    qreal normalizedGy = Gy * inverseNorm;
+    qreal normalizedGz = Gz * inverseNorm;
 
     ///////////////
     /// this algorithm is from Circuit Cellar Aug 2012
@@ -79,15 +106,14 @@ void CompassFilter::accelDataAvailable(unsigned, const AccelerationData *data)
     qreal Psi = 0;
     qreal The = 0;
     qreal Phi = 0;
-    qreal sinAngle = 0;
-    qreal cosAngle = 0;
+    float sinAngle = 0;
+    float cosAngle = 0;
     qreal fBfx = 0;
     qreal fBfy = 0;
 
     /* calculate roll angle Phi (-180deg, 180deg) and sin, cos */
-    Phi = qAtan2(normalizedGy, normalizedGz); /* Equation 2 */
-    sinAngle = qSin(Phi);
-    cosAngle = qCos(Phi);
+    Phi = FastMath::atan2(normalizedGy, normalizedGz); /* Equation 2 */
+    FastMath::sincos(Phi, sinAngle, cosAngle);
 
     /* de-rotate magY roll angle Phi */
     fBfy = magY * cosAngle - magZ * sinAngle; /* Equation 5 y component */
@@ -95,15 +121,14 @@ void CompassFilter::accelDataAvailable(unsigned, const AccelerationData *data)
     normalizedGz = normalizedGy * sinAngle + normalizedGz * cosAngle;
 
     /* calculate pitch angle Theta (-90deg, 90deg) and sin, cos*/
-    The = qAtan(-normalizedGx / normalizedGz);  /* Equation 3 */
-    sinAngle = qSin(The);
-    cosAngle = qCos(The);
+    The = FastMath::atan(-normalizedGx / normalizedGz);  /* Equation 3 */
+    FastMath::sincos(The, sinAngle, cosAngle);
 
     /* de-rotate magY pitch angle Theta */
     fBfx = magX * cosAngle + magZ * sinAngle; /* Equation 5 x component */
 
     /* calculate yaw = ecompass angle psi (-180deg, 180deg) */
-    Psi = (qAtan2(-fBfy, fBfx) * RADIANS_TO_DEGREES); /* Equation 7 */
+    Psi = (FastMath::atan2(-fBfy, fBfx) * RADIANS_TO_DEGREES); /* Equation 7 */
 
     qreal heading = Psi * FILTER_FACTOR + oldHeading * (1.0 - FILTER_FACTOR);
 
@@ -114,3 +139,43 @@ void CompassFilter::accelDataAvailable(unsigned, const AccelerationData *data)
     magSource.propagate(1, &compassData);
     oldHeading = heading;
 }
+
+/*
+ * Same tilt compensation on integers. Sine and cosine of roll and pitch
+ * are ratios of gravity components, so instead of computing the angles
+ * the field is de-rotated with the components directly and both heading
+ * coordinates are left scaled by the same positive factor, which the
+ * final angle does not depend on.
+ */
+void CompassFilter::accelDataAvailableFixed(const AccelerationData *data)
+{
+    const qint32 factor = FixedPoint::fromReal(FILTER_FACTOR);
+
+    // the x/y are switched as compass expects it in aero coordinates
+    qint64 Gx = data->y_;
+    qint64 Gy = data->x_;
+    qint64 Gz = -data->z_;
+
+    /* roll: sin = Gy / r, cos = Gz / r */
+    qint64 r = FixedPoint::sqrt(Gy * Gy + Gz * Gz);
+    /* pitch: sin = -Gx / R, cos = r / R */
+    qint64 R = FixedPoint::sqrt(Gx * Gx + r * r);
+
+    /* Equation 5, y component times r * R */
+    qint64 fBfy = ((qint64)fixedMagY * Gz - (qint64)fixedMagZ * Gy) * R;
+    /* de-rotated z times r */
+    qint64 bz = (qint64)fixedMagY * Gy + (qint64)fixedMagZ * Gz;
+    /* Equation 5, x component times r * R */
+    qint64 fBfx = (qint64)fixedMagX * r * r - bz * Gx;
+
+    /* Equation 7 */
+    qint32 Psi = FixedPoint::atan2(-fBfy, fBfx);
+
+    fixedHeading = FixedPoint::truncate((qint64)Psi * factor + (qint64)fixedHeading * (FixedPoint::One - factor));
+
+    CompassData compassData; //north angle
+    compassData.timestamp_ = data->timestamp_;
+    compassData.degrees_ = FixedPoint::truncate(fixedHeading + 360 * FixedPoint::One) % 360;
+    compassData.level_ = level;
+    magSource.propagate(1, &compassData);
+}
@@ -36,6 +36,12 @@ public:
         return new CompassFilter;
     }
 
+    /**
+     * Select integer or floating point tilt compensation. Set from
+     * <tt>filters/fixed_point</tt> by default.
+     */
+    void setFixedPoint(bool enabled) { fixedPoint = enabled; }
+
 protected:
 
     CompassFilter();
@@ -48,6 +54,7 @@ private:
 
     void magDataAvailable(unsigned, const CalibratedMagneticFieldData*);
     void accelDataAvailable(unsigned, const AccelerationData*);
+    void accelDataAvailableFixed(const AccelerationData*);
 
     CalibratedMagneticFieldData magData;
 
@@ -60,6 +67,12 @@ private:
 
     int level;
     qreal oldHeading;
+
+    bool fixedPoint;
+    qint32 fixedMagX;    /**< smoothed field, Q8 */
+    qint32 fixedMagY;
+    qint32 fixedMagZ;
+    qint32 fixedHeading; /**< smoothed heading, Q16 degrees */
     QList <int> averagingBuffer;
     QList <const CalibratedMagneticFieldData *> magAvgBuffer;
     QList <const AccelerationData *> accelAvgBuffer;
@@ -21,6 +21,8 @@
 #include <QDebug>
 
 #include "calibrationfilter.h"
+#include "magcalibrationengine.h"
+#include "magcalibrationstore.h"
 #include "config.h"
 #include "sensormanager.h"
 #include <QFile>
@@ -36,18 +38,15 @@
 CalibrationFilter::CalibrationFilter() :
     Filter<CalibratedMagneticFieldData, CalibrationFilter, CalibratedMagneticFieldData>(this, &CalibrationFilter::magDataAvailable),
     magDataSink(this, &CalibrationFilter::magDataAvailable),
-    calLevel(0),
-    bufferPos(0),
+    engine(NULL),
     dataPoints(0)
 {
     addSink(&magDataSink, "magsink");
     addSource(&magSource, "calibratedmagneticfield");
-// min, max
-    minMaxList.insert(0,qMakePair(0,0));
-    minMaxList.insert(1,qMakePair(0,0));
-    minMaxList.insert(2,qMakePair(0,0));
 
     manualCalibration = SensorFrameworkConfig::configuration()->value<bool>("magnetometer/needs_calibration", false);
+    if (manualCalibration)
+        engine = new MagCalibrationEngine;
 
     qDebug() << Q_FUNC_INFO << manualCalibration;
 #ifdef CALIBRATE_DATA
@@ -78,74 +77,16 @@ void CalibrationFilter::magDataAvailable(unsigned, const CalibratedMagneticField
     transformed.level_ = data->level_;
 
     if (manualCalibration) {
+        engine->addSample(data->rx_, data->ry_, data->rz_);
 
-        //    simple hard iron correction
-        if (minMaxList.at(0).first == 0) {
-            minMaxList.replace(0,qMakePair(data->rx_, data->rx_));
-            minMaxList.replace(1,qMakePair(data->ry_, data->ry_));
-            minMaxList.replace(2,qMakePair(data->rz_, data->rz_));
-
-        } else {
-            minMaxList.replace(0,qMakePair(qMin(minMaxList.at(0).first, data->rx_),
-                                           qMax(minMaxList.at(0).second, data->rx_)));
-            minMaxList.replace(1,qMakePair(qMin(minMaxList.at(1).first, data->ry_),
-                                           qMax(minMaxList.at(1).second, data->ry_)));
-            minMaxList.replace(2,qMakePair(qMin(minMaxList.at(2).first, data->rz_),
-                                           qMax(minMaxList.at(2).second, data->rz_)));
+        MagCalibration *published = engine->takeCalibration();
+        if (published) {
+            calibration = *published;
+            delete published;
         }
-        meanX = ((minMaxList.at(0).first + minMaxList.at(0).second) * .5);
-        meanY = ((minMaxList.at(1).first + minMaxList.at(1).second) * .5);
-        meanZ = ((minMaxList.at(2).first + minMaxList.at(2).second) * .5);
-
-        if (calLevel != 3
-                || meanX != offsetX || meanY != offsetY || meanZ != offsetZ) {
-
-            calLevel = 0;
-            if (offsetX == meanX)
-                calLevel += 1;
-            if (offsetY == meanY)
-                calLevel += 1;
-            if (offsetZ == meanZ)
-                calLevel += 1;
-
-            offsetX = meanX;
-            offsetY = meanY;
-            offsetZ = meanZ;
-
-            transformed.level_ = calLevel;
-
-            transformed.x_ -= offsetX;
-            transformed.y_ -= offsetY;
-            transformed.z_ -= offsetZ;
-
-            ///////////////////// soft iron
-            qreal vmaxX = minMaxList.at(0).second - ((minMaxList.at(0).first + minMaxList.at(0).second) * 0.5);
-            qreal vmaxY = minMaxList.at(1).second - ((minMaxList.at(1).first + minMaxList.at(1).second) * 0.5);
-            qreal vmaxZ = minMaxList.at(2).second - ((minMaxList.at(2).first + minMaxList.at(2).second) * 0.5);
-
-            qreal vminX = minMaxList.at(0).first - ((minMaxList.at(0).first + minMaxList.at(0).second) * 0.5);
-            qreal vminY = minMaxList.at(1).first - ((minMaxList.at(1).first + minMaxList.at(1).second) * 0.5);
-            qreal vminZ = minMaxList.at(2).first - ((minMaxList.at(2).first + minMaxList.at(2).second) * 0.5);
-
-            qreal avgX = vmaxX + (vminX * -1);
-            avgX = avgX * 0.5;
-            qreal avgY = vmaxY + (vminY * -1);
-            avgY = avgY * 0.5;
-            qreal avgZ = vmaxZ + (vminZ * -1);
-            avgZ = avgZ * 0.5;
-
-            qreal avgRad = avgX + avgY + avgZ;
-            avgRad /= 3.0;
-
-            xScale = (avgRad/avgX);
-            yScale = (avgRad/avgY);
-            zScale = (avgRad/avgZ);
-        }
-
-        transformed.x_ *= xScale;
-        transformed.y_ *= yScale;
-        transformed.z_ *= zScale;
 
+        calibration.apply(transformed.x_, transformed.y_, transformed.z_);
+        transformed.level_ = calibration.level;
     }
 #ifdef CALIBRATE_DATA
     if (dataPoints == DATA_POINTS) {
@@ -165,8 +106,19 @@ void CalibrationFilter::magDataAvailable(unsigned, const CalibratedMagneticField
     source_.propagate(1, &transformed);
 }
 
+CalibrationFilter::~CalibrationFilter()
+{
+    delete engine;
+}
+
+void CalibrationFilter::setCalibrationStore(const QString& path, const QString& key)
+{
+    if (engine)
+        engine->setStore(new MagCalibrationStore(path, key));
+}
+
 void CalibrationFilter::dropCalibration()
 {
-    calLevel = 0;
-    minMaxList.clear();
+    if (engine)
+        engine->reset();
 }
@@ -25,9 +25,12 @@
 
 #include "orientationdata.h"
 #include "filter.h"
+#include "ellipsoidfit.h"
 
 #include <QFile>
 
+class MagCalibrationEngine;
+
 class CalibrationFilter : public QObject, public Filter<CalibratedMagneticFieldData, CalibrationFilter, CalibratedMagneticFieldData>
 {
     Q_OBJECT
@@ -39,6 +42,17 @@ public:
     }
     void dropCalibration();
 
+    /**
+     * Persist calibration in given state file and restore previously
+     * stored calibration from it.
+     *
+     * @param path State file location.
+     * @param key Identifies the calibrated device and sensor.
+     */
+    void setCalibrationStore(const QString& path, const QString& key);
+
+    ~CalibrationFilter();
+
 protected:
 
     CalibrationFilter();
@@ -53,24 +67,8 @@ private:
     CalibratedMagneticFieldData magData;
     CalibratedMagneticFieldData transformed;
 
-    QList <QPair<int,int> > minMaxList;
-
-    qreal offsetX;
-    qreal offsetY;
-    qreal offsetZ;
-
-    qreal xScale;
-    qreal yScale;
-    qreal zScale;
-
-    qreal meanX;
-    qreal meanY;
-    qreal meanZ;
-
-    qreal calLevel;
-    int lowPass(int newVal, int oldVal);
-    QList<const CalibratedMagneticFieldData *> *readingBuffer;
-    int bufferPos;
+    MagCalibrationEngine *engine;
+    MagCalibration calibration;
 
     QFile unCalibratedData;
     QFile calibratedData;
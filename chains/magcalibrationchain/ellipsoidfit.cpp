@@ -0,0 +1,379 @@
+/**
+   @file ellipsoidfit.cpp
+   @brief Incremental ellipsoid fit for magnetometer calibration
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "ellipsoidfit.h"
+#include <math.h>
+#include <limits.h>
+#include <float.h>
+
+/* Forgetting factor of the recursive least squares fit. */
+#define FORGETTING_FACTOR 0.995
+/* Initial diagonal of the inverse correlation matrix. */
+#define INITIAL_COVARIANCE 1000.0
+/* Largest trace of the inverse correlation matrix. Without new
+ * directions the forgetting factor would grow it without bound. */
+#define MAX_COVARIANCE_TRACE (9 * INITIAL_COVARIANCE)
+/* Buckets needed before a fit is trusted at all. */
+#define MIN_COVERAGE 12
+/* Largest accepted ratio between ellipsoid semi-axes. */
+#define MAX_AXIS_RATIO 4.0
+/* Number of azimuth sectors per elevation band. */
+#define AZIMUTH_SECTORS 8
+/* Number of elevation bands, equal area. */
+#define ELEVATION_BANDS (EllipsoidFit::BUCKETS / AZIMUTH_SECTORS)
+
+MagCalibration::MagCalibration() :
+    radius(0),
+    level(0)
+{
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j)
+            matrix[i][j] = (i == j) ? 1 : 0;
+        offset[i] = 0;
+    }
+}
+
+void MagCalibration::apply(int& x, int& y, int& z) const
+{
+    double dx = x - offset[0];
+    double dy = y - offset[1];
+    double dz = z - offset[2];
+    x = (int)lround(matrix[0][0] * dx + matrix[0][1] * dy + matrix[0][2] * dz);
+    y = (int)lround(matrix[1][0] * dx + matrix[1][1] * dy + matrix[1][2] * dz);
+    z = (int)lround(matrix[2][0] * dx + matrix[2][1] * dy + matrix[2][2] * dz);
+}
+
+static bool isFinite(double value)
+{
+    return fabs(value) <= DBL_MAX;
+}
+
+/**
+ * Eigen decomposition of a symmetric 3x3 matrix with cyclic Jacobi
+ * rotations. Columns of v are the eigenvectors of the values in d.
+ */
+static void symmetricEigen(const double a[3][3], double d[3], double v[3][3])
+{
+    double m[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            m[i][j] = a[i][j];
+            v[i][j] = (i == j) ? 1 : 0;
+        }
+    }
+
+    for (int sweep = 0; sweep < 50; ++sweep) {
+        double off = m[0][1] * m[0][1] + m[0][2] * m[0][2] + m[1][2] * m[1][2];
+        if (off < 1e-24)
+            break;
+
+        for (int p = 0; p < 2; ++p) {
+            for (int q = p + 1; q < 3; ++q) {
+                if (m[p][q] == 0)
+                    continue;
+
+                double theta = (m[q][q] - m[p][p]) / (2 * m[p][q]);
+                double t = (theta >= 0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1));
+                double c = 1 / sqrt(t * t + 1);
+                double s = t * c;
+
+                for (int k = 0; k < 3; ++k) {
+                    double mkp = m[k][p];
+                    double mkq = m[k][q];
+                    m[k][p] = c * mkp - s * mkq;
+                    m[k][q] = s * mkp + c * mkq;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    double mpk = m[p][k];
+                    double mqk = m[q][k];
+                    m[p][k] = c * mpk - s * mqk;
+                    m[q][k] = s * mpk + c * mqk;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    double vkp = v[k][p];
+                    double vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < 3; ++i)
+        d[i] = m[i][i];
+}
+
+EllipsoidFit::EllipsoidFit()
+{
+    reset();
+}
+
+void EllipsoidFit::reset()
+{
+    for (int i = 0; i < PARAMS; ++i) {
+        theta_[i] = 0;
+        for (int j = 0; j < PARAMS; ++j)
+            cov_[i][j] = (i == j) ? INITIAL_COVARIANCE : 0;
+    }
+    for (int i = 0; i < BUCKETS; ++i)
+        stamp_[i] = -1;
+    filled_ = 0;
+    seen_ = 0;
+    scale_ = 0;
+}
+
+int EllipsoidFit::coverage() const
+{
+    return filled_;
+}
+
+int EllipsoidFit::bucketOf(const double p[3]) const
+{
+    double d[3];
+    for (int i = 0; i < 3; ++i)
+        d[i] = p[i] - (min_[i] + max_[i]) * 0.5;
+
+    double length = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    if (length == 0)
+        return 0;
+
+    // z / length is uniformly distributed for uniformly distributed
+    // directions, so equal width bands have equal area.
+    int band = (int)((d[2] / length + 1) * 0.5 * ELEVATION_BANDS);
+    int sector = (int)((atan2(d[1], d[0]) + M_PI) / (2 * M_PI) * AZIMUTH_SECTORS);
+    if (band >= ELEVATION_BANDS)
+        band = ELEVATION_BANDS - 1;
+    if (sector >= AZIMUTH_SECTORS)
+        sector = AZIMUTH_SECTORS - 1;
+
+    return band * AZIMUTH_SECTORS + sector;
+}
+
+bool EllipsoidFit::addSample(double x, double y, double z)
+{
+    if (scale_ == 0) {
+        // Keep internal values around unity for numerical stability.
+        scale_ = sqrt(x * x + y * y + z * z);
+        if (scale_ == 0)
+            return false;
+        min_[0] = max_[0] = x / scale_;
+        min_[1] = max_[1] = y / scale_;
+        min_[2] = max_[2] = z / scale_;
+    }
+
+    double p[3] = { x / scale_, y / scale_, z / scale_ };
+    for (int i = 0; i < 3; ++i) {
+        if (p[i] < min_[i])
+            min_[i] = p[i];
+        if (p[i] > max_[i])
+            max_[i] = p[i];
+    }
+
+    // Count every offered sample, not just accepted ones, so a bucket is
+    // refreshed regularly even when only part of the sphere is covered.
+    // The counter wraps within the non-negative range.
+    int seen = seen_;
+    seen_ = (seen_ + 1) & INT_MAX;
+
+    int index = bucketOf(p);
+    int elapsed = (seen - stamp_[index]) & INT_MAX;
+    if (stamp_[index] >= 0 && elapsed < BUCKETS)
+        return false;
+
+    // A bucket refed as soon as it may be means the device is not
+    // turning. Such samples add no new direction, and feeding them would
+    // only make the fit forget the directions seen before.
+    bool fresh = stamp_[index] < 0 || elapsed >= 2 * BUCKETS;
+
+    if (stamp_[index] < 0)
+        ++filled_;
+    stamp_[index] = seen;
+    for (int i = 0; i < 3; ++i)
+        bucket_[index][i] = p[i];
+
+    if (!fresh)
+        return false;
+
+    update(p);
+    return true;
+}
+
+void EllipsoidFit::update(const double p[3])
+{
+    // Model: a x^2 + b y^2 + c z^2 + 2d xy + 2e xz + 2f yz
+    //        + 2g x + 2h y + 2i z = 1
+    const double phi[PARAMS] = {
+        p[0] * p[0], p[1] * p[1], p[2] * p[2],
+        2 * p[0] * p[1], 2 * p[0] * p[2], 2 * p[1] * p[2],
+        2 * p[0], 2 * p[1], 2 * p[2]
+    };
+
+    double cp[PARAMS];
+    double denominator = FORGETTING_FACTOR;
+    double prediction = 0;
+    for (int i = 0; i < PARAMS; ++i) {
+        cp[i] = 0;
+        for (int j = 0; j < PARAMS; ++j)
+            cp[i] += cov_[i][j] * phi[j];
+        denominator += phi[i] * cp[i];
+        prediction += phi[i] * theta_[i];
+    }
+
+    double error = 1 - prediction;
+    for (int i = 0; i < PARAMS; ++i)
+        theta_[i] += cp[i] / denominator * error;
+
+    // cov is symmetric so cp is also phi^T * cov.
+    double trace = 0;
+    for (int i = 0; i < PARAMS; ++i) {
+        for (int j = 0; j < PARAMS; ++j)
+            cov_[i][j] = (cov_[i][j] - cp[i] * cp[j] / denominator) / FORGETTING_FACTOR;
+        trace += cov_[i][i];
+    }
+
+    // Keep the covariance bounded even if forgetting inflates directions
+    // that samples have not covered for a long time.
+    if (!isFinite(trace)) {
+        for (int i = 0; i < PARAMS; ++i)
+            for (int j = 0; j < PARAMS; ++j)
+                cov_[i][j] = (i == j) ? INITIAL_COVARIANCE : 0;
+    } else if (trace > MAX_COVARIANCE_TRACE) {
+        double factor = MAX_COVARIANCE_TRACE / trace;
+        for (int i = 0; i < PARAMS; ++i)
+            for (int j = 0; j < PARAMS; ++j)
+                cov_[i][j] *= factor;
+    }
+}
+
+bool EllipsoidFit::solve(MagCalibration& result) const
+{
+    if (filled_ < MIN_COVERAGE)
+        return false;
+    for (int i = 0; i < PARAMS; ++i)
+        if (!isFinite(theta_[i]))
+            return false;
+
+    const double m[3][3] = {
+        { theta_[0], theta_[3], theta_[4] },
+        { theta_[3], theta_[1], theta_[5] },
+        { theta_[4], theta_[5], theta_[2] }
+    };
+    const double v[3] = { theta_[6], theta_[7], theta_[8] };
+
+    // center = -M^-1 v
+    double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+               - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+               + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    if (fabs(det) < 1e-12)
+        return false;
+
+    double inverse[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            int i1 = (j + 1) % 3, i2 = (j + 2) % 3;
+            int j1 = (i + 1) % 3, j2 = (i + 2) % 3;
+            inverse[i][j] = (m[i1][j1] * m[i2][j2] - m[i1][j2] * m[i2][j1]) / det;
+        }
+    }
+
+    double center[3];
+    for (int i = 0; i < 3; ++i)
+        center[i] = -(inverse[i][0] * v[0] + inverse[i][1] * v[1] + inverse[i][2] * v[2]);
+    for (int i = 0; i < 3; ++i)
+        if (!isFinite(center[i]))
+            return false;
+
+    // (p - center)^T M (p - center) = 1 + center^T M center
+    double k = 1;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            k += center[i] * m[i][j] * center[j];
+    if (k <= 0)
+        return false;
+
+    double shape[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            shape[i][j] = m[i][j] / k;
+
+    double eigenvalues[3];
+    double eigenvectors[3][3];
+    symmetricEigen(shape, eigenvalues, eigenvectors);
+
+    for (int i = 0; i < 3; ++i)
+        if (!isFinite(eigenvalues[i]))
+            return false;
+
+    double smallest = eigenvalues[0];
+    double largest = eigenvalues[0];
+    for (int i = 1; i < 3; ++i) {
+        if (eigenvalues[i] < smallest)
+            smallest = eigenvalues[i];
+        if (eigenvalues[i] > largest)
+            largest = eigenvalues[i];
+    }
+    if (smallest <= 0 || largest / smallest > MAX_AXIS_RATIO * MAX_AXIS_RATIO)
+        return false;
+
+    // Map ellipsoid to a sphere with the same volume, ie. the geometric
+    // mean of the semi-axes.
+    double radius = pow(eigenvalues[0] * eigenvalues[1] * eigenvalues[2], -1.0 / 6);
+    double gain[3];
+    for (int i = 0; i < 3; ++i)
+        gain[i] = sqrt(eigenvalues[i]) * radius;
+
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            result.matrix[i][j] = 0;
+            for (int l = 0; l < 3; ++l)
+                result.matrix[i][j] += eigenvectors[i][l] * gain[l] * eigenvectors[j][l];
+        }
+        result.offset[i] = center[i] * scale_;
+    }
+    result.radius = radius * scale_;
+
+    // Relative RMS distance of bucketed samples from the fitted sphere.
+    double residual = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        if (stamp_[b] < 0)
+            continue;
+        double d[3];
+        for (int i = 0; i < 3; ++i)
+            d[i] = bucket_[b][i] - center[i];
+        double length = 0;
+        for (int i = 0; i < 3; ++i) {
+            double c = result.matrix[i][0] * d[0] + result.matrix[i][1] * d[1] + result.matrix[i][2] * d[2];
+            length += c * c;
+        }
+        double e = sqrt(length) / radius - 1;
+        residual += e * e;
+    }
+    residual = sqrt(residual / filled_);
+
+    if (residual < 0.02 && filled_ >= BUCKETS / 2)
+        result.level = 3;
+    else if (residual < 0.05 && filled_ >= BUCKETS / 4)
+        result.level = 2;
+    else
+        result.level = 1;
+
+    return true;
+}
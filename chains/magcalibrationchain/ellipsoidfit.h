@@ -0,0 +1,127 @@
+/**
+   @file ellipsoidfit.h
+   @brief Incremental ellipsoid fit for magnetometer calibration
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef ELLIPSOIDFIT_H
+#define ELLIPSOIDFIT_H
+
+/**
+ * Magnetometer calibration. Corrected value is
+ * <code>matrix * (raw - offset)</code>, where offset is the hard iron
+ * offset and matrix the soft iron correction.
+ */
+struct MagCalibration
+{
+    /**
+     * Constructor. Creates identity calibration with level 0.
+     */
+    MagCalibration();
+
+    /**
+     * Apply calibration to a raw sample.
+     *
+     * @param x raw X value, replaced with corrected value.
+     * @param y raw Y value, replaced with corrected value.
+     * @param z raw Z value, replaced with corrected value.
+     */
+    void apply(int& x, int& y, int& z) const;
+
+    double matrix[3][3]; /**< soft iron correction */
+    double offset[3];    /**< hard iron offset */
+    double radius;       /**< expected corrected field magnitude, 0 if unknown */
+    int    level;        /**< calibration quality, 0 (none) - 3 (good) */
+};
+
+/**
+ * Fits an ellipsoid to magnetometer samples with recursive least
+ * squares. Samples are bucketed by their direction from the current
+ * center estimate and a bucket feeds the fit at most once per
+ * #BUCKETS offered samples, so lingering in one orientation does not skew the result.
+ * A bucket that keeps being hit as soon as it may be, as with a device at
+ * rest, does not feed the fit at all.
+ *
+ * The fit is not thread safe. #MagCalibrationEngine runs it on its own
+ * thread.
+ */
+class EllipsoidFit
+{
+public:
+    /**
+     * Constructor.
+     */
+    EllipsoidFit();
+
+    /**
+     * Drop all samples and fit state.
+     */
+    void reset();
+
+    /**
+     * Offer a raw sample to the fit.
+     *
+     * @param x raw X value.
+     * @param y raw Y value.
+     * @param z raw Z value.
+     * @return true if the sample was used to update the fit.
+     */
+    bool addSample(double x, double y, double z);
+
+    /**
+     * Derive calibration from the current fit.
+     *
+     * @param result set to the calibration if fit is usable.
+     * @return true if the fit describes a plausible ellipsoid.
+     */
+    bool solve(MagCalibration& result) const;
+
+    /**
+     * Number of direction buckets holding a sample.
+     *
+     * @return number of filled buckets.
+     */
+    int coverage() const;
+
+    static const int BUCKETS = 48; /**< number of direction buckets */
+
+private:
+    static const int PARAMS = 9;   /**< ellipsoid model parameters */
+
+    /**
+     * Find direction bucket of a scaled sample.
+     */
+    int bucketOf(const double p[3]) const;
+
+    /**
+     * Recursive least squares update with a single sample.
+     */
+    void update(const double p[3]);
+
+    double theta_[PARAMS];         /**< model parameters */
+    double cov_[PARAMS][PARAMS];   /**< inverse correlation matrix */
+    double bucket_[BUCKETS][3];    /**< latest scaled sample of a bucket */
+    int    stamp_[BUCKETS];        /**< sample count when bucket was fed */
+    int    filled_;                /**< number of used buckets */
+    int    seen_;                  /**< number of offered samples */
+    double scale_;                 /**< raw to internal unit divisor */
+    double min_[3];                /**< per-axis minimum, scaled */
+    double max_[3];                /**< per-axis maximum, scaled */
+};
+
+#endif // ELLIPSOIDFIT_H
@@ -69,7 +69,7 @@ MagCalibrationChain::MagCalibrationChain(const QString& id) :
     nameOutputBuffer("calibratedmagnetometerdata", calibratedMagnetometerData);
 
     // Create buffers for filter chain
-    filterBin = new Bin;
+    filterBin = new Bin(id);
     //formationsink
     magReader = new BufferReader<CalibratedMagneticFieldData>(1);
 
@@ -91,6 +91,13 @@ MagCalibrationChain::MagCalibrationChain(const QString& id) :
     if (needsCalibration) {
         magCalFilter = sm.instantiateFilter("calibrationfilter");
 
+        QString statePath = SensorFrameworkConfig::configuration()->value<QString>("magnetometer/calibration_state_file",
+                                                                                   "/var/lib/sensorfw/magcalibration.state");
+        if (!statePath.isEmpty() && magAdaptor) {
+            QString key = QString("%1/%2/%3").arg(magAdaptor->id(), magAdaptor->description(), id());
+            static_cast<CalibrationFilter*>(magCalFilter)->setCalibrationStore(statePath, key);
+        }
+
         ((MagCoordinateAlignFilter*)magCoordinateAlignFilter_)->setMatrix(TMagMatrix(aconv_));
 
         filterBin->add(magCalFilter, "calibration");
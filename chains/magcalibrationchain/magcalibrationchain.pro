@@ -2,11 +2,17 @@ TARGET  = magcalibrationchain
 
 HEADERS += magcalibrationchain.h \
            calibrationfilter.h \
+           ellipsoidfit.h \
+           magcalibrationengine.h \
+           magcalibrationstore.h \
            magcalibrationchainplugin.h
  #       qvector3d.h
 
 SOURCES += magcalibrationchain.cpp \
            calibrationfilter.cpp \
+           ellipsoidfit.cpp \
+           magcalibrationengine.cpp \
+           magcalibrationstore.cpp \
            magcalibrationchainplugin.cpp
 #        qvector3d.cpp
 
@@ -0,0 +1,224 @@
+/**
+   @file magcalibrationengine.cpp
+   @brief Background magnetometer calibration
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "magcalibrationengine.h"
+#include "magcalibrationstore.h"
+#include "logging.h"
+#include <QMutexLocker>
+#include <math.h>
+
+/* Maximum number of samples waiting for the worker. */
+#define MAX_PENDING 64
+/* Fit updates between solving the calibration. */
+#define SOLVE_INTERVAL 8
+/* Live samples used to validate a restored calibration. */
+#define VALIDATION_SAMPLES 32
+/* Largest accepted mean relative magnitude error of restored calibration. */
+#define MAX_DEVIATION 0.25
+/* Minimum time between saves of calibration with unchanged level, ms. */
+#define SAVE_INTERVAL 300000
+
+MagCalibrationEngine::MagCalibrationEngine() :
+    running_(true),
+    resetFit_(false),
+    published_(0),
+    store_(0),
+    restored_(false),
+    validated_(0),
+    deviation_(0),
+    savedLevel_(0),
+    dirty_(false)
+{
+    pending_.reserve(MAX_PENDING);
+    start(QThread::LowPriority);
+}
+
+MagCalibrationEngine::~MagCalibrationEngine()
+{
+    mutex_.lock();
+    running_ = false;
+    wakeup_.wakeOne();
+    mutex_.unlock();
+    wait();
+
+    if (dirty_)
+        persist(last_, true);
+
+    delete published_.fetchAndStoreOrdered(0);
+    delete store_;
+}
+
+void MagCalibrationEngine::addSample(int x, int y, int z)
+{
+    if (!mutex_.tryLock())
+        return;
+
+    if (pending_.size() < MAX_PENDING) {
+        Sample sample = { x, y, z };
+        pending_.append(sample);
+        wakeup_.wakeOne();
+    }
+    mutex_.unlock();
+}
+
+MagCalibration* MagCalibrationEngine::takeCalibration()
+{
+    return published_.fetchAndStoreOrdered(0);
+}
+
+void MagCalibrationEngine::reset()
+{
+    QMutexLocker locker(&mutex_);
+    pending_.clear();
+    resetFit_ = true;
+    wakeup_.wakeOne();
+}
+
+void MagCalibrationEngine::setStore(MagCalibrationStore* store)
+{
+    MagCalibration restored;
+    bool valid = store->load(restored);
+
+    QMutexLocker locker(&mutex_);
+    delete store_;
+    store_ = store;
+    if (valid) {
+        sensordLogD() << "[MagCalibrationEngine]: restored calibration level" << restored.level
+                      << "from" << store->path();
+        last_ = restored;
+        restored_ = true;
+        validated_ = 0;
+        deviation_ = 0;
+        savedLevel_ = restored.level;
+        saveTimer_.start();
+
+        // Do not claim full quality before validation.
+        MagCalibration unvalidated(restored);
+        unvalidated.level = qMin(unvalidated.level, 2);
+        publish(unvalidated);
+    }
+}
+
+void MagCalibrationEngine::validate(const Sample& sample)
+{
+    int x = sample.x;
+    int y = sample.y;
+    int z = sample.z;
+    last_.apply(x, y, z);
+
+    double magnitude = sqrt((double)x * x + (double)y * y + (double)z * z);
+    deviation_ += fabs(magnitude / last_.radius - 1);
+    if (++validated_ < VALIDATION_SAMPLES)
+        return;
+
+    if (deviation_ / validated_ <= MAX_DEVIATION) {
+        publish(last_);
+        return;
+    }
+
+    sensordLogW() << "[MagCalibrationEngine]: restored calibration does not match live data, dropping it";
+    last_ = MagCalibration();
+    restored_ = false;
+    publish(last_);
+    persist(last_, true);
+}
+
+void MagCalibrationEngine::persist(const MagCalibration& calibration, bool force)
+{
+    if (!store_)
+        return;
+
+    if (!force && calibration.level == savedLevel_ && saveTimer_.isValid()
+            && saveTimer_.elapsed() < SAVE_INTERVAL) {
+        dirty_ = true;
+        return;
+    }
+
+    store_->save(calibration);
+    savedLevel_ = calibration.level;
+    dirty_ = false;
+    saveTimer_.start();
+}
+
+void MagCalibrationEngine::publish(const MagCalibration& calibration)
+{
+    // If the previous calibration was not taken yet nobody else can
+    // reference it anymore, so it is safe to delete.
+    delete published_.fetchAndStoreOrdered(new MagCalibration(calibration));
+}
+
+void MagCalibrationEngine::run()
+{
+    QVector<Sample> samples;
+    samples.reserve(MAX_PENDING);
+    int updates = 0;
+
+    forever {
+        bool resetFit;
+        {
+            QMutexLocker locker(&mutex_);
+            while (running_ && !resetFit_ && pending_.isEmpty())
+                wakeup_.wait(&mutex_);
+            if (!running_)
+                return;
+            samples.swap(pending_);
+            resetFit = resetFit_;
+            resetFit_ = false;
+        }
+
+        if (resetFit) {
+            fit_.reset();
+            last_ = MagCalibration();
+            restored_ = false;
+            updates = 0;
+            publish(last_);
+            persist(last_, true);
+        }
+
+        foreach (const Sample& sample, samples) {
+            if (restored_ && validated_ < VALIDATION_SAMPLES)
+                validate(sample);
+            if (fit_.addSample(sample.x, sample.y, sample.z))
+                ++updates;
+        }
+        samples.clear();
+
+        if (updates < SOLVE_INTERVAL)
+            continue;
+        updates = 0;
+
+        MagCalibration calibration;
+        if (!fit_.solve(calibration))
+            continue;
+
+        // Keep a validated restored calibration until the fit catches up.
+        if (restored_ && calibration.level < last_.level)
+            continue;
+        restored_ = false;
+
+        if (calibration.level != last_.level)
+            sensordLogD() << "[MagCalibrationEngine]: calibration level" << calibration.level
+                          << "with" << fit_.coverage() << "of" << EllipsoidFit::BUCKETS << "directions";
+        last_ = calibration;
+        publish(calibration);
+        persist(calibration, false);
+    }
+}
@@ -0,0 +1,139 @@
+/**
+   @file magcalibrationengine.h
+   @brief Background magnetometer calibration
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef MAGCALIBRATIONENGINE_H
+#define MAGCALIBRATIONENGINE_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+
+#include "ellipsoidfit.h"
+
+class MagCalibrationStore;
+
+/**
+ * Runs #EllipsoidFit on a low priority thread. Samples are handed over
+ * from the sensor thread without blocking it and finished calibrations
+ * are published through a single atomic pointer swap.
+ *
+ * With a #MagCalibrationStore set, the stored calibration is published
+ * immediately and checked against the first live samples. Calibrations
+ * are saved from the worker thread when their level changes, at most
+ * every few minutes otherwise, and on destruction.
+ */
+class MagCalibrationEngine : public QThread
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(MagCalibrationEngine)
+
+public:
+    /**
+     * Constructor. Starts the worker thread.
+     */
+    MagCalibrationEngine();
+
+    /**
+     * Destructor. Stops the worker thread.
+     */
+    ~MagCalibrationEngine();
+
+    /**
+     * Queue a raw sample for fitting. Never blocks, samples are dropped
+     * when the worker is busy.
+     *
+     * @param x raw X value.
+     * @param y raw Y value.
+     * @param z raw Z value.
+     */
+    void addSample(int x, int y, int z);
+
+    /**
+     * Take the most recently published calibration.
+     *
+     * @return calibration owned by caller, or 0 if nothing new has
+     *         been published since the previous call.
+     */
+    MagCalibration* takeCalibration();
+
+    /**
+     * Drop collected samples and publish identity calibration.
+     */
+    void reset();
+
+    /**
+     * Set persistent storage for calibration and restore calibration
+     * from it. Must be called before samples are added.
+     *
+     * @param store Calibration storage. Ownership is transferred.
+     */
+    void setStore(MagCalibrationStore* store);
+
+protected:
+    /**
+     * Worker thread entry-function.
+     */
+    void run();
+
+private:
+    struct Sample
+    {
+        int x, y, z;
+    };
+
+    /**
+     * Replace the published calibration.
+     */
+    void publish(const MagCalibration& calibration);
+
+    /**
+     * Check restored calibration against a live sample. Restored
+     * calibration is dropped if corrected magnitudes of the first
+     * samples deviate too much from the stored field strength.
+     */
+    void validate(const Sample& sample);
+
+    /**
+     * Save calibration if it differs enough from the saved one.
+     */
+    void persist(const MagCalibration& calibration, bool force);
+
+    QMutex                         mutex_;      /**< protects pending state */
+    QWaitCondition                 wakeup_;     /**< signals pending work */
+    QVector<Sample>                pending_;    /**< samples not yet fitted */
+    bool                           running_;    /**< should worker keep running */
+    bool                           resetFit_;   /**< fit should be reset */
+    QAtomicPointer<MagCalibration> published_;  /**< calibration not yet taken */
+    EllipsoidFit                   fit_;        /**< worker thread only */
+    MagCalibration                 last_;       /**< worker thread only */
+    MagCalibrationStore*           store_;      /**< persistent storage or 0 */
+    bool                           restored_;   /**< last_ came from store_ */
+    int                            validated_;  /**< samples checked against restored calibration */
+    double                         deviation_;  /**< accumulated relative magnitude error */
+    int                            savedLevel_; /**< level of the saved calibration */
+    bool                           dirty_;      /**< last_ not saved yet */
+    QElapsedTimer                  saveTimer_;  /**< time since last save */
+};
+
+#endif // MAGCALIBRATIONENGINE_H
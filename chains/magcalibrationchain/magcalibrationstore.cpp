@@ -0,0 +1,161 @@
+/**
+   @file magcalibrationstore.cpp
+   @brief Persistent magnetometer calibration state
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "magcalibrationstore.h"
+#include "logging.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QDataStream>
+#include <math.h>
+
+MagCalibrationStore::MagCalibrationStore(const QString& path, const QString& key) :
+    path_(path),
+    key_(key)
+{
+}
+
+const QString& MagCalibrationStore::path() const
+{
+    return path_;
+}
+
+bool MagCalibrationStore::readEntries(QMap<QString, QByteArray>& entries) const
+{
+    QFile file(path_);
+    if (!file.exists())
+        return true;
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        sensordLogW() << "[MagCalibrationStore]: failed to open" << path_ << ":" << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if (magic != MAGIC || version != VERSION) {
+        sensordLogW() << "[MagCalibrationStore]: ignoring" << path_ << "with unknown format" << version;
+        return false;
+    }
+
+    quint32 count = 0;
+    stream >> count;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString key;
+        QByteArray entry;
+        stream >> key >> entry;
+        entries.insert(key, entry);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        sensordLogW() << "[MagCalibrationStore]: ignoring truncated" << path_;
+        entries.clear();
+        return false;
+    }
+    return true;
+}
+
+bool MagCalibrationStore::load(MagCalibration& calibration) const
+{
+    QMap<QString, QByteArray> entries;
+    if (!readEntries(entries) || !entries.contains(key_))
+        return false;
+
+    QDataStream stream(entries.value(key_));
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    MagCalibration stored;
+    qint32 level = 0;
+    stream >> level >> stored.radius;
+    for (int i = 0; i < 3; ++i)
+        stream >> stored.offset[i];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            stream >> stored.matrix[i][j];
+    stored.level = level;
+
+    if (stream.status() != QDataStream::Ok || level < 1 || level > 3 || !(stored.radius > 0)) {
+        sensordLogW() << "[MagCalibrationStore]: invalid entry" << key_ << "in" << path_;
+        return false;
+    }
+
+    // Soft iron correction preserves volume, so anything far from unit
+    // determinant is corrupt.
+    const double (&m)[3][3] = stored.matrix;
+    double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+               - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+               + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    if (!(fabs(det - 1) < 0.1)) {
+        sensordLogW() << "[MagCalibrationStore]: implausible entry" << key_ << "in" << path_;
+        return false;
+    }
+
+    calibration = stored;
+    return true;
+}
+
+bool MagCalibrationStore::save(const MagCalibration& calibration) const
+{
+    QMap<QString, QByteArray> entries;
+    readEntries(entries);
+
+    if (calibration.level > 0) {
+        QByteArray entry;
+        QDataStream stream(&entry, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << (qint32)calibration.level << calibration.radius;
+        for (int i = 0; i < 3; ++i)
+            stream << calibration.offset[i];
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                stream << calibration.matrix[i][j];
+        entries.insert(key_, entry);
+    } else {
+        entries.remove(key_);
+    }
+
+    QDir().mkpath(QFileInfo(path_).absolutePath());
+
+    // Write to a temporary file and rename so a crash never leaves a
+    // partial state file behind.
+    QSaveFile file(path_);
+    if (!file.open(QIODevice::WriteOnly)) {
+        sensordLogW() << "[MagCalibrationStore]: failed to open" << path_ << ":" << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << MAGIC << VERSION << (quint32)entries.size();
+    for (QMap<QString, QByteArray>::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it)
+        stream << it.key() << it.value();
+
+    if (!file.commit()) {
+        sensordLogW() << "[MagCalibrationStore]: failed to write" << path_ << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
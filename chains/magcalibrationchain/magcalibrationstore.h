@@ -0,0 +1,92 @@
+/**
+   @file magcalibrationstore.h
+   @brief Persistent magnetometer calibration state
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef MAGCALIBRATIONSTORE_H
+#define MAGCALIBRATIONSTORE_H
+
+#include <QString>
+#include <QMap>
+#include <QByteArray>
+
+#include "ellipsoidfit.h"
+
+/**
+ * Stores magnetometer calibrations in a small versioned binary file so
+ * they survive daemon restarts. The file holds one entry per key, where
+ * key identifies the device and sensor the calibration belongs to.
+ * Entries of other keys are preserved when saving.
+ *
+ * File layout (QDataStream, big endian): magic, format version, entry
+ * count and for each entry the key and a serialized #MagCalibration.
+ * Files with unknown magic or version are ignored.
+ */
+class MagCalibrationStore
+{
+public:
+    /**
+     * Constructor.
+     *
+     * @param path State file location.
+     * @param key Identifies the calibrated device and sensor.
+     */
+    MagCalibrationStore(const QString& path, const QString& key);
+
+    /**
+     * Load stored calibration.
+     *
+     * @param calibration set to the stored calibration.
+     * @return true if a usable calibration was found.
+     */
+    bool load(MagCalibration& calibration) const;
+
+    /**
+     * Store calibration, replacing the previous one with same key.
+     * Level 0 calibration removes the entry.
+     *
+     * @param calibration calibration to store.
+     * @return true on success.
+     */
+    bool save(const MagCalibration& calibration) const;
+
+    /**
+     * Get state file location.
+     *
+     * @return file path.
+     */
+    const QString& path() const;
+
+    static const quint32 MAGIC = 0x53464d43; /**< "SFMC" */
+    static const quint16 VERSION = 1;        /**< current file format */
+
+private:
+    /**
+     * Read all entries of the state file.
+     *
+     * @param entries set to serialized calibrations by key.
+     * @return false if file exists but is not valid.
+     */
+    bool readEntries(QMap<QString, QByteArray>& entries) const;
+
+    QString path_; /**< state file location */
+    QString key_;  /**< entry key */
+};
+
+#endif // MAGCALIBRATIONSTORE_H
@@ -51,7 +51,7 @@ OrientationChain::OrientationChain(const QString& id) :
     nameOutputBuffer("orientation", orientationOutput_);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(accelerometerReader_, "accelerometer");
     filterBin_->add(orientationInterpreterFilter_, "orientationinterpreter");
@@ -0,0 +1,124 @@
+/**
+   @file stepdetectorchain.cpp
+   @brief StepDetectorChain
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "stepdetectorchain.h"
+#include "sensormanager.h"
+#include "bin.h"
+#include "bufferreader.h"
+#include "logging.h"
+#include "config.h"
+
+/* Accelerometer interval needed to resolve walking cadence, ms. */
+#define DEFAULT_ACCELEROMETER_INTERVAL 20
+
+StepDetectorChain::StepDetectorChain(const QString& id) :
+    AbstractChain(id)
+{
+    SensorManager& sm = SensorManager::instance();
+
+    sessionId_ = sm.createNewSessionId();
+    accelerometerInterval_ = SensorFrameworkConfig::configuration()->value<unsigned int>("stepdetector/accelerometer_interval", DEFAULT_ACCELEROMETER_INTERVAL);
+
+    accelerometerChain_ = sm.requestChain("accelerometerchain");
+    Q_ASSERT( accelerometerChain_ );
+    setValid(accelerometerChain_->isValid());
+
+    accelerometerReader_ = new BufferReader<AccelerationData>(1);
+
+    stepDetectorFilter_ = sm.instantiateFilter("stepdetectorfilter");
+    Q_ASSERT( stepDetectorFilter_ );
+
+    outputBuffer_ = new RingBuffer<TimedUnsigned>(1);
+    nameOutputBuffer("stepcounter", outputBuffer_);
+
+    // Create buffers for filter chain
+    filterBin_ = new Bin(id);
+
+    filterBin_->add(accelerometerReader_, "accelerometer");
+    filterBin_->add(stepDetectorFilter_, "stepdetector");
+    filterBin_->add(outputBuffer_, "buffer");
+
+    // Join filterchain buffers
+    if (!filterBin_->join("accelerometer", "source", "stepdetector", "sink"))
+        qDebug() << Q_FUNC_INFO << "accelerometer/stepdetector join failed";
+
+    if (!filterBin_->join("stepdetector", "source", "buffer", "sink"))
+        qDebug() << Q_FUNC_INFO << "stepdetector/buffer join failed";
+
+    // Join datasources to the chain
+    connectToSource(accelerometerChain_, "accelerometer", accelerometerReader_);
+
+    setDescription("Steps detected from accelerometer");
+    addStandbyOverrideSource(accelerometerChain_);
+
+    // Steps are reported as they happen, client intervals do not pace
+    // the accelerometer. The chain keeps its own request on it instead.
+    introduceAvailableInterval(DataRange(0, 1000, 0));
+}
+
+StepDetectorChain::~StepDetectorChain()
+{
+    SensorManager& sm = SensorManager::instance();
+
+    disconnectFromSource(accelerometerChain_, "accelerometer", accelerometerReader_);
+
+    sm.releaseChain("accelerometerchain");
+
+    delete accelerometerReader_;
+    delete stepDetectorFilter_;
+    delete outputBuffer_;
+    delete filterBin_;
+}
+
+bool StepDetectorChain::start()
+{
+    if (AbstractSensorChannel::start()) {
+        sensordLogD() << "Starting StepDetectorChain";
+        filterBin_->start();
+        if (!accelerometerChain_->setIntervalRequest(sessionId_, accelerometerInterval_))
+            sensordLogW() << "Accelerometer does not support" << accelerometerInterval_ << "ms interval for step detection";
+        accelerometerChain_->start();
+    }
+    return true;
+}
+
+bool StepDetectorChain::stop()
+{
+    if (AbstractSensorChannel::stop()) {
+        sensordLogD() << "Stopping StepDetectorChain";
+        accelerometerChain_->stop();
+        accelerometerChain_->removeIntervalRequest(sessionId_);
+        filterBin_->stop();
+    }
+    return true;
+}
+
+unsigned int StepDetectorChain::interval() const
+{
+    return accelerometerInterval_;
+}
+
+bool StepDetectorChain::setInterval(unsigned int value, int sessionId)
+{
+    Q_UNUSED(value);
+    Q_UNUSED(sessionId);
+    return true;
+}
@@ -0,0 +1,83 @@
+/**
+   @file stepdetectorchain.h
+   @brief StepDetectorChain
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef STEPDETECTORCHAIN_H
+#define STEPDETECTORCHAIN_H
+
+#include "abstractsensor.h"
+#include "abstractchain.h"
+#include "deviceadaptor.h"
+#include "datatypes/orientationdata.h"
+#include "datatypes/timedunsigned.h"
+
+class Bin;
+template <class TYPE> class BufferReader;
+class FilterBase;
+
+/**
+ * @brief Stepdetectorchain counts steps from the accelerometer stream
+ * for devices without a hardware step counter. All step counter
+ * sessions share the one detector. The accelerometer is always sampled
+ * at <tt>stepdetector/accelerometer_interval</tt>, intervals requested by
+ * clients are accepted but not forwarded.
+ *
+ * <b>Output buffers:</b>
+ * <ul><li><em>stepcounter</em> total steps, one sample per detected step</li></ul>
+ */
+class StepDetectorChain : public AbstractChain
+{
+    Q_OBJECT;
+
+public:
+    /**
+     * Factory method for StepDetectorChain.
+     * @return Pointer to new StepDetectorChain instance as AbstractChain*
+     */
+    static AbstractChain* factoryMethod(const QString& id)
+    {
+        StepDetectorChain* sc = new StepDetectorChain(id);
+        return sc;
+    }
+
+public Q_SLOTS:
+    bool start();
+    bool stop();
+
+protected:
+    StepDetectorChain(const QString& id);
+    ~StepDetectorChain();
+
+    virtual unsigned int interval() const;
+    virtual bool setInterval(unsigned int value, int sessionId);
+
+private:
+    Bin*                             filterBin_;
+
+    AbstractChain*                   accelerometerChain_;
+    BufferReader<AccelerationData>*  accelerometerReader_;
+    FilterBase*                      stepDetectorFilter_;
+    RingBuffer<TimedUnsigned>*       outputBuffer_;
+
+    int                              sessionId_;             /**< session of the accelerometer interval request */
+    unsigned int                     accelerometerInterval_; /**< requested accelerometer interval, ms */
+};
+
+#endif // STEPDETECTORCHAIN_H
@@ -0,0 +1,9 @@
+TARGET       = stepdetectorchain
+
+HEADERS += stepdetectorchain.h   \
+           stepdetectorchainplugin.h
+
+SOURCES += stepdetectorchain.cpp   \
+           stepdetectorchainplugin.cpp
+
+include( ../chain-config.pri )
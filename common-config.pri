@@ -29,6 +29,12 @@ profile-libc {
   QMAKE_LFLAGS += -lc_p
 }
 
+# Integer arithmetic in filters by default, for targets without fast
+# floating point. filters/fixed_point in configuration overrides it.
+fixedpoint {
+  DEFINES += SENSORFW_FIXED_POINT
+}
+
 TARGET = $$TARGET-qt5
 
 OTHER_FILES += \
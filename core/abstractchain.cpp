@@ -53,6 +53,7 @@ RingBufferBase* AbstractChain::findBuffer(const QString& name) const
 void AbstractChain::nameOutputBuffer(const QString& name, RingBufferBase* buffer)
 {
     outputBufferMap_.insert(name, buffer);
+    buffer->setStatsLabels(id(), name);
 }
 
 const QMap<QString, RingBufferBase*>& AbstractChain::buffers() const
@@ -31,14 +31,37 @@
 #include "abstractsensor.h"
 #include "sensormanager.h"
 #include "sockethandler.h"
+#include "samplehistory.h"
+#include "config.h"
 #include "idutils.h"
 #include "logging.h"
+#include "datatypes/utils.h"
+
+/** Maximum number of history samples written to socket in single frame. */
+static const unsigned int HISTORY_FRAME_SIZE = 256;
+
+/** Default upper limit for the number of stored history samples. */
+static const unsigned int HISTORY_DEFAULT_CAPACITY = 1024;
 
 AbstractSensorChannel::AbstractSensorChannel(const QString& id) :
     NodeBase(getCleanId(id)),
     errorCode_(SNoError),
-    cnt_(0)
+    cnt_(0),
+    history_(NULL),
+    layout_(NULL)
+{
+    unsigned int seconds = SensorFrameworkConfig::configuration()->value<unsigned int>(this->id() + "/history_seconds", 0);
+    if (seconds)
+    {
+        unsigned int capacity = SensorFrameworkConfig::configuration()->value<unsigned int>(this->id() + "/history_samples", HISTORY_DEFAULT_CAPACITY);
+        sensordLogD() << "Keeping" << seconds << "seconds (max" << capacity << "samples) of history for" << this->id();
+        history_ = new SampleHistory((quint64)seconds * 1000000, capacity);
+    }
+}
+
+AbstractSensorChannel::~AbstractSensorChannel()
 {
+    delete history_;
 }
 
 void AbstractSensorChannel::setError(SensorError errorCode, const QString& errorString)
@@ -56,7 +79,8 @@ bool AbstractSensorChannel::start(int sessionId)
     if(!activeSessions_.contains(sessionId))
     {
         activeSessions_.insert(sessionId);
-        requestDefaultInterval(sessionId);
+        if (!getInterval(sessionId))
+            requestDefaultInterval(sessionId);
         return start();
     }
     return false;
@@ -88,26 +112,104 @@ bool AbstractSensorChannel::stop()
 
 bool AbstractSensorChannel::writeToSession(int sessionId, const void* source, int size)
 {
-    if (!(SensorManager::instance().write(sessionId, source, size))) {
+    if (!(SensorManager::instance().write(sessionId, source, size, 1, layout_))) {
         sensordLogD() << "AbstractSensor failed to write to session " << sessionId;
         return false;
     }
     return true;
 }
 
+void AbstractSensorChannel::recordHistory(const void* source, int size)
+{
+    if (history_)
+        history_->append(source, size);
+}
+
+bool AbstractSensorChannel::historyEnabled() const
+{
+    return history_ != NULL;
+}
+
+unsigned int AbstractSensorChannel::requestHistory(int sessionId, unsigned int seconds)
+{
+    if (!history_)
+    {
+        sensordLogD() << "History requested by session" << sessionId << "but not enabled for" << id();
+        return 0;
+    }
+
+    quint64 length = qMin((quint64)seconds * 1000000, history_->length());
+    quint64 now = Utils::getTimeStamp();
+    int size = 0;
+    unsigned int count = 0;
+    QByteArray samples(history_->collect(now > length ? now - length : 0, size, count));
+
+    sensordLogT() << "Delivering" << count << "history samples of" << id() << "to session" << sessionId;
+
+    const char* data = samples.constData();
+    unsigned int written = 0;
+    while (written < count)
+    {
+        unsigned int frame = qMin(count - written, HISTORY_FRAME_SIZE);
+        if (!SensorManager::instance().writeNow(sessionId, data + written * size, size, frame, layout_))
+        {
+            sensordLogW() << "Failed to write history of" << id() << "to session" << sessionId;
+            break;
+        }
+        written += frame;
+    }
+    return written;
+}
+
 bool AbstractSensorChannel::writeToClients(const void* source, int size)
 {
     bool ret = true;
+    recordHistory(source, size);
     foreach(int sessionId, activeSessions_) {
         ret &= writeToSession(sessionId, source, size);
     }
     return ret;
 }
 
+bool AbstractSensorChannel::writeToClients(const void* source, int size, quint64 timestamp)
+{
+    bool ret = true;
+    recordHistory(source, size);
+    foreach(int sessionId, activeSessions_) {
+        if (downsamplingEnabled(sessionId) && !isDue(sessionId, timestamp))
+            continue;
+        ret &= writeToSession(sessionId, source, size);
+    }
+    return ret;
+}
+
+bool AbstractSensorChannel::writeChangeToClients(const void* source, int size, quint64 timestamp, bool changed)
+{
+    bool ret = true;
+    if (changed) {
+        recordHistory(source, size);
+        changePending_ = activeSessions_;
+    }
+    foreach(int sessionId, activeSessions_) {
+        bool due = !downsamplingEnabled(sessionId) || isDue(sessionId, timestamp);
+        if (!due || !changePending_.contains(sessionId))
+            continue;
+        changePending_.remove(sessionId);
+        ret &= writeToSession(sessionId, source, size);
+    }
+    return ret;
+}
+
+bool AbstractSensorChannel::isDue(int sessionId, quint64 timestamp)
+{
+    return decimators_[sessionId].isDue(timestamp, getInterval(sessionId), getInterval());
+}
+
 bool AbstractSensorChannel::downsampleAndPropagate(const TimedXyzData& data, TimedXyzDownsampleBuffer& buffer)
 {
     bool ret = true;
-    unsigned int currentInterval = getInterval();
+    layout_ = WireFormat::layout<TimedXyzData>();
+    recordHistory(&data, sizeof(TimedXyzData));
     foreach(int sessionId, activeSessions_)
     {
         if(!downsamplingEnabled(sessionId))
@@ -115,26 +217,13 @@ bool AbstractSensorChannel::downsampleAndPropagate(const TimedXyzData& data, Tim
             ret &= writeToSession(sessionId, (const void *)& data, sizeof(TimedXyzData));
             continue;
         }
-        unsigned int sessionInterval = getInterval(sessionId);
-        int bufferSize = (sessionInterval < currentInterval || !currentInterval) ? 1 : sessionInterval / currentInterval;
 
         QList<TimedXyzData>& samples(buffer[sessionId]);
         samples.push_back(data);
+        while(data.timestamp_ - samples.front().timestamp_ > 2000000)
+            samples.pop_front();
 
-        for(QList<TimedXyzData>::iterator it = samples.begin(); it != samples.end(); ++it)
-        {
-            if(samples.size() > bufferSize ||
-               data.timestamp_ - it->timestamp_ > 2000000)
-            {
-                it = samples.erase(it);
-                if(it == samples.end())
-                    break;
-            }
-            else
-                break;
-        }
-
-        if(samples.size() < bufferSize)
+        if(!isDue(sessionId, data.timestamp_))
             continue;
 
         long x = 0;
@@ -167,7 +256,8 @@ bool AbstractSensorChannel::downsampleAndPropagate(const TimedXyzData& data, Tim
 bool AbstractSensorChannel::downsampleAndPropagate(const CalibratedMagneticFieldData& data, MagneticFieldDownsampleBuffer& buffer)
 {
     bool ret = true;
-    unsigned int currentInterval = getInterval();
+    layout_ = WireFormat::layout<CalibratedMagneticFieldData>();
+    recordHistory(&data, sizeof(CalibratedMagneticFieldData));
     foreach(int sessionId, activeSessions_)
     {
         if(!downsamplingEnabled(sessionId))
@@ -175,26 +265,13 @@ bool AbstractSensorChannel::downsampleAndPropagate(const CalibratedMagneticField
             ret &= writeToSession(sessionId, (const void *)& data, sizeof(CalibratedMagneticFieldData));
             continue;
         }
-        unsigned int sessionInterval = getInterval(sessionId);
-        int bufferSize = (sessionInterval < currentInterval || !currentInterval) ? 1 : sessionInterval / currentInterval;
 
         QList<CalibratedMagneticFieldData>& samples(buffer[sessionId]);
         samples.push_back(data);
+        while(data.timestamp_ - samples.front().timestamp_ > 2000000)
+            samples.pop_front();
 
-        for(QList<CalibratedMagneticFieldData>::iterator it = samples.begin(); it != samples.end(); ++it)
-        {
-            if(samples.size() > bufferSize ||
-               data.timestamp_ - it->timestamp_ > 2000000)
-            {
-                it = samples.erase(it);
-                if(it == samples.end())
-                    break;
-            }
-            else
-                break;
-        }
-
-        if(samples.size() < bufferSize)
+        if(!isDue(sessionId, data.timestamp_))
             continue;
 
         long x = 0;
@@ -260,6 +337,8 @@ bool AbstractSensorChannel::downsamplingSupported() const
 void AbstractSensorChannel::removeSession(int sessionId)
 {
     downsampling_.take(sessionId);
+    decimators_.remove(sessionId);
+    changePending_.remove(sessionId);
     NodeBase::removeSession(sessionId);
 }
 
@@ -42,7 +42,10 @@
 #include "datarange.h"
 #include "genericdata.h"
 #include "orientationdata.h"
+#include "wireformat.h"
+#include "sampledecimator.h"
 
+class SampleHistory;
 /**
  * Base class for sensor type specific nodes. This is used as base class
  * for chains and graph endpoint nodes which are responsible of streaming
@@ -61,7 +64,7 @@ public:
     /**
      * Destructor.
      */
-    virtual ~AbstractSensorChannel() {}
+    virtual ~AbstractSensorChannel();
 
     /**
      * Last occured error.
@@ -131,7 +134,8 @@ public:
     virtual bool start();
 
     /**
-     * Start data flow for given session.
+     * Start data flow for given session. Default interval is requested
+     * for the session unless it already has an interval request.
      *
      * @param sessionId session ID.
      * @return True if sensor was started. False if it is already running.
@@ -158,6 +162,29 @@ public:
      */
     bool stop(int sessionId);
 
+    /**
+     * Is sample history enabled for this channel. History length is
+     * configured with <tt>&lt;sensor id&gt;/history_seconds</tt>.
+     *
+     * @return is sample history kept.
+     */
+    bool historyEnabled() const;
+
+    /**
+     * Write recently produced samples to given session. Samples are
+     * delivered over the data socket in chronological order as regular
+     * frames. History is handed to the socket before this call returns,
+     * so it reaches a session that is not started yet ahead of any live
+     * data. For a running session live samples may already be written
+     * before it. Must be called in the main thread.
+     *
+     * @param sessionId session ID.
+     * @param seconds How many seconds of history to deliver. Limited by
+     *                the configured history length.
+     * @return number of samples accepted by the session socket.
+     */
+    unsigned int requestHistory(int sessionId, unsigned int seconds);
+
 Q_SIGNALS:
     /**
      * Signal is emitted for occured errors.
@@ -202,6 +229,62 @@ protected:
      */
     bool writeToClients(const void* source, int size);
 
+    /**
+     * Write output sample to all connected sessions. Unlike
+     * #writeToClients(const void*, int) this lets sessions encode the
+     * sample field by field instead of sending its memory.
+     *
+     * @param sample Sample to write.
+     * @return was data succesfully written.
+     */
+    template <class T>
+    bool writeToClients(const T& sample)
+    {
+        layout_ = WireFormat::layout<T>();
+        return writeToClients((const void*)&sample, sizeof(T), sample.timestamp_);
+    }
+
+    /**
+     * Write output data to all connected sessions. Sessions with
+     * downsampling enabled and a longer interval than the sensor runs
+     * at only get the samples they are due.
+     *
+     * @param source Object to write.
+     * @param size Size of the object.
+     * @param timestamp Timestamp of the object.
+     * @return was data succesfully written.
+     */
+    bool writeToClients(const void* source, int size, quint64 timestamp);
+
+    /**
+     * Write output sample of a polled on-change channel. The channel
+     * hands in every sample it reads so session decimation keeps its
+     * phase; a change is delivered to each session on its first due
+     * sample and unchanged samples are not delivered at all.
+     *
+     * @param sample Sample to write.
+     * @param changed does the sample differ from the last one written.
+     * @return was data succesfully written.
+     */
+    template <class T>
+    bool writeChangeToClients(const T& sample, bool changed)
+    {
+        layout_ = WireFormat::layout<T>();
+        return writeChangeToClients((const void*)&sample, sizeof(T), sample.timestamp_, changed);
+    }
+
+    /**
+     * Write output data of a polled on-change channel. See
+     * #writeChangeToClients(const T&, bool).
+     *
+     * @param source Object to write.
+     * @param size Size of the object.
+     * @param timestamp Timestamp of the object.
+     * @param changed does the object differ from the last one written.
+     * @return was data succesfully written.
+     */
+    bool writeChangeToClients(const void* source, int size, quint64 timestamp, bool changed);
+
     /**
      * Downsample and propagate data to all connected sessions.
      *
@@ -240,11 +323,33 @@ private:
      */
     bool writeToSession(int sessionId, const void* source, int size);
 
+    /**
+     * Is a sample due for a session running slower than the sensor.
+     * See #SampleDecimator.
+     *
+     * @param sessionId session ID.
+     * @param timestamp sample timestamp, us.
+     * @return should the sample be delivered.
+     */
+    bool isDue(int sessionId, quint64 timestamp);
+
+    /**
+     * Store sample into history if it is enabled.
+     *
+     * @param source sample.
+     * @param size size of the sample.
+     */
+    void recordHistory(const void* source, int size);
+
     SensorError         errorCode_;       /**< previous occured error code */
     QString             errorString_;     /**< previous occured error description */
     int                 cnt_;             /**< usage reference count */
     QSet<int>           activeSessions_;  /**< active sessions */
     QMap<int, bool>     downsampling_;    /**< downsample state for sessions */
+    QMap<int, SampleDecimator> decimators_; /**< sample picking of sessions */
+    QSet<int>           changePending_;   /**< sessions not yet given the latest change */
+    SampleHistory*      history_;         /**< recent samples or NULL if disabled */
+    const WireLayout*   layout_;          /**< layout of written samples or NULL if not known */
 };
 
 /**
@@ -30,6 +30,47 @@
 #include "sfwerror.h"
 #include <sensormanager.h>
 #include <sockethandler.h>
+#include <limits.h>
+
+/**
+ * Read unsigned session parameter.
+ *
+ * @param parameters session parameters.
+ * @param key parameter name.
+ * @param value set to parameter value if it is present.
+ * @return \c false if parameter is present but not a non-negative number.
+ */
+static bool unsignedParameter(const QVariantMap& parameters, const QString& key, unsigned int& value)
+{
+    QVariantMap::const_iterator it = parameters.find(key);
+    if (it == parameters.end())
+        return true;
+    bool ok = false;
+    qlonglong number = it.value().toLongLong(&ok);
+    if (!ok || number < 0 || number > UINT_MAX)
+        return false;
+    value = number;
+    return true;
+}
+
+/**
+ * Read boolean session parameter.
+ *
+ * @param parameters session parameters.
+ * @param key parameter name.
+ * @param value set to parameter value if it is present.
+ * @return \c false if parameter is present but not a boolean.
+ */
+static bool boolParameter(const QVariantMap& parameters, const QString& key, bool& value)
+{
+    QVariantMap::const_iterator it = parameters.find(key);
+    if (it == parameters.end())
+        return true;
+    if (it.value().type() != QVariant::Bool)
+        return false;
+    value = it.value().toBool();
+    return true;
+}
 
 AbstractSensorChannelAdaptor::AbstractSensorChannelAdaptor(QObject *parent) :
     QDBusAbstractAdaptor(parent)
@@ -208,3 +249,112 @@ void AbstractSensorChannelAdaptor::setDownsampling(int sessionId, bool value)
 {
     node()->setDownsamplingEnabled(sessionId, value);
 }
+
+unsigned int AbstractSensorChannelAdaptor::requestHistory(int sessionId, unsigned int seconds)
+{
+    return node()->requestHistory(sessionId, seconds);
+}
+
+bool AbstractSensorChannelAdaptor::configureSession(int sessionId, const QVariantMap& parameters)
+{
+    static const QStringList keys = QStringList() << "interval" << "bufferInterval" << "bufferSize"
+                                                  << "standbyOverride" << "downsampling"
+                                                  << "dataRangeIndex" << "maxLatency" << "start";
+    AbstractSensorChannel* channel = node();
+
+    foreach (const QString& key, parameters.keys())
+    {
+        if (!keys.contains(key))
+        {
+            sensordLogW() << "Unknown session parameter for" << channel->id() << ":" << key;
+            return false;
+        }
+    }
+
+    unsigned int interval = 0;
+    unsigned int bufferInterval = 0;
+    unsigned int bufferSize = 0;
+    unsigned int dataRangeIndex = 0;
+    unsigned int maxLatency = 0;
+    bool standbyOverride = false;
+    bool downsampling = false;
+    bool start = false;
+    if (!unsignedParameter(parameters, "interval", interval) ||
+        !unsignedParameter(parameters, "bufferInterval", bufferInterval) ||
+        !unsignedParameter(parameters, "bufferSize", bufferSize) ||
+        !unsignedParameter(parameters, "dataRangeIndex", dataRangeIndex) ||
+        !unsignedParameter(parameters, "maxLatency", maxLatency) ||
+        !boolParameter(parameters, "standbyOverride", standbyOverride) ||
+        !boolParameter(parameters, "downsampling", downsampling) ||
+        !boolParameter(parameters, "start", start))
+    {
+        sensordLogW() << "Malformed session parameters for" << channel->id() << "by session" << sessionId;
+        return false;
+    }
+
+    bool hasInterval = parameters.contains("interval");
+    bool hasRange = parameters.contains("dataRangeIndex");
+    bool dummy;
+    const DataRangeList& ranges = channel->getAvailableDataRanges();
+    bool valid = true;
+    if (hasInterval && interval)
+    {
+        bool found = false;
+        foreach (const DataRange& range, channel->getAvailableIntervals())
+            found |= (range.min <= interval && range.max >= interval);
+        valid &= found;
+    }
+    if (bufferInterval)
+        valid &= isInRange(bufferInterval, channel->getAvailableBufferIntervals(dummy));
+    if (bufferSize)
+        valid &= isInRange(bufferSize, channel->getAvailableBufferSizes(dummy));
+    if (hasRange)
+        valid &= dataRangeIndex < (unsigned int)ranges.size();
+    if (!valid)
+    {
+        sensordLogW() << "Rejected session configuration for" << channel->id() << "by session" << sessionId << ":" << parameters;
+        return false;
+    }
+
+    sensordLogT() << "Configuring session" << sessionId << "of" << channel->id() << ":" << parameters;
+
+    // Store all requests first and let each node re-evaluate them once.
+    {
+        NodeBase::RequestBatch batch;
+
+        if (parameters.contains("standbyOverride"))
+            channel->setStandbyOverrideRequest(sessionId, standbyOverride);
+        if (parameters.contains("downsampling"))
+            channel->setDownsamplingEnabled(sessionId, downsampling);
+        if (hasRange)
+            channel->requestDataRange(sessionId, ranges.at(dataRangeIndex));
+        if (parameters.contains("bufferInterval"))
+            setBufferInterval(sessionId, bufferInterval);
+        if (parameters.contains("bufferSize"))
+            setBufferSize(sessionId, bufferSize);
+        if (parameters.contains("maxLatency"))
+            SensorManager::instance().socketHandler().setMaxLatency(sessionId, maxLatency);
+
+        // Starting the session requests the default interval unless the
+        // session already has a request, so set the requested interval first.
+        if (hasInterval)
+        {
+            if (interval)
+            {
+                channel->setIntervalRequest(sessionId, interval);
+                SensorManager::instance().socketHandler().setInterval(sessionId, interval);
+            }
+            else
+            {
+                if (!start || channel->getInterval(sessionId))
+                    channel->requestDefaultInterval(sessionId);
+                SensorManager::instance().socketHandler().clearInterval(sessionId);
+            }
+        }
+    }
+
+    if (start)
+        channel->start(sessionId);
+
+    return true;
+}
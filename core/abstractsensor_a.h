@@ -174,6 +174,31 @@ public Q_SLOTS: // METHODS
     /** AbstractSensorChannel::hwBuffering() */
     bool hwBuffering() const;
 
+    /** AbstractSensorChannel::requestHistory(int, unsigned int) */
+    unsigned int requestHistory(int sessionId, unsigned int seconds);
+
+    /**
+     * Configure session delivery with a single call. Accepted keys are
+     * <tt>interval</tt>, <tt>bufferInterval</tt>, <tt>bufferSize</tt>,
+     * <tt>standbyOverride</tt>, <tt>downsampling</tt>,
+     * <tt>dataRangeIndex</tt>, <tt>maxLatency</tt> and <tt>start</tt>.
+     * Missing keys leave the setting untouched, zero interval and buffer
+     * values select the defaults like the individual setters do.
+     *
+     * <tt>maxLatency</tt> is how many milliseconds data may be held back
+     * while the display is off, see #SessionData::setMaxLatency().
+     *
+     * All parameters are validated before anything is applied, so either
+     * the whole configuration takes effect or none of it. When the session
+     * is started in the same call the requested interval is in place
+     * before the sensor starts, so the interval is evaluated only once.
+     *
+     * @param sessionId session ID.
+     * @param parameters delivery parameters by name.
+     * @return \c false if any parameter was unknown or invalid.
+     */
+    bool configureSession(int sessionId, const QVariantMap& parameters);
+
 Q_SIGNALS:
     /** AbstractSensorChannel::propertyChanged(name) */
     void propertyChanged(const QString& name);
@@ -35,12 +35,27 @@
 #include "ringbuffer.h"
 #include "logging.h"
 
-Bin::Bin()
+static QList<Bin*>& allBins()
 {
+    // Not destroyed at exit, bins may outlive static objects.
+    static QList<Bin*>* bins = new QList<Bin*>;
+    return *bins;
+}
+
+Bin::Bin(const QString& name) :
+    name_(name)
+{
+    allBins().append(this);
 }
 
 Bin::~Bin()
 {
+    allBins().removeOne(this);
+}
+
+const QList<Bin*>& Bin::bins()
+{
+    return allBins();
 }
 
 void Bin::start()
@@ -65,6 +80,10 @@ void Bin::add(Consumer* consumer, const QString& name)
     Q_ASSERT(!filters_.contains(name));
 
     consumers_.insert(name, consumer);
+
+    RingBufferBase* buffer = dynamic_cast<RingBufferBase*>(consumer);
+    if (buffer)
+        buffer->setStatsLabels(name_, name);
 }
 
 void Bin::add(FilterBase* filter, const QString& name)
@@ -90,6 +109,9 @@ bool Bin::join(const QString& producerName,
         if (src->join(snk)) {
 
             joined = true;
+            src->setStatsLabels(name_, producerName + "/" + sourceName);
+            Edge edge = { producerName, sourceName, consumerName, sinkName, src, snk };
+            edges_.append(edge);
 
         } else {
             sensordLogT() << " source "
@@ -128,6 +150,12 @@ bool Bin::unjoin(const QString& producerName,
         if (src->unjoin(snk)) {
 
             unjoined = true;
+            for (int i = 0; i < edges_.size(); ++i) {
+                if (edges_.at(i).source == src && edges_.at(i).sink == snk) {
+                    edges_.removeAt(i);
+                    break;
+                }
+            }
 
         } else {
             sensordLogT() << "Cannot unjoin sink & source. Possibly, they are not connected.";
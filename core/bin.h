@@ -32,6 +32,7 @@
 
 #include "callback.h"
 #include <QHash>
+#include <QList>
 
 class SourceBase;
 class SinkBase;
@@ -56,10 +57,26 @@ class Bin
 public:
     class Command;
 
+    /**
+     * Established dataflow connection.
+     */
+    struct Edge
+    {
+        QString     producerName; /**< name of the producer */
+        QString     sourceName;   /**< data source of the producer */
+        QString     consumerName; /**< name of the consumer */
+        QString     sinkName;     /**< data sink of the consumer */
+        SourceBase* source;       /**< data source */
+        SinkBase*   sink;         /**< data sink */
+    };
+
     /**
      * Constructor.
+     *
+     * @param name name of the node owning the bin, used to label
+     *             statistics of the joined sources and buffers.
      */
-    Bin();
+    Bin(const QString& name = QString());
 
     /**
      * Destructor
@@ -129,6 +146,44 @@ public:
                 const QString& consumerName,
                 const QString& sinkName);
 
+    /**
+     * Name of the node owning the bin.
+     *
+     * @return node name.
+     */
+    const QString& name() const { return name_; }
+
+    /**
+     * Established dataflow connections.
+     *
+     * @return connections in the order they were made.
+     */
+    const QList<Edge>& edges() const { return edges_; }
+
+    /**
+     * Name of a pusher in the bin.
+     *
+     * @param pusher pusher.
+     * @return pusher name or empty string if not in the bin.
+     */
+    QString nameOf(const Pusher* pusher) const { return pushers_.key(const_cast<Pusher*>(pusher)); }
+
+    /**
+     * Name of a consumer in the bin.
+     *
+     * @param consumer consumer.
+     * @return consumer name or empty string if not in the bin.
+     */
+    QString nameOf(const Consumer* consumer) const { return consumers_.key(const_cast<Consumer*>(consumer)); }
+
+    /**
+     * All existing bins. Bins are created and destroyed in the main
+     * thread.
+     *
+     * @return bins in creation order.
+     */
+    static const QList<Bin*>& bins();
+
 protected:
     /**
      * Pointer to the producer data source.
@@ -165,9 +220,11 @@ protected:
     Consumer*   consumer(const QString& name) const;
 
 private:
+    QString                     name_;      /**< owning node */
     QHash<QString, Pusher*>     pushers_;   /**< Pushers   */
     QHash<QString, Consumer*>   consumers_; /**< Consumers */
     QHash<QString, FilterBase*> filters_;   /**< Filters   */
+    QList<Edge>                 edges_;     /**< Connections */
 };
 
 #endif
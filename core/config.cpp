@@ -32,43 +32,54 @@
 #include <QFile>
 #include <QDir>
 #include <QList>
+#include <QMutexLocker>
+#include <QFileSystemWatcher>
 
 static SensorFrameworkConfig *static_configuration = 0;
 
-SensorFrameworkConfig::SensorFrameworkConfig() {
+SensorFrameworkConfig::SensorFrameworkConfig() :
+    m_snapshot(new ConfigSnapshot),
+    m_watcher(0)
+{
 }
 
 SensorFrameworkConfig::~SensorFrameworkConfig() {
 }
 
-void SensorFrameworkConfig::clearConfig() {
-    m_settings.clear();
-}
-
 bool SensorFrameworkConfig::loadConfig(const QString &defConfigPath, const QString &configDPath) {
-    /* Not having config files is ok, failing to load one that exists is not */
-    bool ret = true;
     if (!static_configuration) {
         static_configuration = new SensorFrameworkConfig();
     }
+
+    ConfigSnapshot *snapshot = new ConfigSnapshot(*static_configuration->snapshot());
+    bool ret = loadPaths(snapshot, defConfigPath, configDPath);
+    static_configuration->m_sources.append(qMakePair(defConfigPath, configDPath));
+    static_configuration->publish(snapshot);
+    static_configuration->updateWatcher();
+    return ret;
+}
+
+bool SensorFrameworkConfig::loadPaths(ConfigSnapshot *snapshot, const QString &defConfigPath, const QString &configDPath) {
+    /* Not having config files is ok, failing to load one that exists is not */
+    bool ret = true;
     /* Process config.d dir in alnum order */
     if (!configDPath.isEmpty()) {
         QDir dir(configDPath, "*.conf", QDir::Name, QDir::Files);
         foreach(const QString &file, dir.entryList()) {
-            if (!static_configuration->loadConfigFile(dir.absoluteFilePath(file))) {
+            if (!loadConfigFile(snapshot, dir.absoluteFilePath(file))) {
                 ret = false;
             }
         }
     }
     /* Primary config file overrides config.d */
     if (!defConfigPath.isEmpty() && QFile::exists(defConfigPath) ) {
-        if (!static_configuration->loadConfigFile(defConfigPath))
+        if (!loadConfigFile(snapshot, defConfigPath))
             ret = false;
     }
     return ret;
 }
 
-bool SensorFrameworkConfig::loadConfigFile(const QString &configFileName) {
+bool SensorFrameworkConfig::loadConfigFile(ConfigSnapshot *snapshot, const QString &configFileName) {
     /* Success means the file was loaded and processed without hiccups */
     bool loaded = false;
     if (!QFile::exists(configFileName)) {
@@ -82,26 +93,89 @@ bool SensorFrameworkConfig::loadConfigFile(const QString &configFileName) {
             sensordLogW() << "Unable to open \"" << configFileName <<  "\" configuration file";
         } else {
             foreach (const QString &key, merge.allKeys()) {
-                m_settings.setValue(key, merge.value(key));
+                QVariant value(merge.value(key));
+                sensordLogT() << "Value for key" << key << ":" << value.toString();
+                snapshot->m_values.insert(key, value);
+
+                int separator = key.indexOf('/');
+                if (separator > 0) {
+                    QString group(key.left(separator));
+                    if (!snapshot->m_groups.contains(group))
+                        snapshot->m_groups.append(group);
+                }
             }
+            snapshot->m_groups.sort();
             loaded = true;
         }
     }
     return loaded;
 }
 
-QVariant SensorFrameworkConfig::value(const QString &key) const {
-    QVariant var = m_settings.value(key, QVariant());
-    if(var.isValid()) {
-        sensordLogT() << "Value for key" << key << ":" << var.toString();
+void SensorFrameworkConfig::publish(ConfigSnapshot *snapshot) {
+    QSharedPointer<const ConfigSnapshot> published(snapshot);
+    QMutexLocker locker(&m_mutex);
+    m_snapshot.swap(published);
+}
+
+void SensorFrameworkConfig::watch() {
+    if (m_watcher)
+        return;
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, SIGNAL(fileChanged(const QString&)), this, SLOT(reload()));
+    connect(m_watcher, SIGNAL(directoryChanged(const QString&)), this, SLOT(reload()));
+    updateWatcher();
+}
+
+void SensorFrameworkConfig::updateWatcher() {
+    if (!m_watcher)
+        return;
+
+    QStringList paths;
+    typedef QPair<QString, QString> Source;
+    foreach (const Source &source, m_sources) {
+        if (!source.second.isEmpty() && QFile::exists(source.second)) {
+            QDir dir(source.second, "*.conf", QDir::Name, QDir::Files);
+            paths.append(dir.absolutePath());
+            foreach (const QString &file, dir.entryList())
+                paths.append(dir.absoluteFilePath(file));
+        }
+        if (!source.first.isEmpty() && QFile::exists(source.first))
+            paths.append(source.first);
+    }
+
+    // Editors replace files, which drops them from the watcher.
+    QStringList watched(m_watcher->files() + m_watcher->directories());
+    foreach (const QString &path, paths) {
+        if (!watched.contains(path))
+            m_watcher->addPath(path);
+    }
+}
+
+void SensorFrameworkConfig::reload() {
+    ConfigSnapshot *snapshot = new ConfigSnapshot;
+    typedef QPair<QString, QString> Source;
+    foreach (const Source &source, m_sources) {
+        loadPaths(snapshot, source.first, source.second);
     }
-    return var;
+    publish(snapshot);
+    updateWatcher();
+
+    sensordLogD() << "Configuration reloaded";
+    emit changed();
+}
+
+QSharedPointer<const ConfigSnapshot> SensorFrameworkConfig::snapshot() const {
+    QMutexLocker locker(&m_mutex);
+    return m_snapshot;
+}
+
+QVariant SensorFrameworkConfig::value(const QString &key) const {
+    return snapshot()->value(key);
 }
 
 QStringList SensorFrameworkConfig::groups() const
 {
-    QStringList groups = m_settings.childGroups();
-    return groups;
+    return snapshot()->groups();
 }
 
 SensorFrameworkConfig *SensorFrameworkConfig::configuration() {
@@ -118,5 +192,5 @@ void SensorFrameworkConfig::close() {
 
 bool SensorFrameworkConfig::exists(const QString &key) const
 {
-    return value(key).isValid();
+    return snapshot()->contains(key);
 }
@@ -28,18 +28,92 @@
 #ifndef SENSORD_CONFIG_H
 #define SENSORD_CONFIG_H
 
+#include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QVariant>
-#include <QSettings>
+#include <QHash>
 #include <QList>
+#include <QPair>
+#include <QMutex>
+#include <QSharedPointer>
+
+class QFileSystemWatcher;
+
+/**
+ * Parsed configuration. Files are read once into a hash of full keys,
+ * a snapshot is never modified after it has been published so it can be
+ * used from any thread without locking.
+ */
+class ConfigSnapshot
+{
+public:
+    /**
+     * Find value for given key.
+     *
+     * @param key Configuration key.
+     * @return Value for given key or invalid QVariant if key does not exist.
+     */
+    QVariant value(const QString &key) const { return m_values.value(key); }
+
+    /**
+     * Find value for given key.
+     *
+     * @tparam T Value type for configuration entry.
+     * @param key Configuration key.
+     * @param def Returned value if key does not exists.
+     * @return Value for given key.
+     */
+    template<typename T>
+    T value(const QString &key, const T &def = T()) const;
+
+    /**
+     * Does given key exists in configuration.
+     *
+     * @return does key exists in configuration.
+     */
+    bool contains(const QString &key) const { return m_values.contains(key); }
+
+    /**
+     * List of available groups in configuration.
+     *
+     * @return list of available configuration groups.
+     */
+    const QStringList& groups() const { return m_groups; }
+
+private:
+    friend class SensorFrameworkConfig;
+
+    QHash<QString, QVariant> m_values; /**< values by full key */
+    QStringList              m_groups; /**< top level groups */
+};
+
+template<typename T>
+T ConfigSnapshot::value(const QString &key, const T &def) const
+{
+    QHash<QString, QVariant>::const_iterator it = m_values.constFind(key);
+    if (it == m_values.constEnd())
+        return def;
+    return it.value().value<T>();
+}
 
 /**
  * Sensord configuration parser. Configuration is read and parsed with
- * the QSettings class. SensorFrameworkConfig is a singleton instance to which configuration
- * is loaded once during startup.
+ * the QSettings class into a #ConfigSnapshot. SensorFrameworkConfig is a
+ * singleton instance to which configuration is loaded once during
+ * startup. When watching is enabled, changed files are loaded into a new
+ * snapshot which replaces the current one and #changed() is emitted.
+ *
+ * Filters with tunable parameters, the context engine and sessions
+ * connect to #changed() and apply new values while running. Adaptors
+ * and chains read their device and setup keys when they are created,
+ * so changes to those take effect when they are next instantiated.
  */
-class SensorFrameworkConfig
+class SensorFrameworkConfig : public QObject
 {
+    Q_OBJECT
+    Q_DISABLE_COPY(SensorFrameworkConfig)
+
 public:
     /**
      * Destructor.
@@ -81,6 +155,20 @@ public:
      */
     bool exists(const QString &key) const;
 
+    /**
+     * Current configuration. Hold on to the snapshot to read several
+     * values consistently.
+     *
+     * @return configuration snapshot.
+     */
+    QSharedPointer<const ConfigSnapshot> snapshot() const;
+
+    /**
+     * Reload configuration when loaded files or directories change.
+     * Must be called from a thread running an event loop.
+     */
+    void watch();
+
     /**
      * Get configuration instance singleton. Object may not be deleted.
      *
@@ -102,6 +190,18 @@ public:
      */
     static void close();
 
+Q_SIGNALS:
+    /**
+     * Configuration has been reloaded.
+     */
+    void changed();
+
+private Q_SLOTS:
+    /**
+     * Reload all loaded configuration files.
+     */
+    void reload();
+
 private:
     /**
      * Constructor.
@@ -109,43 +209,46 @@ private:
     SensorFrameworkConfig();
 
     /**
-     * Copy constructor.
+     * Load configuration file and directory into snapshot.
      *
-     * @param c source object.
+     * @param snapshot Snapshot to append to.
+     * @param defConfigPath Path to the config file.
+     * @param configDPath Path to the directory with config files.
+     * @return were all existing files loaded successfully.
      */
-    SensorFrameworkConfig(const SensorFrameworkConfig &c);
+    static bool loadPaths(ConfigSnapshot *snapshot, const QString &defConfigPath, const QString &configDPath);
 
     /**
-     * Assignment operator.
+     * Load configuration file from given path.
      *
-     * @param c source object.
-     * @return current object.
+     * @param snapshot Snapshot to append to.
+     * @param configFileName Configuration file path.
+     * @return was configuration loaded successfully.
      */
-    SensorFrameworkConfig& operator=(const SensorFrameworkConfig &c);
+    static bool loadConfigFile(ConfigSnapshot *snapshot, const QString &configFileName);
 
     /**
-     * Load configuration file from given path.
+     * Publish new snapshot.
      *
-     * @param configFileName Configuration file path.
-     * @return was configuration loaded successfully.
+     * @param snapshot new snapshot.
      */
-    bool loadConfigFile(const QString &configFileName);
+    void publish(ConfigSnapshot *snapshot);
 
     /**
-     * Clear configuration.
+     * Update watched paths from loaded sources.
      */
-    void clearConfig();
+    void updateWatcher();
 
-    QSettings m_settings; /**< parsed QSettings */
+    mutable QMutex                       m_mutex;    /**< protects m_snapshot */
+    QSharedPointer<const ConfigSnapshot> m_snapshot; /**< current configuration */
+    QList<QPair<QString, QString> >      m_sources;  /**< loaded config file and directory pairs */
+    QFileSystemWatcher*                  m_watcher;  /**< watcher for reloading */
 };
 
 template<typename T>
 T SensorFrameworkConfig::value(const QString &key, const T &def) const
 {
-    QVariant val(value(key));
-    if(!val.isValid())
-        return def;
-    return val.value<T>();
+    return snapshot()->value<T>(key, def);
 }
 
 #endif // SENSORD_CONFIG_H
@@ -5,6 +5,7 @@ TARGET = sensorfw
 include( ../common-config.pri )
 
 CONFIG += link_pkgconfig
+PKGCONFIG += libudev
 VERSION = 0.9.0
 
 SENSORFW_INCLUDEPATHS = .. \
@@ -38,7 +39,14 @@ SOURCES += sensormanager.cpp \
     sockethandler.cpp \
     inputdevadaptor.cpp \
     config.cpp \
-    nodebase.cpp
+    nodebase.cpp \
+    samplehistory.cpp \
+    devicediscovery.cpp \
+    logging.cpp \
+    trace.cpp \
+    startupprofile.cpp \
+    statistics.cpp \
+    graphdump.cpp
 
 HEADERS += sensormanager.h \
     sensormanager_a.h \
@@ -66,7 +74,18 @@ HEADERS += sensormanager.h \
     sockethandler.h \
     inputdevadaptor.h \
     config.h \
-    nodebase.h
+    nodebase.h \
+    samplehistory.h \
+    fastmath.h \
+    fixedpoint.h \
+    windowstats.h \
+    sampledecimator.h \
+    pipeline.h \
+    devicediscovery.h \
+    trace.h \
+    startupprofile.h \
+    statistics.h \
+    graphdump.h
 
 mce {
     SOURCES += mcewatcher.cpp
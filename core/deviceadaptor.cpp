@@ -29,6 +29,7 @@
 
 #include "deviceadaptor.h"
 #include "sensormanager.h"
+#include "ringbuffer.h"
 
 AdaptedSensorEntry::AdaptedSensorEntry(const QString& name, const QString& description, RingBufferBase* buffer) :
     name_(name),
@@ -100,6 +101,8 @@ DeviceAdaptor::~DeviceAdaptor()
 
 void DeviceAdaptor::setAdaptedSensor(const QString& name, const QString& description, RingBufferBase* buffer)
 {
+    if (buffer)
+        buffer->setStatsLabels(id(), name);
     setAdaptedSensor(name, new AdaptedSensorEntry(name, description, buffer));
 }
 
@@ -164,3 +167,8 @@ bool DeviceAdaptor::resume()
 {
     return false;
 }
+
+bool DeviceAdaptor::rebind()
+{
+    return isValid();
+}
@@ -198,6 +198,16 @@ public:
      */
     virtual bool resume();
 
+    /**
+     * Look up the device again after devices have been added or removed.
+     * Running sessions are kept, the adaptor continues reading from the
+     * new device once it is available. Default implementation does
+     * nothing.
+     *
+     * @return is device available.
+     */
+    virtual bool rebind();
+
     const QString& name() { return sensor_.first; }
 
 protected:
@@ -0,0 +1,320 @@
+/**
+   @file devicediscovery.cpp
+   @brief Shared index of sensor devices
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "devicediscovery.h"
+#include "config.h"
+#include "logging.h"
+
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+#include <QMutexLocker>
+
+#include <libudev.h>
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+
+/* Number of input device nodes probed. */
+#define MAX_EVENT_DEV 16
+/* Minimum number of probing threads, probing mostly waits for I/O. */
+#define MIN_PROBE_THREADS 4
+/* Delay before rescanning after udev event, ms. */
+#define RESCAN_DELAY 200
+
+/**
+ * Runs probe function for one device in a thread pool.
+ */
+template <class INFO>
+class ProbeTask : public QRunnable
+{
+public:
+    typedef bool (*ProbeFunction)(INFO&);
+
+    ProbeTask(ProbeFunction probe, INFO& device, bool& found) :
+        probe_(probe),
+        device_(device),
+        found_(found)
+    {
+    }
+
+    void run()
+    {
+        found_ = probe_(device_);
+    }
+
+private:
+    ProbeFunction probe_;
+    INFO&         device_;
+    bool&         found_;
+};
+
+const InputDeviceInfo* DeviceIndex::findInputDevice(const QString& match) const
+{
+    foreach (const InputDeviceInfo& device, inputDevices_) {
+        if (device.name.contains(match, Qt::CaseInsensitive))
+            return &device;
+    }
+    return NULL;
+}
+
+const InputDeviceInfo* DeviceIndex::inputDevice(const QString& path) const
+{
+    foreach (const InputDeviceInfo& device, inputDevices_) {
+        if (device.path == path)
+            return &device;
+    }
+    return NULL;
+}
+
+const IioDeviceInfo* DeviceIndex::findIioDevice(const QString& name) const
+{
+    foreach (const IioDeviceInfo& device, iioDevices_) {
+        if (device.name == name)
+            return &device;
+    }
+    return NULL;
+}
+
+DeviceDiscovery* DeviceDiscovery::instance_ = NULL;
+
+DeviceDiscovery& DeviceDiscovery::instance()
+{
+    if (!instance_)
+        instance_ = new DeviceDiscovery;
+    return *instance_;
+}
+
+DeviceDiscovery::DeviceDiscovery() :
+    scanTime_(0),
+    udev_(udev_new()),
+    monitor_(NULL),
+    notifier_(NULL)
+{
+    if (!udev_)
+        sensordLogW() << "[DeviceDiscovery]: udev not available, IIO devices are not discovered";
+
+    rescanTimer_.setSingleShot(true);
+    rescanTimer_.setInterval(RESCAN_DELAY);
+    connect(&rescanTimer_, SIGNAL(timeout()), this, SLOT(rescan()));
+}
+
+DeviceDiscovery::~DeviceDiscovery()
+{
+    delete notifier_;
+    if (monitor_)
+        udev_monitor_unref(monitor_);
+    if (udev_)
+        udev_unref(udev_);
+}
+
+bool DeviceDiscovery::probeInputDevice(InputDeviceInfo& device)
+{
+    int fd = open(device.path.toLocal8Bit().constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd == -1)
+        return false;
+
+    char name[256] = {0,};
+    if (ioctl(fd, EVIOCGNAME(sizeof(name)), name) == -1) {
+        close(fd);
+        return false;
+    }
+    device.name = QString::fromLocal8Bit(name);
+
+    unsigned char bits[ABS_MAX / 8 + 1];
+    memset(bits, 0, sizeof(bits));
+    if (ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(bits)), bits) != -1) {
+        for (int code = 0; code <= ABS_MAX; ++code) {
+            if (bits[code / 8] & (1 << (code % 8)))
+                device.axes.append(code);
+        }
+    }
+
+    close(fd);
+    return true;
+}
+
+bool DeviceDiscovery::probeIioDevice(IioDeviceInfo& device)
+{
+    QFile nameFile(device.sysPath + "/name");
+    if (!nameFile.open(QIODevice::ReadOnly))
+        return false;
+    device.name = QString::fromLatin1(nameFile.readAll().trimmed());
+
+    QString sysName = QDir(device.sysPath).dirName();
+    bool ok;
+    device.index = sysName.mid(sysName.indexOf("device") + 6).toInt(&ok);
+    if (!ok)
+        device.index = -1;
+    device.devNode = "/dev/" + sysName;
+    device.scanElements = QDir(device.sysPath + "/scan_elements").entryList(QDir::Files, QDir::Name);
+
+    // Adaptors pick their channels from these without touching sysfs.
+    foreach (const QString& attribute, QDir(device.sysPath).entryList(QDir::Files, QDir::Name)) {
+        if (attribute.endsWith("_raw")) {
+            device.rawChannels.append(attribute);
+        } else if (attribute.endsWith("scale") || attribute.endsWith("offset") || attribute.endsWith("frequency")) {
+            QFile file(device.sysPath + "/" + attribute);
+            if (file.open(QIODevice::ReadOnly))
+                device.parameters.insert(attribute, QString::fromLatin1(file.readAll().trimmed()));
+        }
+    }
+    return !device.name.isEmpty();
+}
+
+QStringList DeviceDiscovery::iioDevicePaths()
+{
+    QStringList paths;
+    if (!udev_)
+        return paths;
+
+    struct udev_enumerate* enumerate = udev_enumerate_new(udev_);
+    udev_enumerate_add_match_subsystem(enumerate, "iio");
+    udev_enumerate_scan_devices(enumerate);
+
+    struct udev_list_entry* entry;
+    udev_list_entry_foreach(entry, udev_enumerate_get_list_entry(enumerate)) {
+        paths.append(QString::fromLatin1(udev_list_entry_get_name(entry)));
+    }
+    udev_enumerate_unref(enumerate);
+    return paths;
+}
+
+void DeviceDiscovery::scan()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<InputDeviceInfo> inputs;
+    QString sysPath = SensorFrameworkConfig::configuration()->value("global/device_sys_path").toString();
+    if (sysPath.contains("%1")) {
+        for (int i = 0; i < MAX_EVENT_DEV; ++i) {
+            InputDeviceInfo device;
+            device.number = i;
+            device.path = sysPath.arg(i);
+            inputs.append(device);
+        }
+    }
+
+    QVector<IioDeviceInfo> iios;
+    foreach (const QString& path, iioDevicePaths()) {
+        IioDeviceInfo device;
+        device.sysPath = path;
+        iios.append(device);
+    }
+
+    QVector<bool> inputFound(inputs.size());
+    QVector<bool> iioFound(iios.size());
+    {
+        QThreadPool pool;
+        pool.setMaxThreadCount(qMax(QThread::idealThreadCount(), MIN_PROBE_THREADS));
+        for (int i = 0; i < inputs.size(); ++i)
+            pool.start(new ProbeTask<InputDeviceInfo>(&DeviceDiscovery::probeInputDevice, inputs[i], inputFound[i]));
+        for (int i = 0; i < iios.size(); ++i)
+            pool.start(new ProbeTask<IioDeviceInfo>(&DeviceDiscovery::probeIioDevice, iios[i], iioFound[i]));
+        pool.waitForDone();
+    }
+
+    DeviceIndex* index = new DeviceIndex;
+    for (int i = 0; i < inputs.size(); ++i) {
+        if (inputFound[i]) {
+            sensordLogT() << "[DeviceDiscovery]: input device" << inputs[i].path << inputs[i].name;
+            index->inputDevices_.append(inputs[i]);
+        }
+    }
+    for (int i = 0; i < iios.size(); ++i) {
+        if (iioFound[i]) {
+            sensordLogT() << "[DeviceDiscovery]: IIO device" << iios[i].sysPath << iios[i].name;
+            index->iioDevices_.append(iios[i]);
+        }
+    }
+
+    scanTime_ = timer.elapsed();
+    sensordLogD() << "[DeviceDiscovery]: found" << index->inputDevices_.size() << "input and"
+                  << index->iioDevices_.size() << "IIO devices in" << scanTime_ << "ms";
+
+    QMutexLocker locker(&mutex_);
+    index_ = QSharedPointer<const DeviceIndex>(index);
+}
+
+QSharedPointer<const DeviceIndex> DeviceDiscovery::index()
+{
+    {
+        QMutexLocker locker(&mutex_);
+        if (index_)
+            return index_;
+    }
+    scan();
+    QMutexLocker locker(&mutex_);
+    return index_;
+}
+
+bool DeviceDiscovery::startMonitor()
+{
+    if (monitor_)
+        return true;
+    if (!udev_)
+        return false;
+
+    monitor_ = udev_monitor_new_from_netlink(udev_, "udev");
+    if (!monitor_) {
+        sensordLogW() << "[DeviceDiscovery]: failed to create udev monitor";
+        return false;
+    }
+    udev_monitor_filter_add_match_subsystem_devtype(monitor_, "input", NULL);
+    udev_monitor_filter_add_match_subsystem_devtype(monitor_, "iio", NULL);
+    if (udev_monitor_enable_receiving(monitor_) < 0) {
+        sensordLogW() << "[DeviceDiscovery]: failed to enable udev monitor";
+        udev_monitor_unref(monitor_);
+        monitor_ = NULL;
+        return false;
+    }
+
+    notifier_ = new QSocketNotifier(udev_monitor_get_fd(monitor_), QSocketNotifier::Read, this);
+    connect(notifier_, SIGNAL(activated(int)), this, SLOT(udevEvent()));
+    return true;
+}
+
+void DeviceDiscovery::udevEvent()
+{
+    struct udev_device* device = udev_monitor_receive_device(monitor_);
+    if (!device)
+        return;
+
+    sensordLogT() << "[DeviceDiscovery]: udev" << udev_device_get_action(device)
+                  << udev_device_get_syspath(device);
+    udev_device_unref(device);
+
+    // Adding a device produces a burst of events, rescan once.
+    rescanTimer_.start();
+}
+
+void DeviceDiscovery::rescan()
+{
+    scan();
+    emit devicesChanged();
+}
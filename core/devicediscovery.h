@@ -0,0 +1,215 @@
+/**
+   @file devicediscovery.h
+   @brief Shared index of sensor devices
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef DEVICEDISCOVERY_H
+#define DEVICEDISCOVERY_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QMap>
+#include <QMutex>
+#include <QTimer>
+#include <QSharedPointer>
+
+class QSocketNotifier;
+struct udev;
+struct udev_monitor;
+
+/**
+ * Capabilities of an input event device.
+ */
+struct InputDeviceInfo
+{
+    InputDeviceInfo() : number(-1) {}
+
+    int                     number; /**< number in <tt>global/device_sys_path</tt> */
+    QString                 path;   /**< device node */
+    QString                 name;   /**< device name reported by driver */
+    QVector<unsigned short> axes;   /**< supported absolute axes */
+};
+
+/**
+ * Capabilities of an Industrial I/O device.
+ */
+struct IioDeviceInfo
+{
+    IioDeviceInfo() : index(-1) {}
+
+    int         index;        /**< N in iio:deviceN */
+    QString     sysPath;      /**< sysfs directory */
+    QString     devNode;      /**< buffer device node */
+    QString     name;         /**< device name reported by driver */
+    QStringList scanElements; /**< entries of scan_elements directory */
+    QStringList rawChannels;  /**< <tt>*_raw</tt> channel attributes, sorted */
+    QMap<QString, QString> parameters; /**< values of <tt>*scale</tt>, <tt>*offset</tt> and <tt>*frequency</tt> attributes */
+};
+
+/**
+ * Immutable snapshot of discovered devices. A new snapshot is published
+ * whenever devices change, so a held snapshot can be used without
+ * locking.
+ */
+class DeviceIndex
+{
+public:
+    /**
+     * Input devices ordered by device number.
+     *
+     * @return input devices.
+     */
+    const QList<InputDeviceInfo>& inputDevices() const { return inputDevices_; }
+
+    /**
+     * Industrial I/O devices ordered by index.
+     *
+     * @return IIO devices.
+     */
+    const QList<IioDeviceInfo>& iioDevices() const { return iioDevices_; }
+
+    /**
+     * Find input device with name containing given string, ignoring
+     * case.
+     *
+     * @param match string to look for.
+     * @return device with lowest number or NULL if not found.
+     */
+    const InputDeviceInfo* findInputDevice(const QString& match) const;
+
+    /**
+     * Find input device by device node.
+     *
+     * @param path device node.
+     * @return device or NULL if not found.
+     */
+    const InputDeviceInfo* inputDevice(const QString& path) const;
+
+    /**
+     * Find IIO device by name.
+     *
+     * @param name device name.
+     * @return device with lowest index or NULL if not found.
+     */
+    const IioDeviceInfo* findIioDevice(const QString& name) const;
+
+private:
+    friend class DeviceDiscovery;
+
+    QList<InputDeviceInfo> inputDevices_; /**< input devices */
+    QList<IioDeviceInfo>   iioDevices_;   /**< IIO devices */
+};
+
+/**
+ * Enumerates input and IIO devices once for all adaptors. Devices are
+ * probed in parallel and collected into a #DeviceIndex. A udev monitor
+ * keeps the index current when devices are added or removed.
+ */
+class DeviceDiscovery : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(DeviceDiscovery)
+
+public:
+    /**
+     * Get singleton instance.
+     *
+     * @return discovery instance.
+     */
+    static DeviceDiscovery& instance();
+
+    /**
+     * Enumerate and probe all devices and publish a new index.
+     */
+    void scan();
+
+    /**
+     * Get current device index. Devices are scanned on first use.
+     *
+     * @return device index.
+     */
+    QSharedPointer<const DeviceIndex> index();
+
+    /**
+     * Start following udev events for input and IIO devices. Must be
+     * called from a thread running an event loop.
+     *
+     * @return was monitor started.
+     */
+    bool startMonitor();
+
+    /**
+     * Duration of the latest scan.
+     *
+     * @return duration in milliseconds.
+     */
+    qint64 scanTime() const { return scanTime_; }
+
+Q_SIGNALS:
+    /**
+     * Devices have been added or removed and a new index is available.
+     */
+    void devicesChanged();
+
+private Q_SLOTS:
+    void udevEvent();
+    void rescan();
+
+private:
+    DeviceDiscovery();
+    ~DeviceDiscovery();
+
+    /**
+     * Probe input device.
+     *
+     * @param device device with path set, filled in.
+     * @return is the path an input device.
+     */
+    static bool probeInputDevice(InputDeviceInfo& device);
+
+    /**
+     * Probe IIO device.
+     *
+     * @param device device with sysfs path set, filled in.
+     * @return was device readable.
+     */
+    static bool probeIioDevice(IioDeviceInfo& device);
+
+    /**
+     * List sysfs paths of IIO devices.
+     *
+     * @return device paths.
+     */
+    QStringList iioDevicePaths();
+
+    static DeviceDiscovery* instance_;
+
+    QMutex                            mutex_;         /**< protects index_ */
+    QSharedPointer<const DeviceIndex> index_;         /**< current index */
+    qint64                            scanTime_;      /**< latest scan duration, ms */
+    struct udev*                      udev_;          /**< udev context */
+    struct udev_monitor*              monitor_;       /**< hotplug monitor */
+    QSocketNotifier*                  notifier_;      /**< monitor fd notifier */
+    QTimer                            rescanTimer_;   /**< collects event bursts */
+};
+
+#endif // DEVICEDISCOVERY_H
@@ -0,0 +1,221 @@
+/**
+   @file fastmath.h
+   @brief Fast approximations of elementary functions for filters
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+/**
+ * Single precision approximations of the elementary functions used by
+ * the orientation, rotation and compass filters. Outputs of those
+ * filters are whole degrees, so full double precision libm calls are
+ * not needed. Maximum errors over the whole input domain:
+ *
+ * <ul>
+ *   <li>#atan, #atan2: 1e-5 rad (0.0006 degrees)</li>
+ *   <li>#sin, #cos, #sincos: 1e-6 for |x| <= 4 pi</li>
+ *   <li>#rsqrt, #sqrt: 1e-6 relative</li>
+ * </ul>
+ *
+ * Functions use selects instead of branches so the batch variants can
+ * be auto-vectorized by the compiler.
+ */
+class FastMath
+{
+public:
+    /**
+     * Arc tangent of y/x using signs of both to determine the quadrant.
+     * Returns 0 for (0, 0).
+     *
+     * @param y y coordinate.
+     * @param x x coordinate.
+     * @return angle in radians in range [-pi, pi].
+     */
+    static inline float atan2(float y, float x)
+    {
+        float ax = fabsf(x);
+        float ay = fabsf(y);
+        float mx = ax > ay ? ax : ay;
+        float mn = ax > ay ? ay : ax;
+        float r = atanUnit(mx > 0.0f ? mn / mx : 0.0f);
+        r = ay > ax ? 1.57079633f - r : r;
+        r = x < 0.0f ? 3.14159265f - r : r;
+        return y < 0.0f ? -r : r;
+    }
+
+    /**
+     * Arc tangent.
+     *
+     * @param x value.
+     * @return angle in radians in range [-pi/2, pi/2].
+     */
+    static inline float atan(float x)
+    {
+        return atan2(x, 1.0f);
+    }
+
+    /**
+     * Reciprocal square root. Returns a large finite value for 0.
+     *
+     * @param x value, must be non-negative.
+     * @return 1 / sqrt(x).
+     */
+    static inline float rsqrt(float x)
+    {
+        uint32_t i;
+        float h = 0.5f * x;
+        memcpy(&i, &x, sizeof(i));
+        i = 0x5f375a86 - (i >> 1);
+        float y;
+        memcpy(&y, &i, sizeof(y));
+        y = y * (1.5f - h * y * y);
+        y = y * (1.5f - h * y * y);
+        return y * (1.5f - h * y * y);
+    }
+
+    /**
+     * Square root computed through #rsqrt.
+     *
+     * @param x value, must be non-negative.
+     * @return sqrt(x).
+     */
+    static inline float sqrt(float x)
+    {
+        return x > 0.0f ? x * rsqrt(x) : 0.0f;
+    }
+
+    /**
+     * Sine and cosine of the same angle.
+     *
+     * @param x angle in radians.
+     * @param s set to sin(x).
+     * @param c set to cos(x).
+     */
+    static inline void sincos(float x, float& s, float& c)
+    {
+        // Reduce to [-pi, pi] and fold to [-pi/2, pi/2] where the
+        // polynomials are accurate.
+        const float halfPi = 1.57079633f;
+        const float pi = 3.14159265f;
+        float k = floorf(x * 0.159154943f + 0.5f);
+        x = (x - k * 6.28125f) - k * 1.9353072e-3f;
+        float flip = (x > halfPi || x < -halfPi) ? -1.0f : 1.0f;
+        x = x > halfPi ? pi - x : (x < -halfPi ? -pi - x : x);
+
+        float x2 = x * x;
+        s = x * (1.0f + x2 * (-1.6666667e-1f + x2 * (8.3333333e-3f + x2 * (-1.9841270e-4f + x2 * (2.7557319e-6f + x2 * -2.5052108e-8f)))));
+        c = flip * (1.0f + x2 * (-0.5f + x2 * (4.1666667e-2f + x2 * (-1.3888889e-3f + x2 * (2.4801587e-5f + x2 * (-2.7557319e-7f + x2 * 2.0876757e-9f))))));
+    }
+
+    /**
+     * Sine.
+     *
+     * @param x angle in radians.
+     * @return sin(x).
+     */
+    static inline float sin(float x)
+    {
+        float s, c;
+        sincos(x, s, c);
+        return s;
+    }
+
+    /**
+     * Cosine.
+     *
+     * @param x angle in radians.
+     * @return cos(x).
+     */
+    static inline float cos(float x)
+    {
+        float s, c;
+        sincos(x, s, c);
+        return c;
+    }
+
+    /**
+     * Batch form of #atan2(float, float).
+     *
+     * @param y y coordinates.
+     * @param x x coordinates.
+     * @param out location for n angles. May alias either input.
+     * @param n number of elements.
+     */
+    static void atan2(const float* y, const float* x, float* out, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            out[i] = atan2(y[i], x[i]);
+    }
+
+    /**
+     * Batch form of #rsqrt(float).
+     *
+     * @param x values.
+     * @param out location for n results. May alias input.
+     * @param n number of elements.
+     */
+    static void rsqrt(const float* x, float* out, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            out[i] = rsqrt(x[i]);
+    }
+
+    /**
+     * Batch form of #sincos(float, float&, float&).
+     *
+     * @param x angles in radians.
+     * @param s location for n sines.
+     * @param c location for n cosines.
+     * @param n number of elements.
+     */
+    static void sincos(const float* x, float* s, float* c, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            sincos(x[i], s[i], c[i]);
+    }
+
+    /**
+     * Round to nearest integer, halfway cases away from zero, like
+     * round() does.
+     *
+     * @param x value.
+     * @return rounded value.
+     */
+    static inline int roundToInt(float x)
+    {
+        return (int)(x < 0.0f ? x - 0.5f : x + 0.5f);
+    }
+
+private:
+    /**
+     * Minimax polynomial for arc tangent on [0, 1].
+     */
+    static inline float atanUnit(float a)
+    {
+        float a2 = a * a;
+        return a * (0.99997726f + a2 * (-0.33262347f + a2 * (0.19354346f + a2 * (-0.11643287f + a2 * (0.05265332f + a2 * -0.01172120f)))));
+    }
+};
+
+#endif // FASTMATH_H
@@ -0,0 +1,179 @@
+/**
+   @file fixedpoint.h
+   @brief Fixed-point arithmetic for filters
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <QtGlobal>
+#include "config.h"
+
+/**
+ * Q16.16 arithmetic for the integer processing path of the alignment,
+ * averaging, orientation and compass filters. Sensor data is integer
+ * to begin with, so on targets without fast floating point these
+ * filters can run on integer multiply, add and shift only.
+ *
+ * Products are accumulated in 64 bits, which 32-bit ARM computes with
+ * a single multiply-accumulate instruction.
+ *
+ * The integer path is used when <tt>filters/fixed_point</tt> is set.
+ * Building with <tt>CONFIG+=fixedpoint</tt> makes it the default.
+ */
+class FixedPoint
+{
+public:
+    enum {
+        FractionBits = 16,          /**< fraction bits of a Q16 value */
+        One = 1 << FractionBits     /**< 1.0 as Q16 */
+    };
+
+    /**
+     * Should filters use the integer path.
+     *
+     * @return value of <tt>filters/fixed_point</tt>.
+     */
+    static bool enabled()
+    {
+#ifdef SENSORFW_FIXED_POINT
+        const bool byDefault = true;
+#else
+        const bool byDefault = false;
+#endif
+        return SensorFrameworkConfig::configuration()->value<bool>("filters/fixed_point", byDefault);
+    }
+
+    /**
+     * Convert to Q16, rounding to nearest.
+     *
+     * @param value real value, |value| < 32768.
+     * @return Q16 value.
+     */
+    static inline qint32 fromReal(double value)
+    {
+        return (qint32)(value < 0 ? value * One - 0.5 : value * One + 0.5);
+    }
+
+    /**
+     * Convert Q16 to integer, truncating toward zero like a conversion
+     * from floating point does.
+     *
+     * @param value Q16 value.
+     * @return integer part.
+     */
+    static inline int truncate(qint64 value)
+    {
+        return (int)(value < 0 ? -(-value >> FractionBits) : value >> FractionBits);
+    }
+
+    /**
+     * Convert Q16 to integer, rounding half away from zero.
+     *
+     * @param value Q16 value.
+     * @return nearest integer.
+     */
+    static inline int round(qint64 value)
+    {
+        return (int)(value < 0 ? -((-value + One / 2) >> FractionBits)
+                               : (value + One / 2) >> FractionBits);
+    }
+
+    /**
+     * Integer square root.
+     *
+     * @param value value.
+     * @return floor of square root.
+     */
+    static inline quint32 sqrt(quint64 value)
+    {
+        quint64 result = 0;
+        quint64 bit = Q_UINT64_C(1) << 62;
+        while (bit > value)
+            bit >>= 2;
+        while (bit) {
+            if (value >= result + bit) {
+                value -= result + bit;
+                result = (result >> 1) + bit;
+            } else {
+                result >>= 1;
+            }
+            bit >>= 2;
+        }
+        return (quint32)result;
+    }
+
+    /**
+     * Angle of a vector by CORDIC. Only the ratio of the coordinates
+     * matters, so they can be in any common unit. Returns 0 for (0, 0).
+     * Maximum error is 0.001 degrees.
+     *
+     * @param y y coordinate.
+     * @param x x coordinate.
+     * @return angle in Q16 degrees in range [-180, 180].
+     */
+    static inline qint32 atan2(qint64 y, qint64 x)
+    {
+        static const qint32 angles[] = {
+            2949120, 1740967, 919879, 466945, 234379, 117304, 58666, 29335,
+            14668, 7334, 3667, 1833, 917, 458, 229, 115, 57, 29
+        };
+
+        if (!x && !y)
+            return 0;
+
+        // Rotate to the right half plane.
+        qint32 angle = 0;
+        if (x < 0) {
+            angle = y < 0 ? -180 * One : 180 * One;
+            x = -x;
+            y = -y;
+        }
+
+        // Scale so the iteration neither overflows nor runs out of bits.
+        qint64 larger = qMax(x, y < 0 ? -y : y);
+        while (larger >= (Q_INT64_C(1) << 40)) {
+            x >>= 1;
+            y >>= 1;
+            larger >>= 1;
+        }
+        while (larger < (Q_INT64_C(1) << 30)) {
+            x <<= 1;
+            y <<= 1;
+            larger <<= 1;
+        }
+
+        for (int i = 0; i < (int)(sizeof(angles) / sizeof(angles[0])); ++i) {
+            qint64 dx = x >> i;
+            qint64 dy = y >> i;
+            if (y > 0) {
+                x += dy;
+                y -= dx;
+                angle += angles[i];
+            } else {
+                x -= dy;
+                y += dx;
+                angle -= angles[i];
+            }
+        }
+        return angle;
+    }
+};
+
+#endif // FIXEDPOINT_H
@@ -0,0 +1,233 @@
+/**
+   @file graphdump.cpp
+   @brief Live dataflow graph description
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "graphdump.h"
+#include "nodebase.h"
+#include "bin.h"
+#include "source.h"
+#include "ringbuffer.h"
+#include "statistics.h"
+
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+
+/**
+ * Vertex of a bin element, or of the node itself if the element is
+ * not found in the bins of the node.
+ */
+template <class ELEMENT>
+static QString vertex(const QString& node, const ELEMENT* element)
+{
+    foreach (const Bin* bin, Bin::bins()) {
+        if (bin->name() != node)
+            continue;
+        QString name = bin->nameOf(element);
+        if (!name.isEmpty())
+            return node + "/" + name;
+    }
+    return node;
+}
+
+static QString quoted(const QString& text)
+{
+    QString escaped = text;
+    escaped.replace("\\", "\\\\");
+    escaped.replace("\"", "\\\"");
+    escaped.replace("\n", "\\n");
+    return "\"" + escaped + "\"";
+}
+
+GraphDump::GraphDump() :
+    previousTime_(EdgeStats::now())
+{
+}
+
+void GraphDump::add(Sample& sample, const EdgeStats& stats)
+{
+    sample.calls += stats.calls();
+    sample.samples += stats.samples();
+    sample.timeUs += stats.timeUs();
+}
+
+void GraphDump::annotate(Edge& edge, const Sample& sample, double seconds)
+{
+    QString key = edge.from + " " + edge.to + " " + edge.label;
+    Sample previous = previous_.value(key);
+    current_.insert(key, sample);
+
+    unsigned int calls = sample.calls - previous.calls;
+    unsigned int samples = sample.samples - previous.samples;
+    unsigned int timeUs = sample.timeUs - previous.timeUs;
+
+    edge.samples = sample.samples;
+    edge.rate = seconds > 0 ? samples / seconds : 0;
+    edge.batch = calls ? (double)samples / calls : 0;
+    edge.timeUsPerSecond = seconds > 0 ? timeUs / seconds : 0;
+}
+
+QString GraphDump::dump(const QList<NodeBase*>& nodes, Format format)
+{
+    qint64 now = EdgeStats::now();
+    double seconds = (now - previousTime_) / 1000000000.0;
+    QList<Edge> edges;
+    current_.clear();
+
+    foreach (NodeBase* node, nodes) {
+        foreach (const NodeConnection& connection, node->connections()) {
+            RingBufferBase* buffer = connection.source->findBuffer(connection.bufferName);
+
+            Edge edge;
+            edge.from = vertex<Consumer>(connection.source->id(), buffer);
+            edge.to = vertex<Pusher>(node->id(), connection.reader);
+            edge.label = connection.bufferName;
+            edge.dropped = buffer ? buffer->droppedCount() : 0;
+
+            Sample sample;
+            foreach (const SourceBase* source, connection.reader->sources()) {
+                add(sample, source->totalStats());
+            }
+            annotate(edge, sample, seconds);
+            edges.append(edge);
+        }
+    }
+
+    foreach (const Bin* bin, Bin::bins()) {
+        foreach (const Bin::Edge& binEdge, bin->edges()) {
+            Edge edge;
+            edge.from = bin->name() + "/" + binEdge.producerName;
+            edge.to = bin->name() + "/" + binEdge.consumerName;
+            edge.label = binEdge.sourceName + " > " + binEdge.sinkName;
+            edge.dropped = 0;
+
+            Sample sample;
+            const EdgeStats* stats = binEdge.source->edgeStats(binEdge.sink);
+            if (stats)
+                add(sample, *stats);
+            annotate(edge, sample, seconds);
+            edges.append(edge);
+        }
+    }
+
+    previous_ = current_;
+    previousTime_ = now;
+
+    return format == Json ? json(nodes, edges) : dot(nodes, edges);
+}
+
+QString GraphDump::dot(const QList<NodeBase*>& nodes, const QList<Edge>& edges) const
+{
+    // Bin elements are drawn inside a cluster of the owning node.
+    QMap<QString, QSet<QString> > clusters;
+    foreach (const Bin* bin, Bin::bins()) {
+        foreach (const Bin::Edge& binEdge, bin->edges()) {
+            clusters[bin->name()].insert(binEdge.producerName);
+            clusters[bin->name()].insert(binEdge.consumerName);
+        }
+    }
+
+    QStringList lines;
+    lines << "digraph sensorfw {";
+    lines << "    rankdir=LR;";
+    lines << "    node [shape=box];";
+
+    QHash<QString, QString> nodeLines;
+    foreach (const NodeBase* node, nodes) {
+        nodeLines.insert(node->id(), QString("%1 [label=%2%3];")
+                         .arg(quoted(node->id()))
+                         .arg(quoted(node->id() + "\n" + node->metaObject()->className()))
+                         .arg(node->isValid() ? "" : ", style=dashed"));
+    }
+
+    for (QMap<QString, QSet<QString> >::const_iterator it = clusters.constBegin(); it != clusters.constEnd(); ++it) {
+        lines << QString("    subgraph %1 {").arg(quoted("cluster_" + it.key()));
+        lines << QString("        label=%1;").arg(quoted(it.key()));
+        if (nodeLines.contains(it.key()))
+            lines << "        " + nodeLines.take(it.key());
+        QStringList elements = it.value().toList();
+        elements.sort();
+        foreach (const QString& element, elements) {
+            lines << QString("        %1 [label=%2, shape=ellipse];")
+                .arg(quoted(it.key() + "/" + element))
+                .arg(quoted(element));
+        }
+        lines << "    }";
+    }
+
+    foreach (const NodeBase* node, nodes) {
+        if (nodeLines.contains(node->id()))
+            lines << "    " + nodeLines.value(node->id());
+    }
+
+    foreach (const Edge& edge, edges) {
+        QString label = QString("%1\n%2 Hz, batch %3, %4 us/s")
+            .arg(edge.label)
+            .arg(edge.rate, 0, 'f', 1)
+            .arg(edge.batch, 0, 'f', 1)
+            .arg(edge.timeUsPerSecond, 0, 'f', 0);
+        if (edge.dropped)
+            label += QString(", %1 dropped").arg(edge.dropped);
+        lines << QString("    %1 -> %2 [label=%3];").arg(quoted(edge.from)).arg(quoted(edge.to)).arg(quoted(label));
+    }
+
+    lines << "}";
+    return lines.join("\n") + "\n";
+}
+
+QString GraphDump::json(const QList<NodeBase*>& nodes, const QList<Edge>& edges) const
+{
+    QJsonArray nodeArray;
+    foreach (const NodeBase* node, nodes) {
+        QJsonObject object;
+        object.insert("id", node->id());
+        object.insert("type", QString(node->metaObject()->className()));
+        object.insert("valid", node->isValid());
+        nodeArray.append(object);
+    }
+
+    QJsonArray binArray;
+    foreach (const Bin* bin, Bin::bins()) {
+        binArray.append(bin->name());
+    }
+
+    QJsonArray edgeArray;
+    foreach (const Edge& edge, edges) {
+        QJsonObject object;
+        object.insert("from", edge.from);
+        object.insert("to", edge.to);
+        object.insert("label", edge.label);
+        object.insert("samples", (double)edge.samples);
+        object.insert("dropped", (double)edge.dropped);
+        object.insert("rate", edge.rate);
+        object.insert("batch", edge.batch);
+        object.insert("timeUsPerSecond", edge.timeUsPerSecond);
+        edgeArray.append(object);
+    }
+
+    QJsonObject graph;
+    graph.insert("nodes", nodeArray);
+    graph.insert("bins", binArray);
+    graph.insert("edges", edgeArray);
+    return QString::fromUtf8(QJsonDocument(graph).toJson());
+}
@@ -0,0 +1,107 @@
+/**
+   @file graphdump.h
+   @brief Live dataflow graph description
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef GRAPHDUMP_H
+#define GRAPHDUMP_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+
+class NodeBase;
+class EdgeStats;
+
+/**
+ * Describes the running dataflow graph as Graphviz DOT or JSON. The
+ * graph contains the given nodes with their buffer connections and
+ * the connections inside all bins. Each edge is annotated with the
+ * sample rate, average batch size and the time spent in the receiving
+ * side per second, computed over the time since the previous dump.
+ */
+class GraphDump
+{
+public:
+    /**
+     * Output format.
+     */
+    enum Format {
+        Dot = 0, /**< Graphviz DOT */
+        Json     /**< JSON object with node and edge arrays */
+    };
+
+    /**
+     * Constructor. The first dump reports rates since construction.
+     */
+    GraphDump();
+
+    /**
+     * Describe the graph.
+     *
+     * @param nodes nodes to include.
+     * @param format output format.
+     * @return graph description.
+     */
+    QString dump(const QList<NodeBase*>& nodes, Format format);
+
+private:
+    /**
+     * Counter readings of an edge.
+     */
+    struct Sample
+    {
+        Sample() : calls(0), samples(0), timeUs(0) {}
+
+        unsigned int calls;   /**< pushes */
+        unsigned int samples; /**< samples */
+        unsigned int timeUs;  /**< receiving side time */
+    };
+
+    /**
+     * Edge of the described graph.
+     */
+    struct Edge
+    {
+        QString from;            /**< source vertex */
+        QString to;              /**< destination vertex */
+        QString label;           /**< connection name */
+        unsigned int samples;    /**< samples since start */
+        unsigned int dropped;    /**< samples overwritten in buffer */
+        double rate;             /**< samples per second */
+        double batch;            /**< samples per push */
+        double timeUsPerSecond;  /**< receiving side time per second */
+    };
+
+    /**
+     * Compute rates of an edge from the change since the previous dump.
+     */
+    void annotate(Edge& edge, const Sample& sample, double seconds);
+
+    static void add(Sample& sample, const EdgeStats& stats);
+
+    QString dot(const QList<NodeBase*>& nodes, const QList<Edge>& edges) const;
+    QString json(const QList<NodeBase*>& nodes, const QList<Edge>& edges) const;
+
+    qint64                 previousTime_; /**< time of the previous dump, ns */
+    QHash<QString, Sample> previous_;     /**< readings of the previous dump */
+    QHash<QString, Sample> current_;      /**< readings of the dump being made */
+};
+
+#endif // GRAPHDUMP_H
@@ -20,6 +20,7 @@
 
 #include "hybrisadaptor.h"
 #include "deviceadaptor.h"
+#include "trace.h"
 
 #include <QDebug>
 #include <QCoreApplication>
@@ -1053,7 +1054,7 @@ void HybrisManager::processEvents(const sensors_event_t *buffer, int numberOfEve
     for (int i = 0; i < numberOfEvents; i++) {
         const sensors_event_t& data = buffer[i];
 
-        sensordLogT("HYBRIS EVE %s", sensorTypeName(data.type));
+        sensordTrace("HYBRIS EVE %s", sensorTypeName(data.type));
 
         /* Got data -> Clear the no longer needed fallback event */
         sensors_event_t *fallback = eventForHandle(data.sensor);
@@ -30,6 +30,7 @@
  */
 
 #include "inputdevadaptor.h"
+#include "devicediscovery.h"
 #include "config.h"
 
 #include <errno.h>
@@ -37,19 +38,47 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <sys/epoll.h>
+#include <sys/ioctl.h>
 #include <unistd.h>
+#include <time.h>
 
 #include <QFile>
 #include <QDir>
 #include <QString>
 
+#include "ringbuffer.h"
+
+/* Size of event code bitmask buffers, large enough for any event type. */
+#define CODE_BITS_SIZE (KEY_MAX / 8 + 1)
+
+/**
+ * Check if bit is set in event code bitmask.
+ */
+static inline bool testCodeBit(const unsigned char* bits, int code)
+{
+    return bits[code / 8] & (1 << (code % 8));
+}
+
+/**
+ * Difference of monotonic and realtime clocks in microseconds.
+ */
+static qint64 realtimeOffset()
+{
+    timespec monotonic;
+    timespec realtime;
+    clock_gettime(CLOCK_MONOTONIC, &monotonic);
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    return ((qint64)monotonic.tv_sec - realtime.tv_sec) * 1000000
+           + (monotonic.tv_nsec - realtime.tv_nsec) / 1000;
+}
+
 InputDevAdaptor::InputDevAdaptor(const QString& id, int maxDeviceCount) :
     SysfsAdaptor(id, SysfsAdaptor::SelectMode, false),
     deviceCount_(0),
     maxDeviceCount_(maxDeviceCount),
     cachedInterval_(0)
 {
-    memset(evlist_, 0x0, sizeof(input_event)*64);
+    memset(evlist_, 0x0, sizeof(evlist_));
 }
 
 InputDevAdaptor::~InputDevAdaptor()
@@ -59,42 +88,18 @@ InputDevAdaptor::~InputDevAdaptor()
 int InputDevAdaptor::getInputDevices(const QString& typeName)
 {
     qDebug() << Q_FUNC_INFO << typeName;
-    QString deviceSysPathString = SensorFrameworkConfig::configuration()->value("global/device_sys_path").toString();
-    QString devicePollFilePath = SensorFrameworkConfig::configuration()->value("global/device_poll_file_path").toString();
 
-    int deviceNumber = 0;
+    int deviceNumber;
     deviceString_ = typeName;
+    inputMatches_.append(typeName);
 
-    // Check if this device name is defined in configuration
-    QString deviceName = SensorFrameworkConfig::configuration()->value<QString>(typeName + "/device", "");
-
-    // Do not perform strict checks for the input device
-    if (deviceName.size() && checkInputDevice(deviceName, typeName, false)) {
+    QString deviceName = findInputDevice(typeName, deviceNumber);
+    if (!deviceName.isEmpty() && deviceCount_ < maxDeviceCount_) {
         addPath(deviceName, deviceCount_);
         ++deviceCount_;
-    } else if(deviceSysPathString.contains("%1")) {
-        const int MAX_EVENT_DEV = 16;
-qDebug() << deviceNumber << deviceCount_ << maxDeviceCount_;
-
-        // No configuration for this device, try find the device from the device system path
-        while (deviceNumber < MAX_EVENT_DEV && deviceCount_ < maxDeviceCount_) {
-            deviceName = deviceSysPathString.arg(deviceNumber);
-            qDebug() << Q_FUNC_INFO << deviceName;
-            if (checkInputDevice(deviceName, typeName)) {
-                addPath(deviceName, deviceCount_);
-                ++deviceCount_;
-                break;
-            }
-            ++deviceNumber;
-        }
     }
 
-    QString pollConfigKey = QString(typeName + "/poll_file");
-    if (SensorFrameworkConfig::configuration()->exists(pollConfigKey)) {
-        usedDevicePollFilePath_ = SensorFrameworkConfig::configuration()->value<QString>(pollConfigKey, "");
-    } else {
-        usedDevicePollFilePath_ = devicePollFilePath.arg(deviceNumber);
-    }
+    usedDevicePollFilePath_ = pollFilePath(typeName, deviceNumber);
 qDebug() << Q_FUNC_INFO << usedDevicePollFilePath_;
 
     if (deviceCount_ == 0) {
@@ -108,11 +113,74 @@ qDebug() << Q_FUNC_INFO << usedDevicePollFilePath_;
     return deviceCount_;
 }
 
+QString InputDevAdaptor::findInputDevice(const QString& typeName, int& deviceNumber) const
+{
+    QString deviceSysPathString = SensorFrameworkConfig::configuration()->value("global/device_sys_path").toString();
+
+    deviceNumber = 0;
+
+    // Check if this device name is defined in configuration
+    QString deviceName = SensorFrameworkConfig::configuration()->value<QString>(typeName + "/device", "");
+
+    // Do not perform strict checks for the input device
+    if (deviceName.size() && checkInputDevice(deviceName, typeName, false))
+        return deviceName;
+
+    if (deviceSysPathString.contains("%1")) {
+        const int MAX_EVENT_DEV = 16;
+        deviceNumber = MAX_EVENT_DEV;
+
+        // No configuration for this device, look it up from devices probed at startup
+        QSharedPointer<const DeviceIndex> index = DeviceDiscovery::instance().index();
+        const InputDeviceInfo* device = index->findInputDevice(typeName);
+        if (device) {
+            sensordLogT() << "\"" << typeName << "\"" << " matched in device name: " << device->name;
+            deviceNumber = device->number;
+            return device->path;
+        }
+    }
+
+    return QString();
+}
+
+QString InputDevAdaptor::pollFilePath(const QString& typeName, int deviceNumber) const
+{
+    QString pollConfigKey = QString(typeName + "/poll_file");
+    if (SensorFrameworkConfig::configuration()->exists(pollConfigKey))
+        return SensorFrameworkConfig::configuration()->value<QString>(pollConfigKey, "");
+
+    QString devicePollFilePath = SensorFrameworkConfig::configuration()->value("global/device_poll_file_path").toString();
+    return devicePollFilePath.arg(deviceNumber);
+}
+
+bool InputDevAdaptor::findPaths(QStringList& paths, QList<int>& ids)
+{
+    if (inputMatches_.isEmpty())
+        return SysfsAdaptor::findPaths(paths, ids);
+
+    int deviceNumber = 0;
+    foreach (const QString& match, inputMatches_) {
+        QString deviceName = findInputDevice(match, deviceNumber);
+        if (!deviceName.isEmpty() && paths.size() < maxDeviceCount_) {
+            ids.append(paths.size());
+            paths.append(deviceName);
+        }
+    }
+
+    // Only used from this thread, the poll file of the new device is
+    // written when the interval is applied again.
+    usedDevicePollFilePath_ = pollFilePath(deviceString_, deviceNumber);
+    deviceCount_ = paths.size();
+
+    return !paths.isEmpty();
+}
+
 int InputDevAdaptor::getEvents(int fd)
 {
-    int bytes = read(fd, evlist_, sizeof(struct input_event)*64);
+    int bytes = read(fd, evlist_, sizeof(evlist_));
     if (bytes == -1) {
-        sensordLogW() << "Error occured: " << strerror(errno);
+        if (errno != EAGAIN)
+            sensordLogW() << "Error occured: " << strerror(errno);
         return 0;
     }
     if (bytes % sizeof(struct input_event)) {
@@ -122,20 +190,120 @@ int InputDevAdaptor::getEvents(int fd)
     return bytes/sizeof(struct input_event);
 }
 
-void InputDevAdaptor::processSample(int pathId, int fd)
+bool InputDevAdaptor::configureDescriptor(int pathId, int fd)
 {
-    int numEvents = getEvents(fd);
+    Q_UNUSED(pathId);
 
-    for (int i = 0; i < numEvents; ++i) {
-        switch (evlist_[i].type) {
-            case EV_SYN:
-                interpretSync(pathId, &(evlist_[i]));
-                break;
-            default:
-                interpretEvent(pathId, &(evlist_[i]));
-                break;
+    int flags = fcntl(fd, F_GETFL);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        sensordLogW() << "fcntl(): " << strerror(errno);
+        return false;
+    }
+
+    EventDevice device;
+
+    // Kernels before 3.4 only provide realtime timestamps. Other than
+    // evdev descriptors (e.g. test pipes) are left alone.
+    int clock = CLOCK_MONOTONIC;
+    if (ioctl(fd, EVIOCSCLOCKID, &clock) == -1 && errno != ENOTTY) {
+        sensordLogD() << "Monotonic timestamps not supported by " << id() << " device, converting";
+        device.realtime = true;
+    }
+
+    unsigned char bits[CODE_BITS_SIZE];
+    memset(bits, 0, sizeof(bits));
+    if (ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(bits)), bits) != -1) {
+        for (int code = 0; code <= ABS_MAX; ++code) {
+            if (testCodeBit(bits, code))
+                device.axes.append(code);
         }
     }
+    memset(bits, 0, sizeof(bits));
+    if (ioctl(fd, EVIOCGBIT(EV_SW, sizeof(bits)), bits) != -1) {
+        for (int code = 0; code <= SW_MAX; ++code) {
+            if (testCodeBit(bits, code))
+                device.switches.append(code);
+        }
+    }
+
+    devices_.insert(fd, device);
+    return true;
+}
+
+void InputDevAdaptor::resync(int pathId, int fd, const EventDevice& device, const input_event& sync)
+{
+    input_event ev = sync;
+
+    ev.type = EV_ABS;
+    foreach (unsigned short code, device.axes) {
+        struct input_absinfo info;
+        if (ioctl(fd, EVIOCGABS(code), &info) == -1)
+            continue;
+        ev.code = code;
+        ev.value = info.value;
+        interpretEvent(pathId, &ev);
+    }
+
+    unsigned char bits[CODE_BITS_SIZE];
+    memset(bits, 0, sizeof(bits));
+    if (!device.switches.isEmpty() && ioctl(fd, EVIOCGSW(sizeof(bits)), bits) != -1) {
+        ev.type = EV_SW;
+        foreach (unsigned short code, device.switches) {
+            ev.code = code;
+            ev.value = testCodeBit(bits, code) ? 1 : 0;
+            interpretEvent(pathId, &ev);
+        }
+    }
+
+    ev = sync;
+    interpretSync(pathId, &ev);
+}
+
+void InputDevAdaptor::processSample(int pathId, int fd)
+{
+    EventDevice& device = devices_[fd];
+    RingBufferBase* buffer = findBuffer(QString());
+    int numEvents;
+
+    do {
+        numEvents = getEvents(fd);
+        qint64 offset = device.realtime ? realtimeOffset() : 0;
+
+        for (int i = 0; i < numEvents; ++i) {
+            input_event* ev = &evlist_[i];
+
+            if (device.realtime) {
+                qint64 usec = (qint64)ev->time.tv_sec * 1000000 + ev->time.tv_usec + offset;
+                ev->time.tv_sec = usec / 1000000;
+                ev->time.tv_usec = usec % 1000000;
+            }
+
+            if (ev->type == EV_SYN && ev->code == SYN_DROPPED) {
+                sensordLogW() << "Input events of " << id() << " were dropped, resynchronizing";
+                device.dropped = true;
+                continue;
+            }
+            if (device.dropped) {
+                if (ev->type == EV_SYN && ev->code == SYN_REPORT) {
+                    device.dropped = false;
+                    resync(pathId, fd, device, *ev);
+                }
+                continue;
+            }
+
+            switch (ev->type) {
+                case EV_SYN:
+                    interpretSync(pathId, ev);
+                    break;
+                default:
+                    interpretEvent(pathId, ev);
+                    break;
+            }
+        }
+
+        if (numEvents && buffer)
+            buffer->wakeUpReaders();
+    } while (numEvents == BATCH_SIZE);
 }
 
 bool InputDevAdaptor::checkInputDevice(const QString& path, const QString& matchString, bool strictChecks) const
@@ -33,6 +33,8 @@
 #include <QString>
 #include <QStringList>
 #include <QFile>
+#include <QHash>
+#include <QVector>
 #include <linux/input.h>
 
 /**
@@ -42,6 +44,14 @@
 class InputDevAdaptor : public SysfsAdaptor
 {
 public:
+    /**
+     * Maximum number of events read from a device at once. Readers of the
+     * output buffer are woken up once after all frames of a read have
+     * been committed, so the buffer of a subclass must be able to hold
+     * this many samples.
+     */
+    static const int BATCH_SIZE = 64;
+
     /**
      * Constructor.
      *
@@ -104,13 +114,56 @@ protected:
      */
     int getInputDevices(const QString& typeName);
 
+    /**
+     * Find input devices again for all type names passed to
+     * #getInputDevices.
+     *
+     * @param paths Device paths, filled in.
+     * @param ids   Path IDs for the paths, filled in.
+     * @return was any device found.
+     */
+    virtual bool findPaths(QStringList& paths, QList<int>& ids);
+
+    /**
+     * Drain all pending events from the device. Events are dispatched to
+     * #interpretEvent() and #interpretSync(), and readers of the output
+     * buffer are woken up once per read. After the kernel has dropped
+     * events the rest of the broken frame is discarded and axis and
+     * switch state is read back from the device.
+     *
+     * @param pathId Path ID of the device.
+     * @param fd     Device file descriptor.
+     */
     void processSample(int pathId, int fd);
 
+    /**
+     * Make the device non-blocking and request monotonic event
+     * timestamps.
+     *
+     * @param pathId Path ID of the device.
+     * @param fd     Device file descriptor.
+     * @return was the descriptor configured.
+     */
+    virtual bool configureDescriptor(int pathId, int fd);
+
     virtual unsigned int interval() const;
 
     virtual bool setInterval(const unsigned int value, const int sessionId);
 
 private:
+    /**
+     * State of an opened event device.
+     */
+    struct EventDevice
+    {
+        EventDevice() : realtime(false), dropped(false) {}
+
+        bool                    realtime; /**< timestamps use realtime clock */
+        bool                    dropped;  /**< discarding events until next report */
+        QVector<unsigned short> axes;     /**< supported absolute axes */
+        QVector<unsigned short> switches; /**< supported switches */
+    };
+
     /**
      * Read events from file descriptor. The read events are stored in
      * #evlist_ array.
@@ -120,11 +173,43 @@ private:
      */
     int getEvents(int fd);
 
+    /**
+     * Read current axis and switch state from the device and pass it
+     * through #interpretEvent() followed by #interpretSync().
+     *
+     * @param pathId Path ID of the device.
+     * @param fd     Device file descriptor.
+     * @param device Device state.
+     * @param sync   Report event which ended the dropped frame.
+     */
+    void resync(int pathId, int fd, const EventDevice& device, const input_event& sync);
+
+    /**
+     * Find device node for a device type, either configured with
+     * <tt>typeName/device</tt> or from discovered input devices.
+     *
+     * @param typeName     Device type name.
+     * @param deviceNumber Number of the found device, filled in.
+     * @return device node or empty string if not found.
+     */
+    QString findInputDevice(const QString& typeName, int& deviceNumber) const;
+
+    /**
+     * Path of the poll interval file for a device.
+     *
+     * @param typeName     Device type name.
+     * @param deviceNumber Number of the device.
+     * @return poll file path.
+     */
+    QString pollFilePath(const QString& typeName, int deviceNumber) const;
+
     QString usedDevicePollFilePath_; /**< sysfs path to input device poll file */
     QString deviceString_;           /**< input device name */
+    QStringList inputMatches_;       /**< type names of requested devices */
     int deviceCount_;                /**< number of available input devices */
     const int maxDeviceCount_;       /**< maximum number of supported devices */
-    input_event evlist_[64];         /**< input event buffer */
+    input_event evlist_[BATCH_SIZE]; /**< input event buffer */
+    QHash<int, EventDevice> devices_; /**< opened devices by descriptor */
     unsigned int cachedInterval_;    /**< cached interval reading */
 };
 
@@ -36,6 +36,7 @@
 
 #include "logging.h"
 #include "config.h"
+#include "startupprofile.h"
 
 #ifdef USE_SSUSYSINFO
 # include <ssusysinfo/ssusysinfo.h>
@@ -43,7 +44,9 @@
 
 Loader::Loader()
 {
+    qint64 begin = StartupProfile::elapsed();
     scanAvailablePlugins();
+    StartupProfile::record("plugin scan", begin);
 }
 
 Loader& Loader::instance()
@@ -79,6 +82,7 @@ bool Loader::loadPluginFile(const QString &name, QString &errorString, QStringLi
     PluginBase *plugin = 0;
     sensordLogD() << "Loader loading plugin:" << resolvedName << "as:" << name << "from:" << qpl.fileName();
     bool loaded = false;
+    qint64 begin = StartupProfile::elapsed();
     bool cyclic = stack.contains(resolvedName);
     stack.prepend(resolvedName);
     if (cyclic) {
@@ -100,6 +104,7 @@ bool Loader::loadPluginFile(const QString &name, QString &errorString, QStringLi
         errorString = "not a Plugin type";
         sensordLogC() << "Plugin loading error: " << resolvedName << "-" << errorString;
     } else {
+        StartupProfile::record(QString("dlopen %1").arg(resolvedName), begin);
         loaded = true;
         QStringList dependencies(plugin->Dependencies());
         sensordLogD() << resolvedName << "requires:" << dependencies;
@@ -109,9 +114,11 @@ bool Loader::loadPluginFile(const QString &name, QString &errorString, QStringLi
             }
         }
         if (loaded) {
+            begin = StartupProfile::elapsed();
             plugin->Register(*this);
             loadedPluginNames_.append(resolvedName);
             plugin->Init(*this);
+            StartupProfile::record(QString("register %1").arg(resolvedName), begin);
         }
     }
     stack.removeOne(resolvedName);
@@ -132,6 +139,15 @@ bool Loader::loadPlugin(const QString& name, QString *errorString)
     return loaded;
 }
 
+void Loader::registerBuiltinPlugin(const QString &name)
+{
+    const QString resolvedName(resolveRealPluginName(name));
+    if (!loadedPluginNames_.contains(resolvedName)) {
+        sensordLogD() << "Loader using builtin plugin:" << resolvedName << "as:" << name;
+        loadedPluginNames_.append(resolvedName);
+    }
+}
+
 #ifdef USE_SSUSYSINFO
 static ssusysinfo_t *ssusysinfo = 0;
 #endif
@@ -76,6 +76,16 @@ public:
      */
     QStringList availableSensorPlugins() const;
 
+    /**
+     * Mark plugin as loaded without loading it from disk. Used by
+     * applications that register the components of the plugin
+     * themselves, e.g. fake adaptors in tests and benchmarks, so that
+     * plugins depending on it resolve to those components.
+     *
+     * @param name plugin name.
+     */
+    void registerBuiltinPlugin(const QString &name);
+
 private:
     Loader();
     Loader(const Loader&);
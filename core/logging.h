@@ -28,10 +28,14 @@
 #define LOGGING_H
 
 #include <QDebug>
+#include <QLoggingCategory>
 
-#define sensordLogT(ARGS_...) (qDebug(ARGS_))
-#define sensordLogD(ARGS_...) (qInfo(ARGS_))
-#define sensordLogW(ARGS_...) (qWarning(ARGS_))
-#define sensordLogC(ARGS_...) (qCritical(ARGS_))
+Q_DECLARE_LOGGING_CATEGORY(lcSensorFw)
+
+/* Level is checked before the message or its arguments are evaluated. */
+#define sensordLogT(ARGS_...) qCDebug(lcSensorFw, ##ARGS_)
+#define sensordLogD(ARGS_...) qCInfo(lcSensorFw, ##ARGS_)
+#define sensordLogW(ARGS_...) qCWarning(lcSensorFw, ##ARGS_)
+#define sensordLogC(ARGS_...) qCCritical(lcSensorFw, ##ARGS_)
 
 #endif //LOGGING_H
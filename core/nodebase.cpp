@@ -39,12 +39,60 @@ NodeBase::NodeBase(const QString& id, QObject* parent) :
     m_defaultInterval(0),
     DEFAULT_DATA_RANGE_REQUEST(-1),
     id_(id),
-    isValid_(false)
+    isValid_(false),
+    m_pendingUpdates(0),
+    m_pendingPreviousInterval(0)
 {
 }
 
 NodeBase::~NodeBase()
 {
+    s_pendingNodes.removeAll(this);
+}
+
+int NodeBase::s_batchDepth = 0;
+QList<NodeBase*> NodeBase::s_pendingNodes;
+
+NodeBase::RequestBatch::RequestBatch()
+{
+    ++s_batchDepth;
+}
+
+NodeBase::RequestBatch::~RequestBatch()
+{
+    if (--s_batchDepth)
+        return;
+    // Re-evaluation can not add requests, but take nodes one at a time
+    // in case a node is destroyed by another one's update.
+    while (!s_pendingNodes.isEmpty())
+        s_pendingNodes.takeFirst()->flushUpdates();
+}
+
+bool NodeBase::deferUpdate(PendingUpdate update)
+{
+    if (!s_batchDepth)
+        return false;
+    if (!m_pendingUpdates)
+        s_pendingNodes.append(this);
+    if (update == PendingInterval && !(m_pendingUpdates & PendingInterval))
+        m_pendingPreviousInterval = interval();
+    m_pendingUpdates |= update;
+    return true;
+}
+
+void NodeBase::flushUpdates()
+{
+    int updates = m_pendingUpdates;
+    m_pendingUpdates = 0;
+
+    if (updates & PendingStandbyOverride)
+        setStandbyOverride(m_standbyRequestList.size() > 0);
+    if (updates & PendingBufferSize)
+        updateBufferSize();
+    if (updates & PendingBufferInterval)
+        updateBufferInterval();
+    if (updates & PendingInterval)
+        updateInterval(m_pendingPreviousInterval);
 }
 
 const QString& NodeBase::id() const
@@ -57,6 +105,26 @@ bool NodeBase::isValid() const
     return isValid_;
 }
 
+bool NodeBase::revalidate()
+{
+    if (isValid_ || m_sourceList.isEmpty())
+        return isValid_;
+
+    foreach (NodeBase* source, m_sourceList) {
+        if (!source->isValid())
+            return false;
+    }
+
+    sensordLogD() << "Node '" << id() << "' state changed to valid";
+    isValid_ = true;
+    return true;
+}
+
+const QList<NodeConnection>& NodeBase::connections() const
+{
+    return m_connectionList;
+}
+
 bool NodeBase::isMetadataValid() const
 {
     if (!hasLocalRange())
@@ -322,8 +390,9 @@ bool NodeBase::setIntervalRequest(const int sessionId, const unsigned int value)
         return m_intervalSource->setIntervalRequest(sessionId, value);
     }
 
-    // Validate interval request
-    if (!isValidIntervalRequest(value))
+    // Validate interval request, rates between the supported ones are
+    // served by running faster and decimating
+    if (!isValidIntervalRequest(value) && arbitrateInterval(value) == value)
     {
         sensordLogW() << "Invalid interval requested for node '" << id() << "' by session '" << sessionId << "': " << value;
         return false;
@@ -332,12 +401,16 @@ bool NodeBase::setIntervalRequest(const int sessionId, const unsigned int value)
     // Store the request for the session
     m_intervalMap[sessionId] = value;
 
-    // Store the current interval
-    unsigned int previousInterval = interval();
+    if (!deferUpdate(PendingInterval))
+        updateInterval(interval());
 
-    // Re-evaluate
+    return true;
+}
+
+void NodeBase::updateInterval(unsigned int previousInterval)
+{
     int winningSessionId;
-    unsigned int winningRequest = evaluateIntervalRequests(winningSessionId);
+    unsigned int winningRequest = arbitrateInterval(evaluateIntervalRequests(winningSessionId));
 
     if (winningSessionId >= 0) {
         sensordLogD() << "Setting new interval for node: " << id() << ". Evaluation won by session '" << winningSessionId << "' with request: " << winningRequest;
@@ -349,8 +422,6 @@ bool NodeBase::setIntervalRequest(const int sessionId, const unsigned int value)
     {
         emit propertyChanged("interval");
     }
-
-    return true;
 }
 
 void NodeBase::addStandbyOverrideSource(NodeBase* node)
@@ -392,6 +463,8 @@ bool NodeBase::setStandbyOverrideRequest(const int sessionId, const bool overrid
     // Re-evaluate state for nodes that implement handling locally.
     if (m_standbySourceList.size() == 0)
     {
+        if (deferUpdate(PendingStandbyOverride))
+            return true;
         return setStandbyOverride(m_standbyRequestList.size() > 0);
     }
 
@@ -450,6 +523,28 @@ unsigned int NodeBase::evaluateIntervalRequests(int& sessionId) const
     return highestValue;
 }
 
+unsigned int NodeBase::arbitrateInterval(unsigned int fastest) const
+{
+    if (isValidIntervalRequest(fastest))
+        return fastest;
+
+    unsigned int longest = 0;
+    bool found = false;
+    foreach (const DataRange& range, m_intervalList)
+    {
+        if (range.max < fastest && (!found || range.max > longest))
+        {
+            longest = (unsigned int)range.max;
+            found = true;
+        }
+    }
+    if (!found)
+        return fastest;
+
+    sensordLogD() << "Running" << id() << "at" << longest << "ms, the closest supported interval to" << fastest << "ms";
+    return longest;
+}
+
 unsigned int NodeBase::defaultInterval() const
 {
     return m_defaultInterval;
@@ -499,17 +594,8 @@ void NodeBase::removeIntervalRequest(const int sessionId)
         }
 
         // Re-evaluate local setting
-        int winningSessionId;
-        unsigned int winningRequest = evaluateIntervalRequests(winningSessionId);
-        if (winningSessionId >= 0) {
-            setInterval(winningRequest, winningSessionId);
-        }
-
-        // Signal listeners if changed.
-        if (previousInterval != interval())
-        {
-            emit propertyChanged("interval");
-        }
+        if (!deferUpdate(PendingInterval))
+            updateInterval(previousInterval);
     }
 }
 
@@ -532,6 +618,8 @@ bool NodeBase::connectToSource(NodeBase* source, const QString& bufferName, Ring
     {
         // Store a reference to the source
         m_sourceList.append(source);
+        NodeConnection connection = { source, bufferName, reader };
+        m_connectionList.append(connection);
     }
 
     return success;
@@ -558,6 +646,12 @@ bool NodeBase::disconnectFromSource(NodeBase* source, const QString& bufferName,
         {
             sensordLogW() << "Buffer '" << bufferName << "' not disconnected properly for node: " << id();
         }
+        for (int i = 0; i < m_connectionList.size(); ++i) {
+            if (m_connectionList.at(i).source == source && m_connectionList.at(i).reader == reader) {
+                m_connectionList.removeAt(i);
+                break;
+            }
+        }
     }
 
     return success;
@@ -611,13 +705,14 @@ bool NodeBase::setBufferSize(int sessionId, unsigned int value)
     if(!isInRange(value, getAvailableBufferSizes(hwbuffering)))
         return false;
     m_bufferSizeMap.insert(sessionId, value);
-    return updateBufferSize();
+    return deferUpdate(PendingBufferSize) || updateBufferSize();
 }
 
 bool NodeBase::clearBufferSize(int sessionId)
 {
     int index = m_bufferSizeMap.remove(sessionId);
-    updateBufferSize();
+    if (!deferUpdate(PendingBufferSize))
+        updateBufferSize();
     return index != 0;
 }
 
@@ -647,13 +742,14 @@ bool NodeBase::setBufferInterval(int sessionId, unsigned int value)
     if(!isInRange(value, getAvailableBufferIntervals(hwbuffering)))
         return false;
     m_bufferIntervalMap.insert(sessionId, value);
-    return updateBufferInterval();
+    return deferUpdate(PendingBufferInterval) || updateBufferInterval();
 }
 
 bool NodeBase::clearBufferInterval(int sessionId)
 {
     int index = m_bufferIntervalMap.remove(sessionId);
-    updateBufferInterval();
+    if (!deferUpdate(PendingBufferInterval))
+        updateBufferInterval();
     return index != 0;
 }
 
@@ -35,6 +35,17 @@
 
 class RingBufferReaderBase;
 class RingBufferBase;
+class NodeBase;
+
+/**
+ * Connection of a node to a buffer of its source node.
+ */
+struct NodeConnection
+{
+    NodeBase*             source;     /**< source node */
+    QString               bufferName; /**< buffer of the source node */
+    RingBufferReaderBase* reader;     /**< reader joined to the buffer */
+};
 
 /**
  * Base class for all nodes in sensord framework filtering chain.
@@ -65,6 +76,22 @@ protected:
     virtual ~NodeBase();
 
 public:
+    /**
+     * Scope in which interval, buffer and standby override requests are
+     * only stored. Each node whose requests changed re-evaluates them
+     * once when the outermost batch ends, so configuring several
+     * settings of a session reconfigures the hardware once.
+     */
+    class RequestBatch
+    {
+    public:
+        RequestBatch();
+        ~RequestBatch();
+
+    private:
+        Q_DISABLE_COPY(RequestBatch)
+    };
+
     /**
      * Idenfication string for the sensor node
      *
@@ -79,6 +106,22 @@ public:
      */
     bool isValid() const;
 
+    /**
+     * Mark invalid node valid if it is connected to sources and all of
+     * them are valid. Used for nodes built while their device was
+     * missing.
+     *
+     * @return is object valid.
+     */
+    bool revalidate();
+
+    /**
+     * Get connections to source node buffers.
+     *
+     * @return connections in the order they were made.
+     */
+    const QList<NodeConnection>& connections() const;
+
 public Q_SLOTS:
     /**
      * Get the description for this node.
@@ -175,8 +218,9 @@ public Q_SLOTS:
     const QList<DataRange>& getAvailableIntervals() const;
 
     /**
-     * Set interval request for the node. Acceptable values are listed by
-     * #getAvailableIntervals().
+     * Set interval request for the node. Values listed by
+     * #getAvailableIntervals() are run at as such, longer values between
+     * them are served by #arbitrateInterval().
      *
      * @param sessionId Session ID.
      * @param value interval value is milliseconds.
@@ -460,6 +504,18 @@ protected:
      */
     virtual unsigned int evaluateIntervalRequests(int& sessionId) const;
 
+    /**
+     * Choose the interval to run at for the fastest request. A request
+     * the node does not support exactly is served by the longest
+     * supported interval below it, so the node runs no faster than its
+     * fastest request needs. Sessions asking for longer intervals get
+     * their own rate through per-session decimation.
+     *
+     * @param fastest interval from #evaluateIntervalRequests().
+     * @return interval to set, \c fastest if nothing supported serves it.
+     */
+    unsigned int arbitrateInterval(unsigned int fastest) const;
+
     /**
      * Node to fetch interval from
      *
@@ -547,6 +603,37 @@ private:
      */
     bool updateBufferInterval();
 
+    /**
+     * Pending re-evaluations of a node inside a #RequestBatch.
+     */
+    enum PendingUpdate
+    {
+        PendingInterval        = 1, /**< interval requests changed */
+        PendingBufferSize      = 2, /**< buffer size requests changed */
+        PendingBufferInterval  = 4, /**< buffer interval requests changed */
+        PendingStandbyOverride = 8  /**< standby override requests changed */
+    };
+
+    /**
+     * Postpone a re-evaluation to the end of the current batch.
+     *
+     * @param update re-evaluation to postpone.
+     * @return was it postponed, false outside a batch.
+     */
+    bool deferUpdate(PendingUpdate update);
+
+    /**
+     * Run re-evaluations postponed by #deferUpdate().
+     */
+    void flushUpdates();
+
+    /**
+     * Re-evaluate interval requests and set the winning interval.
+     *
+     * @param previousInterval interval before the requests changed.
+     */
+    void updateInterval(unsigned int previousInterval);
+
     QString                 m_description; /**< node description */
 
     QList<DataRange>        m_dataRangeList; /**< available data ranges */
@@ -561,6 +648,7 @@ private:
     unsigned int            m_defaultInterval; /**< locally set interval */
 
     QList<NodeBase*>        m_sourceList; /**< source nodes */
+    QList<NodeConnection>   m_connectionList; /**< source node buffer connections */
 
     //Oldest session wins for these:
     QMap<int, unsigned int> m_bufferSizeMap; /**< buffersize requests for sessions. */
@@ -570,6 +658,12 @@ private:
 
     QString                 id_; /**< node ID */
     bool                    isValid_; /**< is node correctly initialized */
+
+    int                     m_pendingUpdates; /**< PendingUpdate flags */
+    unsigned int            m_pendingPreviousInterval; /**< interval when first request was deferred */
+
+    static int              s_batchDepth; /**< nesting of RequestBatch scopes */
+    static QList<NodeBase*> s_pendingNodes; /**< nodes with deferred re-evaluations */
 };
 
 #endif
@@ -0,0 +1,205 @@
+/**
+   @file pipeline.h
+   @brief Statically composed filter pipelines
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <QVector>
+#include "filter.h"
+
+/**
+ * Terminates a #Pipeline. Passes values through unchanged.
+ *
+ * @tparam TYPE data type.
+ */
+template <class TYPE>
+class PipelineEnd
+{
+public:
+    typedef TYPE InputType;  /**< accepted data type */
+    typedef TYPE OutputType; /**< produced data type */
+
+    /**
+     * Pass value through.
+     *
+     * @param in input value.
+     * @param out set to input value.
+     * @return always true.
+     */
+    inline bool apply(const TYPE& in, TYPE& out)
+    {
+        out = in;
+        return true;
+    }
+};
+
+/**
+ * Compile-time composition of filter stages. A stage is any class with
+ * <code>InputType</code> and <code>OutputType</code> typedefs and a
+ * member
+ * <code>bool apply(const InputType& in, OutputType& out)</code>
+ * which returns false when the input produced no output, e.g. while
+ * downsampling. Stages are chained by nesting:
+ *
+ * <code>Pipeline&lt;AvgAccStage, Pipeline&lt;DownsampleStage&gt; &gt;</code>
+ *
+ * Unlike filters joined in a #Bin there is no virtual dispatch or sink
+ * lookup between stages, so the compiler can inline the whole chain
+ * into a single loop over a batch of samples. The runtime graph is still
+ * used for anything that needs to be rewired dynamically; wrap the
+ * pipeline into a #FusedFilter to place it in a #Bin.
+ *
+ * @tparam STAGE first stage.
+ * @tparam NEXT rest of the pipeline.
+ */
+template <class STAGE, class NEXT = PipelineEnd<typename STAGE::OutputType> >
+class Pipeline
+{
+public:
+    typedef typename STAGE::InputType InputType;  /**< accepted data type */
+    typedef typename NEXT::OutputType OutputType; /**< produced data type */
+
+    /**
+     * Get first stage.
+     *
+     * @return stage.
+     */
+    STAGE& stage() { return stage_; }
+
+    /**
+     * Get rest of the pipeline.
+     *
+     * @return pipeline following first stage.
+     */
+    NEXT& next() { return next_; }
+
+    /**
+     * Run single value through all stages.
+     *
+     * @param in input value.
+     * @param out location for output value.
+     * @return was output produced.
+     */
+    inline bool apply(const InputType& in, OutputType& out)
+    {
+        typename STAGE::OutputType intermediate;
+        return stage_.apply(in, intermediate) && next_.apply(intermediate, out);
+    }
+
+    /**
+     * Run a batch of values through all stages.
+     *
+     * @param n number of input values.
+     * @param in input values.
+     * @param out location for at most n output values.
+     * @return number of produced output values.
+     */
+    int process(int n, const InputType* in, OutputType* out)
+    {
+        int produced = 0;
+        for (int i = 0; i < n; ++i) {
+            if (apply(in[i], out[produced]))
+                ++produced;
+        }
+        return produced;
+    }
+
+private:
+    STAGE stage_; /**< first stage */
+    NEXT  next_;  /**< following stages */
+};
+
+/**
+ * Last stage of a pipeline writes directly to the output.
+ */
+template <class STAGE, class TYPE>
+class Pipeline<STAGE, PipelineEnd<TYPE> >
+{
+public:
+    typedef typename STAGE::InputType  InputType;
+    typedef typename STAGE::OutputType OutputType;
+
+    STAGE& stage() { return stage_; }
+
+    inline bool apply(const InputType& in, OutputType& out)
+    {
+        return stage_.apply(in, out);
+    }
+
+    int process(int n, const InputType* in, OutputType* out)
+    {
+        int produced = 0;
+        for (int i = 0; i < n; ++i) {
+            if (apply(in[i], out[produced]))
+                ++produced;
+        }
+        return produced;
+    }
+
+private:
+    STAGE stage_;
+};
+
+/**
+ * Filter node running a #Pipeline. Whole batch collected from "sink"
+ * goes through the pipeline in one loop and the results are propagated
+ * to "source" at once.
+ *
+ * @tparam PIPELINE pipeline type.
+ */
+template <class PIPELINE>
+class FusedFilter : public Filter<typename PIPELINE::InputType, FusedFilter<PIPELINE>, typename PIPELINE::OutputType>
+{
+public:
+    typedef typename PIPELINE::InputType  InputType;  /**< accepted data type */
+    typedef typename PIPELINE::OutputType OutputType; /**< produced data type */
+
+    /**
+     * Constructor.
+     */
+    FusedFilter() :
+        Filter<InputType, FusedFilter<PIPELINE>, OutputType>(this, &FusedFilter::process)
+    {
+    }
+
+    /**
+     * Get pipeline for configuring its stages.
+     *
+     * @return pipeline.
+     */
+    PIPELINE& pipeline() { return pipeline_; }
+
+private:
+    void process(unsigned n, const InputType* values)
+    {
+        if ((unsigned)output_.size() < n)
+            output_.resize(n);
+
+        int produced = pipeline_.process(n, values, output_.data());
+        if (produced)
+            this->source_.propagate(produced, output_.constData());
+    }
+
+    PIPELINE            pipeline_; /**< stages */
+    QVector<OutputType> output_;   /**< reused output batch */
+};
+
+#endif // PIPELINE_H
@@ -46,6 +46,13 @@ public:
      */
     SourceBase* source(const QString& name);
 
+    /**
+     * Get all sources.
+     *
+     * @return sources by name.
+     */
+    const QHash<QString, SourceBase*>& sources() const { return sources_; }
+
 protected:
     /**
      * Destructor.
@@ -31,6 +31,18 @@ RingBufferReaderBase::~RingBufferReaderBase()
 {
 }
 
+RingBufferBase::RingBufferBase() :
+    written_("sensorfw_buffer_written_total"),
+    dropped_("sensorfw_buffer_dropped_total")
+{
+}
+
+void RingBufferBase::setStatsLabels(const QString& node, const QString& name)
+{
+    written_.setLabels(node, name);
+    dropped_.setLabels(node, name);
+}
+
 bool RingBufferBase::join(RingBufferReaderBase* reader)
 {
     return joinTypeChecked(reader);
@@ -33,6 +33,7 @@
 #include "sink.h"
 #include "pusher.h"
 #include "logging.h"
+#include "statistics.h"
 #include <QSet>
 
 template <class TYPE>
@@ -95,6 +96,11 @@ private:
 class RingBufferBase : public Consumer
 {
 public:
+    /**
+     * Constructor.
+     */
+    RingBufferBase();
+
     /**
      * Destructor.
      */
@@ -116,6 +122,38 @@ public:
      */
     bool unjoin(RingBufferReaderBase* reader);
 
+    /**
+     * Wake up connected buffer readers.
+     */
+    virtual void wakeUpReaders() = 0;
+
+    /**
+     * Label write and drop counters of the buffer.
+     *
+     * @param node ID of the node owning the buffer.
+     * @param name name of the buffer within the node.
+     */
+    void setStatsLabels(const QString& node, const QString& name);
+
+    /**
+     * Number of objects written, wraps around.
+     *
+     * @return written object count.
+     */
+    unsigned int writtenCount() const { return written_.value(); }
+
+    /**
+     * Number of objects overwritten before a reader got them, wraps
+     * around.
+     *
+     * @return dropped object count.
+     */
+    unsigned int droppedCount() const { return dropped_.value(); }
+
+protected:
+    StatsCounter         written_; /**< written objects */
+    mutable StatsCounter dropped_; /**< objects overwritten before a reader got them */
+
 private:
     /**
      * Connect reader to this buffer.
@@ -177,8 +215,15 @@ public:
                   TYPE*                   values,
                   RingBufferReader<TYPE>& reader) const
     {
+        unsigned written = writeCount_;
+        if (written - reader.readCount_ > bufferSize_) {
+            // Reader has been lapped, skip to the oldest object still buffered.
+            dropped_.add(written - reader.readCount_ - bufferSize_);
+            reader.readCount_ = written - bufferSize_;
+        }
+
         unsigned itemsRead = 0;
-        while (itemsRead < n && reader.readCount_ != (unsigned)writeCount_) {
+        while (itemsRead < n && reader.readCount_ != written) {
 
             *values++ = buffer_[reader.readCount_++ % bufferSize_];
 
@@ -205,6 +250,7 @@ protected:
     void commit()
     {
         ++writeCount_;
+        written_.add();
     }
 
     /**
@@ -0,0 +1,90 @@
+/**
+   @file sampledecimator.h
+   @brief Timestamp based decimation of a sample stream
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef SAMPLEDECIMATOR_H
+#define SAMPLEDECIMATOR_H
+
+#include <QtGlobal>
+
+/**
+ * Picks samples of a stream for a consumer running at a longer interval
+ * than the stream. Samples are picked on the consumer's own period,
+ * measured from the first picked sample, rather than by counting them,
+ * so the consumer gets its rate also when it is not a multiple of the
+ * stream rate. The period advances in whole steps, so jitter of single
+ * timestamps does not make the phase drift.
+ */
+class SampleDecimator
+{
+public:
+    SampleDecimator() :
+        due_(0),
+        started_(false)
+    {
+    }
+
+    /**
+     * Start over, the next sample is picked.
+     */
+    void reset()
+    {
+        started_ = false;
+    }
+
+    /**
+     * Should a sample be picked.
+     *
+     * @param timestamp sample timestamp, us.
+     * @param interval interval of the consumer, ms.
+     * @param sourceInterval interval of the stream, ms.
+     * @return is the sample due.
+     */
+    bool isDue(quint64 timestamp, unsigned int interval, unsigned int sourceInterval)
+    {
+        if (!interval || interval <= sourceInterval)
+            return true;
+
+        quint64 period = (quint64)interval * 1000;
+        // Timestamps jitter, so a sample arriving up to half a stream
+        // period early still counts as the one the consumer is due.
+        quint64 slack = (quint64)sourceInterval * 500;
+
+        if (!started_) {
+            started_ = true;
+            due_ = timestamp + period;
+            return true;
+        }
+        if (timestamp + slack < due_)
+            return false;
+
+        // After a gap in the stream start over.
+        due_ += period;
+        if (due_ <= timestamp)
+            due_ = timestamp + period;
+        return true;
+    }
+
+private:
+    quint64 due_;     /**< timestamp of the next sample due, us */
+    bool    started_; /**< has a sample been picked */
+};
+
+#endif // SAMPLEDECIMATOR_H
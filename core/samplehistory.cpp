@@ -0,0 +1,136 @@
+/**
+   @file samplehistory.cpp
+   @brief SampleHistory
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "samplehistory.h"
+#include "datatypes/genericdata.h"
+#include "logging.h"
+#include <QMutexLocker>
+#include <string.h>
+
+SampleHistory::SampleHistory(quint64 length, unsigned int capacity) :
+    length_(length),
+    capacity_(capacity ? capacity : 1),
+    sampleSize_(0),
+    buffer_(0),
+    first_(0),
+    count_(0)
+{
+}
+
+SampleHistory::~SampleHistory()
+{
+    delete[] buffer_;
+}
+
+const char* SampleHistory::slotAt(unsigned int index) const
+{
+    return buffer_ + ((first_ + index) % capacity_) * sampleSize_;
+}
+
+quint64 SampleHistory::timestampAt(unsigned int index) const
+{
+    return reinterpret_cast<const TimedData*>(slotAt(index))->timestamp_;
+}
+
+void SampleHistory::append(const void* source, int size)
+{
+    if (size < (int)sizeof(TimedData))
+        return;
+
+    QMutexLocker locker(&mutex_);
+
+    if (size != sampleSize_)
+    {
+        sensordLogT() << "[SampleHistory]: sample size changed to" << size << ", resetting history";
+        delete[] buffer_;
+        buffer_ = new char[capacity_ * size];
+        sampleSize_ = size;
+        first_ = 0;
+        count_ = 0;
+    }
+
+    quint64 timestamp = reinterpret_cast<const TimedData*>(source)->timestamp_;
+
+    // Expire samples which fell out of the window.
+    while (count_ && timestamp > length_ && timestampAt(0) < timestamp - length_)
+    {
+        first_ = (first_ + 1) % capacity_;
+        --count_;
+    }
+
+    if (count_ == capacity_)
+    {
+        first_ = (first_ + 1) % capacity_;
+        --count_;
+    }
+
+    memcpy(buffer_ + ((first_ + count_) % capacity_) * sampleSize_, source, sampleSize_);
+    ++count_;
+}
+
+QByteArray SampleHistory::collect(quint64 since, int& size, unsigned int& count) const
+{
+    QMutexLocker locker(&mutex_);
+
+    // Samples are stored in chronological order, so binary search the
+    // oldest one we are interested in.
+    unsigned int low = 0;
+    unsigned int high = count_;
+    while (low < high)
+    {
+        unsigned int mid = low + (high - low) / 2;
+        if (timestampAt(mid) < since)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    size = sampleSize_;
+    count = count_ - low;
+
+    QByteArray data;
+    if (!count)
+        return data;
+
+    data.resize(count * sampleSize_);
+    char* target = data.data();
+
+    // Copy at most two contiguous runs from the ring.
+    unsigned int start = (first_ + low) % capacity_;
+    unsigned int tail = qMin(count, capacity_ - start);
+    memcpy(target, buffer_ + start * sampleSize_, tail * sampleSize_);
+    if (tail < count)
+        memcpy(target + tail * sampleSize_, buffer_, (count - tail) * sampleSize_);
+
+    return data;
+}
+
+void SampleHistory::clear()
+{
+    QMutexLocker locker(&mutex_);
+    first_ = 0;
+    count_ = 0;
+}
+
+quint64 SampleHistory::length() const
+{
+    return length_;
+}
@@ -0,0 +1,113 @@
+/**
+   @file samplehistory.h
+   @brief SampleHistory
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef SAMPLEHISTORY_H
+#define SAMPLEHISTORY_H
+
+#include <QByteArray>
+#include <QMutex>
+
+/**
+ * Bounded, time indexed history of the samples written by a sensor
+ * channel. Samples are stored as raw fixed size records in a single
+ * preallocated ring. Each record is expected to start with #TimedData
+ * so the ring can be searched by timestamp.
+ *
+ * Samples are appended from the thread which is pushing data through the
+ * chain and collected from the main thread, so access is serialized.
+ */
+class SampleHistory
+{
+public:
+    /**
+     * Constructor.
+     *
+     * @param length How long samples are kept in microseconds.
+     * @param capacity Maximum number of samples kept.
+     */
+    SampleHistory(quint64 length, unsigned int capacity);
+
+    /**
+     * Destructor.
+     */
+    ~SampleHistory();
+
+    /**
+     * Append sample to the history. Samples older than the configured
+     * length (relative to given sample) are dropped. If sample size
+     * changes the history is reset.
+     *
+     * @param source Sample to store.
+     * @param size Size of the sample in bytes.
+     */
+    void append(const void* source, int size);
+
+    /**
+     * Copy samples with timestamp newer or equal than given one.
+     *
+     * @param since Monotonic timestamp in microseconds.
+     * @param size Set to the size of single sample in bytes.
+     * @param count Set to the number of returned samples.
+     * @return samples in chronological order.
+     */
+    QByteArray collect(quint64 since, int& size, unsigned int& count) const;
+
+    /**
+     * Drop all stored samples.
+     */
+    void clear();
+
+    /**
+     * How long samples are kept.
+     *
+     * @return history length in microseconds.
+     */
+    quint64 length() const;
+
+private:
+    Q_DISABLE_COPY(SampleHistory)
+
+    /**
+     * Get timestamp of sample in given logical position.
+     *
+     * @param index Position counted from the oldest stored sample.
+     * @return sample timestamp.
+     */
+    quint64 timestampAt(unsigned int index) const;
+
+    /**
+     * Get storage of sample in given logical position.
+     *
+     * @param index Position counted from the oldest stored sample.
+     * @return pointer to sample record.
+     */
+    const char* slotAt(unsigned int index) const;
+
+    mutable QMutex     mutex_;      /**< serializes writer and readers */
+    const quint64      length_;     /**< history length in microseconds */
+    const unsigned int capacity_;   /**< maximum number of samples */
+    int                sampleSize_; /**< size of single sample */
+    char*              buffer_;     /**< sample storage */
+    unsigned int       first_;      /**< slot of the oldest sample */
+    unsigned int       count_;      /**< number of stored samples */
+};
+
+#endif // SAMPLEHISTORY_H
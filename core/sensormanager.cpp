@@ -31,6 +31,7 @@
 #include "serviceinfo.h"
 #include "sensormanager.h"
 #include "loader.h"
+#include "config.h"
 #include "idutils.h"
 #include "logging.h"
 #ifdef SENSORFW_MCE_WATCHER
@@ -40,11 +41,17 @@
 #include "lsclient.h"
 #endif // SENSORFW_LUNA_SERVICE_CLIENT
 #include <QSocketNotifier>
+#include <QTimer>
 #include <errno.h>
 #include "sockethandler.h"
+#include "devicediscovery.h"
+#include "statistics.h"
+#include <QLocalServer>
+#include <QLocalSocket>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/ioctl.h>
 #include <unistd.h>
 #include <QSettings>
 
@@ -52,7 +59,9 @@
 typedef struct {
         int id;
         int size;
+        unsigned int count;
         void* buffer;
+        const WireLayout* layout;
 } PipeData;
 
 SensorManager* SensorManager::instance_ = NULL;
@@ -96,6 +105,16 @@ inline QDBusConnection bus()
     return QDBusConnection::systemBus();
 }
 
+/* Set to run in-process without D-Bus, e.g. in benchmarks. Sensor
+ * channels are then only reachable through the C++ API. */
+#define NO_DBUS_ENV "SENSORFW_NO_DBUS"
+
+static bool dbusDisabled()
+{
+    static const bool disabled = !qgetenv(NO_DBUS_ENV).isEmpty();
+    return disabled;
+}
+
 SensorManager& SensorManager::instance()
 {
     if ( !instance_ )
@@ -109,14 +128,19 @@ SensorManager& SensorManager::instance()
 SensorManager::SensorManager()
     : errorCode_(SmNoError),
     pipeNotifier_(0),
+    lazyPlugins_(SensorFrameworkConfig::configuration()->value<bool>("global/lazy_plugins", false)),
     deviation(0)
 {
     QString pluginPath;
     const char* SOCKET_NAME = "/var/run/sensord.sock";
+    const char* STATS_SOCKET_NAME = "/var/run/sensord-stats.sock";
     QByteArray env = qgetenv("SENSORFW_SOCKET_PATH");
+    QByteArray statsEnv = env;
     if (!env.isEmpty()) {
       env += SOCKET_NAME;
       SOCKET_NAME = env;
+      statsEnv += STATS_SOCKET_NAME;
+      STATS_SOCKET_NAME = statsEnv;
     }
 
     new SensorManagerAdaptor(this);
@@ -124,7 +148,9 @@ SensorManager::SensorManager()
     socketHandler_ = new SocketHandler(this);
     connect(socketHandler_, SIGNAL(lostSession(int)), this, SLOT(lostClient(int)));
 
-    Q_ASSERT(socketHandler_->listen(SOCKET_NAME));
+    if (!socketHandler_->listen(SOCKET_NAME)) {
+        sensordLogC() << "Failed to listen on" << SOCKET_NAME;
+    }
 
     if (pipe(pipefds_) == -1) {
         sensordLogC() << "Failed to create pipe: " << strerror(errno);
@@ -138,6 +164,17 @@ SensorManager::SensorManager()
         sensordLogW() << "Error setting socket permissions! " << SOCKET_NAME;
     }
 
+    statsServer_ = new QLocalServer(this);
+    connect(statsServer_, SIGNAL(newConnection()), this, SLOT(statsConnection()));
+    QLocalServer::removeServer(STATS_SOCKET_NAME);
+    if (!statsServer_->listen(STATS_SOCKET_NAME)) {
+        sensordLogW() << "Failed to listen on" << STATS_SOCKET_NAME << ":" << statsServer_->errorString();
+    } else if (chmod(STATS_SOCKET_NAME, S_IRWXU|S_IRWXG|S_IRWXO) != 0) {
+        sensordLogW() << "Error setting socket permissions! " << STATS_SOCKET_NAME;
+    }
+
+    connect(&DeviceDiscovery::instance(), SIGNAL(devicesChanged()), this, SLOT(devicesChanged()));
+
 #ifdef SENSORFW_MCE_WATCHER
     mceWatcher_ = new MceWatcher(this);
     connect(mceWatcher_, SIGNAL(displayStateChanged(const bool)),
@@ -291,11 +328,14 @@ AbstractSensorChannel* SensorManager::addSensor(const QString& id)
     {
         sensordLogC() << QString("%1 instantiation failed").arg(cleanId);
         delete sensorChannel;
-        removeSensor(getCleanId(id));
-        sensorFactoryMap_.remove(id);
+        // Keep the sensor registered, it can be requested again once
+        // its device appears.
         return NULL;
     }
 
+    if ( dbusDisabled() )
+        return sensorChannel;
+
     bool ok = bus().registerObject(OBJECT_PATH + "/" + sensorChannel->id(), sensorChannel);
     if ( !ok )
     {
@@ -313,7 +353,8 @@ void SensorManager::removeSensor(const QString& id)
     sensordLogD() << "SensorManager removing sensor:" << id;
 
     QMap<QString, SensorInstanceEntry>::iterator entryIt = sensorInstanceMap_.find(id);
-    bus().unregisterObject(OBJECT_PATH + "/" + id);
+    if ( !dbusDisabled() )
+        bus().unregisterObject(OBJECT_PATH + "/" + id);
     delete entryIt.value().sensor_;
     entryIt.value().sensor_ = 0;
     sensorInstanceMap_.remove(id);
@@ -333,6 +374,21 @@ bool SensorManager::loadPlugin(const QString& name)
     return result;
 }
 
+void SensorManager::loadPluginLater(const QString& name)
+{
+    if (deferredPlugins_.isEmpty())
+        QTimer::singleShot(0, this, SLOT(loadDeferredPlugins()));
+    deferredPlugins_.append(name);
+}
+
+void SensorManager::loadDeferredPlugins()
+{
+    while (!deferredPlugins_.isEmpty()) {
+        QString name = deferredPlugins_.takeFirst();
+        sensordLogD() << "Loading deferred plugin" << name << loadPlugin(name);
+    }
+}
+
 QStringList SensorManager::availablePlugins() const
 {
     Loader& l = Loader::instance();
@@ -362,6 +418,10 @@ int SensorManager::requestSensor(const QString& id)
     qDebug() << sensorInstanceMap_.keys();
 
     QMap<QString, SensorInstanceEntry>::iterator entryIt = sensorInstanceMap_.find(cleanId);
+    if ( entryIt == sensorInstanceMap_.end() && lazyPlugins_ && loadPlugin(cleanId) )
+    {
+        entryIt = sensorInstanceMap_.find(cleanId);
+    }
     if ( entryIt == sensorInstanceMap_.end() )
     {
         setError(SmIdNotRegistered, QString(tr("requested sensor id '%1' not registered")).arg(cleanId));
@@ -639,9 +699,9 @@ FilterBase* SensorManager::instantiateFilter(const QString& id)
     return it.value()();
 }
 
-bool SensorManager::write(int id, const void* source, int size)
+bool SensorManager::write(int id, const void* source, int size, unsigned int count, const WireLayout* layout)
 {
-    void* buffer = malloc(size);
+    void* buffer = malloc(size * count);
     if(!buffer) {
         sensordLogC() << "Malloc failed!";
         return false;
@@ -649,9 +709,11 @@ bool SensorManager::write(int id, const void* source, int size)
     PipeData pipeData;
     pipeData.id = id;
     pipeData.size = size;
+    pipeData.count = count;
     pipeData.buffer = buffer;
+    pipeData.layout = layout;
 
-    memcpy(buffer, source, size);
+    memcpy(buffer, source, size * count);
 
     if (::write(pipefds_[1], &pipeData, sizeof(pipeData)) < (int)sizeof(pipeData)) {
         sensordLogW() << "Failed to write all data to pipe.";
@@ -665,13 +727,25 @@ void SensorManager::sensorDataHandler(int)
     PipeData pipeData;
     ssize_t bytesRead = read(pipefds_[0], &pipeData, sizeof(pipeData));
 
-    if (!bytesRead || !socketHandler_->write(pipeData.id, pipeData.buffer, pipeData.size)) {
+    if (!bytesRead) {
+        sensordLogW() << "Failed to read data from pipe.";
+        return;
+    }
+
+    if (!writeNow(pipeData.id, pipeData.buffer, pipeData.size, pipeData.count, pipeData.layout)) {
         sensordLogW() << "Failed to write data to socket.";
     }
 
     free(pipeData.buffer);
 }
 
+bool SensorManager::writeNow(int id, const void* source, int size, unsigned int count, const WireLayout* layout)
+{
+    if (count > 1)
+        return socketHandler_->writeFrame(id, source, size, count, layout);
+    return socketHandler_->write(id, source, size, layout);
+}
+
 void SensorManager::lostClient(int sessionId)
 {
     for(QMap<QString, SensorInstanceEntry>::iterator it = sensorInstanceMap_.begin(); it != sensorInstanceMap_.end(); ++it) {
@@ -708,6 +782,11 @@ void SensorManager::displayStateChanged(bool displayState)
 
     }
 
+    // Sessions kept running by standby override deliver in batches while
+    // the display is off, waking the display up is the wake event which
+    // delivers whatever is held back.
+    socketHandler_->setDisplayOn(displayState);
+
     foreach (const DeviceAdaptorInstanceEntry& adaptor, deviceAdaptorInstanceMap_) {
         if (adaptor.adaptor_) {
             if (displayState) {
@@ -722,6 +801,33 @@ void SensorManager::displayStateChanged(bool displayState)
     }
 }
 
+void SensorManager::devicesChanged()
+{
+    sensordLogD() << "Devices changed, rebinding adaptors";
+
+    bool appeared = false;
+    foreach (const DeviceAdaptorInstanceEntry& adaptor, deviceAdaptorInstanceMap_) {
+        if (adaptor.adaptor_) {
+            bool wasValid = adaptor.adaptor_->isValid();
+            if (adaptor.adaptor_->rebind() && !wasValid)
+                appeared = true;
+        }
+    }
+
+    if (!appeared)
+        return;
+
+    // Chains may depend on other chains, repeat until nothing changes.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        foreach (const ChainInstanceEntry& chain, chainInstanceMap_) {
+            if (chain.chain_ && !chain.chain_->isValid() && chain.chain_->revalidate())
+                changed = true;
+        }
+    }
+}
+
 void SensorManager::devicePSMStateChanged(bool psmState)
 {
     if (psmState)
@@ -756,18 +862,57 @@ void SensorManager::printStatus(QStringList& output) const
     }
 }
 
-QString SensorManager::socketToPid(int id) const
+QByteArray SensorManager::statistics() const
 {
-    struct ucred cr;
-    socklen_t len = sizeof(cr);
-    int fd = socketHandler_->getSocketFd(id);
-    if (fd)
-    {
-        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cr, &len) == 0)
-            return QString("%1").arg(cr.pid);
-        else
-            return strerror(errno);
+    QByteArray output;
+    Statistics::instance().appendCounters(output);
+
+    for (QMap<QString, SensorInstanceEntry>::const_iterator it = sensorInstanceMap_.constBegin(); it != sensorInstanceMap_.constEnd(); ++it) {
+        foreach (int sessionId, it.value().sessions_) {
+            socketHandler_->appendStats(output, it.key(), sessionId);
+        }
     }
+
+    // Sample batches written by adaptor threads and not yet forwarded to sessions.
+    int queued = 0;
+    if (pipefds_[0] && ioctl(pipefds_[0], FIONREAD, &queued) == 0)
+        Statistics::appendLine(output, "sensorfw_pipe_queued_batches", "sensormanager", "pipe", queued / sizeof(PipeData));
+    return output;
+}
+
+QString SensorManager::graph(const QString& format)
+{
+    QList<NodeBase*> nodes;
+    for (QMap<QString, DeviceAdaptorInstanceEntry>::const_iterator it = deviceAdaptorInstanceMap_.constBegin(); it != deviceAdaptorInstanceMap_.constEnd(); ++it) {
+        if (it.value().adaptor_)
+            nodes.append(it.value().adaptor_);
+    }
+    for (QMap<QString, ChainInstanceEntry>::const_iterator it = chainInstanceMap_.constBegin(); it != chainInstanceMap_.constEnd(); ++it) {
+        if (it.value().chain_)
+            nodes.append(it.value().chain_);
+    }
+    for (QMap<QString, SensorInstanceEntry>::const_iterator it = sensorInstanceMap_.constBegin(); it != sensorInstanceMap_.constEnd(); ++it) {
+        if (it.value().sensor_)
+            nodes.append(it.value().sensor_);
+    }
+    return graphDump_.dump(nodes, format == "json" ? GraphDump::Json : GraphDump::Dot);
+}
+
+void SensorManager::statsConnection()
+{
+    while (statsServer_->hasPendingConnections()) {
+        QLocalSocket* socket = statsServer_->nextPendingConnection();
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        socket->write(statistics());
+        socket->disconnectFromServer();
+    }
+}
+
+QString SensorManager::socketToPid(int id) const
+{
+    pid_t pid = socketHandler_->getSocketPid(id);
+    if (pid)
+        return QString("%1").arg(pid);
     return "n/a";
 }
 
@@ -37,6 +37,7 @@
 #include "sfwerror.h"
 #include "idutils.h"
 #include "parameterparser.h"
+#include "graphdump.h"
 #include "logging.h"
 
 #ifdef SENSORFW_MCE_WATCHER
@@ -50,6 +51,7 @@ class MceWatcher;
 #endif
 
 class QSocketNotifier;
+class QLocalServer;
 class SocketHandler;
 
 /**
@@ -143,6 +145,25 @@ public:
      */
     void printStatus(QStringList& output) const;
 
+    /**
+     * Current throughput, drop and queue depth counters of all nodes and
+     * sessions in #Statistics exposition format. Served also through the
+     * statistics socket.
+     *
+     * @return statistics text.
+     */
+    QByteArray statistics() const;
+
+    /**
+     * Describe instantiated adaptors, chains and sensors and the
+     * dataflow between them. Edges are annotated with rates measured
+     * since the previous call.
+     *
+     * @param format "dot" for Graphviz DOT, "json" for JSON.
+     * @return graph description.
+     */
+    QString graph(const QString& format);
+
     /**
      * Get last occured error code.
      *
@@ -264,9 +285,26 @@ public:
      *
      * @param id Session ID.
      * @param source Source from where to write.
-     * @param size How many bytes to write.
+     * @param size Size of single sample in bytes.
+     * @param count How many samples to write. Multiple samples are
+     *              written to the session as a single frame.
+     * @param layout Layout of the samples or NULL if not known.
+     */
+    bool write(int id, const void* source, int size, unsigned int count = 1, const WireLayout* layout = NULL);
+
+    /**
+     * Write sensor data for given session straight to its socket instead
+     * of passing it through the pipe to the main thread. Must only be
+     * called in the main thread.
+     *
+     * @param id Session ID.
+     * @param source Source from where to write.
+     * @param size Size of single sample in bytes.
+     * @param count How many samples to write as a single frame.
+     * @param layout Layout of the samples or NULL if not known.
+     * @return was the data accepted by the socket handler.
      */
-    bool write(int id, const void* source, int size);
+    bool writeNow(int id, const void* source, int size, unsigned int count = 1, const WireLayout* layout = NULL);
 
     /**
      * Load plugin.
@@ -276,6 +314,15 @@ public:
      */
     bool loadPlugin(const QString& name);
 
+    /**
+     * Load plugin once the event loop runs, so that it does not delay
+     * the daemon from becoming ready. With <tt>global/lazy_plugins</tt>
+     * set, a request for its sensor before that loads it right away.
+     *
+     * @param name plugin name.
+     */
+    void loadPluginLater(const QString& name);
+
     /**
      * Test if a plugin is available
      *
@@ -297,6 +344,14 @@ public:
      */
     QStringList availableSensorPlugins() const;
 
+    /**
+     * Generate new unique session ID. Chains use their own session to
+     * place interval requests on shared sources.
+     *
+     * @return session ID.
+     */
+    int createNewSessionId();
+
     /**
      * Request sensor.
      *
@@ -387,6 +442,23 @@ private Q_SLOTS:
      */
     void sensorDataHandler(int);
 
+    /**
+     * Callback for added or removed devices. Rebinds instantiated
+     * adaptors and makes chains valid whose device has appeared.
+     */
+    void devicesChanged();
+
+    /**
+     * Callback for new connection to the statistics socket. Writes
+     * #statistics() and closes the connection.
+     */
+    void statsConnection();
+
+    /**
+     * Load plugins queued with #loadPluginLater().
+     */
+    void loadDeferredPlugins();
+
 Q_SIGNALS:
     /**
      * Signal for occured errors.
@@ -448,13 +520,6 @@ private:
      */
     void removeSensor(const QString& id);
 
-    /**
-     * Generate new unique session ID.
-     *
-     * @return session ID.
-     */
-    int createNewSessionId();
-
     /**
      * Resolve peer PID of given session.
      *
@@ -483,6 +548,8 @@ private:
     QMap<QString, FilterFactoryMethod>             filterFactoryMap_; /**< factories for filter types */
 
     SocketHandler*                                 socketHandler_; /**< socket handler */
+    QLocalServer*                                  statsServer_; /**< statistics socket */
+    GraphDump                                      graphDump_; /**< graph description with previous rates */
     MceWatcher*                                    mceWatcher_; /**< MCE watcher */
 #ifdef SENSORFW_LUNA_SERVICE_CLIENT
     LSClient*                                      lsClient_; /**< LS client */
@@ -491,6 +558,8 @@ private:
     QString                                        errorString_; /** global error description */
     int                                            pipefds_[2]; /** pipe for sensor samples */
     QSocketNotifier*                               pipeNotifier_; /** notifier for pipe stream */
+    bool                                           lazyPlugins_; /** load sensor plugins on first request */
+    QStringList                                    deferredPlugins_; /** plugins to load once event loop runs */
 
     static SensorManager*                          instance_; /** singleton */
     static int                                     sessionIdCount_; /** session ID counter */
@@ -82,6 +82,11 @@ bool SensorManagerAdaptor::releaseSensor(const QString &id, int sessionId, qint6
     return sensorManager()->releaseSensor(id, sessionId);
 }
 
+QString SensorManagerAdaptor::graph(const QString& format)
+{
+    return sensorManager()->graph(format);
+}
+
 void SensorManagerAdaptor::setMagneticDeviation(double level)
 {
     sensorManager()->setMagneticDeviation(level);
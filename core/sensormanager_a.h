@@ -127,6 +127,14 @@ public Q_SLOTS:
      */
     bool releaseSensor(const QString &id, int sessionId, qint64 pid);
 
+    /**
+     * Describe the running dataflow graph with per edge rates.
+     *
+     * @param format "dot" for Graphviz DOT, "json" for JSON.
+     * @return graph description.
+     */
+    QString graph(const QString& format);
+
     double magneticDeviation();
     void setMagneticDeviation(double level);
 
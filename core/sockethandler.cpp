@@ -28,12 +28,20 @@
 
 #include <QLocalSocket>
 #include <QLocalServer>
+#include <QVector>
 #include <sys/socket.h>
+#include <poll.h>
 #include "logging.h"
 #include "sockethandler.h"
+#include "statistics.h"
+#include "wireformat.h"
+#include "config.h"
 #include <unistd.h>
 #include <limits.h>
 
+/* Samples are dropped while more than this is waiting for the client. */
+#define DEFAULT_MAX_QUEUED_BYTES 262144
+
 SessionData::SessionData(QLocalSocket* socket, QObject* parent) : QObject(parent),
                                                                   socket(socket),
                                                                   interval(-1),
@@ -42,17 +50,42 @@ SessionData::SessionData(QLocalSocket* socket, QObject* parent) : QObject(parent
                                                                   count(0),
                                                                   bufferSize(1),
                                                                   bufferInterval(0),
-                                                                  downsampling(false)
+                                                                  downsampling(false),
+                                                                  pid(0),
+                                                                  received(0),
+                                                                  sent(0),
+                                                                  dropped(0),
+                                                                  wireVersion(0),
+                                                                  layout(0),
+                                                                  maxQueuedBytes(DEFAULT_MAX_QUEUED_BYTES),
+                                                                  congested(false),
+                                                                  maxLatency(0),
+                                                                  deferring(false)
 {
     lastWrite.tv_sec = 0;
     lastWrite.tv_usec = 0;
+
+    struct ucred cr;
+    socklen_t len = sizeof(cr);
+    if (getsockopt(socket->socketDescriptor(), SOL_SOCKET, SO_PEERCRED, &cr, &len) == 0)
+        pid = cr.pid;
+    configurationChanged();
+    connect(SensorFrameworkConfig::configuration(), SIGNAL(changed()), this, SLOT(configurationChanged()));
     timer.setSingleShot(true);
     connect(&timer, SIGNAL(timeout()), this, SLOT(timerTimeout()));
+    latencyTimer.setSingleShot(true);
+    connect(&latencyTimer, SIGNAL(timeout()), this, SLOT(latencyTimeout()));
+}
+
+void SessionData::configurationChanged()
+{
+    maxQueuedBytes = SensorFrameworkConfig::configuration()->value<qint64>("socket/max_queued_bytes", DEFAULT_MAX_QUEUED_BYTES);
 }
 
 SessionData::~SessionData()
 {
     timer.stop();
+    latencyTimer.stop();
     delete socket;
     delete[] buffer;
 }
@@ -62,6 +95,11 @@ void SessionData::timerTimeout()
     delayedWrite();
 }
 
+void SessionData::latencyTimeout()
+{
+    flushDeferred();
+}
+
 long SessionData::sinceLastWrite() const
 {
     if(lastWrite.tv_sec == 0)
@@ -71,31 +109,100 @@ long SessionData::sinceLastWrite() const
     return (now.tv_sec - lastWrite.tv_sec) * 1000 + ((now.tv_usec - lastWrite.tv_usec) / 1000);
 }
 
+bool SessionData::isCongested(unsigned int count)
+{
+    if(socket->bytesToWrite() <= maxQueuedBytes)
+    {
+        if(congested)
+            sensordLogD() << "[SocketHandler]: client" << pid << "is reading again";
+        congested = false;
+        return false;
+    }
+    if(!congested)
+        sensordLogW() << "[SocketHandler]: client" << pid << "is not reading, dropping samples";
+    congested = true;
+    dropped += count;
+    return true;
+}
+
+bool SessionData::output(const char* data, qint64 length)
+{
+    if(deferring && maxLatency)
+    {
+        deferred.append(data, length);
+        if(deferred.size() >= maxQueuedBytes)
+            return flushDeferred();
+        if(!latencyTimer.isActive())
+            latencyTimer.start(maxLatency);
+        return true;
+    }
+    return socket->write(data, length) >= 0;
+}
+
+bool SessionData::flushDeferred()
+{
+    latencyTimer.stop();
+    if(deferred.isEmpty() || !socket)
+        return true;
+    qint64 written = socket->write(deferred);
+    deferred.clear();
+    if(written < 0)
+    {
+        sensordLogW() << "[SocketHandler]: failed to write deferred data to the socket: " << socket->errorString();
+        return false;
+    }
+    return true;
+}
+
 bool SessionData::write(void* source, int size, unsigned int count)
 {
     if(socket && count)
     {
+        // Drops for a client which is not reading are counted and
+        // logged once by isCongested(), they are not write errors.
+        if(isCongested(count))
+            return true;
+        if(wireVersion)
+            return writeSamples(layout, (const char*)source + sizeof(unsigned int), size, count);
         memcpy(source, &count, sizeof(unsigned int));
-        int written = socket->write((const char*)source, size * count + sizeof(unsigned int));
-        if(written < 0)
+        if(!output((const char*)source, size * count + sizeof(unsigned int)))
         {
             sensordLogW() << "[SocketHandler]: failed to write payload to the socket: " << socket->errorString();
+            dropped += count;
             return false;
         }
+        sent += count;
         return true;
     }
     return false;
 }
 
-bool SessionData::write(const void* source, int size)
+bool SessionData::writeSamples(const WireLayout* layout, const void* source, int size, unsigned int count)
+{
+    encoded.resize(0);
+    WireFormat::encode(layout, size, source, count, encoded);
+    if(!output(encoded.constData(), encoded.size()))
+    {
+        sensordLogW() << "[SocketHandler]: failed to write payload to the socket: " << socket->errorString();
+        dropped += count;
+        return false;
+    }
+    sent += count;
+    return true;
+}
+
+bool SessionData::write(const void* source, int size, const WireLayout* layout)
 {
     long since = sinceLastWrite();
+    ++received;
+    if(count && (size != this->size || layout != this->layout))
+        delayedWrite();
+    this->layout = layout;
     int allocSize = bufferSize * size + sizeof(unsigned int);
     if(!buffer)
         buffer = new char[allocSize];
     else if(size != this->size)
     {
-        socket->waitForBytesWritten();
         delete[] buffer;
         buffer = new char[allocSize];
     }
@@ -108,6 +215,7 @@ bool SessionData::write(const void* source, int size)
             gettimeofday(&lastWrite, 0);
             return write(buffer, size, 1);
         }
+        ++dropped;
     }
     else
     {
@@ -132,6 +240,34 @@ bool SessionData::write(const void* source, int size)
     return true;
 }
 
+bool SessionData::writeFrame(const void* source, int size, unsigned int count, const WireLayout* layout)
+{
+    if(!socket || !count)
+        return false;
+    if(this->count)
+        delayedWrite();
+    received += count;
+    if(isCongested(count))
+        return true;
+    if(wireVersion)
+    {
+        if(!writeSamples(layout, source, size, count))
+            return false;
+        gettimeofday(&lastWrite, 0);
+        return true;
+    }
+    if(!output((const char*)&count, sizeof(unsigned int)) ||
+       !output((const char*)source, size * count))
+    {
+        sensordLogW() << "[SocketHandler]: failed to write frame to the socket: " << socket->errorString();
+        dropped += count;
+        return false;
+    }
+    sent += count;
+    gettimeofday(&lastWrite, 0);
+    return true;
+}
+
 bool SessionData::delayedWrite()
 {
     if(timer.isActive())
@@ -154,6 +290,11 @@ QLocalSocket* SessionData::getSocket() const
     return socket;
 }
 
+pid_t SessionData::getPid() const
+{
+    return pid;
+}
+
 void SessionData::setInterval(int interval)
 {
     this->interval = interval;
@@ -178,9 +319,10 @@ void SessionData::setBufferSize(unsigned int size)
 {
     if(size != bufferSize)
     {
+        if(count)
+            delayedWrite();
         if(timer.isActive())
             timer.stop();
-        socket->waitForBytesWritten();
         delete[] buffer;
         buffer = 0;
         count = 0;
@@ -211,7 +353,61 @@ bool SessionData::getDownsampling() const
     return downsampling;
 }
 
-SocketHandler::SocketHandler(QObject* parent) : QObject(parent), m_server(NULL)
+void SessionData::setWireVersion(int version)
+{
+    wireVersion = version;
+}
+
+int SessionData::getWireVersion() const
+{
+    return wireVersion;
+}
+
+void SessionData::setMaxLatency(unsigned int latency)
+{
+    if(latency != maxLatency)
+    {
+        maxLatency = latency;
+        flushDeferred();
+    }
+}
+
+unsigned int SessionData::getMaxLatency() const
+{
+    return maxLatency;
+}
+
+void SessionData::setDeferring(bool value)
+{
+    deferring = value;
+    if(!deferring)
+        flushDeferred();
+}
+
+unsigned int SessionData::receivedCount() const
+{
+    return received;
+}
+
+unsigned int SessionData::sentCount() const
+{
+    return sent;
+}
+
+unsigned int SessionData::droppedCount() const
+{
+    return dropped;
+}
+
+qint64 SessionData::queuedBytes() const
+{
+    qint64 bytes = (qint64)count * size + deferred.size();
+    if(socket)
+        bytes += socket->bytesToWrite();
+    return bytes;
+}
+
+SocketHandler::SocketHandler(QObject* parent) : QObject(parent), m_server(NULL), m_displayOn(true)
 {
     m_server = new QLocalServer(this);
     connect(m_server, SIGNAL(newConnection()), this, SLOT(newConnection()));
@@ -244,34 +440,48 @@ bool SocketHandler::listen(const QString& serverName)
     return m_server->isListening();
 }
 
-bool SocketHandler::write(int id, const void* source, int size)
+bool SocketHandler::write(int id, const void* source, int size, const WireLayout* layout)
+{
+    QHash<int, SessionData*>::iterator it = m_idMap.find(id);
+    if (it == m_idMap.end())
+    {
+        sensordLogD() << "[SocketHandler]: Trying to write to nonexistent session (normal, no panic).";
+        return false;
+    }
+    return (*it)->write(source, size, layout);
+}
+
+bool SocketHandler::writeFrame(int id, const void* source, int size, unsigned int count, const WireLayout* layout)
 {
-    QMap<int, SessionData*>::iterator it = m_idMap.find(id);
+    QHash<int, SessionData*>::iterator it = m_idMap.find(id);
     if (it == m_idMap.end())
     {
         sensordLogD() << "[SocketHandler]: Trying to write to nonexistent session (normal, no panic).";
         return false;
     }
-    return (*it)->write(source, size);
+    return (*it)->writeFrame(source, size, count, layout);
 }
 
 bool SocketHandler::removeSession(int sessionId)
 {
-    if (!(m_idMap.keys().contains(sessionId))) {
+    QHash<int, SessionData*>::iterator it = m_idMap.find(sessionId);
+    if (it == m_idMap.end()) {
         sensordLogW() << "[SocketHandler]: Trying to remove nonexistent session.";
         return false;
     }
 
-    QLocalSocket* socket = (*m_idMap.find(sessionId))->stealSocket();
+    SessionData* session = it.value();
+    m_idMap.erase(it);
+    m_pidMap.remove(session->getPid(), sessionId);
 
+    QLocalSocket* socket = session->stealSocket();
     if (socket) {
-        disconnect(socket, SIGNAL(readyRead()), this, SLOT(socketReadable()));
-        disconnect(socket, SIGNAL(disconnected()), this, SLOT(socketDisconnected()));
-        disconnect(socket, SIGNAL(error(QLocalSocket::LocalSocketError)), this, SLOT(socketError(QLocalSocket::LocalSocketError)));
+        m_socketMap.remove(socket);
+        disconnect(socket, 0, this, 0);
         socket->deleteLater();
     }
 
-    delete m_idMap.take(sessionId);
+    delete session;
 
     return true;
 }
@@ -287,9 +497,10 @@ void SocketHandler::newConnection()
         connect(socket, SIGNAL(disconnected()), this, SLOT(socketDisconnected()));
         connect(socket, SIGNAL(error(QLocalSocket::LocalSocketError)), this, SLOT(socketError(QLocalSocket::LocalSocketError)));
 
-        // Initialize socket
-        socket->write("\n", 1);
-        socket->waitForBytesWritten();
+        // Initialize socket. Clients which do not know about framing
+        // versions ignore the value of the tag.
+        char tag = WireFormat::TagBase + WireFormat::Version;
+        socket->write(&tag, 1);
     }
 }
 
@@ -297,13 +508,36 @@ void SocketHandler::socketReadable()
 {
     int sessionId = -1;
     QLocalSocket* socket = (QLocalSocket*)sender();
-    ((QLocalSocket*)sender())->read((char*)&sessionId, sizeof(int));
+
+    // Session ID and hello are written by the client in one go, wait
+    // until all of it has arrived.
+    qint64 available = socket->bytesAvailable();
+    if (available < (qint64)sizeof(int) ||
+        (available > (qint64)sizeof(int) && available < (qint64)sizeof(int) + WireFormat::HelloSize))
+        return;
+
+    socket->read((char*)&sessionId, sizeof(int));
+
+    int wireVersion = 0;
+    if (socket->bytesAvailable() >= WireFormat::HelloSize) {
+        quint32 hello[2];
+        socket->read((char*)hello, sizeof(hello));
+        if (hello[0] == (quint32)WireFormat::HelloMagic)
+            wireVersion = qMin((int)hello[1], (int)WireFormat::Version);
+    }
 
     disconnect(socket, SIGNAL(readyRead()), this, SLOT(socketReadable()));
 
     if (sessionId >= 0) {
-        if(!m_idMap.contains(sessionId))
-            m_idMap.insert(sessionId, new SessionData((QLocalSocket*)sender(), this));
+        if(!m_idMap.contains(sessionId)) {
+            SessionData* session = new SessionData(socket, this);
+            session->setWireVersion(wireVersion);
+            session->setDeferring(!m_displayOn);
+            sensordLogT() << "[SocketHandler]: Session" << sessionId << "uses framing version" << wireVersion;
+            m_idMap.insert(sessionId, session);
+            m_socketMap.insert(socket, sessionId);
+            m_pidMap.insert(session->getPid(), sessionId);
+        }
     } else {
         sensordLogC() << "[SocketHandler]: Failed to read valid session ID from client. Closing socket.";
         socket->abort();
@@ -314,20 +548,50 @@ void SocketHandler::socketDisconnected()
 {
     QLocalSocket* socket = (QLocalSocket*)sender();
 
-    int sessionId = -1;
-    for(QMap<int, SessionData*>::const_iterator it = m_idMap.constBegin(); it != m_idMap.constEnd(); ++it)
-    {
-        if(it.value()->getSocket() == socket)
-            sessionId = it.key();
-    }
-
-    if (sessionId == -1) {
+    QHash<QLocalSocket*, int>::const_iterator it = m_socketMap.constFind(socket);
+    if (it == m_socketMap.constEnd()) {
         sensordLogW() << "[SocketHandler]: Noticed lost session, but can't find it.";
         return;
     }
+    int sessionId = it.value();
+
+    // A dying client closes all of its sessions at once. Tear down every
+    // already closed session of the process now instead of handling the
+    // disconnects one event loop round at a time.
+    QList<int> lost;
+    pid_t pid = m_idMap.value(sessionId)->getPid();
+    if (pid)
+        lost = closedSessions(pid);
+    if (!lost.contains(sessionId))
+        lost.append(sessionId);
+
+    if (lost.size() > 1)
+        sensordLogW() << "[SocketHandler]: Noticed" << lost.size() << "lost sessions of process" << pid;
+    foreach (int id, lost) {
+        sensordLogW() << "[SocketHandler]: Noticed lost session: " << id;
+        emit lostSession(id);
+    }
+}
 
-    sensordLogW() << "[SocketHandler]: Noticed lost session: " << sessionId;
-    emit lostSession(sessionId);
+QList<int> SocketHandler::closedSessions(pid_t pid) const
+{
+    QList<int> ids = m_pidMap.values(pid);
+    QVector<struct pollfd> fds(ids.size());
+    for (int i = 0; i < ids.size(); ++i) {
+        QLocalSocket* socket = m_idMap.value(ids[i])->getSocket();
+        fds[i].fd = socket ? socket->socketDescriptor() : -1;
+        fds[i].events = 0;
+        fds[i].revents = 0;
+    }
+
+    QList<int> closed;
+    if (poll(fds.data(), fds.size(), 0) > 0) {
+        for (int i = 0; i < ids.size(); ++i) {
+            if (fds[i].revents & (POLLHUP | POLLERR))
+                closed.append(ids[i]);
+        }
+    }
+    return closed;
 }
 
 void SocketHandler::socketError(QLocalSocket::LocalSocketError socketError)
@@ -336,9 +600,22 @@ void SocketHandler::socketError(QLocalSocket::LocalSocketError socketError)
     socketDisconnected();
 }
 
+pid_t SocketHandler::getSocketPid(int sessionId) const
+{
+    QHash<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
+    if (it != m_idMap.end())
+        return (*it)->getPid();
+    return 0;
+}
+
+int SocketHandler::sessionCount() const
+{
+    return m_idMap.size();
+}
+
 int SocketHandler::getSocketFd(int sessionId) const
 {
-    QMap<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
+    QHash<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
     if (it != m_idMap.end() && (*it)->getSocket())
         return (*it)->getSocket()->socketDescriptor();
     return 0;
@@ -346,21 +623,21 @@ int SocketHandler::getSocketFd(int sessionId) const
 
 void SocketHandler::setInterval(int sessionId, int value)
 {
-    QMap<int, SessionData*>::iterator it = m_idMap.find(sessionId);
+    QHash<int, SessionData*>::iterator it = m_idMap.find(sessionId);
     if (it != m_idMap.end())
         (*it)->setInterval(value);
 }
 
 void SocketHandler::clearInterval(int sessionId)
 {
-    QMap<int, SessionData*>::iterator it = m_idMap.find(sessionId);
+    QHash<int, SessionData*>::iterator it = m_idMap.find(sessionId);
     if (it != m_idMap.end())
         (*it)->setInterval(-1);
 }
 
 int SocketHandler::interval(int sessionId) const
 {
-    QMap<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
+    QHash<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
     if (it != m_idMap.end())
         return (*it)->getInterval();
     return 0;
@@ -368,7 +645,7 @@ int SocketHandler::interval(int sessionId) const
 
 void SocketHandler::setBufferSize(int sessionId, unsigned int value)
 {
-    QMap<int, SessionData*>::iterator it = m_idMap.find(sessionId);
+    QHash<int, SessionData*>::iterator it = m_idMap.find(sessionId);
     if (it != m_idMap.end())
         (*it)->setBufferSize(value);
 }
@@ -380,7 +657,7 @@ void SocketHandler::clearBufferSize(int sessionId)
 
 unsigned int SocketHandler::bufferSize(int sessionId) const
 {
-    QMap<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
+    QHash<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
     if (it != m_idMap.end())
         return (*it)->getBufferSize();
     return 0;
@@ -388,7 +665,7 @@ unsigned int SocketHandler::bufferSize(int sessionId) const
 
 void SocketHandler::setBufferInterval(int sessionId, unsigned int value)
 {
-    QMap<int, SessionData*>::iterator it = m_idMap.find(sessionId);
+    QHash<int, SessionData*>::iterator it = m_idMap.find(sessionId);
     if (it != m_idMap.end())
         (*it)->setBufferInterval(value);
 }
@@ -400,7 +677,7 @@ void SocketHandler::clearBufferInterval(int sessionId)
 
 unsigned int SocketHandler::bufferInterval(int sessionId) const
 {
-    QMap<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
+    QHash<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
     if (it != m_idMap.end())
         return (*it)->getBufferInterval();
     return 0;
@@ -408,7 +685,7 @@ unsigned int SocketHandler::bufferInterval(int sessionId) const
 
 bool SocketHandler::downsampling(int sessionId) const
 {
-    QMap<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
+    QHash<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
     if (it != m_idMap.end())
         return (*it)->getBufferSize();
     return 0;
@@ -416,7 +693,44 @@ bool SocketHandler::downsampling(int sessionId) const
 
 void SocketHandler::setDownsampling(int sessionId, bool value)
 {
-    QMap<int, SessionData*>::iterator it = m_idMap.find(sessionId);
+    QHash<int, SessionData*>::iterator it = m_idMap.find(sessionId);
     if (it != m_idMap.end())
         (*it)->setBufferInterval(value);
 }
+
+void SocketHandler::setMaxLatency(int sessionId, unsigned int value)
+{
+    QHash<int, SessionData*>::iterator it = m_idMap.find(sessionId);
+    if (it != m_idMap.end())
+        (*it)->setMaxLatency(value);
+}
+
+unsigned int SocketHandler::maxLatency(int sessionId) const
+{
+    QHash<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
+    if (it != m_idMap.end())
+        return (*it)->getMaxLatency();
+    return 0;
+}
+
+void SocketHandler::setDisplayOn(bool on)
+{
+    if (on == m_displayOn)
+        return;
+    m_displayOn = on;
+    foreach (SessionData* session, m_idMap)
+        session->setDeferring(!on);
+}
+
+void SocketHandler::appendStats(QByteArray& output, const QString& node, int sessionId) const
+{
+    QHash<int, SessionData*>::const_iterator it = m_idMap.find(sessionId);
+    if (it == m_idMap.end())
+        return;
+
+    QString name = QString::number(sessionId);
+    Statistics::appendLine(output, "sensorfw_session_received_total", node, name, (*it)->receivedCount());
+    Statistics::appendLine(output, "sensorfw_session_sent_total", node, name, (*it)->sentCount());
+    Statistics::appendLine(output, "sensorfw_session_dropped_total", node, name, (*it)->droppedCount());
+    Statistics::appendLine(output, "sensorfw_session_queued_bytes", node, name, (*it)->queuedBytes());
+}
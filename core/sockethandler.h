@@ -29,14 +29,18 @@
 #define SOCKETHANDLER_H
 
 #include <QObject>
-#include <QMap>
+#include <QByteArray>
+#include <QHash>
+#include <QMultiHash>
 #include <QTimer>
 #include <QList>
 #include <QMutex>
 #include <QLocalSocket>
 #include <sys/time.h>
+#include <sys/types.h>
 
 class QLocalServer;
+struct WireLayout;
 
 /**
  * Class contains data for single sensor session related data socket
@@ -67,9 +71,25 @@ public:
      *
      * @param source Source from where to write.
      * @param size How many bytes to write from source.
-     * @return was data succesfully written.
+     * @param layout Layout of the sample or NULL if not known.
+     * @return false on socket error. Samples dropped for a client which
+     *         is not reading are counted and not reported as errors.
      */
-    bool write(const void* source, int size);
+    bool write(const void* source, int size, const WireLayout* layout = NULL);
+
+    /**
+     * Write several samples to socket as a single frame. Samples queued
+     * by #write(const void*, int) are flushed first so ordering of the
+     * stream is preserved. Interval and buffering settings are not
+     * applied to the frame.
+     *
+     * @param source Source from where to write.
+     * @param size Size of single sample in bytes.
+     * @param count How many samples to write.
+     * @param layout Layout of the samples or NULL if not known.
+     * @return false on socket error, see #write(const void*, int, const WireLayout*).
+     */
+    bool writeFrame(const void* source, int size, unsigned int count, const WireLayout* layout = NULL);
 
     /**
      * Get used local socket pointer.
@@ -86,6 +106,13 @@ public:
      */
     QLocalSocket* stealSocket();
 
+    /**
+     * Get process ID of the connected client.
+     *
+     * @return client process ID or 0 if not known.
+     */
+    pid_t getPid() const;
+
     /**
      * Set used interval for the data stream. If data is received at higher
      * rate samples will be dropped.
@@ -146,6 +173,74 @@ public:
      */
     bool getDownsampling() const;
 
+    /**
+     * Set framing version of the data stream. See #WireFormat.
+     *
+     * @param version negotiated version, 0 for the original stream.
+     */
+    void setWireVersion(int version);
+
+    /**
+     * Get framing version of the data stream.
+     *
+     * @return framing version.
+     */
+    int getWireVersion() const;
+
+    /**
+     * Set how long written data may be held back while deferring. Held
+     * back data is written in one go when the latency expires, when
+     * deferring ends or when more than the queue limit has gathered, so
+     * the client is woken up once per batch instead of once per sample.
+     *
+     * @param latency maximum latency in milliseconds, 0 to write at once.
+     */
+    void setMaxLatency(unsigned int latency);
+
+    /**
+     * Get maximum latency of held back data.
+     *
+     * @return latency in milliseconds.
+     */
+    unsigned int getMaxLatency() const;
+
+    /**
+     * Enable or disable deferring. Only sessions with a maximum latency
+     * are deferred. Disabling writes everything held back.
+     *
+     * @param value should writes be deferred.
+     */
+    void setDeferring(bool value);
+
+    /**
+     * Number of samples given to the session for writing.
+     *
+     * @return received sample count.
+     */
+    unsigned int receivedCount() const;
+
+    /**
+     * Number of samples written to the socket.
+     *
+     * @return sent sample count.
+     */
+    unsigned int sentCount() const;
+
+    /**
+     * Number of samples discarded by downsampling or failed writes.
+     *
+     * @return dropped sample count.
+     */
+    unsigned int droppedCount() const;
+
+    /**
+     * Bytes waiting to be written to the socket, including samples
+     * held in the buffer.
+     *
+     * @return queued byte count.
+     */
+    qint64 queuedBytes() const;
+
 private:
     /**
      * How many milliseconds since last time data was written to socket.
@@ -161,9 +256,47 @@ private:
      * @param source Source from where to write.
      * @param size How many bytes to write.
      * @param count How many data elements are written.
+     * @return false on socket error, drops of a congested client are
+     *         counted and not errors.
      */
     bool write(void* source, int size, unsigned int count);
 
+    /**
+     * Write samples to the socket in the negotiated framing.
+     *
+     * @param layout Layout of the samples or NULL if not known.
+     * @param source First sample.
+     * @param size Size of single sample in bytes.
+     * @param count How many samples to write.
+     * @return was data succesfully written.
+     */
+    bool writeSamples(const WireLayout* layout, const void* source, int size, unsigned int count);
+
+    /**
+     * Check whether the client has fallen too far behind. Samples are
+     * counted as dropped while it has.
+     *
+     * @param count How many samples are about to be written.
+     * @return should the samples be dropped.
+     */
+    bool isCongested(unsigned int count);
+
+    /**
+     * Write encoded data to the socket, or hold it back while deferring.
+     *
+     * @param data Data to write.
+     * @param length How many bytes to write.
+     * @return was data accepted.
+     */
+    bool output(const char* data, qint64 length);
+
+    /**
+     * Write data held back by deferring to the socket.
+     *
+     * @return was writing to socket succesful.
+     */
+    bool flushDeferred();
+
     /**
      * Delayed write invocation.
      *
@@ -181,6 +314,19 @@ private:
     unsigned int bufferSize;     /**< buffer size */
     unsigned int bufferInterval; /**< buffer interval in milliseconds */
     bool downsampling;           /**< sample dropping */
+    pid_t pid;                   /**< client process ID */
+    unsigned int received;       /**< samples given for writing */
+    unsigned int sent;           /**< samples written to socket */
+    unsigned int dropped;        /**< samples discarded */
+    int wireVersion;             /**< framing version of the stream */
+    const WireLayout* layout;    /**< layout of buffered samples */
+    QByteArray encoded;          /**< encoding buffer */
+    qint64 maxQueuedBytes;       /**< limit of data waiting for the client */
+    bool congested;              /**< are samples dropped for a slow client */
+    unsigned int maxLatency;     /**< deferring latency in milliseconds */
+    bool deferring;              /**< are writes held back */
+    QByteArray deferred;         /**< data held back */
+    QTimer latencyTimer;         /**< timer for writing held back data */
 
 private slots:
 
@@ -188,6 +334,16 @@ private slots:
      * Callback for delayed write timer.
      */
     void timerTimeout();
+
+    /**
+     * Callback for deferring latency timer.
+     */
+    void latencyTimeout();
+
+    /**
+     * Callback for reloaded configuration.
+     */
+    void configurationChanged();
 };
 
 /**
@@ -225,8 +381,21 @@ public:
      * @param id Session ID.
      * @param source Location from where to write.
      * @param size How many bytes to write.
+     * @param layout Layout of the sample or NULL if not known.
      */
-    bool write(int id, const void* source, int size);
+    bool write(int id, const void* source, int size, const WireLayout* layout = NULL);
+
+    /**
+     * Write several samples to given session as a single frame. For more
+     * details see #SessionData::writeFrame(const void*, int, unsigned int).
+     *
+     * @param id Session ID.
+     * @param source Location from where to write.
+     * @param size Size of single sample in bytes.
+     * @param count How many samples to write.
+     * @param layout Layout of the samples or NULL if not known.
+     */
+    bool writeFrame(int id, const void* source, int size, unsigned int count, const WireLayout* layout = NULL);
 
     /**
      * Close related socket connection for session.
@@ -244,6 +413,21 @@ public:
      */
     int getSocketFd(int sessionId) const;
 
+    /**
+     * Get process ID of the client owning given session.
+     *
+     * @param sessionId Session ID.
+     * @return client process ID or 0 if not known.
+     */
+    pid_t getSocketPid(int sessionId) const;
+
+    /**
+     * Get number of sessions with established data connection.
+     *
+     * @return session count.
+     */
+    int sessionCount() const;
+
     /**
      * Set interval for given session. For more details see
      * #SessionData::setInterval(int).
@@ -337,6 +521,42 @@ public:
      */
     void setDownsampling(int sessionId, bool value);
 
+    /**
+     * Set maximum latency for given session. For more details see
+     * #SessionData::setMaxLatency(unsigned int).
+     *
+     * @param sessionId Session ID.
+     * @param value latency in milliseconds, 0 to write at once.
+     */
+    void setMaxLatency(int sessionId, unsigned int value);
+
+    /**
+     * Get maximum latency for given session.
+     *
+     * @param sessionId Session ID.
+     * @return latency in milliseconds.
+     */
+    unsigned int maxLatency(int sessionId) const;
+
+    /**
+     * Update display state. While the display is off, data of sessions
+     * with a maximum latency is held back. Turning the display on writes
+     * it to the clients.
+     *
+     * @param on is display on.
+     */
+    void setDisplayOn(bool on);
+
+    /**
+     * Append statistics of given session in #Statistics exposition
+     * format.
+     *
+     * @param output text to append to.
+     * @param node ID of the sensor the session belongs to.
+     * @param sessionId Session ID.
+     */
+    void appendStats(QByteArray& output, const QString& node, int sessionId) const;
+
 Q_SIGNALS:
     /**
      * Signal is emitted for lost sessions which can happen for example
@@ -371,8 +591,20 @@ private slots:
 
 private:
 
-    QLocalServer*            m_server; /**< listening server socket. */
-    QMap<int, SessionData*>  m_idMap;  /**< map of client sessions. */
+    /**
+     * Find sessions of given client process whose data connection has
+     * already been closed by the peer.
+     *
+     * @param pid Client process ID.
+     * @return IDs of closed sessions.
+     */
+    QList<int> closedSessions(pid_t pid) const;
+
+    QLocalServer*             m_server;    /**< listening server socket. */
+    QHash<int, SessionData*>  m_idMap;     /**< client sessions by session ID. */
+    QHash<QLocalSocket*, int> m_socketMap; /**< session IDs by socket. */
+    QMultiHash<pid_t, int>    m_pidMap;    /**< session IDs by client process. */
+    bool                      m_displayOn; /**< is display on. */
 };
 
 #endif // SOCKETHANDLER_H
@@ -39,3 +39,26 @@ bool SourceBase::unjoin(SinkBase* sink)
     unjoinTypeChecked(sink);
     return true;
 }
+
+SourceBase::~SourceBase()
+{
+    qDeleteAll(edges_);
+}
+
+const EdgeStats* SourceBase::edgeStats(SinkBase* sink) const
+{
+    return edges_.value(sink);
+}
+
+EdgeStats* SourceBase::edge(SinkBase* sink)
+{
+    EdgeStats*& stats = edges_[sink];
+    if (!stats)
+        stats = new EdgeStats;
+    return stats;
+}
+
+void SourceBase::dropEdge(SinkBase* sink)
+{
+    delete edges_.take(sink);
+}
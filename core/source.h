@@ -31,8 +31,9 @@
 
 #include "sink.h"
 #include "logging.h"
+#include "statistics.h"
 #include <typeinfo>
-#include <QSet>
+#include <QHash>
 
 class SinkBase;
 
@@ -58,11 +59,60 @@ public:
      */
     bool unjoin(SinkBase* sink);
 
+    /**
+     * Label sample counter of the source.
+     *
+     * @param node ID of the node owning the source.
+     * @param name name of the source within the node.
+     */
+    void setStatsLabels(const QString& node, const QString& name) { samples_.setLabels(node, name); }
+
+    /**
+     * Counters of the connection to given sink. Counters are dropped when
+     * the sink is disconnected. See #EdgeStats::enabled().
+     *
+     * @param sink Sink.
+     * @return counters or NULL if sink is not connected.
+     */
+    const EdgeStats* edgeStats(SinkBase* sink) const;
+
+    /**
+     * Counters of all propagations from the source.
+     *
+     * @return counters.
+     */
+    const EdgeStats& totalStats() const { return total_; }
+
 protected:
+    /**
+     * Constructor.
+     */
+    SourceBase() : samples_("sensorfw_source_samples_total") {}
+
     /**
      * Destructor.
      */
-    virtual ~SourceBase() {}
+    virtual ~SourceBase();
+
+    /**
+     * Get counters of the connection to given sink, created on first
+     * use.
+     *
+     * @param sink Sink.
+     * @return counters.
+     */
+    EdgeStats* edge(SinkBase* sink);
+
+    /**
+     * Drop counters of the connection to given sink.
+     *
+     * @param sink Sink.
+     */
+    void dropEdge(SinkBase* sink);
+
+    StatsCounter                 samples_; /**< propagated samples */
+    EdgeStats                    total_;   /**< all propagations */
+    QHash<SinkBase*, EdgeStats*> edges_;   /**< counters of connected sinks */
 
 private:
     /**
@@ -99,9 +149,29 @@ public:
      */
     void propagate(int n, const TYPE* values)
     {
-        foreach (SinkTyped<TYPE>* sink, sinks_) {
-            sink->collect(n, values);
+        samples_.add(n);
+
+        // Copy so that sinks may disconnect while collecting.
+        const QHash<SinkTyped<TYPE>*, EdgeStats*> sinks = sinks_;
+        typename QHash<SinkTyped<TYPE>*, EdgeStats*>::const_iterator it;
+        if (!EdgeStats::enabled()) {
+            for (it = sinks.constBegin(); it != sinks.constEnd(); ++it)
+                it.key()->collect(n, values);
+            return;
+        }
+
+        qint64 start = EdgeStats::now();
+        qint64 previous = start;
+        for (it = sinks.constBegin(); it != sinks.constEnd(); ++it) {
+            it.key()->collect(n, values);
+            qint64 now = EdgeStats::now();
+            // Counters of a sink disconnected while collecting are gone.
+            EdgeStats* stats = sinks_.value(it.key());
+            if (stats)
+                stats->record(n, now - previous);
+            previous = now;
         }
+        total_.record(n, previous - start);
     }
 private:
     bool joinTypeChecked(SinkBase* sink)
@@ -109,7 +179,7 @@ private:
         SinkTyped<TYPE>* type = dynamic_cast<SinkTyped<TYPE>*>(sink);
         if(type)
         {
-            sinks_.insert(type);
+            sinks_.insert(type, edge(sink));
             return true;
         }
         sensordLogC() << "Failed to join type '" << typeid(type).name() << " to source!";
@@ -122,13 +192,14 @@ private:
         if(type)
         {
             sinks_.remove(type);
+            dropEdge(sink);
             return true;
         }
         sensordLogC() << "Failed to unjoin type '" << typeid(type).name() << " from source!";
         return false;
     }
 
-    QSet<SinkTyped<TYPE>*> sinks_; /**< connected sinks. */
+    QHash<SinkTyped<TYPE>*, EdgeStats*> sinks_; /**< connected sinks and their counters. */
 };
 
 #endif
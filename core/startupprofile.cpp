@@ -0,0 +1,118 @@
+/**
+   @file startupprofile.cpp
+   @brief Timing of daemon startup
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "startupprofile.h"
+#include "logging.h"
+
+#include <QElapsedTimer>
+#include <QList>
+
+#include <algorithm>
+
+/**
+ * Phase or span of startup.
+ */
+struct StartupEntry
+{
+    QString what;     /**< phase name or description of the span */
+    qint64  begin;    /**< start time, ms */
+    qint64  duration; /**< duration, ms */
+    bool    phase;    /**< is a phase rather than a span within one */
+};
+
+/**
+ * Order entries by start time, a phase before the spans within it.
+ */
+static bool startsBefore(const StartupEntry& a, const StartupEntry& b)
+{
+    if (a.begin != b.begin)
+        return a.begin < b.begin;
+    return a.phase && !b.phase;
+}
+
+static QElapsedTimer clock_;
+static QList<StartupEntry> entries_;
+static qint64 lastMark_ = 0;
+static qint64 readyAt_ = -1;
+
+void StartupProfile::start()
+{
+    clock_.start();
+    entries_.clear();
+    lastMark_ = 0;
+    readyAt_ = -1;
+}
+
+qint64 StartupProfile::elapsed()
+{
+    return clock_.isValid() ? clock_.elapsed() : 0;
+}
+
+void StartupProfile::mark(const QString& phase)
+{
+    qint64 now = elapsed();
+    StartupEntry entry = { phase, lastMark_, now - lastMark_, true };
+    entries_.append(entry);
+    lastMark_ = now;
+    sensordLogT() << "Startup phase" << phase << "took" << entry.duration << "ms";
+}
+
+void StartupProfile::record(const QString& what, qint64 begin)
+{
+    StartupEntry entry = { what, begin, elapsed() - begin, false };
+    entries_.append(entry);
+    sensordLogT() << what << "took" << entry.duration << "ms";
+}
+
+void StartupProfile::ready()
+{
+    readyAt_ = elapsed();
+
+    QStringList output;
+    printStatus(output);
+    foreach (const QString& line, output)
+        sensordLogD() << line.toLocal8Bit().data();
+}
+
+bool StartupProfile::isReady()
+{
+    return readyAt_ >= 0;
+}
+
+void StartupProfile::printStatus(QStringList& output)
+{
+    if (!isReady())
+        return;
+
+    QList<StartupEntry> entries(entries_);
+    std::stable_sort(entries.begin(), entries.end(), startsBefore);
+
+    output.append(QString("  Startup: ready in %1 ms").arg(readyAt_));
+    foreach (const StartupEntry& entry, entries) {
+        if (entry.phase) {
+            output.append(QString("    %1: %2 ms").arg(entry.what).arg(entry.duration));
+        } else {
+            output.append(QString("      %1: %2 ms at %3 ms%4")
+                          .arg(entry.what).arg(entry.duration).arg(entry.begin)
+                          .arg(entry.begin >= readyAt_ ? " (after ready)" : ""));
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/**
+   @file startupprofile.h
+   @brief Timing of daemon startup
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * Wall time of startup phases. Phases are marked in order as they end,
+ * and parts of them, like loading a single plugin, are recorded as
+ * spans within them. The profile is logged once the daemon is ready
+ * and included in the status dump.
+ *
+ * Spans recorded after the daemon is ready, e.g. plugins loaded on the
+ * first request for a sensor, are kept too and listed after ready.
+ *
+ * Only to be used from the main thread.
+ */
+class StartupProfile
+{
+public:
+    /**
+     * Start timing. Called as early in main() as possible.
+     */
+    static void start();
+
+    /**
+     * Time since #start().
+     *
+     * @return elapsed time, ms.
+     */
+    static qint64 elapsed();
+
+    /**
+     * Mark the end of a phase which started at the previous mark.
+     *
+     * @param phase phase name.
+     */
+    static void mark(const QString& phase);
+
+    /**
+     * Record a span of work within a phase.
+     *
+     * @param what description of the work.
+     * @param begin #elapsed() when the work started, ms.
+     */
+    static void record(const QString& what, qint64 begin);
+
+    /**
+     * Mark the daemon ready and log the profile.
+     */
+    static void ready();
+
+    /**
+     * Has the daemon become ready.
+     */
+    static bool isReady();
+
+    /**
+     * Append the profile to status output.
+     *
+     * @param output list to append lines to.
+     */
+    static void printStatus(QStringList& output);
+};
+
+#endif // STARTUPPROFILE_H
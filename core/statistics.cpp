@@ -0,0 +1,105 @@
+/**
+   @file statistics.cpp
+   @brief Throughput and drop counters of dataflow nodes
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "statistics.h"
+
+#include <QMutexLocker>
+
+StatsCounter::StatsCounter(const char* metric) :
+    metric_(metric),
+    value_(0),
+    registered_(false)
+{
+}
+
+StatsCounter::~StatsCounter()
+{
+    if (registered_)
+        Statistics::instance().remove(this);
+}
+
+void StatsCounter::setLabels(const QString& node, const QString& name)
+{
+    Statistics& statistics = Statistics::instance();
+    QMutexLocker locker(&statistics.mutex_);
+    node_ = node;
+    name_ = name;
+    if (!registered_) {
+        statistics.counters_.append(this);
+        registered_ = true;
+    }
+}
+
+QBasicAtomicInt EdgeStats::enabled_ = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+void EdgeStats::setEnabled(bool enabled)
+{
+    enabled_.store(enabled);
+}
+
+Statistics* Statistics::instance_ = NULL;
+
+Statistics& Statistics::instance()
+{
+    // Not destroyed at exit, nodes may outlive static objects.
+    if (!instance_)
+        instance_ = new Statistics;
+    return *instance_;
+}
+
+void Statistics::remove(StatsCounter* counter)
+{
+    QMutexLocker locker(&mutex_);
+    counters_.removeOne(counter);
+}
+
+/**
+ * Escape label value for the exposition format.
+ */
+static QByteArray escapeLabel(const QString& value)
+{
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\");
+    escaped.replace('"', "\\\"");
+    escaped.replace('\n', "\\n");
+    return escaped;
+}
+
+void Statistics::appendLine(QByteArray& output, const char* metric,
+                            const QString& node, const QString& name, qint64 value)
+{
+    output += metric;
+    output += "{node=\"";
+    output += escapeLabel(node);
+    output += "\",name=\"";
+    output += escapeLabel(name);
+    output += "\"} ";
+    output += QByteArray::number(value);
+    output += '\n';
+}
+
+void Statistics::appendCounters(QByteArray& output) const
+{
+    QMutexLocker locker(&mutex_);
+    foreach (const StatsCounter* counter, counters_) {
+        appendLine(output, counter->metric_, counter->node_, counter->name_, counter->value());
+    }
+}
@@ -0,0 +1,220 @@
+/**
+   @file statistics.h
+   @brief Throughput and drop counters of dataflow nodes
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <QString>
+#include <QByteArray>
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+
+#include <time.h>
+
+/**
+ * Event counter which can be incremented from any thread. Counters are
+ * 32 bits wide and wrap around, readers compute rates from the
+ * difference of two readings. A counter is listed in #Statistics once
+ * it has been labeled.
+ */
+class StatsCounter
+{
+public:
+    /**
+     * Constructor.
+     *
+     * @param metric metric name, must be a string literal.
+     */
+    explicit StatsCounter(const char* metric);
+
+    /**
+     * Destructor. Removes the counter from #Statistics.
+     */
+    ~StatsCounter();
+
+    /**
+     * Set labels of the counter and list it in #Statistics.
+     *
+     * @param node ID of the node owning the counter.
+     * @param name name of the counted object within the node.
+     */
+    void setLabels(const QString& node, const QString& name);
+
+    /**
+     * Increment counter.
+     *
+     * @param n amount to add.
+     */
+    inline void add(unsigned int n = 1) { value_.fetchAndAddRelaxed(n); }
+
+    /**
+     * Current value.
+     *
+     * @return counter value.
+     */
+    inline unsigned int value() const { return value_.load(); }
+
+private:
+    Q_DISABLE_COPY(StatsCounter)
+    friend class Statistics;
+
+    const char* metric_;     /**< metric name */
+    QString     node_;       /**< node label */
+    QString     name_;       /**< name label */
+    QAtomicInt  value_;      /**< counter value */
+    bool        registered_; /**< is counter listed */
+};
+
+/**
+ * Counters of one dataflow connection: how many times samples were
+ * pushed through it, how many samples and how long the receiving side
+ * took including everything it propagated further. Updated only by the
+ * thread propagating through the connection, read from any thread.
+ * Counting costs a clock read per connection, so it is done only while
+ * #enabled().
+ */
+class EdgeStats
+{
+public:
+    /**
+     * Constructor.
+     */
+    EdgeStats() : calls_(0), samples_(0), timeUs_(0), remainderNs_(0) {}
+
+    /**
+     * Are connections counted.
+     *
+     * @return is counting enabled.
+     */
+    static inline bool enabled() { return enabled_.load(); }
+
+    /**
+     * Enable or disable counting for all connections.
+     *
+     * @param enabled should connections be counted.
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * Monotonic clock for timing callbacks.
+     *
+     * @return time in nanoseconds.
+     */
+    static inline qint64 now()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (qint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    }
+
+    /**
+     * Account one push through the connection.
+     *
+     * @param samples number of samples pushed.
+     * @param ns time spent in the receiving side.
+     */
+    inline void record(unsigned int samples, qint64 ns)
+    {
+        calls_.fetchAndAddRelaxed(1);
+        samples_.fetchAndAddRelaxed(samples);
+        ns += remainderNs_;
+        timeUs_.fetchAndAddRelaxed(ns / 1000);
+        remainderNs_ = ns % 1000;
+    }
+
+    /**
+     * @return number of pushes, wraps around.
+     */
+    inline unsigned int calls() const { return calls_.load(); }
+
+    /**
+     * @return number of samples, wraps around.
+     */
+    inline unsigned int samples() const { return samples_.load(); }
+
+    /**
+     * @return time spent in the receiving side in microseconds, wraps around.
+     */
+    inline unsigned int timeUs() const { return timeUs_.load(); }
+
+private:
+    Q_DISABLE_COPY(EdgeStats)
+
+    QAtomicInt calls_;       /**< pushes */
+    QAtomicInt samples_;     /**< samples */
+    QAtomicInt timeUs_;      /**< receiving side time */
+    qint64     remainderNs_; /**< time not yet added to timeUs_, writer only */
+
+    static QBasicAtomicInt enabled_; /**< are connections counted */
+};
+
+/**
+ * Registry of labeled counters. Counters are exported in a line based
+ * text format:
+ *
+ * <pre>
+ * sensorfw_source_samples_total{node="accelerometerchain",name="accelerometeradaptor/accelerometer"} 1234
+ * </pre>
+ */
+class Statistics
+{
+public:
+    /**
+     * Get singleton instance.
+     *
+     * @return statistics instance.
+     */
+    static Statistics& instance();
+
+    /**
+     * Append one exposition line.
+     *
+     * @param output text to append to.
+     * @param metric metric name.
+     * @param node node label.
+     * @param name name label.
+     * @param value metric value.
+     */
+    static void appendLine(QByteArray& output, const char* metric,
+                           const QString& node, const QString& name, qint64 value);
+
+    /**
+     * Append all listed counters.
+     *
+     * @param output text to append to.
+     */
+    void appendCounters(QByteArray& output) const;
+
+private:
+    friend class StatsCounter;
+
+    Statistics() {}
+
+    void remove(StatsCounter* counter);
+
+    static Statistics* instance_;
+
+    mutable QMutex       mutex_;    /**< protects counters_ and labels */
+    QList<StatsCounter*> counters_; /**< listed counters */
+};
+
+#endif // STATISTICS_H
@@ -33,6 +33,7 @@
 #include <fcntl.h>
 #include <sys/epoll.h>
 #include <unistd.h>
+#include <time.h>
 #include <QFile>
 #include "logging.h"
 #include "config.h"
@@ -67,7 +68,7 @@ SysfsAdaptor::~SysfsAdaptor()
 
 bool SysfsAdaptor::addPath(const QString& path, const int id)
 {
-    qDebug() << Q_FUNC_INFO << path;
+    sensordLogT() << Q_FUNC_INFO << path;
 
     if (!QFile::exists(path)) {
         return false;
@@ -215,6 +216,72 @@ bool SysfsAdaptor::resume()
     return true;
 }
 
+bool SysfsAdaptor::rebind()
+{
+    QStringList paths;
+    QList<int> ids;
+    bool found = findPaths(paths, ids);
+
+    if (paths != paths_ || ids != pathIds_ || !descriptorsCurrent()) {
+        bool open = running_ && !inStandbyMode_;
+        sensordLogD() << "Adaptor '" << id() << "' rebinding to" << paths;
+
+        if (open) {
+            stopReaderThread();
+            closeAllFds();
+        }
+
+        paths_ = paths;
+        pathIds_ = ids;
+
+        if (open) {
+            // Sessions stay open, keep reading even without device so
+            // that it is picked up again on next rebind.
+            if (!startReaderThread()) {
+                sensordLogW() << "Adaptor '" << id() << "' failed to reopen device";
+            } else {
+                unsigned int value = interval();
+                if (value)
+                    setInterval(value, 0);
+            }
+        }
+    }
+
+    if (found != isValid()) {
+        sensordLogD() << "Adaptor '" << id() << "' device" << (found ? "appeared" : "disappeared");
+        setValid(found);
+    }
+    return found;
+}
+
+bool SysfsAdaptor::findPaths(QStringList& paths, QList<int>& ids)
+{
+    paths = paths_;
+    ids = pathIds_;
+    return isValid();
+}
+
+bool SysfsAdaptor::descriptorsCurrent()
+{
+    QMutexLocker locker(&mutex_);
+
+    if (!running_ || inStandbyMode_)
+        return true;
+    if (sysfsDescriptors_.size() != paths_.size())
+        return false;
+
+    for (int i = 0; i < sysfsDescriptors_.size(); ++i) {
+        struct stat opened;
+        struct stat current;
+        if (fstat(sysfsDescriptors_.at(i), &opened) == -1 ||
+            stat(paths_.at(i).toLatin1().constData(), &current) == -1 ||
+            opened.st_dev != current.st_dev || opened.st_ino != current.st_ino) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool SysfsAdaptor::openFds()
 {
     QMutexLocker locker(&mutex_);
@@ -226,6 +293,10 @@ bool SysfsAdaptor::openFds()
             return false;
         }
         sysfsDescriptors_.append(fd);
+        if (!configureDescriptor(pathIds_.at(i), fd)) {
+            sensordLogW() << "Failed to configure " << paths_.at(i);
+            return false;
+        }
     }
 
     // Set up epoll for select mode
@@ -271,6 +342,13 @@ bool SysfsAdaptor::openFds()
     return true;
 }
 
+bool SysfsAdaptor::configureDescriptor(int pathId, int fd)
+{
+    Q_UNUSED(pathId);
+    Q_UNUSED(fd);
+    return true;
+}
+
 void SysfsAdaptor::closeAllFds()
 {
     QMutexLocker locker(&mutex_);
@@ -398,8 +476,35 @@ SysfsAdaptor::PollMode SysfsAdaptor::mode() const
     return mode_;
 }
 
-SysfsAdaptorReader::SysfsAdaptorReader(SysfsAdaptor *parent) : running_(false), parent_(parent)
+SysfsAdaptorReader::SysfsAdaptorReader(SysfsAdaptor *parent) :
+    running_(false),
+    parent_(parent),
+    reads_("sensorfw_reader_samples_total"),
+    cpuTime_("sensorfw_reader_cpu_us_total"),
+    cpuBase_(0)
+{
+    reads_.setLabels(parent->id(), "reader");
+    cpuTime_.setLabels(parent->id(), "reader");
+}
+
+/**
+ * CPU time used by the calling thread.
+ *
+ * @return CPU time in microseconds.
+ */
+static qint64 threadCpuTime()
 {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return 0;
+    return (qint64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void SysfsAdaptorReader::accountCpuTime()
+{
+    qint64 now = threadCpuTime();
+    cpuTime_.add(now - cpuBase_);
+    cpuBase_ = now;
 }
 
 void SysfsAdaptorReader::stopReader()
@@ -415,6 +520,10 @@ void SysfsAdaptorReader::startReader()
 
 void SysfsAdaptorReader::run()
 {
+    // Samples are propagated through the chains in this thread, so its
+    // CPU time covers the whole pipeline fed by the adaptor.
+    cpuBase_ = threadCpuTime();
+
     while (running_) {
 
         if (parent_->mode_ == SysfsAdaptor::SelectMode) {
@@ -438,6 +547,7 @@ void SysfsAdaptorReader::run()
                     int index = parent_->sysfsDescriptors_.lastIndexOf(events[i].data.fd);
                     if (index != -1) {
                         parent_->processSample(parent_->pathIds_.at(index), events[i].data.fd);
+                        reads_.add();
 
                         if (parent_->doSeek_)
                         {
@@ -459,6 +569,7 @@ void SysfsAdaptorReader::run()
             // Read through all fds.
             for (int i = 0; i < parent_->sysfsDescriptors_.size(); ++i) {
                 parent_->processSample(parent_->pathIds_.at(i), parent_->sysfsDescriptors_.at(i));
+                reads_.add();
 
                 if (parent_->doSeek_)
                 {
@@ -473,6 +584,8 @@ void SysfsAdaptorReader::run()
             // Sleep for interval
             QThread::msleep(parent_->interval());
         }
+
+        accountCpuTime();
     }
 }
 
@@ -31,6 +31,7 @@
 
 #include "deviceadaptor.h"
 #include "deviceadaptorringbuffer.h"
+#include "statistics.h"
 #include <QString>
 #include <QStringList>
 #include <QThread>
@@ -73,8 +74,17 @@ public:
     void startReader();
 
 private:
+    /**
+     * Add CPU time used by the thread since the previous call to the
+     * CPU time counter.
+     */
+    void accountCpuTime();
+
     bool          running_; /**< should thread be running or not */
     SysfsAdaptor *parent_;  /**< parent object. */
+    StatsCounter  reads_;   /**< processed samples */
+    StatsCounter  cpuTime_; /**< thread CPU time in microseconds */
+    qint64        cpuBase_; /**< thread CPU time at previous accounting */
 };
 
 /**
@@ -150,6 +160,23 @@ public:
 
     virtual bool resume();
 
+    /**
+     * Look up device paths again with #findPaths. If the paths have
+     * changed or open descriptors refer to a removed device, the reader
+     * thread of a running adaptor is restarted on the new paths and the
+     * current interval is applied again.
+     *
+     * @return is device available.
+     */
+    virtual bool rebind();
+
+    /**
+     * Tells which mode the adaptor is using for getting input.
+     * Mode is usually set in constructor or via configuration file.
+     * @return SysfsAdaptor::PollMode matching the used mode.
+     */
+    PollMode mode() const;
+
 protected:
     /**
      * Called when new data is available on some file descriptor.
@@ -163,6 +190,28 @@ protected:
      */
     virtual void processSample(int pathId, int fd) = 0;
 
+    /**
+     * Called for every file descriptor right after it has been opened
+     * and before the reader thread starts. Default implementation does
+     * nothing.
+     *
+     * @param pathId Path ID for the opened file.
+     * @param fd     Opened file descriptor.
+     * @return \c false if the descriptor can not be used.
+     */
+    virtual bool configureDescriptor(int pathId, int fd);
+
+    /**
+     * Find current device paths of the adaptor. Called by #rebind while
+     * the reader thread may be running, so must not modify the paths
+     * in use. Default implementation returns the current paths.
+     *
+     * @param paths  Device paths, filled in.
+     * @param ids    Path IDs for the paths, filled in.
+     * @return is device available.
+     */
+    virtual bool findPaths(QStringList& paths, QList<int>& ids);
+
     /**
      * Utility function for writing to files. Can be used to control
      * sensor driver parameters (setting to powersave mode etc.)
@@ -206,13 +255,6 @@ protected:
      */
     virtual bool setInterval(const unsigned int value, const int sessionId);
 
-    /**
-     * Tells which mode the adaptor is using for getting input.
-     * Mode is usually set in constructor or via configuration file.
-     * @return SysfsAdaptor::PollMode matching the used mode.
-     */
-    PollMode mode() const;
-
 private:
     /**
      * Opens all file descriptors required by the adaptor.
@@ -240,6 +282,15 @@ private:
      */
     bool startReaderThread();
 
+    /**
+     * Check that open descriptors still refer to the files at the
+     * current paths.
+     *
+     * @return \c false if a descriptor is missing or its file has been
+     *         removed or replaced.
+     */
+    bool descriptorsCurrent();
+
     /**
      * Sanity check for inteval usage.
      */
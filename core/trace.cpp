@@ -0,0 +1,285 @@
+/**
+   @file trace.cpp
+   @brief Binary trace buffer
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "trace.h"
+#include "logging.h"
+#include "datatypes/utils.h"
+
+#include <QFile>
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <string.h>
+#include <algorithm>
+
+/**
+ * Trace record. #sequence is odd while the record is being written.
+ */
+struct TraceRecord
+{
+    QBasicAtomicInt  sequence;
+    quint64          timestamp;
+    const char*      format;
+    int              argc;
+    TraceArg::Type   types[Trace::MAX_ARGS];
+    TraceArg::Value  values[Trace::MAX_ARGS];
+};
+
+/**
+ * Record copied out of a ring for dumping.
+ */
+struct TraceEntry
+{
+    quint64         timestamp;
+    int             tid;
+    const char*     format;
+    int             argc;
+    TraceArg::Type  types[Trace::MAX_ARGS];
+    TraceArg::Value values[Trace::MAX_ARGS];
+
+    bool operator<(const TraceEntry& other) const { return timestamp < other.timestamp; }
+};
+
+/**
+ * Records of one thread.
+ */
+struct TraceRing
+{
+    TraceRing(int size) :
+        records(new TraceRecord[size]()),
+        capacity(size),
+        head(0),
+        tid(syscall(SYS_gettid))
+    {
+    }
+
+    TraceRecord* records;  /**< record slots */
+    int          capacity; /**< number of slots */
+    unsigned int head;     /**< next slot, used only by the owning thread */
+    int          tid;      /**< owning thread */
+};
+
+QBasicAtomicInt Trace::enabled_ = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+static QBasicAtomicInt traceCapacity = Q_BASIC_ATOMIC_INITIALIZER(0);
+static __thread TraceRing* currentRing = 0;
+
+static QMutex& ringsMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+static QList<TraceRing*>& rings()
+{
+    static QList<TraceRing*> list;
+    return list;
+}
+
+void Trace::setCapacity(int capacity)
+{
+    traceCapacity.store(qMax(capacity, 0));
+    enabled_.store(capacity > 0);
+}
+
+void Trace::record(const char* format)
+{
+    record(format, 0, NULL);
+}
+
+void Trace::record(const char* format, TraceArg a1)
+{
+    record(format, 1, &a1);
+}
+
+void Trace::record(const char* format, TraceArg a1, TraceArg a2)
+{
+    TraceArg args[] = { a1, a2 };
+    record(format, 2, args);
+}
+
+void Trace::record(const char* format, TraceArg a1, TraceArg a2, TraceArg a3)
+{
+    TraceArg args[] = { a1, a2, a3 };
+    record(format, 3, args);
+}
+
+void Trace::record(const char* format, TraceArg a1, TraceArg a2, TraceArg a3, TraceArg a4)
+{
+    TraceArg args[] = { a1, a2, a3, a4 };
+    record(format, 4, args);
+}
+
+void Trace::record(const char* format, TraceArg a1, TraceArg a2, TraceArg a3, TraceArg a4,
+                   TraceArg a5)
+{
+    TraceArg args[] = { a1, a2, a3, a4, a5 };
+    record(format, 5, args);
+}
+
+void Trace::record(const char* format, TraceArg a1, TraceArg a2, TraceArg a3, TraceArg a4,
+                   TraceArg a5, TraceArg a6)
+{
+    TraceArg args[] = { a1, a2, a3, a4, a5, a6 };
+    record(format, 6, args);
+}
+
+void Trace::record(const char* format, int argc, const TraceArg* args)
+{
+    TraceRing* ring = currentRing;
+    if (!ring) {
+        int capacity = traceCapacity.load();
+        if (!capacity)
+            return;
+        ring = new TraceRing(capacity);
+        QMutexLocker locker(&ringsMutex());
+        rings().append(ring);
+        currentRing = ring;
+    }
+
+    TraceRecord& record = ring->records[ring->head++ % ring->capacity];
+    record.sequence.fetchAndAddAcquire(1);
+    record.timestamp = Utils::getTimeStamp();
+    record.format = format;
+    record.argc = argc;
+    for (int i = 0; i < argc; ++i) {
+        record.types[i] = args[i].type_;
+        record.values[i] = args[i].value_;
+    }
+    record.sequence.fetchAndAddRelease(1);
+}
+
+/**
+ * Format one printf conversion with a recorded argument. Length
+ * modifiers of the conversion are replaced to match the stored type.
+ */
+static QString formatArg(QByteArray spec, char conversion, const TraceArg::Type type, const TraceArg::Value& value)
+{
+    switch (conversion) {
+    case 'd':
+    case 'i':
+        spec += "ll";
+        spec += conversion;
+        return QString::asprintf(spec.constData(),
+                                 type == TraceArg::Double ? (long long)value.d : (long long)value.i);
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        spec += "ll";
+        spec += conversion;
+        return QString::asprintf(spec.constData(),
+                                 type == TraceArg::Double ? (unsigned long long)value.d : (unsigned long long)value.u);
+    case 'c':
+        spec += conversion;
+        return QString::asprintf(spec.constData(), (int)value.i);
+    case 's':
+        spec += conversion;
+        return QString::asprintf(spec.constData(), type == TraceArg::String && value.s ? value.s : "(null)");
+    case 'p':
+        spec += conversion;
+        return QString::asprintf(spec.constData(), (const void*)value.s);
+    default:
+        spec += conversion;
+        return QString::asprintf(spec.constData(),
+                                 type == TraceArg::Double ? value.d :
+                                 type == TraceArg::Signed ? (double)value.i : (double)value.u);
+    }
+}
+
+static QString formatEntry(const TraceEntry& entry)
+{
+    QString text;
+    int arg = 0;
+    for (const char* c = entry.format; *c; ++c) {
+        if (*c != '%') {
+            text += QLatin1Char(*c);
+            continue;
+        }
+        if (c[1] == '%') {
+            text += QLatin1Char('%');
+            ++c;
+            continue;
+        }
+
+        QByteArray spec("%");
+        const char* p = c + 1;
+        while (*p && strchr("-+ #0123456789.", *p))
+            spec += *p++;
+        while (*p && strchr("hlLqjzt", *p))
+            ++p;
+        if (!*p || arg >= entry.argc) {
+            text += QString::fromLatin1(c, p - c + (*p ? 1 : 0));
+        } else {
+            text += formatArg(spec, *p, entry.types[arg], entry.values[arg]);
+            ++arg;
+        }
+        if (!*p)
+            break;
+        c = p;
+    }
+    return text;
+}
+
+int Trace::dump(const QString& path)
+{
+    QVector<TraceEntry> entries;
+    {
+        QMutexLocker locker(&ringsMutex());
+        foreach (TraceRing* ring, rings()) {
+            for (int i = 0; i < ring->capacity; ++i) {
+                TraceRecord& record = ring->records[i];
+                int sequence = record.sequence.loadAcquire();
+                if (!sequence || (sequence & 1))
+                    continue;
+
+                TraceEntry entry;
+                entry.timestamp = record.timestamp;
+                entry.tid = ring->tid;
+                entry.format = record.format;
+                entry.argc = qBound(0, record.argc, (int)MAX_ARGS);
+                memcpy(entry.types, record.types, sizeof(entry.types));
+                memcpy(entry.values, record.values, sizeof(entry.values));
+
+                // Skip records overwritten while copying.
+                if (record.sequence.fetchAndAddOrdered(0) != sequence)
+                    continue;
+                entries.append(entry);
+            }
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        sensordLogW() << "Failed to open trace file" << path << ":" << file.errorString();
+        return -1;
+    }
+    foreach (const TraceEntry& entry, entries) {
+        QString line = QString("%1 [%2] %3\n").arg(entry.timestamp).arg(entry.tid).arg(formatEntry(entry));
+        file.write(line.toUtf8());
+    }
+    return entries.size();
+}
@@ -0,0 +1,126 @@
+/**
+   @file trace.h
+   @brief Binary trace buffer
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QAtomicInt>
+
+/**
+ * Record a trace event. Format must be a string literal with printf
+ * style conversions, it is stored as a pointer and only formatted when
+ * the trace is dumped. Arguments are numbers or pointers to static
+ * strings, at most #Trace::MAX_ARGS of them. Arguments are not evaluated
+ * when tracing is disabled.
+ */
+#define sensordTrace(FORMAT_, ARGS_...) \
+    do { if (Trace::enabled()) Trace::record("" FORMAT_, ##ARGS_); } while (0)
+
+/**
+ * Argument of a trace record.
+ */
+class TraceArg
+{
+public:
+    enum Type {
+        Signed = 0,
+        Unsigned,
+        Double,
+        String
+    };
+
+    TraceArg(int value) : type_(Signed) { value_.i = value; }
+    TraceArg(long value) : type_(Signed) { value_.i = value; }
+    TraceArg(long long value) : type_(Signed) { value_.i = value; }
+    TraceArg(unsigned int value) : type_(Unsigned) { value_.u = value; }
+    TraceArg(unsigned long value) : type_(Unsigned) { value_.u = value; }
+    TraceArg(unsigned long long value) : type_(Unsigned) { value_.u = value; }
+    TraceArg(bool value) : type_(Unsigned) { value_.u = value; }
+    TraceArg(float value) : type_(Double) { value_.d = value; }
+    TraceArg(double value) : type_(Double) { value_.d = value; }
+    TraceArg(const char* value) : type_(String) { value_.s = value; }
+
+    union Value {
+        qint64      i;
+        quint64     u;
+        double      d;
+        const char* s;
+    };
+
+    Type  type_;  /**< stored type */
+    Value value_; /**< stored value */
+};
+
+/**
+ * Per-thread rings of binary trace records. Each thread writes only to
+ * its own ring without locking, a slot is protected by a sequence number
+ * so a dump taken while threads are running skips records being
+ * overwritten. Rings are allocated on the first record of a thread and
+ * kept after the thread exits so its history remains in dumps.
+ */
+class Trace
+{
+public:
+    /** Maximum number of arguments in a record. */
+    static const int MAX_ARGS = 6;
+
+    /**
+     * Is tracing enabled.
+     *
+     * @return is tracing enabled.
+     */
+    static inline bool enabled() { return enabled_.load(); }
+
+    /**
+     * Enable or disable tracing. Rings created before the capacity is
+     * changed keep their size.
+     *
+     * @param capacity records per thread, 0 disables tracing.
+     */
+    static void setCapacity(int capacity);
+
+    static void record(const char* format);
+    static void record(const char* format, TraceArg a1);
+    static void record(const char* format, TraceArg a1, TraceArg a2);
+    static void record(const char* format, TraceArg a1, TraceArg a2, TraceArg a3);
+    static void record(const char* format, TraceArg a1, TraceArg a2, TraceArg a3, TraceArg a4);
+    static void record(const char* format, TraceArg a1, TraceArg a2, TraceArg a3, TraceArg a4,
+                       TraceArg a5);
+    static void record(const char* format, TraceArg a1, TraceArg a2, TraceArg a3, TraceArg a4,
+                       TraceArg a5, TraceArg a6);
+
+    /**
+     * Format records of all threads in timestamp order and write them
+     * to a file, one record per line.
+     *
+     * @param path file to write.
+     * @return number of records written or -1 on error.
+     */
+    static int dump(const QString& path);
+
+private:
+    static void record(const char* format, int argc, const TraceArg* args);
+
+    static QBasicAtomicInt enabled_; /**< is tracing enabled */
+};
+
+#endif // TRACE_H
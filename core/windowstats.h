@@ -0,0 +1,289 @@
+/**
+   @file windowstats.h
+   @brief Moving statistics over a window of samples
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef WINDOWSTATS_H
+#define WINDOWSTATS_H
+
+#include <QVector>
+#include <string.h>
+
+/**
+ * Sum, mean, variance, minimum and maximum of the latest samples. The
+ * window holds at most #size() samples; adding to a full window drops
+ * the oldest one.
+ *
+ * The sum is compensated (Neumaier) and mean and variance are updated
+ * with Welford's method, so results do not depend on the magnitude of
+ * the sum of squares. Rounding errors of the moving updates are
+ * discarded by recomputing everything from the window once every
+ * #size() updates, which keeps the cost constant per sample and the
+ * error bounded regardless of how long the window runs.
+ *
+ * Sums of integer samples are exact as long as they fit in 53 bits.
+ *
+ * The class does no locking. It is meant to be owned by one filter and
+ * updated from the thread delivering its data.
+ *
+ * @tparam T sample type, convertible to double.
+ */
+template <class T>
+class WindowStats
+{
+public:
+    /**
+     * Constructor.
+     *
+     * @param size number of samples in a full window.
+     */
+    explicit WindowStats(int size = 1) :
+        size_(0)
+    {
+        setSize(size);
+    }
+
+    /**
+     * Change window size. Clears the window.
+     *
+     * @param size number of samples in a full window.
+     */
+    void setSize(int size)
+    {
+        size_ = size > 0 ? size : 1;
+        values_.resize(size_);
+        reset();
+    }
+
+    /**
+     * Remove all samples.
+     */
+    void reset()
+    {
+        count_ = 0;
+        first_ = 0;
+        updates_ = 0;
+        sum_ = 0;
+        compensation_ = 0;
+        mean_ = 0;
+        m2_ = 0;
+    }
+
+    int size() const { return size_; }
+
+    int count() const { return count_; }
+
+    bool isEmpty() const { return count_ == 0; }
+
+    bool isFull() const { return count_ == size_; }
+
+    /**
+     * @return oldest sample, window must not be empty.
+     */
+    const T& oldest() const { return values_[first_]; }
+
+    /**
+     * @return sum of samples in the window.
+     */
+    double sum() const { return sum_ + compensation_; }
+
+    /**
+     * @return mean of samples in the window, 0 if empty.
+     */
+    double mean() const { return mean_; }
+
+    /**
+     * @return sample variance of the window, 0 with less than two samples.
+     */
+    double variance() const { return count_ > 1 ? m2_ / (count_ - 1) : 0; }
+
+    /**
+     * @return variance of the window as population, 0 if empty.
+     */
+    double populationVariance() const { return count_ ? m2_ / count_ : 0; }
+
+    /**
+     * Smallest sample. Scans the window, so call it when needed rather
+     * than per sample.
+     *
+     * @return smallest sample, window must not be empty.
+     */
+    T min() const
+    {
+        T result = oldest();
+        for (int i = 1; i < count_; ++i) {
+            const T& value = at(i);
+            if (value < result)
+                result = value;
+        }
+        return result;
+    }
+
+    /**
+     * Largest sample. Scans the window like #min().
+     *
+     * @return largest sample, window must not be empty.
+     */
+    T max() const
+    {
+        T result = oldest();
+        for (int i = 1; i < count_; ++i) {
+            const T& value = at(i);
+            if (result < value)
+                result = value;
+        }
+        return result;
+    }
+
+    /**
+     * Add a sample, dropping the oldest one if the window is full.
+     *
+     * @param value sample.
+     */
+    inline void add(const T& value)
+    {
+        double x = value;
+        if (count_ < size_) {
+            values_[index(count_)] = value;
+            ++count_;
+            double delta = x - mean_;
+            mean_ += delta / count_;
+            m2_ += delta * (x - mean_);
+            accumulate(x);
+        } else {
+            double old = values_[first_];
+            values_[first_] = value;
+            first_ = first_ + 1 == size_ ? 0 : first_ + 1;
+            double previousMean = mean_;
+            mean_ += (x - old) / count_;
+            m2_ += (x - old) * (x - mean_ + old - previousMean);
+            accumulate(x);
+            accumulate(-old);
+        }
+        settle();
+    }
+
+    /**
+     * Add a batch of samples. A batch at least as large as the window
+     * replaces it and is summed in one pass over contiguous memory
+     * instead of being updated sample by sample.
+     *
+     * @param values samples, oldest first.
+     * @param n number of samples.
+     */
+    void add(const T* values, int n)
+    {
+        if (n < size_) {
+            for (int i = 0; i < n; ++i)
+                add(values[i]);
+            return;
+        }
+        memcpy(values_.data(), values + n - size_, size_ * sizeof(T));
+        count_ = size_;
+        first_ = 0;
+        recompute();
+    }
+
+    /**
+     * Remove the oldest sample, for windows limited by time as well
+     * as by number of samples.
+     */
+    inline void removeOldest()
+    {
+        if (count_ <= 1) {
+            reset();
+            return;
+        }
+        double x = values_[first_];
+        first_ = first_ + 1 == size_ ? 0 : first_ + 1;
+        --count_;
+        double previousMean = mean_;
+        mean_ -= (x - mean_) / count_;
+        m2_ -= (x - previousMean) * (x - mean_);
+        accumulate(-x);
+        settle();
+    }
+
+private:
+    inline int index(int i) const
+    {
+        i += first_;
+        return i < size_ ? i : i - size_;
+    }
+
+    inline const T& at(int i) const { return values_[index(i)]; }
+
+    /**
+     * Neumaier compensated addition to the sum.
+     */
+    inline void accumulate(double x)
+    {
+        double t = sum_ + x;
+        if ((sum_ < 0 ? -sum_ : sum_) >= (x < 0 ? -x : x))
+            compensation_ += (sum_ - t) + x;
+        else
+            compensation_ += (x - t) + sum_;
+        sum_ = t;
+    }
+
+    /**
+     * Bound the error of moving updates.
+     */
+    inline void settle()
+    {
+        if (m2_ < 0)
+            m2_ = 0;
+        if (++updates_ >= size_)
+            recompute();
+    }
+
+    /**
+     * Compute sum, mean and variance from the window in two passes.
+     */
+    void recompute()
+    {
+        updates_ = 0;
+        sum_ = 0;
+        compensation_ = 0;
+        m2_ = 0;
+        if (!count_) {
+            mean_ = 0;
+            return;
+        }
+        for (int i = 0; i < count_; ++i)
+            accumulate(at(i));
+        mean_ = sum() / count_;
+        for (int i = 0; i < count_; ++i) {
+            double delta = at(i) - mean_;
+            m2_ += delta * delta;
+        }
+    }
+
+    QVector<T> values_;       /**< ring buffer of samples */
+    int        size_;         /**< capacity of the window */
+    int        count_;        /**< samples in the window */
+    int        first_;        /**< index of the oldest sample */
+    int        updates_;      /**< moving updates since recompute */
+    double     sum_;          /**< sum of samples */
+    double     compensation_; /**< rounding error of sum_ */
+    double     mean_;         /**< mean of samples */
+    double     m2_;           /**< sum of squared deviations from mean_ */
+};
+
+#endif // WINDOWSTATS_H
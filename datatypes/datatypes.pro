@@ -25,7 +25,8 @@ HEADERS += xyz.h \
     touchdata.h \
     proximity.h \
     lid.h \
-    liddata.h
+    liddata.h \
+    wireformat.h
 
 SOURCES += xyz.cpp \
     orientation.cpp \
@@ -33,7 +34,8 @@ SOURCES += xyz.cpp \
     compass.cpp \
     utils.cpp \
     tap.cpp \
-    lid.cpp
+    lid.cpp \
+    wireformat.cpp
 
 include(../common-install.pri)
 publicheaders.path  = $${publicheaders.path}/datatypes
@@ -168,4 +168,8 @@ public:
     bool withinProximity_; /**< is an object within proximity or not */
 };
 
+Q_DECLARE_METATYPE ( CalibratedMagneticFieldData )
+Q_DECLARE_METATYPE ( CompassData )
+Q_DECLARE_METATYPE ( ProximityData )
+
 #endif // ORIENTATIONDATA_H
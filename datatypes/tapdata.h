@@ -79,4 +79,6 @@ public:
         TimedData(timestamp), direction_(direction), type_(type) {}
 };
 
+Q_DECLARE_METATYPE ( TapData )
+
 #endif // TAPDATA_H
@@ -39,6 +39,7 @@
 #include "tap.h"
 #include "posedata.h"
 #include "proximity.h"
+#include "liddata.h"
 
 void __attribute__ ((constructor)) datatypes_init(void)
 {
@@ -55,6 +56,13 @@ void __attribute__ ((constructor)) datatypes_init(void)
     qRegisterMetaType<TimedUnsigned>();
     qRegisterMetaType<PoseData>();
     qRegisterMetaType<Proximity>();
+    qRegisterMetaType<QVector<TimedXyzData> >();
+    qRegisterMetaType<QVector<CalibratedMagneticFieldData> >();
+    qRegisterMetaType<QVector<CompassData> >();
+    qRegisterMetaType<QVector<TimedUnsigned> >();
+    qRegisterMetaType<QVector<ProximityData> >();
+    qRegisterMetaType<QVector<TapData> >();
+    qRegisterMetaType<QVector<LidData> >();
 }
 
 void __attribute__ ((destructor)) datatypes_fini(void)
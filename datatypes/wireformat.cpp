@@ -0,0 +1,160 @@
+/**
+   @file wireformat.cpp
+   @brief Framed encoding of samples on the data socket
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "wireformat.h"
+
+static inline bool fitsNarrow(qint64 value)
+{
+    return value >= -32768 && value <= 32767;
+}
+
+static inline bool fitsWide(qint64 value)
+{
+    return value >= -2147483647LL - 1 && value <= 2147483647LL;
+}
+
+/**
+ * Append little endian integer.
+ */
+static inline void append(QByteArray& output, quint64 value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        output.append((char)(value >> (8 * i)));
+}
+
+/**
+ * Take little endian integer and advance past it.
+ */
+static inline quint64 take(const char*& data, int bytes)
+{
+    quint64 value = 0;
+    for (int i = 0; i < bytes; ++i)
+        value |= (quint64)(uchar)data[i] << (8 * i);
+    data += bytes;
+    return value;
+}
+
+static inline qint64 takeSigned(const char*& data, bool narrow)
+{
+    if (narrow)
+        return (qint16)take(data, 2);
+    return (qint32)take(data, 4);
+}
+
+static void appendHeader(QByteArray& output, int layout, int flags, unsigned int count,
+                         int sampleSize, quint64 timestamp)
+{
+    append(output, WireFormat::Version, 1);
+    append(output, layout, 1);
+    append(output, flags, 2);
+    append(output, count, 2);
+    append(output, sampleSize, 2);
+    append(output, timestamp, 8);
+}
+
+int WireFormat::sampleSize(int fields, int flags)
+{
+    return ((flags & NarrowTime) ? 2 : 4) + fields * ((flags & NarrowFields) ? 2 : 4);
+}
+
+void WireFormat::encode(const WireLayout* layout, int size, const void* samples,
+                        unsigned int count, QByteArray& output)
+{
+    const char* data = (const char*)samples;
+    if (layout && layout->size != size)
+        layout = NULL;
+
+    while (count) {
+        unsigned int frame = qMin(count, (unsigned int)MaxFrameSamples);
+
+        if (!layout) {
+            appendHeader(output, 0, 0, frame, size, 0);
+            output.append(data, size * frame);
+            data += size * frame;
+            count -= frame;
+            continue;
+        }
+
+        // Pick the narrowest widths the frame fits in. A gap too long
+        // for a 32 bit delta starts a new frame.
+        qint64 values[MaxFields];
+        quint64 base = layout->timestamp(data);
+        quint64 previous = base;
+        int flags = NarrowTime | NarrowFields;
+        unsigned int n;
+        for (n = 0; n < frame; ++n) {
+            const char* sample = data + n * size;
+            qint64 delta = (qint64)(layout->timestamp(sample) - previous);
+            if (!fitsWide(delta))
+                break;
+            if (!fitsNarrow(delta))
+                flags &= ~NarrowTime;
+            previous += delta;
+            layout->get(sample, values);
+            for (int i = 0; i < layout->fields; ++i) {
+                if (!fitsNarrow(values[i]))
+                    flags &= ~NarrowFields;
+            }
+        }
+        frame = n;
+
+        int encodedSize = sampleSize(layout->fields, flags);
+        int timeBytes = (flags & NarrowTime) ? 2 : 4;
+        int fieldBytes = (flags & NarrowFields) ? 2 : 4;
+        output.reserve(output.size() + HeaderSize + frame * encodedSize);
+        appendHeader(output, layout->id, flags, frame, encodedSize, base);
+
+        previous = base;
+        for (n = 0; n < frame; ++n) {
+            const char* sample = data + n * size;
+            quint64 timestamp = layout->timestamp(sample);
+            append(output, timestamp - previous, timeBytes);
+            previous = timestamp;
+            layout->get(sample, values);
+            for (int i = 0; i < layout->fields; ++i)
+                append(output, values[i], fieldBytes);
+        }
+
+        data += size * frame;
+        count -= frame;
+    }
+}
+
+bool WireFormat::parseHeader(const char* data, Header& header)
+{
+    header.version = take(data, 1);
+    header.layout = take(data, 1);
+    header.flags = take(data, 2);
+    header.count = take(data, 2);
+    header.sampleSize = take(data, 2);
+    header.timestamp = take(data, 8);
+    return header.version >= 1 && header.version <= Version &&
+        header.count <= MaxFrameSamples;
+}
+
+const char* WireFormat::decodeSample(const char* data, int fields, int flags,
+                                     qint64& delta, qint64* values)
+{
+    delta = takeSigned(data, flags & NarrowTime);
+    for (int i = 0; i < fields; ++i)
+        values[i] = takeSigned(data, flags & NarrowFields);
+    return data;
+}
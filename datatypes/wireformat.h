@@ -0,0 +1,324 @@
+/**
+   @file wireformat.h
+   @brief Framed encoding of samples on the data socket
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef WIREFORMAT_H
+#define WIREFORMAT_H
+
+#include <QByteArray>
+#include <string.h>
+
+#include <datatypes/genericdata.h>
+#include <datatypes/timedunsigned.h>
+#include <datatypes/orientationdata.h>
+#include <datatypes/posedata.h>
+#include <datatypes/tapdata.h>
+#include <datatypes/liddata.h>
+
+/**
+ * Describes how a sample type is put on the wire. Identifiers name
+ * the wire shape, not the C++ type, so types with the same fields
+ * share one. An identifier must never be reused for different fields.
+ *
+ * Specialisations provide <tt>get()</tt> and <tt>set()</tt> which
+ * convert between the sample and its integer fields. Types without a
+ * specialisation are sent as raw memory.
+ *
+ * @tparam T sample type.
+ */
+template <class T>
+struct WireTraits
+{
+    enum {
+        Id = 0,    /**< raw memory */
+        Fields = 0 /**< number of fields */
+    };
+    static void get(const T&, qint64*) {}
+    static void set(T&, const qint64*) {}
+};
+
+template <>
+struct WireTraits<TimedXyzData>
+{
+    enum { Id = 1, Fields = 3 };
+    static void get(const TimedXyzData& d, qint64* v) { v[0] = d.x_; v[1] = d.y_; v[2] = d.z_; }
+    static void set(TimedXyzData& d, const qint64* v) { d.x_ = v[0]; d.y_ = v[1]; d.z_ = v[2]; }
+};
+
+template <>
+struct WireTraits<CalibratedMagneticFieldData>
+{
+    enum { Id = 2, Fields = 7 };
+    static void get(const CalibratedMagneticFieldData& d, qint64* v)
+    {
+        v[0] = d.x_; v[1] = d.y_; v[2] = d.z_;
+        v[3] = d.rx_; v[4] = d.ry_; v[5] = d.rz_;
+        v[6] = d.level_;
+    }
+    static void set(CalibratedMagneticFieldData& d, const qint64* v)
+    {
+        d.x_ = v[0]; d.y_ = v[1]; d.z_ = v[2];
+        d.rx_ = v[3]; d.ry_ = v[4]; d.rz_ = v[5];
+        d.level_ = v[6];
+    }
+};
+
+template <>
+struct WireTraits<CompassData>
+{
+    enum { Id = 3, Fields = 4 };
+    static void get(const CompassData& d, qint64* v)
+    {
+        v[0] = d.degrees_; v[1] = d.rawDegrees_; v[2] = d.correctedDegrees_; v[3] = d.level_;
+    }
+    static void set(CompassData& d, const qint64* v)
+    {
+        d.degrees_ = v[0]; d.rawDegrees_ = v[1]; d.correctedDegrees_ = v[2]; d.level_ = v[3];
+    }
+};
+
+template <>
+struct WireTraits<TimedUnsigned>
+{
+    enum { Id = 4, Fields = 1 };
+    static void get(const TimedUnsigned& d, qint64* v) { v[0] = d.value_; }
+    static void set(TimedUnsigned& d, const qint64* v) { d.value_ = (unsigned)v[0]; }
+};
+
+/* Orientation is received by clients as TimedUnsigned. */
+template <>
+struct WireTraits<PoseData>
+{
+    enum { Id = 4, Fields = 1 };
+    static void get(const PoseData& d, qint64* v) { v[0] = d.orientation_; }
+    static void set(PoseData& d, const qint64* v) { d.orientation_ = (PoseData::Orientation)v[0]; }
+};
+
+template <>
+struct WireTraits<ProximityData>
+{
+    enum { Id = 5, Fields = 2 };
+    static void get(const ProximityData& d, qint64* v) { v[0] = d.value_; v[1] = d.withinProximity_; }
+    static void set(ProximityData& d, const qint64* v) { d.value_ = (unsigned)v[0]; d.withinProximity_ = v[1] != 0; }
+};
+
+template <>
+struct WireTraits<TapData>
+{
+    enum { Id = 6, Fields = 2 };
+    static void get(const TapData& d, qint64* v) { v[0] = d.direction_; v[1] = d.type_; }
+    static void set(TapData& d, const qint64* v)
+    {
+        d.direction_ = (TapData::Direction)v[0];
+        d.type_ = (TapData::Type)v[1];
+    }
+};
+
+template <>
+struct WireTraits<LidData>
+{
+    enum { Id = 7, Fields = 2 };
+    static void get(const LidData& d, qint64* v) { v[0] = d.type_; v[1] = d.value_; }
+    static void set(LidData& d, const qint64* v) { d.type_ = (LidData::Type)v[0]; d.value_ = (unsigned)v[1]; }
+};
+
+/**
+ * Type erased description of a sample type, used by the daemon which
+ * only sees samples as memory.
+ */
+struct WireLayout
+{
+    int id;     /**< wire shape identifier */
+    int fields; /**< number of fields */
+    int size;   /**< size of the sample in memory */
+    void (*get)(const void* sample, qint64* values); /**< field getter */
+    quint64 (*timestamp)(const void* sample);        /**< timestamp getter */
+};
+
+/**
+ * Versioned framing of the data socket.
+ *
+ * Version 0 is the original stream: native endian sample count
+ * followed by raw sample memory. From version 1 each write is one or
+ * more frames of a little endian header
+ *
+ * <pre>
+ * quint8  version
+ * quint8  layout      wire shape identifier, 0 for raw memory
+ * quint16 flags       NarrowTime, NarrowFields
+ * quint16 count       number of samples
+ * quint16 sampleSize  bytes per encoded sample
+ * quint64 timestamp   timestamp of the first sample
+ * </pre>
+ *
+ * followed by samples of a signed timestamp delta to the previous
+ * sample and the fields of the sample. Deltas and fields are 16 bits
+ * wide if the corresponding flag is set and 32 bits otherwise.
+ *
+ * The version is negotiated when the data socket is opened. The
+ * daemon sends a tag byte of <tt>TagBase + Version</tt> instead of
+ * <tt>'\\n'</tt> and a client supporting it answers with
+ * <tt>HelloMagic</tt> and its own version right after its session ID.
+ * Both sides then use the lower of the two versions.
+ */
+class WireFormat
+{
+public:
+    enum {
+        Version = 1,             /**< highest supported version */
+        TagBase = 0x80,          /**< tag byte advertising a version */
+        HelloMagic = 0x53465746, /**< "SFWF" */
+        HelloSize = 8,           /**< magic and version as quint32 */
+        HeaderSize = 16,         /**< size of a frame header */
+        MaxFrameSamples = 1000,  /**< most samples a client accepts in one frame */
+        MaxFields = 8            /**< most fields of a layout */
+    };
+
+    /**
+     * Frame flags.
+     */
+    enum Flags {
+        NarrowTime = 0x1,  /**< timestamp deltas are 16 bits */
+        NarrowFields = 0x2 /**< fields are 16 bits */
+    };
+
+    /**
+     * Decoded frame header.
+     */
+    struct Header
+    {
+        int version;       /**< framing version */
+        int layout;        /**< wire shape identifier */
+        int flags;         /**< frame flags */
+        int count;         /**< number of samples */
+        int sampleSize;    /**< bytes per encoded sample */
+        quint64 timestamp; /**< timestamp of the first sample */
+    };
+
+    /**
+     * Get layout of a sample type.
+     *
+     * @tparam T sample type.
+     * @return layout, or NULL for types sent as raw memory.
+     */
+    template <class T>
+    static const WireLayout* layout();
+
+    /**
+     * Encode samples into one or more frames.
+     *
+     * @param layout sample layout or NULL to send raw memory.
+     * @param size size of a sample in memory.
+     * @param samples samples to encode.
+     * @param count number of samples.
+     * @param output buffer the frames are appended to.
+     */
+    static void encode(const WireLayout* layout, int size, const void* samples,
+                       unsigned int count, QByteArray& output);
+
+    /**
+     * Parse a frame header.
+     *
+     * @param data HeaderSize bytes.
+     * @param header parsed header.
+     * @return is the header of a supported version.
+     */
+    static bool parseHeader(const char* data, Header& header);
+
+    /**
+     * Decode samples of a frame.
+     *
+     * @tparam T sample type.
+     * @param header frame header.
+     * @param payload <tt>header.count * header.sampleSize</tt> bytes.
+     * @param samples storage for <tt>header.count</tt> samples.
+     * @return false if the frame does not match the layout of @c T.
+     */
+    template <class T>
+    static bool decode(const Header& header, const char* payload, T* samples);
+
+private:
+    /**
+     * Bytes per encoded sample.
+     */
+    static int sampleSize(int fields, int flags);
+
+    /**
+     * Decode one sample.
+     *
+     * @return position of the next sample.
+     */
+    static const char* decodeSample(const char* data, int fields, int flags,
+                                    qint64& delta, qint64* values);
+
+    template <class T>
+    static void get(const void* sample, qint64* values)
+    {
+        WireTraits<T>::get(*(const T*)sample, values);
+    }
+
+    template <class T>
+    static quint64 timestamp(const void* sample)
+    {
+        return ((const T*)sample)->timestamp_;
+    }
+};
+
+template <class T>
+const WireLayout* WireFormat::layout()
+{
+    if (!WireTraits<T>::Id)
+        return NULL;
+    static const WireLayout layout = {
+        WireTraits<T>::Id, WireTraits<T>::Fields, sizeof(T),
+        &WireFormat::get<T>, &WireFormat::timestamp<T>
+    };
+    return &layout;
+}
+
+template <class T>
+bool WireFormat::decode(const Header& header, const char* payload, T* samples)
+{
+    if (header.layout != WireTraits<T>::Id)
+        return false;
+
+    if (!header.layout) {
+        if (header.sampleSize != (int)sizeof(T))
+            return false;
+        memcpy((void*)samples, payload, sizeof(T) * header.count);
+        return true;
+    }
+
+    if (header.sampleSize != sampleSize(WireTraits<T>::Fields, header.flags))
+        return false;
+
+    quint64 timestamp = header.timestamp;
+    qint64 values[MaxFields];
+    for (int i = 0; i < header.count; ++i) {
+        qint64 delta;
+        payload = decodeSample(payload, WireTraits<T>::Fields, header.flags, delta, values);
+        timestamp += delta;
+        samples[i].timestamp_ = timestamp;
+        WireTraits<T>::set(samples[i], values);
+    }
+    return true;
+}
+
+#endif // WIREFORMAT_H
@@ -23,44 +23,31 @@
 #define FILTER_COUNT 10
 
 AvgAccFilter::AvgAccFilter() :
-    Filter<TimedXyzData, AvgAccFilter, TimedXyzData>(this, &AvgAccFilter::interpret),
-    avgAccdata(0,0,0,0),
-    filterFactor(0.54)
+    Filter<TimedXyzData, AvgAccFilter, TimedXyzData>(this, &AvgAccFilter::interpret)
 {
+    stage_.setFixedPoint(FixedPoint::enabled());
 }
 
 void AvgAccFilter::interpret(unsigned, const TimedXyzData *data)
 {
-    avgAccdata.x_ = data->x_ * filterFactor + averageX * (1.0f - filterFactor);
-    avgAccdata.y_ = data->y_ * filterFactor + averageY * (1.0f - filterFactor);
-    avgAccdata.z_ = data->z_ * filterFactor + averageZ * (1.0f - filterFactor);
+    TimedXyzData filteredData;
 
-    TimedXyzData filteredData(data->timestamp_,
-                              avgAccdata.x_,
-                              avgAccdata.y_,
-                              avgAccdata.z_);
+    stage_.apply(*data, filteredData);
 
     source_.propagate(1, &filteredData);
-
-    averageX = avgAccdata.x_;
-    averageY = avgAccdata.y_;
-    averageZ = avgAccdata.z_;
 }
 
 void AvgAccFilter::reset()
 {
-    avgAccdata.x_ = 0;
-    avgAccdata.y_ = 0;
-    avgAccdata.z_ = 0;
+    stage_.reset();
 }
 
 void AvgAccFilter::setFactor(qreal f)
 {
-    filterFactor = f;
+    stage_.setFactor(f);
 }
 
 qreal AvgAccFilter::factor()
 {
-    return filterFactor;
+    return stage_.factor();
 }
-
@@ -25,6 +25,84 @@
 
 #include "orientationdata.h"
 #include "filter.h"
+#include "fixedpoint.h"
+
+/**
+ * Pipeline stage smoothing XYZ data with an exponential moving average.
+ * See #Pipeline.
+ *
+ * With fixed point enabled the factor is applied as Q16. Results
+ * differ from the floating point path by at most one unit.
+ */
+class AvgAccStage
+{
+public:
+    typedef TimedXyzData InputType;  /**< accepted data type */
+    typedef TimedXyzData OutputType; /**< produced data type */
+
+    AvgAccStage() :
+        filterFactor(0.54),
+        fixedFactor(FixedPoint::fromReal(0.54)),
+        fixedPoint(false),
+        averageX(0),
+        averageY(0),
+        averageZ(0)
+    {
+    }
+
+    void reset()
+    {
+        averageX = 0;
+        averageY = 0;
+        averageZ = 0;
+    }
+
+    void setFactor(qreal f)
+    {
+        filterFactor = f;
+        fixedFactor = FixedPoint::fromReal(f);
+    }
+
+    qreal factor() const { return filterFactor; }
+
+    void setFixedPoint(bool enabled) { fixedPoint = enabled; }
+
+    inline bool apply(const TimedXyzData& in, TimedXyzData& out)
+    {
+        out.timestamp_ = in.timestamp_;
+
+        if (fixedPoint) {
+            // Averages hold previous outputs, which are whole numbers.
+            qint32 keep = FixedPoint::One - fixedFactor;
+            out.x_ = FixedPoint::truncate((qint64)in.x_ * fixedFactor + (qint64)averageX * keep);
+            out.y_ = FixedPoint::truncate((qint64)in.y_ * fixedFactor + (qint64)averageY * keep);
+            out.z_ = FixedPoint::truncate((qint64)in.z_ * fixedFactor + (qint64)averageZ * keep);
+
+            averageX = out.x_;
+            averageY = out.y_;
+            averageZ = out.z_;
+            return true;
+        }
+
+        out.x_ = in.x_ * filterFactor + averageX * (1.0f - filterFactor);
+        out.y_ = in.y_ * filterFactor + averageY * (1.0f - filterFactor);
+        out.z_ = in.z_ * filterFactor + averageZ * (1.0f - filterFactor);
+
+        averageX = out.x_;
+        averageY = out.y_;
+        averageZ = out.z_;
+        return true;
+    }
+
+private:
+    qreal filterFactor;
+    qint32 fixedFactor;
+    bool fixedPoint;
+
+    int averageX;
+    int averageY;
+    int averageZ;
+};
 
 class AvgAccFilter : public QObject, public Filter<TimedXyzData, AvgAccFilter, TimedXyzData>
 {
@@ -46,19 +124,7 @@ private:
 
     void interpret(unsigned, const TimedXyzData*);
 
-    typedef QList<TimedXyzData> XyzAvgAccBuffer;
-
-    TimedXyzData avgAccdata;
-    XyzAvgAccBuffer avgBuffer;
-    unsigned int avgBufferSize;
-    qreal filterFactor;
-
-    qreal averageX;
-    qreal averageY;
-    qreal averageZ;
-
-    QList<TimedXyzData> avgAccelBuffer;
-
+    AvgAccStage stage_;
 };
 
 #endif // ROTATIONFILTER_H
@@ -29,17 +29,14 @@
 CoordinateAlignFilter::CoordinateAlignFilter() :
         Filter<TimedXyzData, CoordinateAlignFilter, TimedXyzData>(this, &CoordinateAlignFilter::filter)
 {
+    stage_.setFixedPoint(FixedPoint::enabled());
 }
 
 void CoordinateAlignFilter::filter(unsigned, const TimedXyzData* data)
 {
     TimedXyzData transformed;
 
-    transformed.timestamp_ = data->timestamp_;
-
-    transformed.x_ = matrix_.get(0,0)*data->x_ + matrix_.get(0,1)*data->y_ + matrix_.get(0,2)*data->z_;
-    transformed.y_ = matrix_.get(1,0)*data->x_ + matrix_.get(1,1)*data->y_ + matrix_.get(1,2)*data->z_;
-    transformed.z_ = matrix_.get(2,0)*data->x_ + matrix_.get(2,1)*data->y_ + matrix_.get(2,2)*data->z_;
+    stage_.apply(*data, transformed);
 
     source_.propagate(1, &transformed);
 }
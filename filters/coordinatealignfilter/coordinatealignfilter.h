@@ -29,6 +29,7 @@
 
 #include "datatypes/orientationdata.h"
 #include "filter.h"
+#include "fixedpoint.h"
 
 /**
  * TMatrix holds a transformation matrix.
@@ -64,6 +65,64 @@ public:
 };
 Q_DECLARE_METATYPE(TMatrix);
 
+/**
+ * Pipeline stage rotating XYZ data with a transformation matrix. See
+ * #Pipeline.
+ *
+ * With fixed point enabled the matrix is applied as Q16 coefficients.
+ * Results differ from the floating point path by at most one unit.
+ */
+class CoordinateAlignStage
+{
+public:
+    typedef TimedXyzData InputType;  /**< accepted data type */
+    typedef TimedXyzData OutputType; /**< produced data type */
+
+    CoordinateAlignStage() :
+        fixedPoint_(false)
+    {
+        setMatrix(TMatrix());
+    }
+
+    const TMatrix& matrix() const { return matrix_; }
+
+    void setMatrix(const TMatrix& matrix)
+    {
+        matrix_ = matrix;
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                fixedMatrix_[i][j] = FixedPoint::fromReal(matrix_.data_[i][j]);
+    }
+
+    bool fixedPoint() const { return fixedPoint_; }
+
+    void setFixedPoint(bool enabled) { fixedPoint_ = enabled; }
+
+    inline bool apply(const TimedXyzData& in, TimedXyzData& out)
+    {
+        out.timestamp_ = in.timestamp_;
+
+        if (fixedPoint_) {
+            const qint32 (&f)[3][3] = fixedMatrix_;
+            out.x_ = FixedPoint::truncate((qint64)f[0][0]*in.x_ + (qint64)f[0][1]*in.y_ + (qint64)f[0][2]*in.z_);
+            out.y_ = FixedPoint::truncate((qint64)f[1][0]*in.x_ + (qint64)f[1][1]*in.y_ + (qint64)f[1][2]*in.z_);
+            out.z_ = FixedPoint::truncate((qint64)f[2][0]*in.x_ + (qint64)f[2][1]*in.y_ + (qint64)f[2][2]*in.z_);
+            return true;
+        }
+
+        const double (&m)[3][3] = matrix_.data_;
+        out.x_ = m[0][0]*in.x_ + m[0][1]*in.y_ + m[0][2]*in.z_;
+        out.y_ = m[1][0]*in.x_ + m[1][1]*in.y_ + m[1][2]*in.z_;
+        out.z_ = m[2][0]*in.x_ + m[2][1]*in.y_ + m[2][2]*in.z_;
+        return true;
+    }
+
+private:
+    TMatrix matrix_;
+    qint32  fixedMatrix_[3][3]; /**< matrix_ as Q16 */
+    bool    fixedPoint_;        /**< use fixedMatrix_ */
+};
+
 /**
  * @brief Coordinate alignment filter.
  *
@@ -86,9 +145,9 @@ public:
         return new CoordinateAlignFilter;
     }
 
-    const TMatrix& matrix() const { return matrix_; }
+    const TMatrix& matrix() const { return stage_.matrix(); }
 
-    void setMatrix(const TMatrix& matrix) { matrix_ = matrix; }
+    void setMatrix(const TMatrix& matrix) { stage_.setMatrix(matrix); }
 
 protected:
     /**
@@ -99,7 +158,7 @@ protected:
 private:
     void filter(unsigned, const TimedXyzData*);
 
-    TMatrix matrix_;
+    CoordinateAlignStage stage_; /**< alignment implementation */
 };
 
 #endif // COORDINATEALIGNFILTER_H
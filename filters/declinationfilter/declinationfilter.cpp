@@ -25,34 +25,38 @@
  */
 
 #include <QSettings>
-#include <QSettings>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
 
 #include "declinationfilter.h"
-#include "config.h"
 #include "logging.h"
 
 const char* DeclinationFilter::declinationKey = "/system/osso/location/settings/magneticvariation";
 
+/* Location settings written by SensorManager::setMagneticDeviation(). */
+static const char* LOCATION_CONF = "/etc/xdg/sensorfw/location.conf";
+
 DeclinationFilter::DeclinationFilter() :
         Filter<CompassData, DeclinationFilter, CompassData>(this, &DeclinationFilter::correct),
-        declinationCorrection_(0),
-        lastUpdate_(0)
+        declinationCorrection_(0)
 {
-    updateInterval_ = SensorFrameworkConfig::configuration()->value<quint64>("compass/declination_update_interval", 1000 * 60 * 60) * 1000;
+    // Settings are replaced by renaming, so watch the directory as well.
+    watcher_ = new QFileSystemWatcher(this);
+    watcher_->addPath(QFileInfo(LOCATION_CONF).absolutePath());
+    connect(watcher_, SIGNAL(fileChanged(const QString&)), this, SLOT(loadSettings()));
+    connect(watcher_, SIGNAL(directoryChanged(const QString&)), this, SLOT(loadSettings()));
     loadSettings();
 }
 
 void DeclinationFilter::correct(unsigned, const CompassData* data)
 {
     CompassData newOrientation(*data);
-    if (newOrientation.timestamp_ - lastUpdate_ > updateInterval_) {
-        loadSettings();
-        lastUpdate_ = newOrientation.timestamp_;
-    }
 
     newOrientation.correctedDegrees_ = newOrientation.degrees_;
-    if (declinationCorrection_.loadAcquire() != 0) {
-        newOrientation.correctedDegrees_ += declinationCorrection_.loadAcquire();
+    int correction = declinationCorrection_.loadAcquire();
+    if (correction != 0) {
+        newOrientation.correctedDegrees_ += correction;
         newOrientation.correctedDegrees_ %= 360;
 //        sensordLogT() << "DeclinationFilter corrected degree " << newOrientation.degrees_ << " => " << newOrientation.correctedDegrees_ << ". Level: " << newOrientation.level_;
     }
@@ -62,17 +66,22 @@ void DeclinationFilter::correct(unsigned, const CompassData* data)
 
 void DeclinationFilter::loadSettings()
 {
-    QSettings confFile("/etc/xdg/sensorfw/location.conf", QSettings::IniFormat);
+    if (QFile::exists(LOCATION_CONF) && !watcher_->files().contains(LOCATION_CONF))
+        watcher_->addPath(LOCATION_CONF);
+
+    QSettings confFile(LOCATION_CONF, QSettings::IniFormat);
     confFile.beginGroup("location");
-    double declination = confFile.value("declination",0).toDouble();
-    if (declination != 0) {
-        declinationCorrection_ = declination;
+    int declination = (int)confFile.value("declination",0).toDouble();
+    if (declination != declinationCorrection_.loadAcquire()) {
+        declinationCorrection_.storeRelease(declination);
+        sensordLogD() << "Fetched declination correction from GConf: " << declination;
     }
-    sensordLogD() << "Fetched declination correction from GConf: " << declinationCorrection_.loadAcquire();
 }
 
 int DeclinationFilter::declinationCorrection()
 {
+    // The watcher needs the event loop to notice a change, so a value
+    // read right after setMagneticDeviation() would be stale.
     loadSettings();
     return declinationCorrection_.loadAcquire();
 }
@@ -32,6 +32,8 @@
 #include "datatypes/orientationdata.h"
 #include "filter.h"
 
+class QFileSystemWatcher;
+
 /**
  * Filter for calculating declination correction for Compass data.
  */
@@ -53,20 +55,26 @@ public:
     /**
      * Holds the declination correction amount applied in the calculation.
      * The value is read from GConf key \c /system/osso/location/settings/magneticvariation.
+     * Reads the settings again, so the value is current also before
+     * the change has been noticed by the data path.
      */
     int declinationCorrection();
 
+private Q_SLOTS:
+    /**
+     * Read declination correction from location settings. Called when
+     * the settings change.
+     */
+    void loadSettings();
+
 private:
     DeclinationFilter();
 
     void correct(unsigned, const CompassData*);
 
-    void loadSettings();
-
     CompassData orientation_;
     QAtomicInt declinationCorrection_;
-    quint64 lastUpdate_;
-    quint64 updateInterval_;
+    QFileSystemWatcher* watcher_;
 
     static const char* declinationKey;
 };
@@ -28,72 +28,38 @@
 // averaging filter
 
 DownsampleFilter::DownsampleFilter() :
-    Filter<TimedXyzData, DownsampleFilter, TimedXyzData>(this, &DownsampleFilter::filter),
-    bufferSize_(1),
-    timeout_(-1)
+    Filter<TimedXyzData, DownsampleFilter, TimedXyzData>(this, &DownsampleFilter::filter)
 {
 }
 
 unsigned int DownsampleFilter::bufferSize() const
 {
-    return bufferSize_;
+    return stage_.bufferSize();
 }
 
 void DownsampleFilter::setBufferSize(unsigned int size)
 {
     sensordLogD() << "DownsampleFilter buffer size = " << size;
-    bufferSize_ = size;
+    stage_.setBufferSize(size);
 }
 
 int DownsampleFilter::timeout() const
 {
-    return timeout_ / 1000;
+    return stage_.timeout();
 }
 
 void DownsampleFilter::setTimeout(int ms)
 {
-    timeout_ = static_cast<long>(ms) * 1000;
+    stage_.setTimeout(ms);
     sensordLogD() << "DownsampleFilter timeout = " << ms;
 }
 
 void DownsampleFilter::filter(unsigned, const TimedXyzData* data)
 {
-    buffer_.push_back(*data);
+    TimedXyzData downsampled;
 
-    for(TimedXyzDownsampleBuffer::iterator it = buffer_.begin(); it != buffer_.end(); ++it)
-    {
-        if(static_cast<unsigned int>(buffer_.size()) > bufferSize_ ||
-           (timeout_ && (data->timestamp_ - it->timestamp_ >
-                         static_cast<unsigned long>(timeout_))))
-        {
-            it = buffer_.erase(it);
-            if(it == buffer_.end())
-                break;
-        }
-        else
-            break;
-    }
-
-    if(static_cast<unsigned int>(buffer_.size()) < bufferSize_)
+    if (!stage_.apply(*data, downsampled))
         return;
 
-    long x = 0;
-    long y = 0;
-    long z = 0;
-    foreach(const TimedXyzData& data, buffer_)
-    {
-        x += data.x_;
-        y += data.y_;
-        z += data.z_;
-    }
-    int count = buffer_.count();
-    TimedXyzData downsampled(data->timestamp_,
-                             x / count,
-                             y / count,
-                             z / count);
-
-//    sensordLogT() << "Downsampled: " << downsampled.x_ << ", " << downsampled.y_ << ", " << downsampled.z_;
-
     source_.propagate(1, &downsampled);
-    buffer_.clear();
 }
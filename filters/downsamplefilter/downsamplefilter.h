@@ -30,6 +30,79 @@
 #include <QObject>
 #include "datatypes/orientationdata.h"
 #include "filter.h"
+#include "windowstats.h"
+
+/**
+ * Pipeline stage averaging buffered XYZ samples. Produces output once
+ * the buffer is full. See #Pipeline and #DownsampleFilter.
+ */
+class DownsampleStage
+{
+public:
+    typedef TimedXyzData InputType;  /**< accepted data type */
+    typedef TimedXyzData OutputType; /**< produced data type */
+
+    DownsampleStage() :
+        bufferSize_(1),
+        timeout_(-1)
+    {
+    }
+
+    unsigned int bufferSize() const { return bufferSize_; }
+
+    void setBufferSize(unsigned int size)
+    {
+        bufferSize_ = size;
+        x_.setSize(size);
+        y_.setSize(size);
+        z_.setSize(size);
+        timestamps_.clear();
+    }
+
+    int timeout() const { return timeout_ / 1000; }
+
+    void setTimeout(int ms) { timeout_ = static_cast<long>(ms) * 1000; }
+
+    inline bool apply(const TimedXyzData& in, TimedXyzData& out)
+    {
+        // Full buffer drops the oldest sample.
+        if (x_.isFull())
+            timestamps_.removeFirst();
+        x_.add(in.x_);
+        y_.add(in.y_);
+        z_.add(in.z_);
+        timestamps_.append(in.timestamp_);
+
+        // Drop samples exceeding the timeout.
+        while (timeout_ && !timestamps_.isEmpty() &&
+               in.timestamp_ - timestamps_.first() > static_cast<unsigned long>(timeout_)) {
+            timestamps_.removeFirst();
+            x_.removeOldest();
+            y_.removeOldest();
+            z_.removeOldest();
+        }
+
+        if (static_cast<unsigned int>(x_.count()) < bufferSize_)
+            return false;
+
+        int count = x_.count();
+        out = TimedXyzData(in.timestamp_, (long)x_.sum() / count,
+                           (long)y_.sum() / count, (long)z_.sum() / count);
+        x_.reset();
+        y_.reset();
+        z_.reset();
+        timestamps_.clear();
+        return true;
+    }
+
+private:
+    unsigned int bufferSize_;      /**< buffer size */
+    long timeout_;                 /**< timeout in microseconds */
+    WindowStats<int> x_;           /**< buffered x values */
+    WindowStats<int> y_;           /**< buffered y values */
+    WindowStats<int> z_;           /**< buffered z values */
+    QList<quint64> timestamps_;    /**< timestamps of buffered samples */
+};
 
 /**
  * @brief Downsample filter.
@@ -95,12 +168,7 @@ private:
      */
     void filter(unsigned, const TimedXyzData*);
 
-    /** Sample buffer type for TimedXyzData downsampling. */
-    typedef QList<TimedXyzData> TimedXyzDownsampleBuffer;
-
-    unsigned int bufferSize_; /**< buffer size */
-    long timeout_;   /**< timeout in milliseconds */
-    TimedXyzDownsampleBuffer buffer_; /**< downsample buffer */
+    DownsampleStage stage_; /**< downsampling implementation */
 };
 
 #endif // DOWNSAMPLEFILTER_H
@@ -5,7 +5,8 @@ SUBDIRS = coordinatealignfilter \
           rotationfilter \
           downsamplefilter \
           avgaccfilter \
-          magcoordinatealignfilter
+          magcoordinatealignfilter \
+          stepdetectorfilter
 
 include(../common-install.pri)
 publicheaders.files = *.h
@@ -30,6 +30,8 @@
 #include "orientationinterpreter.h"
 #include "logging.h"
 #include "config.h"
+#include "fastmath.h"
+#include "fixedpoint.h"
 #include <math.h>
 #include <stdlib.h>
 #include <limits.h>
@@ -59,13 +61,9 @@ OrientationInterpreter::OrientationInterpreter() :
     addSource(&faceSource, "face");
     addSource(&orientationSource, "orientation");
 
-    minLimit = SensorFrameworkConfig::configuration()->value("orientation/overflow_min", QVariant(OVERFLOW_MIN)).toInt();
-    maxLimit = SensorFrameworkConfig::configuration()->value("orientation/overflow_max", QVariant(OVERFLOW_MAX)).toInt();
-
-    angleThresholdPortrait = SensorFrameworkConfig::configuration()->value("orientation/threshold_portrait",QVariant(THRESHOLD_PORTRAIT)).toInt();
-    angleThresholdLandscape = SensorFrameworkConfig::configuration()->value("orientation/threshold_landscape",QVariant(THRESHOLD_LANDSCAPE)).toInt();
-    discardTime = SensorFrameworkConfig::configuration()->value("orientation/discard_time", QVariant(DISCARD_TIME)).toUInt();
-    maxBufferSize = SensorFrameworkConfig::configuration()->value("orientation/buffer_size", QVariant(AVG_BUFFER_MAX_SIZE)).toInt();
+    maxBufferSize = 0;
+    loadSettings();
+    connect(SensorFrameworkConfig::configuration(), SIGNAL(changed()), this, SLOT(configurationChanged()));
 
     // Open the handle for boosting cpu on changes that affect orientation
     if (cpuBoostFile.exists()) {
@@ -73,8 +71,38 @@ OrientationInterpreter::OrientationInterpreter() :
       }
 }
 
+void OrientationInterpreter::loadSettings()
+{
+    SensorFrameworkConfig* config = SensorFrameworkConfig::configuration();
+    minLimit = config->value("orientation/overflow_min", QVariant(OVERFLOW_MIN)).toInt();
+    maxLimit = config->value("orientation/overflow_max", QVariant(OVERFLOW_MAX)).toInt();
+
+    angleThresholdPortrait = config->value("orientation/threshold_portrait",QVariant(THRESHOLD_PORTRAIT)).toInt();
+    angleThresholdLandscape = config->value("orientation/threshold_landscape",QVariant(THRESHOLD_LANDSCAPE)).toInt();
+    discardTime = config->value("orientation/discard_time", QVariant(DISCARD_TIME)).toUInt();
+    int bufferSize = config->value("orientation/buffer_size", QVariant(AVG_BUFFER_MAX_SIZE)).toInt();
+    if (bufferSize != maxBufferSize) {
+        maxBufferSize = bufferSize;
+        xAverage.setSize(maxBufferSize);
+        yAverage.setSize(maxBufferSize);
+        zAverage.setSize(maxBufferSize);
+        averageTimestamps.clear();
+    }
+    fixedPoint = FixedPoint::enabled();
+}
+
+void OrientationInterpreter::configurationChanged()
+{
+    // Samples are processed in the adaptor thread, so settings are
+    // applied there rather than from this slot.
+    settingsChanged.storeRelease(1);
+}
+
 void OrientationInterpreter::accDataAvailable(unsigned, const AccelerationData* pdata)
 {
+    if (settingsChanged.testAndSetOrdered(1, 0))
+        loadSettings();
+
     data = *pdata;
 
     // Check overflow
@@ -84,29 +112,28 @@ void OrientationInterpreter::accDataAvailable(unsigned, const AccelerationData*
         return;
     }
 
-    // Append new value to buffer
-    dataBuffer.append(data);
+    // Append new value to the window, full window drops the oldest one
+    if (xAverage.isFull())
+        averageTimestamps.removeFirst();
+    xAverage.add(data.x_);
+    yAverage.add(data.y_);
+    zAverage.add(data.z_);
+    averageTimestamps.append(data.timestamp_);
 
-    // Clear old values from buffer.
-    while (dataBuffer.count() > maxBufferSize || (dataBuffer.count() > 1 && (data.timestamp_ - dataBuffer.first().timestamp_ > discardTime)))
+    // Clear old values from window.
+    while (averageTimestamps.count() > 1 && (data.timestamp_ - averageTimestamps.first() > discardTime))
     {
-        dataBuffer.removeFirst();
+        averageTimestamps.removeFirst();
+        xAverage.removeOldest();
+        yAverage.removeOldest();
+        zAverage.removeOldest();
     }
 
     //Calculate average
-    long x = 0;
-    long y = 0;
-    long z = 0;
-    foreach (const AccelerationData& sample, dataBuffer)
-    {
-        x += sample.x_;
-        y += sample.y_;
-        z += sample.z_;
-    }
-
-    data.x_ = x / dataBuffer.count();
-    data.y_ = y / dataBuffer.count();
-    data.z_ = z / dataBuffer.count();
+    int count = xAverage.count();
+    data.x_ = (long)xAverage.sum() / count;
+    data.y_ = (long)yAverage.sum() / count;
+    data.z_ = (long)zAverage.sum() / count;
 
     // calculate topedge
     processTopEdge();
@@ -127,9 +154,19 @@ bool OrientationInterpreter::overFlowCheck()
 int OrientationInterpreter::orientationCheck(const AccelerationData &data,  OrientationMode mode) const
 {
     if (mode == OrientationInterpreter::Landscape)
-        return round(atan((double)data.x_ / sqrt(data.y_ * data.y_ + data.z_ * data.z_)) * RADIANS_TO_DEGREES);
+        return tiltAngle(data.x_, data.y_, data.z_, fixedPoint);
     else
-        return round(atan((double)data.y_ / sqrt(data.x_ * data.x_ + data.z_ * data.z_)) * RADIANS_TO_DEGREES);
+        return tiltAngle(data.y_, data.x_, data.z_, fixedPoint);
+}
+
+int OrientationInterpreter::tiltAngle(int axis, int first, int second, bool fixedPoint)
+{
+    // Square root with 8 fraction bits, so its truncation does not
+    // move the angle over a rounding boundary.
+    if (fixedPoint)
+        return FixedPoint::round(FixedPoint::atan2((qint64)axis << 8, FixedPoint::sqrt(((qint64)first * first + (qint64)second * second) << 16)));
+
+    return FastMath::roundToInt(FastMath::atan2(axis, FastMath::sqrt((float)first * first + (float)second * second)) * RADIANS_TO_DEGREES);
 }
 
 PoseData OrientationInterpreter::rotateToPortrait(int rotation)
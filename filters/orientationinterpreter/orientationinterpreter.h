@@ -30,8 +30,10 @@
 #define ORIENTATIONINTERPRETER_H
 
 #include <QObject>
+#include <QAtomicInt>
 #include <QFile>
 #include "filter.h"
+#include "windowstats.h"
 #include <datatypes/orientationdata.h>
 #include <datatypes/posedata.h>
 
@@ -63,13 +65,21 @@ private:
 
     OrientationInterpreter();
 
+    /**
+     * Read thresholds and window size from configuration.
+     */
+    void loadSettings();
+
     PoseData topEdge;
     PoseData face;
     PoseData previousFace;
     bool updatePreviousFace;
 
     AccelerationData data;
-    QList<AccelerationData> dataBuffer;
+    WindowStats<int> xAverage;
+    WindowStats<int> yAverage;
+    WindowStats<int> zAverage;
+    QList<quint64> averageTimestamps;
 
     int minLimit;
     int maxLimit;
@@ -77,6 +87,8 @@ private:
     int angleThresholdLandscape;
     unsigned long discardTime;
     int maxBufferSize;
+    bool fixedPoint;
+    QAtomicInt settingsChanged; /**< configuration changed since loadSettings() */
 
     PoseData orientationData;
 
@@ -118,6 +130,24 @@ public:
     }
 
     PoseData orientation() const { return orientationData; }
+
+    /**
+     * Tilt of an axis against the plane of the other two, as used to
+     * decide the orientation.
+     *
+     * @param axis value on the tilted axis.
+     * @param first value on one of the other axes.
+     * @param second value on the remaining axis.
+     * @param fixedPoint use the integer path instead of FastMath.
+     * @return angle in degrees, rounded.
+     */
+    static int tiltAngle(int axis, int first, int second, bool fixedPoint);
+
+private Q_SLOTS:
+    /**
+     * Take changed configuration into use with the next sample.
+     */
+    void configurationChanged();
 };
 
 #endif
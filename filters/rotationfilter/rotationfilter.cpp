@@ -25,6 +25,7 @@
 */
 
 #include "rotationfilter.h"
+#include "fastmath.h"
 #include <math.h>
 
 RotationFilter::RotationFilter() :
@@ -44,7 +45,10 @@ void RotationFilter::interpret(unsigned, const TimedXyzData* data)
     rotation_.timestamp_ = data->timestamp_;
 
     // X-Rotation
-    rotation_.x_ = round(atan((double)data->y_ / sqrt(data->x_ * data->x_ + data->z_ * data->z_)) * RADIANS_TO_DEGREES);
+    float x = data->x_;
+    float y = data->y_;
+    float z = data->z_;
+    rotation_.x_ = FastMath::roundToInt(FastMath::atan2(y, FastMath::sqrt(x * x + z * z)) * RADIANS_TO_DEGREES);
     rotation_.x_ = -rotation_.x_;
 
     // Y-rotation
@@ -53,10 +57,11 @@ void RotationFilter::interpret(unsigned, const TimedXyzData* data)
     } else if (data->x_ == 0 && data->z_  == 0) {
         rotation_.y_ = 0;
     } else {
-        rotation_.y_ = round(atan((double)data->x_ / sqrt(data->y_ * data->y_ + data->z_ * data->z_)) * RADIANS_TO_DEGREES);
+        rotation_.y_ = FastMath::roundToInt(FastMath::atan2(x, FastMath::sqrt(y * y + z * z)) * RADIANS_TO_DEGREES);
 
-        qreal theta = atan(sqrt(data->x_ * data->x_ + data->y_ * data->y_) / data->z_) * RADIANS_TO_DEGREES;
-        if (theta > 0) {
+        // Tilt from the z-axis, atan(sqrt(x^2 + y^2) / z), is positive
+        // exactly when z >= 0 as the x == y == 0 cases are handled above.
+        if (data->z_ >= 0) {
             if (rotation_.y_ >= 0)
                 rotation_.y_ = 180 - rotation_.y_;
             else
@@ -0,0 +1,189 @@
+/**
+   @file stepdetectorfilter.cpp
+   @brief StepDetectorFilter
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "stepdetectorfilter.h"
+#include "config.h"
+#include "logging.h"
+#include <math.h>
+
+#define DEFAULT_THRESHOLD     120.0f
+#define DEFAULT_MIN_INTERVAL  250
+#define DEFAULT_LOW_CUTOFF    0.5f
+#define DEFAULT_HIGH_CUTOFF   3.0f
+/* Sample interval assumed until timestamps tell otherwise, us. */
+#define DEFAULT_SAMPLE_INTERVAL 20000
+
+/* Steps counted by destroyed filters. Filters are created and destroyed
+ * with the chain in the main thread. */
+static unsigned int countedSteps = 0;
+
+StepDetectorStage::StepDetectorStage() :
+    threshold_(DEFAULT_THRESHOLD),
+    minInterval_((quint64)DEFAULT_MIN_INTERVAL * 1000),
+    lowCutoff_(DEFAULT_LOW_CUTOFF),
+    highCutoff_(DEFAULT_HIGH_CUTOFF),
+    highPassGain_(0),
+    lowPassGain_(0),
+    lastStep_(0),
+    steps_(0)
+{
+    reset();
+}
+
+void StepDetectorStage::reset()
+{
+    primed_ = false;
+    previous_ = 0;
+    highPassed_ = 0;
+    bandPassed_ = 0;
+    lastTimestamp_ = 0;
+    inPeak_ = false;
+    peak_ = 0;
+    peakTime_ = 0;
+    updateCoefficients(0, DEFAULT_SAMPLE_INTERVAL, 1);
+}
+
+void StepDetectorStage::setPassBand(float low, float high)
+{
+    lowCutoff_ = low;
+    highCutoff_ = high;
+    updateCoefficients(0, DEFAULT_SAMPLE_INTERVAL, 1);
+}
+
+void StepDetectorStage::updateCoefficients(quint64 first, quint64 last, int n)
+{
+    if (last <= first || n <= 0)
+        return;
+
+    float dt = (last - first) / (n * 1000000.0f);
+    float highPassRc = 1.0f / (2.0f * (float)M_PI * lowCutoff_);
+    float lowPassRc = 1.0f / (2.0f * (float)M_PI * highCutoff_);
+    highPassGain_ = highPassRc / (highPassRc + dt);
+    lowPassGain_ = dt / (lowPassRc + dt);
+}
+
+int StepDetectorStage::process(int n, const TimedXyzData* in, TimedUnsigned* out)
+{
+    float magnitude[BatchSize];
+    if (n > BatchSize)
+        n = BatchSize;
+    if (n <= 0)
+        return 0;
+
+    // Samples are independent here, so the compiler can vectorise this.
+    for (int i = 0; i < n; ++i) {
+        float x = in[i].x_;
+        float y = in[i].y_;
+        float z = in[i].z_;
+        magnitude[i] = sqrtf(x * x + y * y + z * z);
+    }
+
+    if (lastTimestamp_)
+        updateCoefficients(lastTimestamp_, in[n - 1].timestamp_, n);
+    else
+        updateCoefficients(in[0].timestamp_, in[n - 1].timestamp_, n - 1);
+    lastTimestamp_ = in[n - 1].timestamp_;
+
+    int produced = 0;
+    for (int i = 0; i < n; ++i) {
+        if (detect(magnitude[i], in[i].timestamp_, out[produced]))
+            ++produced;
+    }
+    return produced;
+}
+
+bool StepDetectorStage::detect(float magnitude, quint64 timestamp, TimedUnsigned& out)
+{
+    if (!primed_) {
+        previous_ = magnitude;
+        primed_ = true;
+    }
+    highPassed_ = highPassGain_ * (highPassed_ + magnitude - previous_);
+    previous_ = magnitude;
+    bandPassed_ += lowPassGain_ * (highPassed_ - bandPassed_);
+
+    if (bandPassed_ > threshold_) {
+        if (!inPeak_ || bandPassed_ > peak_) {
+            peak_ = bandPassed_;
+            peakTime_ = timestamp;
+        }
+        inPeak_ = true;
+        return false;
+    }
+
+    // The lobe ends when the signal crosses zero, so noise around the
+    // threshold does not count as several steps.
+    if (!inPeak_ || bandPassed_ > 0)
+        return false;
+    inPeak_ = false;
+
+    if (lastStep_ && peakTime_ - lastStep_ < minInterval_)
+        return false;
+    lastStep_ = peakTime_;
+    ++steps_;
+    out = TimedUnsigned(peakTime_, steps_);
+    return true;
+}
+
+StepDetectorFilter::StepDetectorFilter() :
+    Filter<TimedXyzData, StepDetectorFilter, TimedUnsigned>(this, &StepDetectorFilter::filter)
+{
+    stage_.setSteps(countedSteps);
+    loadSettings();
+    connect(SensorFrameworkConfig::configuration(), SIGNAL(changed()), this, SLOT(configurationChanged()));
+}
+
+StepDetectorFilter::~StepDetectorFilter()
+{
+    countedSteps = stage_.steps();
+}
+
+void StepDetectorFilter::loadSettings()
+{
+    SensorFrameworkConfig* config = SensorFrameworkConfig::configuration();
+    stage_.setThreshold(config->value<float>("stepdetector/threshold", DEFAULT_THRESHOLD));
+    stage_.setMinInterval(config->value<unsigned int>("stepdetector/min_interval", DEFAULT_MIN_INTERVAL));
+    sensordLogD() << "StepDetectorFilter threshold =" << stage_.threshold()
+                  << "min interval =" << stage_.minInterval();
+}
+
+void StepDetectorFilter::configurationChanged()
+{
+    // Applied from the data path, which runs in the adaptor thread.
+    settingsChanged_.storeRelease(1);
+}
+
+void StepDetectorFilter::filter(unsigned n, const TimedXyzData* data)
+{
+    if (settingsChanged_.testAndSetOrdered(1, 0))
+        loadSettings();
+
+    TimedUnsigned steps[StepDetectorStage::BatchSize];
+
+    while (n) {
+        int count = qMin(n, (unsigned)StepDetectorStage::BatchSize);
+        int produced = stage_.process(count, data, steps);
+        if (produced)
+            source_.propagate(produced, steps);
+        data += count;
+        n -= count;
+    }
+}
@@ -0,0 +1,197 @@
+/**
+   @file stepdetectorfilter.h
+   @brief StepDetectorFilter
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef STEPDETECTORFILTER_H
+#define STEPDETECTORFILTER_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include "datatypes/orientationdata.h"
+#include "datatypes/timedunsigned.h"
+#include "filter.h"
+
+/**
+ * Pipeline stage detecting steps from accelerometer data. The magnitude
+ * of acceleration is band-pass filtered to the walking cadence and each
+ * positive lobe rising over the threshold counts as one step, unless it
+ * follows the previous step too closely. Produces the total number of
+ * steps, timestamped at the peak of the lobe. See #Pipeline and
+ * #StepDetectorFilter.
+ *
+ * Filter coefficients follow the sample rate measured from timestamps,
+ * so the detector works at any accelerometer interval short enough to
+ * resolve the pass band, see <tt>stepdetector/accelerometer_interval</tt>.
+ */
+class StepDetectorStage
+{
+public:
+    typedef TimedXyzData  InputType;  /**< accepted data type */
+    typedef TimedUnsigned OutputType; /**< produced data type */
+
+    enum {
+        BatchSize = 64 /**< most samples handled by one #process() call */
+    };
+
+    StepDetectorStage();
+
+    /**
+     * Forget filter state. Step count is kept.
+     */
+    void reset();
+
+    float threshold() const { return threshold_; }
+
+    /**
+     * Set minimum height of a step in band-passed acceleration.
+     *
+     * @param threshold threshold in mG.
+     */
+    void setThreshold(float threshold) { threshold_ = threshold; }
+
+    unsigned int minInterval() const { return minInterval_ / 1000; }
+
+    /**
+     * Set minimum time between two steps.
+     *
+     * @param ms interval in milliseconds.
+     */
+    void setMinInterval(unsigned int ms) { minInterval_ = (quint64)ms * 1000; }
+
+    /**
+     * Set pass band of the filter.
+     *
+     * @param low high-pass cutoff in Hz, removes gravity.
+     * @param high low-pass cutoff in Hz, removes shaking.
+     */
+    void setPassBand(float low, float high);
+
+    unsigned int steps() const { return steps_; }
+
+    /**
+     * Continue counting from an earlier total.
+     *
+     * @param steps steps counted so far.
+     */
+    void setSteps(unsigned int steps) { steps_ = steps; }
+
+    inline bool apply(const TimedXyzData& in, TimedUnsigned& out)
+    {
+        return process(1, &in, &out) == 1;
+    }
+
+    /**
+     * Run a batch of samples through the detector without allocating.
+     * Magnitudes of the whole batch are computed in one loop before the
+     * recursive filters run over them.
+     *
+     * @param n number of input samples, at most #BatchSize.
+     * @param in input samples.
+     * @param out location for at most n step counts.
+     * @return number of detected steps.
+     */
+    int process(int n, const TimedXyzData* in, TimedUnsigned* out);
+
+private:
+    /**
+     * Recompute filter coefficients for the sample interval of a batch.
+     */
+    void updateCoefficients(quint64 first, quint64 last, int n);
+
+    /**
+     * Filter one magnitude and look for a step.
+     *
+     * @return was a step completed.
+     */
+    bool detect(float magnitude, quint64 timestamp, TimedUnsigned& out);
+
+    float        threshold_;     /**< step threshold, mG */
+    quint64      minInterval_;   /**< minimum time between steps, us */
+    float        lowCutoff_;     /**< high-pass cutoff, Hz */
+    float        highCutoff_;    /**< low-pass cutoff, Hz */
+    float        highPassGain_;  /**< high-pass coefficient */
+    float        lowPassGain_;   /**< low-pass coefficient */
+    bool         primed_;        /**< has filter state */
+    float        previous_;      /**< previous magnitude */
+    float        highPassed_;    /**< high-pass output */
+    float        bandPassed_;    /**< low-pass output */
+    quint64      lastTimestamp_; /**< timestamp of previous sample */
+    bool         inPeak_;        /**< is signal in a positive lobe over threshold */
+    float        peak_;          /**< height of current lobe */
+    quint64      peakTime_;      /**< timestamp of current lobe peak */
+    quint64      lastStep_;      /**< timestamp of previous step */
+    unsigned int steps_;         /**< detected steps */
+};
+
+/**
+ * @brief Step detector filter.
+ *
+ * Turns accelerometer data into step counts. Configured from
+ * <tt>stepdetector/threshold</tt> and <tt>stepdetector/min_interval</tt>.
+ * The count continues from the previous instance, so it covers the
+ * lifetime of the daemon even though the chain is recreated whenever
+ * its users come and go.
+ */
+class StepDetectorFilter : public QObject, public Filter<TimedXyzData, StepDetectorFilter, TimedUnsigned>
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(StepDetectorFilter)
+
+public:
+    /**
+     * Factory method.
+     *
+     * @return New StepDetectorFilter instance.
+     */
+    static FilterBase* factoryMethod() { return new StepDetectorFilter; }
+
+    /**
+     * Destructor. Hands the step count over to the next instance.
+     */
+    ~StepDetectorFilter();
+
+protected:
+    /**
+     * Constructor.
+     */
+    StepDetectorFilter();
+
+private Q_SLOTS:
+    /**
+     * Take changed configuration into use with the next sample.
+     */
+    void configurationChanged();
+
+private:
+    /**
+     * Callback for incoming accelerometer data.
+     */
+    void filter(unsigned n, const TimedXyzData* data);
+
+    /**
+     * Read threshold and minimum interval from configuration.
+     */
+    void loadSettings();
+
+    StepDetectorStage stage_;           /**< detector implementation */
+    QAtomicInt        settingsChanged_; /**< configuration changed since loadSettings() */
+};
+
+#endif // STEPDETECTORFILTER_H
@@ -0,0 +1,9 @@
+TARGET = stepdetectorfilter
+
+HEADERS += stepdetectorfilter.h \
+           stepdetectorfilterplugin.h
+
+SOURCES += stepdetectorfilter.cpp \
+           stepdetectorfilterplugin.cpp
+
+include( ../filter-config.pri )
@@ -35,6 +35,9 @@
 #include "lsclient.h"
 #endif
 
+/** How long requestHistory() waits for the data socket handshake, ms. */
+static const int HANDSHAKE_TIMEOUT = 5000;
+
 struct AbstractSensorChannelInterface::AbstractSensorChannelInterfaceImpl : public QDBusAbstractInterface
 {
     AbstractSensorChannelInterfaceImpl(QObject* parent, int sessionId, const QString& path, const char* interfaceName);
@@ -46,10 +49,12 @@ struct AbstractSensorChannelInterface::AbstractSensorChannelInterfaceImpl : publ
     int interval_;
     unsigned int bufferInterval_;
     unsigned int bufferSize_;
+    unsigned int maxLatency_;
     SocketReader socketReader_;
     bool running_;
     bool standbyOverride_;
     bool downsampling_;
+    bool configureSession_;
 };
 
 AbstractSensorChannelInterface::AbstractSensorChannelInterfaceImpl::AbstractSensorChannelInterfaceImpl(QObject* parent, int sessionId, const QString& path, const char* interfaceName) :
@@ -60,16 +65,19 @@ AbstractSensorChannelInterface::AbstractSensorChannelInterfaceImpl::AbstractSens
     interval_(0),
     bufferInterval_(0),
     bufferSize_(1),
+    maxLatency_(0),
     socketReader_(parent),
     running_(false),
     standbyOverride_(false),
-    downsampling_(true)
+    downsampling_(true),
+    configureSession_(true)
 {
 }
 
 AbstractSensorChannelInterface::AbstractSensorChannelInterface(const QString& path, const char* interfaceName, int sessionId) :
     pimpl_(new AbstractSensorChannelInterfaceImpl(this, sessionId, path, interfaceName))
 {
+    connect(&pimpl_->socketReader_, SIGNAL(connected()), this, SLOT(socketConnected()));
     if (!pimpl_->socketReader_.initiateConnection(sessionId)) {
         setError(SClientSocketError, "Socket connection failed.");
     }
@@ -133,6 +141,75 @@ QDBusReply<void> AbstractSensorChannelInterface::start(int sessionId)
 
     connect(pimpl_->socketReader_.socket(), SIGNAL(readyRead()), this, SLOT(dataReceived()));
 
+    // Sensord can not apply socket settings or write samples before it
+    // has received the session ID over the socket, the session is
+    // configured from socketConnected() then.
+    if (!pimpl_->socketReader_.isHandshaken())
+        return QDBusReply<void>();
+
+    configureAndStart(sessionId);
+    return QDBusReply<void>();
+}
+
+void AbstractSensorChannelInterface::socketConnected()
+{
+    if (pimpl_->running_)
+        configureAndStart(pimpl_->sessionId_);
+}
+
+void AbstractSensorChannelInterface::configureAndStart(int sessionId)
+{
+    if (!pimpl_->configureSession_) {
+        startLegacy(sessionId);
+        return;
+    }
+
+    QVariantMap parameters;
+    parameters.insert("standbyOverride", pimpl_->standbyOverride_);
+    parameters.insert("interval", pimpl_->interval_);
+    parameters.insert("bufferInterval", pimpl_->bufferInterval_);
+    parameters.insert("bufferSize", pimpl_->bufferSize_);
+    parameters.insert("downsampling", pimpl_->downsampling_);
+    if (pimpl_->maxLatency_)
+        parameters.insert("maxLatency", pimpl_->maxLatency_);
+    parameters.insert("start", true);
+
+    QList<QVariant> argumentList;
+    argumentList << qVariantFromValue(sessionId) << qVariantFromValue(parameters);
+
+    QDBusPendingReply <bool> returnValue = pimpl_->asyncCallWithArgumentList(QLatin1String("configureSession"), argumentList);
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(returnValue, this);
+    watcher->setProperty("sessionId", sessionId);
+    connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
+            SLOT(configureSessionFinished(QDBusPendingCallWatcher*)));
+}
+
+void AbstractSensorChannelInterface::configureSessionFinished(QDBusPendingCallWatcher *watch)
+{
+    watch->deleteLater();
+    QDBusPendingReply<bool> reply = *watch;
+    int sessionId = watch->property("sessionId").toInt();
+
+    if (reply.isError()) {
+        if (reply.error().type() != QDBusError::UnknownMethod) {
+            qDebug() << reply.error().message();
+            setError(SHwSensorStartFailed, reply.error().message());
+            return;
+        }
+        pimpl_->configureSession_ = false;
+    } else if (reply.value()) {
+        return;
+    } else {
+        // Keep the old behaviour of applying whatever the sensor accepts.
+        qDebug() << "Session configuration rejected, applying parameters separately";
+    }
+
+    if (pimpl_->running_)
+        startLegacy(sessionId);
+}
+
+QDBusPendingReply<void> AbstractSensorChannelInterface::startLegacy(int sessionId)
+{
     QList<QVariant> argumentList;
     argumentList << qVariantFromValue(sessionId);
 
@@ -430,11 +507,14 @@ void AbstractSensorChannelInterface::clearError()
 
 void AbstractSensorChannelInterface::dataReceived()
 {
-    do
-    {
-        if(!dataReceivedImpl())
-            return;
-    } while(pimpl_->socketReader_.socket()->bytesAvailable());
+    // Subclasses return false once no complete frame is left.
+    while(dataReceivedImpl())
+        ;
+    flushSamples();
+}
+
+void AbstractSensorChannelInterface::flushSamples()
+{
 }
 
 bool AbstractSensorChannelInterface::read(void* buffer, int size)
@@ -466,6 +546,23 @@ void AbstractSensorChannelInterface::setDataRangeIndexFinished(QDBusPendingCallW
     }
 }
 
+QDBusReply<unsigned int> AbstractSensorChannelInterface::requestHistory(unsigned int seconds)
+{
+    clearError();
+    // History goes over the socket, so sensord has to know it first.
+    if (!pimpl_->socketReader_.waitForHandshake(HANDSHAKE_TIMEOUT)) {
+        setError(SClientSocketError, "Socket handshake not completed.");
+        return QDBusReply<unsigned int>(QDBusError(QDBusError::Disconnected, "Socket handshake not completed."));
+    }
+    QDBusReply<unsigned int> reply(call(QDBus::Block, QLatin1String("requestHistory"),
+                                        qVariantFromValue(pimpl_->sessionId_), qVariantFromValue(seconds)));
+    if(!reply.isValid()) {
+        qDebug() << reply.error().message();
+        setError(SaCannotAccessSensor, reply.error().message());
+    }
+    return reply;
+}
+
 QDBusMessage AbstractSensorChannelInterface::call(QDBus::CallMode mode,
                                                   const QString& method,
                                                   const QVariant& arg1,
@@ -519,6 +616,45 @@ QDBusReply<void> AbstractSensorChannelInterface::setDownsampling(int sessionId,
     return returnValue;
 }
 
+unsigned int AbstractSensorChannelInterface::maxLatency()
+{
+    return pimpl_->maxLatency_;
+}
+
+bool AbstractSensorChannelInterface::setMaxLatency(unsigned int value)
+{
+    pimpl_->maxLatency_ = value;
+    if (!pimpl_->running_)
+        return true;
+    if (!pimpl_->configureSession_)
+        return false;
+
+    QVariantMap parameters;
+    parameters.insert("maxLatency", value);
+
+    QList<QVariant> argumentList;
+    argumentList << qVariantFromValue(pimpl_->sessionId_) << qVariantFromValue(parameters);
+
+    QDBusPendingReply <bool> returnValue = pimpl_->asyncCallWithArgumentList(QLatin1String("configureSession"), argumentList);
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(returnValue, this);
+    connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
+            SLOT(setMaxLatencyFinished(QDBusPendingCallWatcher*)));
+    return true;
+}
+
+void AbstractSensorChannelInterface::setMaxLatencyFinished(QDBusPendingCallWatcher *watch)
+{
+    watch->deleteLater();
+    QDBusPendingReply<bool> reply = *watch;
+
+    if(reply.isError()) {
+        qDebug() << reply.error().message();
+        setError(SaCannotAccessSensor, reply.error().message());
+    } else if (!reply.value()) {
+        setError(SaCannotAccessSensor, "maximum latency rejected");
+    }
+}
+
 void AbstractSensorChannelInterface::setDownsamplingFinished(QDBusPendingCallWatcher *watch)
 {
     watch->deleteLater();
@@ -58,6 +58,7 @@ class AbstractSensorChannelInterface : public QObject
     Q_PROPERTY(unsigned int bufferSize READ bufferSize WRITE setBufferSize)
     Q_PROPERTY(bool hwBuffering READ hwBuffering)
     Q_PROPERTY(bool downsampling READ downsampling WRITE setDownsampling)
+    Q_PROPERTY(unsigned int maxLatency READ maxLatency WRITE setMaxLatency)
 
 public:
 
@@ -214,6 +215,27 @@ public:
      */
     IntegerRangeList getAvailableBufferSizes();
 
+    /**
+     * Get maximum delivery latency while the display is off.
+     *
+     * @return latency in millisecs.
+     */
+    unsigned int maxLatency();
+
+    /**
+     * Set maximum delivery latency while the display is off. With
+     * standby-override enabled the sensor keeps sampling while the
+     * display is off, and a non-zero latency lets the daemon hold the
+     * samples back and deliver them in batches at most this late, or
+     * at once when the display turns on. Requires a daemon supporting
+     * session configuration.
+     *
+     * @param value latency in millisecs, 0 to deliver samples at once.
+     * @return was latency stored or sent. A rejection by sensord is
+     *         reported through the error state.
+     */
+    bool setMaxLatency(unsigned int value);
+
     /**
      * Textual description about sensor type.
      *
@@ -286,6 +308,19 @@ public:
      */
     bool hwBuffering();
 
+    /**
+     * Request recently measured samples. Samples are delivered through
+     * the data socket in chronological order, using the same signals as
+     * live data. Call blocks until the daemon has queued the samples, so
+     * requesting history before #start() guarantees it arrives ahead of
+     * any live data. Sensor daemon only keeps history for channels
+     * configured with <tt>&lt;sensor id&gt;/history_seconds</tt>.
+     *
+     * @param seconds How many seconds of history to request.
+     * @return object from which the number of delivered samples can be seen.
+     */
+    QDBusReply<unsigned int> requestHistory(unsigned int seconds);
+
     /**
      * Does the current instance have valid connection established
      * to sensor daemon.
@@ -363,13 +398,35 @@ private Q_SLOTS: // METHODS
     QDBusReply<void> setDownsampling(int sessionId, bool value);
 
     /**
-     * Start sensor for session.
+     * Start sensor for session. All locally stored settings are sent
+     * with a single configureSession call. Settings are sent one by one
+     * if sensord does not support it or rejects the combination. The
+     * call does not wait for sensord, failures are reported through the
+     * error state. If the data socket handshake is not done yet, the
+     * settings are sent once it is.
      *
      * @param sessionId session ID.
      * @return DBus reply.
      */
     QDBusReply<void> start(int sessionId);
 
+    /**
+     * Send the locally stored settings and start the session. Called
+     * from #start(int), or from #socketConnected() if the data socket
+     * handshake was not done yet.
+     *
+     * @param sessionId session ID.
+     */
+    void configureAndStart(int sessionId);
+
+    /**
+     * Start sensor for session with separate call for every setting.
+     *
+     * @param sessionId session ID.
+     * @return DBus reply.
+     */
+    QDBusPendingReply<void> startLegacy(int sessionId);
+
     /**
      * Stop sensor for session.
      *
@@ -394,7 +451,8 @@ protected:
     AbstractSensorChannelInterface(const QString& path, const char* interfaceName, int sessionId);
 
     /**
-     * Read data from socket into buffer.
+     * Read data from socket into buffer. Does not block, nothing is read
+     * unless the given amount of data has been received.
      *
      * @param buffer Pointer to buffer where to write.
      * @param size Number of bytes to read.
@@ -413,12 +471,19 @@ protected:
 
     /**
      * Callback for subclasses in which they must read their expected data
-     * from socket.
+     * from socket. Called until it returns false.
      *
-     * @return was read successful.
+     * @return was a frame read, false when no complete frame is left.
      */
     virtual bool dataReceivedImpl() = 0;
 
+    /**
+     * Callback for subclasses called once all data pending in the socket
+     * has been read, also after a failed read. Subclasses which collect
+     * samples in dataReceivedImpl() deliver them here as one batch.
+     */
+    virtual void flushSamples();
+
     /**
      * Utility for calling DBus methods from current connection which
      * return value and take no args.
@@ -477,6 +542,9 @@ protected slots:
     void setStandbyOverrideFinished(QDBusPendingCallWatcher *watch);
     void setDownsamplingFinished(QDBusPendingCallWatcher *watch);
     void setDataRangeIndexFinished(QDBusPendingCallWatcher *watch);
+    void configureSessionFinished(QDBusPendingCallWatcher *watch);
+    void setMaxLatencyFinished(QDBusPendingCallWatcher *watch);
+    void socketConnected();
 
 
 private:
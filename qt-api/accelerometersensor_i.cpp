@@ -62,25 +62,34 @@ AccelerometerSensorChannelInterface* AccelerometerSensorChannelInterface::interf
 
 bool AccelerometerSensorChannelInterface::dataReceivedImpl()
 {
-    QVector<AccelerationData> values;
-    if(!read<AccelerationData>(values))
+    int first = samples_.size();
+    if(!read<AccelerationData>(samples_))
         return false;
-    if(!frameAvailableConnected || values.size() == 1)
-    {
-        foreach(const AccelerationData& data, values)
-            emit dataAvailable(XYZ(data));
-    }
-    else
+    static const QMetaMethod dataAvailableSignal = QMetaMethod::fromSignal(&AccelerometerSensorChannelInterface::dataAvailable);
+    if(frameAvailableConnected && samples_.size() - first > 1)
     {
         QVector<XYZ> realValues;
-        realValues.reserve(values.size());
-        foreach(const AccelerationData& data, values)
-            realValues.push_back(XYZ(data));
+        realValues.reserve(samples_.size() - first);
+        for(int i = first; i < samples_.size(); ++i)
+            realValues.push_back(XYZ(samples_.at(i)));
         emit frameAvailable(realValues);
     }
+    else if(isSignalConnected(dataAvailableSignal))
+    {
+        for(int i = first; i < samples_.size(); ++i)
+            emit dataAvailable(XYZ(samples_.at(i)));
+    }
     return true;
 }
 
+void AccelerometerSensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 XYZ AccelerometerSensorChannelInterface::get()
 {
     return getAccessor<XYZ>("xyz");
@@ -64,14 +64,26 @@ ALSSensorChannelInterface* ALSSensorChannelInterface::interface(const QString& i
 
 bool ALSSensorChannelInterface::dataReceivedImpl()
 {
-    QVector<TimedUnsigned> values;
-    if(!read<TimedUnsigned>(values))
+    int first = samples_.size();
+    if(!read<TimedUnsigned>(samples_))
         return false;
-    foreach(const TimedUnsigned& data, values)
-        emit ALSChanged(data);
+    static const QMetaMethod changedSignal = QMetaMethod::fromSignal(&ALSSensorChannelInterface::ALSChanged);
+    if(isSignalConnected(changedSignal))
+    {
+        for(int i = first; i < samples_.size(); ++i)
+            emit ALSChanged(samples_.at(i));
+    }
     return true;
 }
 
+void ALSSensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 Unsigned ALSSensorChannelInterface::lux()
 {
     return getAccessor<Unsigned>("lux");
@@ -62,14 +62,26 @@ CompassSensorChannelInterface* CompassSensorChannelInterface::interface(const QS
 
 bool CompassSensorChannelInterface::dataReceivedImpl()
 {
-    QVector<CompassData> values;
-    if(!read<CompassData>(values))
+    int first = samples_.size();
+    if(!read<CompassData>(samples_))
         return false;
-    foreach(const CompassData& data, values)
-        emit dataAvailable(Compass(data, useDeclination_));
+    static const QMetaMethod dataAvailableSignal = QMetaMethod::fromSignal(&CompassSensorChannelInterface::dataAvailable);
+    if(isSignalConnected(dataAvailableSignal))
+    {
+        for(int i = first; i < samples_.size(); ++i)
+            emit dataAvailable(Compass(samples_.at(i), useDeclination_));
+    }
     return true;
 }
 
+void CompassSensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 Compass CompassSensorChannelInterface::get()
 {
     return Compass(getAccessor<Compass>("value").data(), useDeclination_);
@@ -125,8 +125,20 @@ public:
 
 protected:
     virtual bool dataReceivedImpl();
+    virtual void flushSamples();
+
+private:
+    QVector<CompassData> samples_; /**< samples of the current socket read */
 
 Q_SIGNALS:
+    /**
+     * Sent once per socket read with all samples received in it.
+     * Unlike the other signals this does not construct an object
+     * per sample.
+     *
+     * @param samples received samples, oldest first.
+     */
+    void samplesAvailable(const QVector<CompassData>& samples);
 
     /**
      * Sent when compass direction or calibration level has changed.
@@ -62,14 +62,26 @@ HumiditySensorChannelInterface* HumiditySensorChannelInterface::interface(const
 
 bool HumiditySensorChannelInterface::dataReceivedImpl()
 {
-    QVector<TimedUnsigned> values;
-    if(!read<TimedUnsigned>(values))
+    int first = samples_.size();
+    if(!read<TimedUnsigned>(samples_))
         return false;
-    foreach(const TimedUnsigned& data, values)
-        emit relativeHumidityChanged(data);
+    static const QMetaMethod changedSignal = QMetaMethod::fromSignal(&HumiditySensorChannelInterface::relativeHumidityChanged);
+    if(isSignalConnected(changedSignal))
+    {
+        for(int i = first; i < samples_.size(); ++i)
+            emit relativeHumidityChanged(samples_.at(i));
+    }
     return true;
 }
 
+void HumiditySensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 Unsigned HumiditySensorChannelInterface::relativeHumidity()
 {
     return getAccessor<Unsigned>("relativeHumidity");
@@ -101,8 +101,21 @@ public:
 
 protected:
     virtual bool dataReceivedImpl();
+    virtual void flushSamples();
+
+private:
+    QVector<TimedUnsigned> samples_; /**< samples of the current socket read */
 
 Q_SIGNALS:
+    /**
+     * Sent once per socket read with all samples received in it.
+     * Unlike the other signals this does not construct an object
+     * per sample.
+     *
+     * @param samples received samples, oldest first.
+     */
+    void samplesAvailable(const QVector<TimedUnsigned>& samples);
+
     /**
      * Sent when measured relative humidity has changed.
      *
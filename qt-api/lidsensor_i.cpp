@@ -62,14 +62,22 @@ LidSensorChannelInterface* LidSensorChannelInterface::interface(const QString& i
 
 bool LidSensorChannelInterface::dataReceivedImpl()
 {
-    QVector<LidData> values;
-    if (!read<LidData>(values))
+    int first = samples_.size();
+    if (!read<LidData>(samples_))
         return false;
-    foreach(const LidData &data, values)
-        emit lidChanged(data);
+    for (int i = first; i < samples_.size(); ++i)
+        emit lidChanged(samples_.at(i));
     return true;
 }
 
+void LidSensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 LidData LidSensorChannelInterface::closed()
 {
     return getAccessor<LidData>("closed");
@@ -64,25 +64,34 @@ MagnetometerSensorChannelInterface* MagnetometerSensorChannelInterface::interfac
 
 bool MagnetometerSensorChannelInterface::dataReceivedImpl()
 {
-    QVector<CalibratedMagneticFieldData> values;
-    if(!read<CalibratedMagneticFieldData>(values))
+    int first = samples_.size();
+    if(!read<CalibratedMagneticFieldData>(samples_))
         return false;
-    if(!frameAvailableConnected || values.size() == 1)
-    {
-        foreach(const CalibratedMagneticFieldData& data, values)
-            emit dataAvailable(MagneticField(data));
-    }
-    else
+    static const QMetaMethod dataAvailableSignal = QMetaMethod::fromSignal(&MagnetometerSensorChannelInterface::dataAvailable);
+    if(frameAvailableConnected && samples_.size() - first > 1)
     {
         QVector<MagneticField> realValues;
-        realValues.reserve(values.size());
-        foreach(const CalibratedMagneticFieldData& data, values)
-            realValues.push_back(MagneticField(data));
+        realValues.reserve(samples_.size() - first);
+        for(int i = first; i < samples_.size(); ++i)
+            realValues.push_back(MagneticField(samples_.at(i)));
         emit frameAvailable(realValues);
     }
+    else if(isSignalConnected(dataAvailableSignal))
+    {
+        for(int i = first; i < samples_.size(); ++i)
+            emit dataAvailable(MagneticField(samples_.at(i)));
+    }
     return true;
 }
 
+void MagnetometerSensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 void MagnetometerSensorChannelInterface::connectNotify(const QMetaMethod &signal)
 {
     static const QMetaMethod frameAvailableSignal = QMetaMethod::fromSignal(&MagnetometerSensorChannelInterface::frameAvailable);
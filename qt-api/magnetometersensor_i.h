@@ -102,6 +102,7 @@ public:
 protected:
     virtual void connectNotify(const QMetaMethod & signal);
     virtual bool dataReceivedImpl();
+    virtual void flushSamples();
 
 private:
     bool frameAvailableConnected; /**< has applicaiton connected slot for frameAvailable signal. */
@@ -114,7 +115,19 @@ public Q_SLOTS:
      */
     QDBusReply<void> reset();
 
+private:
+    QVector<CalibratedMagneticFieldData> samples_; /**< samples of the current socket read */
+
 Q_SIGNALS:
+    /**
+     * Sent once per socket read with all samples received in it.
+     * Unlike the other signals this does not construct an object
+     * per sample.
+     *
+     * @param samples received samples, oldest first.
+     */
+    void samplesAvailable(const QVector<CalibratedMagneticFieldData>& samples);
+
     /**
      * Sent when new measurement is available.
      *
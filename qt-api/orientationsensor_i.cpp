@@ -62,14 +62,26 @@ OrientationSensorChannelInterface* OrientationSensorChannelInterface::interface(
 
 bool OrientationSensorChannelInterface::dataReceivedImpl()
 {
-    QVector<TimedUnsigned> values;
-    if(!read<TimedUnsigned>(values))
+    int first = samples_.size();
+    if(!read<TimedUnsigned>(samples_))
         return false;
-    foreach(const TimedUnsigned& data, values)
-        emit orientationChanged(data);
+    static const QMetaMethod changedSignal = QMetaMethod::fromSignal(&OrientationSensorChannelInterface::orientationChanged);
+    if(isSignalConnected(changedSignal))
+    {
+        for(int i = first; i < samples_.size(); ++i)
+            emit orientationChanged(samples_.at(i));
+    }
     return true;
 }
 
+void OrientationSensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 Unsigned OrientationSensorChannelInterface::orientation()
 {
     return getAccessor<Unsigned>("orientation");
@@ -62,14 +62,26 @@ PressureSensorChannelInterface* PressureSensorChannelInterface::interface(const
 
 bool PressureSensorChannelInterface::dataReceivedImpl()
 {
-    QVector<TimedUnsigned> values;
-    if(!read<TimedUnsigned>(values))
+    int first = samples_.size();
+    if(!read<TimedUnsigned>(samples_))
         return false;
-    foreach(const TimedUnsigned& data, values)
-        emit pressureChanged(data);
+    static const QMetaMethod changedSignal = QMetaMethod::fromSignal(&PressureSensorChannelInterface::pressureChanged);
+    if(isSignalConnected(changedSignal))
+    {
+        for(int i = first; i < samples_.size(); ++i)
+            emit pressureChanged(samples_.at(i));
+    }
     return true;
 }
 
+void PressureSensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 Unsigned PressureSensorChannelInterface::pressure()
 {
     return getAccessor<Unsigned>("pressure");
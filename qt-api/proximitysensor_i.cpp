@@ -63,18 +63,31 @@ ProximitySensorChannelInterface* ProximitySensorChannelInterface::interface(cons
 
 bool ProximitySensorChannelInterface::dataReceivedImpl()
 {
-    QVector<ProximityData> values;
-    if(!read<ProximityData>(values))
+    int first = samples_.size();
+    if(!read<ProximityData>(samples_))
         return false;
-    foreach(const ProximityData& data, values)
+    static const QMetaMethod dataAvailableSignal = QMetaMethod::fromSignal(&ProximitySensorChannelInterface::dataAvailable);
+    static const QMetaMethod reflectanceSignal = QMetaMethod::fromSignal(&ProximitySensorChannelInterface::reflectanceDataAvailable);
+    if(isSignalConnected(dataAvailableSignal) || isSignalConnected(reflectanceSignal))
     {
-        Proximity proximity(data);
-        emit dataAvailable(proximity);
-        emit reflectanceDataAvailable(proximity);
+        for(int i = first; i < samples_.size(); ++i)
+        {
+            Proximity proximity(samples_.at(i));
+            emit dataAvailable(proximity);
+            emit reflectanceDataAvailable(proximity);
+        }
     }
     return true;
 }
 
+void ProximitySensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 Unsigned ProximitySensorChannelInterface::proximity()
 {
     return getAccessor<Unsigned>("proximity");
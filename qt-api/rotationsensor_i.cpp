@@ -63,25 +63,34 @@ RotationSensorChannelInterface* RotationSensorChannelInterface::interface(const
 
 bool RotationSensorChannelInterface::dataReceivedImpl()
 {
-    QVector<TimedXyzData> values;
-    if(!read<TimedXyzData>(values))
+    int first = samples_.size();
+    if(!read<TimedXyzData>(samples_))
         return false;
-    if(!frameAvailableConnected || values.size() == 1)
-    {
-        foreach(const TimedXyzData& data, values)
-            emit dataAvailable(XYZ(data));
-    }
-    else
+    static const QMetaMethod dataAvailableSignal = QMetaMethod::fromSignal(&RotationSensorChannelInterface::dataAvailable);
+    if(frameAvailableConnected && samples_.size() - first > 1)
     {
         QVector<XYZ> realValues;
-        realValues.reserve(values.size());
-        foreach(const TimedXyzData& data, values)
-            realValues.push_back(XYZ(data));
+        realValues.reserve(samples_.size() - first);
+        for(int i = first; i < samples_.size(); ++i)
+            realValues.push_back(XYZ(samples_.at(i)));
         emit frameAvailable(realValues);
     }
+    else if(isSignalConnected(dataAvailableSignal))
+    {
+        for(int i = first; i < samples_.size(); ++i)
+            emit dataAvailable(XYZ(samples_.at(i)));
+    }
     return true;
 }
 
+void RotationSensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 XYZ RotationSensorChannelInterface::rotation()
 {
     return getAccessor<XYZ>("rotation");
@@ -112,11 +112,22 @@ protected:
     virtual void connectNotify(const QMetaMethod &signal);
 
     virtual bool dataReceivedImpl();
+    virtual void flushSamples();
 
 private:
     bool frameAvailableConnected; /**< has applicaiton connected slot for frameAvailable signal. */
+    QVector<TimedXyzData> samples_; /**< samples of the current socket read */
 
 Q_SIGNALS:
+    /**
+     * Sent once per socket read with all samples received in it.
+     * Unlike the other signals this does not construct an object
+     * per sample.
+     *
+     * @param samples received samples, oldest first.
+     */
+    void samplesAvailable(const QVector<TimedXyzData>& samples);
+
     /**
      * Sent when device rotation has changed.
      *
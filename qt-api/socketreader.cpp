@@ -25,13 +25,19 @@
  */
 
 #include "socketreader.h"
+#include <QElapsedTimer>
 
 const char* SocketReader::channelIDString = "_SENSORCHANNEL_";
 
 SocketReader::SocketReader(QObject* parent) :
     QObject(parent),
     socket_(NULL),
-    tagRead_(false)
+    sessionId_(-1),
+    tagRead_(false),
+    handshaken_(false),
+    serverVersion_(0),
+    wireVersion_(0),
+    offset_(0)
 {
 }
 
@@ -57,6 +63,8 @@ bool SocketReader::initiateConnection(int sessionId)
         SOCKET_NAME = env;
     }
 
+    sessionId_ = sessionId;
+    connect(socket_, SIGNAL(readyRead()), this, SLOT(socketReadable()));
     socket_->connectToServer(SOCKET_NAME, QIODevice::ReadWrite);
 
     if (!(socket_->serverName().size())) {
@@ -64,11 +72,9 @@ bool SocketReader::initiateConnection(int sessionId)
         return false;
     }
 
-    if (socket_->write((const char*)&sessionId, sizeof(sessionId)) != sizeof(sessionId)) {
-        qDebug() << "[SOCKETREADER]: SessionId write failed: " << socket_->errorString();
-    }
-    socket_->flush();
-    readSocketTag();
+    // The daemon greets the connection as soon as it is accepted, the
+    // handshake is completed from socketReadable().
+    fill();
 
     return true;
 }
@@ -78,13 +84,16 @@ bool SocketReader::dropConnection()
     if (!socket_)
         return false;
 
-    socket_->disconnectFromServer();
-    if(socket_->state() != QLocalSocket::UnconnectedState)
-        socket_->waitForDisconnected();
+    socket_->abort();
     delete socket_;
     socket_ = NULL;
 
     tagRead_ = false;
+    handshaken_ = false;
+    serverVersion_ = 0;
+    wireVersion_ = 0;
+    buffer_.clear();
+    offset_ = 0;
 
     return true;
 }
@@ -94,37 +103,100 @@ QLocalSocket* SocketReader::socket()
     return socket_;
 }
 
-bool SocketReader::readSocketTag()
+void SocketReader::socketReadable()
 {
-    char foo;
-    socket_->waitForReadyRead();
-    tagRead_ = read(&foo, 1);
-    return true;
+    fill();
+}
+
+void SocketReader::fill()
+{
+    if (!socket_)
+        return;
+
+    // Drop consumed data before it is moved around by appending.
+    if (offset_ == buffer_.size()) {
+        buffer_.resize(0);
+        offset_ = 0;
+    } else if (offset_ > buffer_.size() / 2) {
+        buffer_.remove(0, offset_);
+        offset_ = 0;
+    }
+
+    qint64 available = socket_->bytesAvailable();
+    if (available > 0) {
+        int size = buffer_.size();
+        buffer_.resize(size + available);
+        qint64 bytes = socket_->read(buffer_.data() + size, available);
+        buffer_.resize(size + qMax(bytes, (qint64)0));
+    }
+
+    if (!tagRead_ && pending())
+        readSocketTag();
+}
+
+void SocketReader::readSocketTag()
+{
+    uchar tag = *pendingData();
+    ++offset_;
+    tagRead_ = true;
+    if (tag >= WireFormat::TagBase)
+        serverVersion_ = tag - WireFormat::TagBase;
+
+    QByteArray handshake((const char*)&sessionId_, sizeof(sessionId_));
+    if (serverVersion_) {
+        quint32 hello[2] = { WireFormat::HelloMagic, WireFormat::Version };
+        handshake.append((const char*)hello, sizeof(hello));
+        wireVersion_ = qMin(serverVersion_, (int)WireFormat::Version);
+    }
+    if (socket_->write(handshake) != handshake.size()) {
+        qDebug() << "[SOCKETREADER]: SessionId write failed: " << socket_->errorString();
+        return;
+    }
+    socket_->flush();
+    handshaken_ = true;
+    emit connected();
+}
+
+void SocketReader::flush()
+{
+    buffer_.resize(0);
+    offset_ = 0;
+    socket_->readAll();
 }
 
 bool SocketReader::read(void* buffer, int size)
 {
-    int bytesRead = 0;
-    int retry = 100;
-    while(bytesRead < size)
-    {
-        int bytes = socket_->read((char *)buffer + bytesRead, size);
-        if(bytes == 0)
-        {
-            if(!retry)
-                return false;
-            struct timespec ts;
-            ts.tv_sec = 0;
-            ts.tv_nsec = 100000000;
-            nanosleep( &ts, NULL );
-            --retry;
-            continue;
-        }
-        if(bytes < 1)
-            return false;
-        bytesRead += bytes;
+    if (!socket_)
+        return false;
+    fill();
+    if (!tagRead_ || size <= 0 || pending() < size)
+        return false;
+    memcpy(buffer, pendingData(), size);
+    offset_ += size;
+    return true;
+}
+
+int SocketReader::wireVersion() const
+{
+    return wireVersion_;
+}
+
+bool SocketReader::isHandshaken() const
+{
+    return handshaken_;
+}
+
+bool SocketReader::waitForHandshake(int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (socket_ && !handshaken_) {
+        int remaining = msecs - (int)timer.elapsed();
+        if (remaining <= 0 || !socket_->waitForReadyRead(remaining))
+            break;
+        fill();
     }
-    return (bytesRead > 0);
+    return handshaken_;
 }
 
 bool SocketReader::isConnected()
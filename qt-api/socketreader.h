@@ -30,6 +30,10 @@
 #include <QObject>
 #include <QLocalSocket>
 #include <QVector>
+#include <QByteArray>
+#include <QDebug>
+#include <string.h>
+#include "datatypes/wireformat.h"
 
 /**
  * @brief Helper class for reading socket datachannel from sensord
@@ -58,7 +62,9 @@ public:
     ~SocketReader();
 
     /**
-     * Initiates new data socket connection.
+     * Initiates new data socket connection. The call does not wait for
+     * the daemon, the session ID is sent once the daemon has greeted
+     * the connection.
      *
      * @param sessionId ID for the current session.
      * @return was the connection established successfully.
@@ -80,10 +86,8 @@ public:
     QLocalSocket* socket();
 
     /**
-     * Attempt to read given number of bytes from the socket. As
-     * QLocalSocket is used, we are guaranteed that any number of bytes
-     * written in single operation are available for immediate reading
-     * with a single operation.
+     * Read given number of bytes from data received so far. The call
+     * does not block, nothing is consumed unless all bytes are there.
      *
      * @param size Number of bytes to read.
      * @param buffer Location for storing the data.
@@ -92,16 +96,24 @@ public:
     bool read(void* buffer, int size);
 
     /**
-     * Attempt to read objects from the sockets. The call blocks until
-     * there are minimum amount of expected bytes availabled in the socket.
+     * Read one frame of objects from data received so far. The call
+     * does not block, nothing is consumed until the whole frame has been
+     * received.
      *
      * @param values Vector to which objects will be appended.
      * @tparam T type of expected object in the stream.
-     * @return true if atleast one object was read.
+     * @return true if a frame was read.
      */
     template<typename T>
     bool read(QVector<T>& values);
 
+    /**
+     * Framing version used on the socket. See #WireFormat.
+     *
+     * @return negotiated version, 0 for the original stream.
+     */
+    int wireVersion() const;
+
     /**
      * Returns whether the socket is currently connected.
      *
@@ -109,6 +121,35 @@ public:
      */
     bool isConnected();
 
+    /**
+     * Has the session ID been sent to the daemon. Until then the daemon
+     * does not know the socket of the session, so requests using it
+     * have to wait for #connected().
+     *
+     * @return is the handshake written.
+     */
+    bool isHandshaken() const;
+
+    /**
+     * Block until the handshake has been written.
+     *
+     * @param msecs how long to wait at most.
+     * @return is the handshake written.
+     */
+    bool waitForHandshake(int msecs);
+
+Q_SIGNALS:
+    /**
+     * Emitted once the session ID has been sent to the daemon.
+     */
+    void connected();
+
+private Q_SLOTS:
+    /**
+     * Move received data from the socket into the buffer.
+     */
+    void socketReadable();
+
 private:
     /**
      * Prefix text needed to be written to the sensor daemon socket connection
@@ -117,12 +158,52 @@ private:
     static const char* channelIDString;
 
     /**
-     * Reads initial magic byte from the fresh connection.
+     * Move data available in the socket to the buffer and complete the
+     * handshake once the greeting of the daemon has arrived.
+     */
+    void fill();
+
+    /**
+     * Consume the initial magic byte and answer with the session ID. The
+     * byte tells which framing versions the daemon supports.
+     */
+    void readSocketTag();
+
+    /**
+     * Discard everything received so far.
+     */
+    void flush();
+
+    /**
+     * @return number of buffered bytes not yet consumed.
+     */
+    int pending() const { return buffer_.size() - offset_; }
+
+    /**
+     * @return first buffered byte not yet consumed.
+     */
+    const char* pendingData() const { return buffer_.constData() + offset_; }
+
+    /**
+     * Read one frame of the original stream.
+     */
+    template<typename T>
+    bool readPlainFrame(QVector<T>& values);
+
+    /**
+     * Read one frame of the versioned framing.
      */
-    bool readSocketTag();
+    template<typename T>
+    bool readFrame(QVector<T>& values);
 
     QLocalSocket* socket_; /**< socket data connection to sensord */
+    int sessionId_; /**< session ID sent in the handshake */
     bool tagRead_; /**< is initial magic byte read from the socket */
+    bool handshaken_; /**< is session ID written to the socket */
+    int serverVersion_; /**< highest framing version of the daemon */
+    int wireVersion_; /**< negotiated framing version */
+    QByteArray buffer_; /**< received data */
+    int offset_; /**< consumed bytes at the start of buffer_ */
 };
 
 template<typename T>
@@ -132,25 +213,67 @@ bool SocketReader::read(QVector<T>& values)
         return false;
     }
 
+    fill();
+    if (!tagRead_) {
+        return false;
+    }
+    if (wireVersion_) {
+        return readFrame(values);
+    }
+    return readPlainFrame(values);
+}
+
+template<typename T>
+bool SocketReader::readPlainFrame(QVector<T>& values)
+{
     unsigned int count;
-    if(!read((void*)&count, sizeof(unsigned int)))
+    if(pending() < (int)sizeof(count))
+        return false;
+    memcpy(&count, pendingData(), sizeof(count));
+    if(count > WireFormat::MaxFrameSamples)
     {
-        socket_->readAll();
+        qWarning() << "Too many samples waiting in socket. Flushing it to empty";
+        flush();
         return false;
     }
-    if(count > 1000)
+    int size = sizeof(T) * count;
+    if(pending() < (int)sizeof(count) + size)
+        return false;
+    offset_ += sizeof(count);
+    int offset = values.size();
+    values.resize(offset + count);
+    memcpy((void*)(values.data() + offset), pendingData(), size);
+    offset_ += size;
+    return true;
+}
+
+template<typename T>
+bool SocketReader::readFrame(QVector<T>& values)
+{
+    WireFormat::Header frame;
+    if(pending() < WireFormat::HeaderSize)
+        return false;
+    if(!WireFormat::parseHeader(pendingData(), frame))
     {
-        qWarning() << "Too many samples waiting in socket. Flushing it to empty";
-        socket_->readAll();
+        qWarning() << "Invalid frame in socket. Flushing it to empty";
+        flush();
         return false;
     }
-    values.resize(values.size() + count);
-    if(!read((void*)values.data(), sizeof(T) * count))
+    int size = frame.count * frame.sampleSize;
+    if(pending() < WireFormat::HeaderSize + size)
+        return false;
+    offset_ += WireFormat::HeaderSize;
+    int offset = values.size();
+    values.resize(offset + frame.count);
+    if(!WireFormat::decode(frame, pendingData(), values.data() + offset))
     {
-        qWarning() << "Error occured while reading data from socket: " << socket_->errorString();
-        socket_->readAll();
+        qWarning() << "Received samples of layout" << frame.layout << "and size" << frame.sampleSize
+                   << "do not match the expected type. Flushing socket to empty";
+        values.resize(offset);
+        flush();
         return false;
     }
+    offset_ += size;
     return true;
 }
 
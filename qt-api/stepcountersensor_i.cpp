@@ -66,14 +66,26 @@ StepCounterSensorChannelInterface* StepCounterSensorChannelInterface::interface(
 
 bool StepCounterSensorChannelInterface::dataReceivedImpl()
 {
-    QVector<TimedUnsigned> values;
-    if(!read<TimedUnsigned>(values))
+    int first = samples_.size();
+    if(!read<TimedUnsigned>(samples_))
         return false;
-    foreach(const TimedUnsigned& data, values)
-        emit StepCounterChanged(data);
+    static const QMetaMethod changedSignal = QMetaMethod::fromSignal(&StepCounterSensorChannelInterface::StepCounterChanged);
+    if(isSignalConnected(changedSignal))
+    {
+        for(int i = first; i < samples_.size(); ++i)
+            emit StepCounterChanged(samples_.at(i));
+    }
     return true;
 }
 
+void StepCounterSensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 Unsigned StepCounterSensorChannelInterface::steps()
 {
     return getAccessor<Unsigned>("steps");
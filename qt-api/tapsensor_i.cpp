@@ -66,10 +66,11 @@ TapSensorChannelInterface* TapSensorChannelInterface::interface(const QString& i
 
 bool TapSensorChannelInterface::dataReceivedImpl()
 {
-    QVector<TapData> values;
-    if(!read<TapData>(values))
+    int first = samples_.size();
+    if(!read<TapData>(samples_))
         return false;
-    foreach(TapData value, values) {
+    for(int i = first; i < samples_.size(); ++i) {
+        TapData value = samples_.at(i);
         if (type_ == Single) {
             emit dataAvailable(Tap(value));
         } else if (timer_->isActive()) {
@@ -92,6 +93,14 @@ bool TapSensorChannelInterface::dataReceivedImpl()
     return true;
 }
 
+void TapSensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 void TapSensorChannelInterface::setTapType(TapSelection type)
 {
     tapValues_.clear();
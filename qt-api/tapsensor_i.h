@@ -120,11 +120,25 @@ public:
 
 protected:
     virtual bool dataReceivedImpl();
+    virtual void flushSamples();
 
 private Q_SLOTS:
     void output();
 
+private:
+    QVector<TapData> samples_; /**< samples of the current socket read */
+
 Q_SIGNALS:
+    /**
+     * Sent once per socket read with all samples received in it.
+     * Unlike the other signals this does not construct an object
+     * per sample. Taps are reported as detected by the sensor, they
+     * are not combined according to tap type.
+     *
+     * @param samples received samples, oldest first.
+     */
+    void samplesAvailable(const QVector<TapData>& samples);
+
     /**
      * Sent when new tap event has occurred.
      *
@@ -62,14 +62,26 @@ TemperatureSensorChannelInterface* TemperatureSensorChannelInterface::interface(
 
 bool TemperatureSensorChannelInterface::dataReceivedImpl()
 {
-    QVector<TimedUnsigned> values;
-    if(!read<TimedUnsigned>(values))
+    int first = samples_.size();
+    if(!read<TimedUnsigned>(samples_))
         return false;
-    foreach(const TimedUnsigned& data, values)
-        emit temperatureChanged(data);
+    static const QMetaMethod changedSignal = QMetaMethod::fromSignal(&TemperatureSensorChannelInterface::temperatureChanged);
+    if(isSignalConnected(changedSignal))
+    {
+        for(int i = first; i < samples_.size(); ++i)
+            emit temperatureChanged(samples_.at(i));
+    }
     return true;
 }
 
+void TemperatureSensorChannelInterface::flushSamples()
+{
+    if(samples_.isEmpty())
+        return;
+    emit samplesAvailable(samples_);
+    samples_.resize(0);
+}
+
 Unsigned TemperatureSensorChannelInterface::temperature()
 {
     return getAccessor<Unsigned>("temperature");
@@ -137,6 +137,7 @@ systemctl daemon-reload || :
 %{_libdir}/libsensorclient-qt5.so.*
 %{_libdir}/libsensordatatypes-qt5.so.*
 %attr(755,root,root)%{_sbindir}/sensorfwd
+%attr(755,root,root)%{_bindir}/sensorfw-top
 %dir %{_libdir}/sensord-qt5
 %{_libdir}/sensord-qt5/*.so
 %{_libdir}/libsensorfw*.so.*
@@ -178,6 +179,7 @@ systemctl daemon-reload || :
 #%attr(755,root,root)%{_bindir}/sensorexternal-test
 %attr(755,root,root)%{_bindir}/sensorfilters-test
 %attr(755,root,root)%{_bindir}/sensormetadata-test
+%attr(755,root,root)%{_bindir}/sensorpipelinebenchmark-test
 %attr(755,root,root)%{_bindir}/sensorpowermanagement-test
 %attr(755,root,root)%{_bindir}/sensorstandbyoverride-test
 %attr(755,root,root)%{_bindir}/sensortestapp
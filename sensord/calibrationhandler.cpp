@@ -88,17 +88,22 @@ void CalibrationHandler::sampleReceived(const MagneticField& sample)
         m_level = sample.level();
         m_timer.start(m_calibTimeout);
     }
+
+    // Nothing to gain from running longer, e.g. calibration was restored
+    // from the state file.
+    if (m_sensor && m_level >= 3)
+    {
+        sensordLogD() << "Stopping magnetometer background calibration, fully calibrated.";
+        suspendCalibration();
+    }
 }
 
 void CalibrationHandler::stopCalibration()
 {
     if (m_sensor && m_timer.isActive())
     {
-        m_timer.stop();
-        m_sensor->setStandbyOverrideRequest(m_sessionId, false);
-        m_sensor->stop();
-        disconnect(m_sensor, SIGNAL(internalData(const MagneticField&)), this, SLOT(sampleReceived(const MagneticField&)));
         sensordLogD() << "Stopping magnetometer background calibration due to PSM on";
+        suspendCalibration();
     }
 }
 
@@ -107,12 +112,18 @@ void CalibrationHandler::calibrationTimeout()
     if (m_sensor)
     {
         sensordLogD() << "Stopping magnetometer background calibration due to timeout.";
-        m_sensor->setStandbyOverrideRequest(m_sessionId, false);
-        m_sensor->stop();
-        disconnect(m_sensor, SIGNAL(internalData(const MagneticField&)), this, SLOT(sampleReceived(const MagneticField&)));
+        suspendCalibration();
     }
 }
 
+void CalibrationHandler::suspendCalibration()
+{
+    m_timer.stop();
+    m_sensor->setStandbyOverrideRequest(m_sessionId, false);
+    m_sensor->stop();
+    disconnect(m_sensor, SIGNAL(internalData(const MagneticField&)), this, SLOT(sampleReceived(const MagneticField&)));
+}
+
 void CalibrationHandler::resumeCalibration()
 {
     sensordLogD() << "Resuming magnetometer background calibration";
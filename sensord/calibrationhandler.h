@@ -86,6 +86,12 @@ private slots:
     void calibrationTimeout();
 
 private:
+    /**
+     * Stop the calibration session and its timer. Caller checks that
+     * the sensor exists.
+     */
+    void suspendCalibration();
+
     static const QString       SENSOR_NAME;    /**< magnetometer sensor name */
 
     MagnetometerSensorChannel* m_sensor;       /**< magnetometer sensor channel */
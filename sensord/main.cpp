@@ -31,6 +31,7 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
 #include <QSocketNotifier>
+#include <QFile>
 
 #include <systemd/sd-daemon.h>
 
@@ -42,11 +43,16 @@
 #include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/resource.h>
 
 #include "config.h"
 #include "sensormanager.h"
 #include "sensormanager_a.h"
+#include "devicediscovery.h"
 #include "logging.h"
+#include "trace.h"
+#include "statistics.h"
+#include "startupprofile.h"
 #include "calibrationhandler.h"
 #include "parser.h"
 
@@ -71,6 +77,16 @@ static int normalizeLevel(QtMsgType type)
     }
 }
 
+/* Apply level to sensord logging before messages are formatted. */
+static void applyLogLevel()
+{
+    int level = normalizeLevel(logLevel);
+    QLoggingCategory::setFilterRules(QString("sensorfw.debug=%1\nsensorfw.info=%2\nsensorfw.warning=%3")
+                                     .arg(level <= normalizeLevel(QtDebugMsg) ? "true" : "false")
+                                     .arg(level <= normalizeLevel(QtInfoMsg) ? "true" : "false")
+                                     .arg(level <= normalizeLevel(QtWarningMsg) ? "true" : "false"));
+}
+
 static void messageOutput(QtMsgType type, const QMessageLogContext &context, const QString &str)
 {
     if (normalizeLevel(type) < normalizeLevel(logLevel))
@@ -86,10 +102,12 @@ void signalUSR1(int param)
     Q_UNUSED(param);
     if (logLevel != QtDebugMsg) {
         logLevel = QtDebugMsg;
+        applyLogLevel();
         sensordLogW() << "Debug logging enabled";
     }
     else {
         logLevel = QtWarningMsg;
+        applyLogLevel();
         sensordLogW() << "Debug logging disabled";
     }
 }
@@ -103,10 +121,27 @@ void signalUSR2(int param)
     output.append("Flushing sensord state");
     output.append(QString("  Logging level: %1").arg(logLevel));
     SensorManager::instance().printStatus(output);
+    StartupProfile::printStatus(output);
 
     foreach (const QString& line, output) {
         sensordLogW() << line.toLocal8Bit().data();
     }
+
+    QString graphPath = SensorFrameworkConfig::configuration()->value<QString>("global/graph_file", "/tmp/sensord-graph.dot");
+    QFile graphFile(graphPath);
+    if (graphFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        graphFile.write(SensorManager::instance().graph("dot").toUtf8());
+        sensordLogW() << "Wrote dataflow graph to" << graphPath;
+    } else {
+        sensordLogW() << "Failed to open graph file" << graphPath << ":" << graphFile.errorString();
+    }
+
+    if (Trace::enabled()) {
+        QString path = SensorFrameworkConfig::configuration()->value<QString>("global/trace_file", "/tmp/sensord.trace");
+        int records = Trace::dump(path);
+        if (records >= 0)
+            sensordLogW() << "Wrote" << records << "trace records to" << path;
+    }
 }
 
 void signalINT(int param)
@@ -200,6 +235,8 @@ int main(int argc, char *argv[])
 {
     previousMessageHandler = qInstallMessageHandler(messageOutput);
 
+    StartupProfile::start();
+
     QCoreApplication app(argc, argv);
     Parser parser(app.arguments());
 
@@ -212,6 +249,7 @@ int main(int argc, char *argv[])
     }
 
     logLevel = parser.getLogLevel();
+    applyLogLevel();
 
     const char* CONFIG_FILE_PATH = "/etc/sensorfw/sensord.conf";
     const char* CONFIG_DIR_PATH = "/etc/sensorfw/sensord.conf.d/";
@@ -247,6 +285,8 @@ int main(int argc, char *argv[])
         }
     }
 
+    StartupProfile::mark("config load");
+
     if (parser.createDaemon())
     {
         fflush(0);
@@ -263,15 +303,46 @@ int main(int argc, char *argv[])
         }
     }
 
+    // Every session holds a data socket, allow as many as the hard limit.
+    struct rlimit fileLimit;
+    if (getrlimit(RLIMIT_NOFILE, &fileLimit) == 0 && fileLimit.rlim_cur < fileLimit.rlim_max)
+    {
+        fileLimit.rlim_cur = fileLimit.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &fileLimit) != 0)
+            sensordLogW() << "Failed to raise open file limit: " << strerror(errno);
+    }
+
+    SensorFrameworkConfig::configuration()->watch();
+    Trace::setCapacity(SensorFrameworkConfig::configuration()->value<int>("global/trace_records", 0));
+    EdgeStats::setEnabled(SensorFrameworkConfig::configuration()->value<bool>("global/edge_stats", false));
+
+    // Probe devices once for all adaptors before any plugin is loaded.
+    DeviceDiscovery& discovery = DeviceDiscovery::instance();
+    discovery.scan();
+    discovery.startMonitor();
+    StartupProfile::mark("device discovery");
+
     SensorManager& sm = SensorManager::instance();
+    StartupProfile::mark("socket listen");
 
 #ifdef PROVIDE_CONTEXT_INFO
     if (parser.contextInfo())
     {
-        sensordLogD() << "Loading ContextSensor " << sm.loadPlugin("contextsensor");
-        sensordLogD() << "Loading ALSSensor " << sm.loadPlugin("alssensor");
+        // Context properties are not needed for the daemon to serve
+        // clients, so in lazy mode they are set up after it is ready.
+        if (SensorFrameworkConfig::configuration()->value<bool>("global/lazy_plugins", false))
+        {
+            sm.loadPluginLater("contextsensor");
+            sm.loadPluginLater("alssensor");
+        }
+        else
+        {
+            sensordLogD() << "Loading ContextSensor " << sm.loadPlugin("contextsensor");
+            sensordLogD() << "Loading ALSSensor " << sm.loadPlugin("alssensor");
+        }
     }
 #endif
+    StartupProfile::mark("plugins");
 
     if (parser.magnetometerCalibration())
     {
@@ -280,6 +351,7 @@ int main(int argc, char *argv[])
         QObject::connect(&sm, SIGNAL(resumeCalibration()), calibrationHandler_, SLOT(resumeCalibration()));
         QObject::connect(&sm, SIGNAL(stopCalibration()), calibrationHandler_, SLOT(stopCalibration()));
     }
+    StartupProfile::mark("calibration");
 
     if (!sm.registerService())
     {
@@ -287,6 +359,9 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    StartupProfile::mark("D-Bus registration");
+    StartupProfile::ready();
+
     if (parser.notifySystemd())
     {
         sd_notify(0, "READY=1");
@@ -21,6 +21,7 @@ SUBDIRS = datatypes \
           filters \
           sensors \
           sensord \
+          tools \
           qt-api \
           chains \
           tests \
@@ -50,7 +50,7 @@ AccelerometerSensorChannel::AccelerometerSensorChannel(const QString& id) :
     outputBuffer_ = new RingBuffer<AccelerationData>(1);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(accelerometerReader_, "accelerometer");
     filterBin_->add(outputBuffer_, "buffer");
@@ -60,7 +60,7 @@ AccelerometerSensorChannel::AccelerometerSensorChannel(const QString& id) :
     // Join datasources to the chain
     connectToSource(accelerometerChain_, "accelerometer", accelerometerReader_);
 
-    marshallingBin_ = new Bin;
+    marshallingBin_ = new Bin(id);
     marshallingBin_->add(this, "sensorchannel");
 
     outputBuffer_->join(this);
@@ -26,6 +26,7 @@
 #include "alssensor.h"
 
 #include "sensormanager.h"
+#include "sysfsadaptor.h"
 #include "bin.h"
 #include "bufferreader.h"
 #include "datatypes/orientation.h"
@@ -47,6 +48,8 @@ ALSSensorChannel::ALSSensorChannel(const QString& id) :
     SensorManager& sm = SensorManager::instance();
 
     alsAdaptor_ = sm.requestDeviceAdaptor("alsadaptor");
+    SysfsAdaptor* sysfsAdaptor = dynamic_cast<SysfsAdaptor*>(alsAdaptor_);
+    polled_ = sysfsAdaptor && sysfsAdaptor->mode() == SysfsAdaptor::IntervalMode;
     if (!alsAdaptor_) {
         setValid(false);
         return;
@@ -57,7 +60,7 @@ ALSSensorChannel::ALSSensorChannel(const QString& id) :
     outputBuffer_ = new RingBuffer<TimedUnsigned>(1);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(alsReader_, "als");
     filterBin_->add(outputBuffer_, "buffer");
@@ -67,7 +70,7 @@ ALSSensorChannel::ALSSensorChannel(const QString& id) :
     // Join datasources to the chain
     connectToSource(alsAdaptor_, "als", alsReader_);
 
-    marshallingBin_ = new Bin;
+    marshallingBin_ = new Bin(id);
     marshallingBin_->add(this, "sensorchannel");
 
     outputBuffer_->join(this);
@@ -110,6 +113,11 @@ ALSSensorChannel::~ALSSensorChannel()
     }
 }
 
+bool ALSSensorChannel::downsamplingSupported() const
+{
+    return polled_;
+}
+
 bool ALSSensorChannel::start()
 {
     sensordLogD() << "Starting ALSSensorChannel";
@@ -136,11 +144,9 @@ bool ALSSensorChannel::stop()
 
 void ALSSensorChannel::emitData(const TimedUnsigned& value)
 {
-    if (value.value_ != previousValue_.value_) {
-        previousValue_.value_ = value.value_;
-
-        writeToClients((const void*)(&value), sizeof(value));
-    }
+    bool changed = value.value_ != previousValue_.value_;
+    previousValue_.value_ = value.value_;
+    writeChangeToClients(value, changed);
 
 #ifdef PROVIDE_CONTEXT_INFO
     // Publish the new data via Context FW. Note that setting the same
@@ -75,6 +75,8 @@ public:
      */
     Unsigned lux() const { return previousValue_; }
 
+    virtual bool downsamplingSupported() const;
+
 public Q_SLOTS:
     bool start();
     bool stop();
@@ -95,6 +97,7 @@ private:
     Bin*                          filterBin_;
     Bin*                          marshallingBin_;
     DeviceAdaptor*                alsAdaptor_;
+    bool                          polled_;
     BufferReader<TimedUnsigned>*  alsReader_;
     RingBuffer<TimedUnsigned>*    outputBuffer_;
 
@@ -49,7 +49,7 @@ CompassSensorChannel::CompassSensorChannel(const QString& id) :
     outputBuffer_ = new RingBuffer<CompassData>(1);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(inputReader_, "input");
     filterBin_->add(outputBuffer_, "output");
@@ -59,7 +59,7 @@ CompassSensorChannel::CompassSensorChannel(const QString& id) :
 
     connectToSource(compassChain_, "truenorth", inputReader_);
 
-    marshallingBin_ = new Bin;
+    marshallingBin_ = new Bin(id);
     marshallingBin_->add(this, "sensorchannel");
 
     outputBuffer_->join(this);
@@ -119,5 +119,10 @@ bool CompassSensorChannel::stop()
 void CompassSensorChannel::emitData(const CompassData& value)
 {
     compassData = value;
-    writeToClients((const void*)(&value), sizeof(CompassData));
+    writeToClients(value);
+}
+
+bool CompassSensorChannel::downsamplingSupported() const
+{
+    return true;
 }
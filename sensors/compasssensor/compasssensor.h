@@ -68,6 +68,8 @@ public:
 
     Compass get() const { return compassData; }
 
+    virtual bool downsamplingSupported() const;
+
 public Q_SLOTS:
     bool start();
     bool stop();
@@ -23,64 +23,27 @@
 */
 
 #include "avgvarfilter.h"
-#include <QMutexLocker>
-#include <math.h>
 
 AvgVarFilter::AvgVarFilter(int size) :
     Filter<double, AvgVarFilter, QPair<double, double> >(this, &AvgVarFilter::interpret),
-    size(size), samplesReceived(0), current(0), samples(size), samplesSquared(size), sampleSum(0), sampleSquareSum(0)
-
+    stats(size)
 {
 }
 
 void AvgVarFilter::interpret(unsigned, const double* data)
 {
-    double avg,var;
-    {
-        QMutexLocker locker(&mutex);
-
-        // Ramp-up-phase:
-        if (samplesReceived < size) {
-            samples[samplesReceived] = *data;
-            samplesSquared[samplesReceived] = (*data)*(*data);
-            sampleSum += *data;
-            sampleSquareSum += (*data)*(*data);
-            ++samplesReceived;
-            return;
-        }
-
-        //qDebug() << "Data received on AvgVarFilter:" << *data;
-        //qDebug() << "Cur data:" << samples;
-
-        // Moving average & variance computations:
-        // Remove the oldest sample, replace with the new sample
-        sampleSum = sampleSum - samples[current] + *data;
-        sampleSquareSum = sampleSquareSum - samples[current] * samples[current] + (*data) * (*data);
+    stats.add(*data);
 
-        // Take the new value in
-        samples[current] = *data;
-        ++current;
-        if (current >= size) {
-            current = 0;
-        }
+    // Ramp-up-phase:
+    if (!stats.isFull())
+        return;
 
-        avg = sampleSum / size;
-        var = (size * sampleSquareSum - (sampleSum * sampleSum)) / (size * (size - 1));
-    }
-
-    //qDebug() << "Avg and var" << avg << var;
-
-    QPair<double, double> pair(avg, var);
+    QPair<double, double> pair(stats.mean(), stats.variance());
     source_.propagate(1, &pair);
 }
 
 // Start the ramp-up again
 void AvgVarFilter::reset()
 {
-    QMutexLocker locker(&mutex);
-
-    samplesReceived = 0;
-    current = 0;
-    sampleSum = 0;
-    sampleSquareSum = 0;
+    stats.reset();
 }
@@ -26,10 +26,9 @@
 #define AVGVARFILTER_H
 
 #include "filter.h"
+#include "windowstats.h"
 
 #include <QPair>
-#include <QVector>
-#include <QMutex>
 
 class AvgVarFilter : public QObject, public Filter<double, AvgVarFilter, QPair<double, double> >
 {
@@ -40,14 +39,7 @@ public:
     void reset();
 
 private:
-    int size;
-    int samplesReceived;
-    int current;
-    QVector<double> samples;
-    QVector<double> samplesSquared;
-    double sampleSum;
-    double sampleSquareSum;
-    QMutex mutex;
+    WindowStats<double> stats;
 
     void interpret(unsigned, const double* data);
 };
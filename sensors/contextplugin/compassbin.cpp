@@ -27,12 +27,14 @@
 #include "contextplugin.h"
 #include "sensormanager.h"
 
-CompassBin::CompassBin(ContextProvider::Service& s, bool pluginValid):
+CompassBin::CompassBin(ContextProvider::Service& s, ContextEngine& engine, bool pluginValid):
+    Bin("compassbin"),
     headingProperty(s, "Location.Heading"),
     compassChain(0),
     compassReader(10),
     headingFilter(&headingProperty),
-    sessionId(0)
+    engine(engine),
+    running(false)
 {
     if (pluginValid)
     {
@@ -50,16 +52,17 @@ CompassBin::CompassBin(ContextProvider::Service& s, bool pluginValid):
     }
 }
 
-CompassBin::~CompassBin() {}
+CompassBin::~CompassBin()
+{
+    stopRun();
+}
 
 void CompassBin::startRun()
 {
-    // Get unique sessionId for this Bin.
-    sessionId = SensorManager::instance().requestSensor("contextsensor");
-    if (sessionId == INVALID_SESSION)
-    {
-        sensordLogC() << "Failed to get unique id for compass info via context.";
-    }
+    if (running)
+        return;
+    running = true;
+    engine.acquire();
 
     compassChain = SensorManager::instance().requestChain("compasschain");
     if (!compassChain)
@@ -84,6 +87,10 @@ void CompassBin::startRun()
 
 void CompassBin::stopRun()
 {
+    if (!running)
+        return;
+    running = false;
+
     stop();
     if (compassChain) {
         compassChain->stop();
@@ -96,6 +103,5 @@ void CompassBin::stopRun()
         SensorManager::instance().releaseChain("compasschain");
         compassChain = NULL;
     }
-    SensorManager::instance().releaseSensor("contextsensor", sessionId);
-
+    engine.release();
 }
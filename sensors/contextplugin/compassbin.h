@@ -30,6 +30,7 @@
 #include "datatypes/orientationdata.h"
 
 #include "headingfilter.h"
+#include "contextengine.h"
 
 #include <ContextProvider>
 
@@ -40,7 +41,7 @@ class CompassBin : public QObject, Bin
     Q_OBJECT
 
 public:
-    CompassBin(ContextProvider::Service& service, bool pluginValid = true);
+    CompassBin(ContextProvider::Service& service, ContextEngine& engine, bool pluginValid = true);
     ~CompassBin();
 
 private Q_SLOTS:
@@ -54,7 +55,8 @@ private:
     BufferReader<CompassData> compassReader;
     HeadingFilter headingFilter;
 
-    int sessionId;
+    ContextEngine& engine;
+    bool running;
 };
 
 #endif
@@ -0,0 +1,201 @@
+/**
+   @file contextengine.cpp
+   @brief Shared scheduling of context properties
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+*/
+
+#include "contextengine.h"
+#include "sensormanager.h"
+#include "nodebase.h"
+#include "config.h"
+#include "logging.h"
+
+#include <QPair>
+
+#define DEFAULT_FAST_INTERVAL   250
+#define DEFAULT_SLOW_INTERVAL   1000
+#define DEFAULT_STABLE_VARIANCE 7.0
+/* Time the device has to stay stable before sampling slows down, ms. */
+#define BACKOFF_HOLD            5000
+/* Relative change of activity needed to speed sampling up again. */
+#define ACTIVITY_HYSTERESIS     0.1
+
+ContextEngine::ContextEngine() :
+    users_(0),
+    sessionId_(INVALID_SESSION),
+    lastChange_(0)
+{
+    loadSettings();
+    interval_ = fastInterval_;
+
+    clock_.start();
+    timer_.setSingleShot(true);
+    connect(&timer_, SIGNAL(timeout()), this, SLOT(timerTimeout()));
+    connect(SensorFrameworkConfig::configuration(), SIGNAL(changed()), this, SLOT(configurationChanged()));
+}
+
+void ContextEngine::loadSettings()
+{
+    SensorFrameworkConfig* config = SensorFrameworkConfig::configuration();
+    fastInterval_ = config->value("context/orientation_poll_interval", QVariant(DEFAULT_FAST_INTERVAL)).toUInt();
+    slowInterval_ = qMax(fastInterval_, config->value("context/slow_poll_interval", QVariant(DEFAULT_SLOW_INTERVAL)).toUInt());
+    stableVariance_ = config->value("context/stable_variance", QVariant(DEFAULT_STABLE_VARIANCE)).toDouble();
+    // Polling disabled by configuration is not adapted either.
+    if (!fastInterval_)
+        slowInterval_ = 0;
+}
+
+void ContextEngine::configurationChanged()
+{
+    loadSettings();
+    // Start over from the fast interval, adaptation slows it down again.
+    lastChange_ = clock_.elapsed();
+    if (interval_ != fastInterval_)
+        setInterval(fastInterval_);
+}
+
+ContextEngine::~ContextEngine()
+{
+    timer_.stop();
+}
+
+void ContextEngine::acquire()
+{
+    if (users_++)
+        return;
+
+    sessionId_ = SensorManager::instance().requestSensor("contextsensor");
+    if (sessionId_ == INVALID_SESSION)
+        sensordLogC() << "Failed to get unique id for context properties.";
+    interval_ = fastInterval_;
+    lastChange_ = clock_.elapsed();
+}
+
+void ContextEngine::release()
+{
+    if (!users_ || --users_)
+        return;
+
+    foreach (NodeBase* node, pacedNodes_)
+        node->removeIntervalRequest(sessionId_);
+    pacedNodes_.clear();
+    timeouts_.clear();
+    timer_.stop();
+    SensorManager::instance().releaseSensor("contextsensor", sessionId_);
+    sessionId_ = INVALID_SESSION;
+}
+
+void ContextEngine::addPacedNode(NodeBase* node)
+{
+    if (!node || pacedNodes_.contains(node))
+        return;
+    pacedNodes_.append(node);
+    node->setIntervalRequest(sessionId_, interval_);
+}
+
+void ContextEngine::removePacedNode(NodeBase* node)
+{
+    if (pacedNodes_.removeOne(node))
+        node->removeIntervalRequest(sessionId_);
+}
+
+void ContextEngine::reportActivity(double variance)
+{
+    // Posted from the data path, may arrive after the last release().
+    if (!users_)
+        return;
+
+    qint64 now = clock_.elapsed();
+    if (variance > stableVariance_ * (1 + ACTIVITY_HYSTERESIS)) {
+        lastChange_ = now;
+        if (interval_ != fastInterval_)
+            setInterval(fastInterval_);
+    } else if (variance < stableVariance_ && interval_ < slowInterval_ &&
+               now - lastChange_ >= BACKOFF_HOLD) {
+        lastChange_ = now;
+        setInterval(qMin(interval_ * 2, slowInterval_));
+    }
+}
+
+void ContextEngine::setInterval(unsigned int interval)
+{
+    sensordLogT() << "Context sampling interval" << interval_ << "->" << interval;
+    interval_ = interval;
+    foreach (NodeBase* node, pacedNodes_)
+        node->setIntervalRequest(sessionId_, interval_);
+}
+
+void ContextEngine::setTimeout(QObject* receiver, const QByteArray& member, int ms)
+{
+    if (!users_)
+        return;
+
+    Timeout timeout = { clock_.elapsed() + ms, member };
+    timeouts_.insert(receiver, timeout);
+
+    // Deadlines moving later are handled when the timer fires, so
+    // restarting a timeout for every sample does not touch the timer.
+    int remaining = timer_.isActive() ? timer_.remainingTime() : -1;
+    if (remaining < 0 || ms < remaining)
+        timer_.start(ms);
+}
+
+void ContextEngine::cancelTimeout(QObject* receiver)
+{
+    timeouts_.remove(receiver);
+    if (timeouts_.isEmpty())
+        timer_.stop();
+}
+
+void ContextEngine::timerTimeout()
+{
+    qint64 now = clock_.elapsed();
+    QList<QPair<QObject*, QByteArray> > expired;
+    for (QHash<QObject*, Timeout>::iterator it = timeouts_.begin(); it != timeouts_.end();) {
+        if (it.value().deadline <= now) {
+            expired.append(qMakePair(it.key(), it.value().member));
+            it = timeouts_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (int i = 0; i < expired.size(); ++i)
+        QMetaObject::invokeMethod(expired[i].first, expired[i].second.constData());
+
+    reschedule();
+}
+
+void ContextEngine::reschedule()
+{
+    if (timeouts_.isEmpty())
+        return;
+
+    qint64 next = -1;
+    foreach (const Timeout& timeout, timeouts_) {
+        if (next < 0 || timeout.deadline < next)
+            next = timeout.deadline;
+    }
+    timer_.start(qMax<qint64>(0, next - clock_.elapsed()));
+}
+
+void ContextEngine::publish(ContextProvider::Property* property, const QVariant& value)
+{
+    if (property->value() != value)
+        property->setValue(value);
+}
@@ -0,0 +1,154 @@
+/**
+   @file contextengine.h
+   @brief Shared scheduling of context properties
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+*/
+
+#ifndef CONTEXTENGINE_H
+#define CONTEXTENGINE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+#include <QList>
+#include <QVariant>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+#include <ContextProvider>
+
+class NodeBase;
+
+/*!
+
+    \class ContextEngine
+
+    \brief Runs the context property bins as one subscriber driven unit.
+
+    Bins acquire the engine when their properties get the first
+    subscriber and release it after the last one is gone. While acquired
+    the engine holds a single contextsensor session for all bins, paces
+    the sensors they read and runs their timeouts from one timer.
+
+    Sampling adapts to the stability of the device: the interval of the
+    paced nodes grows towards the slow interval while reported activity
+    stays low and drops back to the fast interval as soon as it rises.
+
+*/
+
+class ContextEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    ContextEngine();
+    ~ContextEngine();
+
+    /**
+     * Take the engine into use. The first user opens the session.
+     */
+    void acquire();
+
+    /**
+     * Stop using the engine. The last user closes the session.
+     */
+    void release();
+
+    /**
+     * Session shared by all bins, valid while acquired.
+     */
+    int sessionId() const { return sessionId_; }
+
+    /**
+     * Request the current interval from a node until it is removed.
+     */
+    void addPacedNode(NodeBase* node);
+
+    /**
+     * Stop pacing a node and remove its interval request.
+     */
+    void removePacedNode(NodeBase* node);
+
+    /**
+     * Report activity level of the device. Values below the stable
+     * threshold slow down sampling, values above it speed it up.
+     *
+     * Like the timeout methods this must run on the engine's thread.
+     * Filters call it from the adaptor thread with a queued
+     * QMetaObject::invokeMethod().
+     *
+     * @param variance variance of normalized acceleration.
+     */
+    Q_INVOKABLE void reportActivity(double variance);
+
+    /**
+     * Invoke a slot after a timeout. Setting the timeout again for the
+     * same receiver replaces the previous one, which is cheap enough to
+     * do for every sample.
+     *
+     * @param receiver object to call.
+     * @param member slot name without signature.
+     * @param ms timeout in milliseconds.
+     */
+    Q_INVOKABLE void setTimeout(QObject* receiver, const QByteArray& member, int ms);
+
+    /**
+     * Cancel the timeout of a receiver.
+     */
+    Q_INVOKABLE void cancelTimeout(QObject* receiver);
+
+    /**
+     * Current sampling interval in milliseconds.
+     */
+    unsigned int interval() const { return interval_; }
+
+    /**
+     * Set property value unless it already has the value, so
+     * subscribers are notified only of actual changes.
+     */
+    static void publish(ContextProvider::Property* property, const QVariant& value);
+
+private Q_SLOTS:
+    void timerTimeout();
+    void configurationChanged();
+
+private:
+    struct Timeout
+    {
+        qint64      deadline; /**< clock_ time to fire at, ms */
+        QByteArray  member;   /**< slot to invoke */
+    };
+
+    void loadSettings();
+    void setInterval(unsigned int interval);
+    void reschedule();
+
+    int                           users_;          /**< acquire count */
+    int                           sessionId_;      /**< shared session */
+    QList<NodeBase*>              pacedNodes_;     /**< nodes following interval_ */
+    unsigned int                  interval_;       /**< current interval, ms */
+    unsigned int                  fastInterval_;   /**< interval while active, ms */
+    unsigned int                  slowInterval_;   /**< longest interval while stable, ms */
+    double                        stableVariance_; /**< activity below this is stable */
+    qint64                        lastChange_;     /**< clock_ time interval_ was set, ms */
+    QHash<QObject*, Timeout>      timeouts_;       /**< pending timeouts */
+    QTimer                        timer_;          /**< the one timer of all bins */
+    QElapsedTimer                 clock_;          /**< time base of deadlines */
+};
+
+#endif
@@ -29,6 +29,7 @@
 #include "orientationbin.h"
 #include "compassbin.h"
 #include "stabilitybin.h"
+#include "contextengine.h"
 
 class ContextSensorChannel : public AbstractSensorChannel
 {
@@ -48,6 +49,7 @@ protected:
 
 private:
     ContextProvider::Service service;
+    ContextEngine engine;
     OrientationBin orientationBin;
     CompassBin* compassBin;
     StabilityBin stabilityBin;
@@ -23,6 +23,7 @@
 */
 
 #include "headingfilter.h"
+#include "contextengine.h"
 
 HeadingFilter::HeadingFilter(Property* headingProperty) :
     Filter<CompassData, HeadingFilter, CompassData>(this, &HeadingFilter::interpret),
@@ -32,6 +33,6 @@ HeadingFilter::HeadingFilter(Property* headingProperty) :
 
 void HeadingFilter::interpret(unsigned, const CompassData* data)
 {
-    headingProperty->setValue(data->degrees_);
+    ContextEngine::publish(headingProperty, data->degrees_);
     source_.propagate(1, data);
 }
@@ -26,19 +26,19 @@
 #include "orientationbin.h"
 #include "contextplugin.h"
 #include "sensormanager.h"
-#include "config.h"
 
-const int OrientationBin::POLL_INTERVAL = 250;
-
-OrientationBin::OrientationBin(ContextProvider::Service& s):
+OrientationBin::OrientationBin(ContextProvider::Service& s, ContextEngine& engine):
+    Bin("orientationbin"),
     topEdgeProperty(s, "Screen.TopEdge"),
     isCoveredProperty(s, "Screen.IsCovered"),
     isFlatProperty(s, "Position.IsFlat"),
     accelerometerReader(10),
     topEdgeReader(10),
     faceReader(10),
+    orientationChain(NULL),
     screenInterpreterFilter(&topEdgeProperty, &isCoveredProperty, &isFlatProperty),
-    sessionId(0)
+    engine(engine),
+    running(false)
 {
     add(&topEdgeReader, "topedge");
     add(&faceReader, "face");
@@ -68,12 +68,10 @@ OrientationBin::~OrientationBin()
 
 void OrientationBin::startRun()
 {
-    // Get unique sessionId for this Bin.
-    sessionId = SensorManager::instance().requestSensor("contextsensor");
-    if (sessionId == INVALID_SESSION)
-    {
-        sensordLogC() << "Failed to get unique id for orientation detection.";
-    }
+    if (running)
+        return;
+    running = true;
+    engine.acquire();
 
     orientationChain = SensorManager::instance().requestChain("orientationchain");
     if (!orientationChain)
@@ -101,15 +99,20 @@ void OrientationBin::startRun()
     start();
     orientationChain->start();
 
-    unsigned int pollInterval = SensorFrameworkConfig::configuration()->value("context/orientation_poll_interval", QVariant(POLL_INTERVAL)).toUInt();
-    orientationChain->setIntervalRequest(sessionId, pollInterval);
+    // Sampling follows the stability of the device.
+    engine.addPacedNode(orientationChain);
 }
 
 void OrientationBin::stopRun()
 {
+    if (!running)
+        return;
+    running = false;
+
     stop();
     if (orientationChain)
     {
+        engine.removePacedNode(orientationChain);
         orientationChain->stop();
 
         RingBufferBase* rb = orientationChain->findBuffer("topedge");
@@ -124,10 +127,10 @@ void OrientationBin::stopRun()
             rb->unjoin(&faceReader);
         }
 
-        orientationChain->removeSession(sessionId);
+        orientationChain->removeSession(engine.sessionId());
         SensorManager::instance().releaseChain("orientationchain");
         orientationChain = NULL;
     }
 
-    SensorManager::instance().releaseSensor("contextsensor", sessionId);
+    engine.release();
 }
@@ -33,6 +33,7 @@
 #include "posedata.h"
 
 #include "screeninterpreterfilter.h"
+#include "contextengine.h"
 
 #include <ContextProvider>
 
@@ -45,7 +46,7 @@ class OrientationBin : public QObject, Bin
     Q_OBJECT
 
 public:
-    OrientationBin(ContextProvider::Service& service);
+    OrientationBin(ContextProvider::Service& service, ContextEngine& engine);
     ~OrientationBin();
 
 private Q_SLOTS:
@@ -65,9 +66,8 @@ private:
     AbstractChain* orientationChain;
     ScreenInterpreterFilter screenInterpreterFilter;
 
-    int sessionId;
-
-    static const int POLL_INTERVAL;
+    ContextEngine& engine;
+    bool running;
 };
 
 #endif
@@ -24,6 +24,7 @@
 */
 
 #include "screeninterpreterfilter.h"
+#include "contextengine.h"
 #include "genericdata.h"
 #include "config.h"
 #include "logging.h"
@@ -99,7 +100,7 @@ void ScreenInterpreterFilter::provideScreenData(PoseData::Orientation orientatio
             break;
     }
 
-    topEdgeProperty->setValue(topEdge);
-    isCoveredProperty->setValue(isCovered);
-    isFlatProperty->setValue(isFlat);
+    ContextEngine::publish(topEdgeProperty, topEdge);
+    ContextEngine::publish(isCoveredProperty, isCovered);
+    ContextEngine::publish(isFlatProperty, isFlat);
 }
@@ -34,14 +34,17 @@ const int StabilityBin::STABILITY_THRESHOLD = 7;
 const int StabilityBin::UNSTABILITY_THRESHOLD = 300;
 const float StabilityBin::STABILITY_HYSTERESIS = 0.1;
 
-StabilityBin::StabilityBin(ContextProvider::Service& s):
+StabilityBin::StabilityBin(ContextProvider::Service& s, ContextEngine& engine):
+    Bin("stabilitybin"),
     isStableProperty(s, "Position.Stable"),
     isShakyProperty(s, "Position.Shaky"),
     accelerometerReader(10),
+    accelerometerAdaptor(NULL),
     cutterFilter(4.0),
     avgVarFilter(60),
-    stabilityFilter(&isStableProperty, &isShakyProperty, STABILITY_THRESHOLD, UNSTABILITY_THRESHOLD, STABILITY_HYSTERESIS),
-    sessionId(0)
+    stabilityFilter(&engine, &isStableProperty, &isShakyProperty, STABILITY_THRESHOLD, UNSTABILITY_THRESHOLD, STABILITY_HYSTERESIS),
+    engine(engine),
+    running(false)
 {
     add(&accelerometerReader, "accelerometer");
     add(&normalizerFilter, "normalizerfilter");
@@ -68,12 +71,10 @@ StabilityBin::~StabilityBin()
 
 void StabilityBin::startRun()
 {
-    // Get unique sessionId for this Bin.
-    sessionId = SensorManager::instance().requestSensor("contextsensor");
-    if (sessionId == INVALID_SESSION)
-    {
-        sensordLogC() << "Failed to get unique id for stability detection.";
-    }
+    if (running)
+        return;
+    running = true;
+    engine.acquire();
 
     accelerometerAdaptor = SensorManager::instance().requestDeviceAdaptor("accelerometeradaptor");
     if (!accelerometerAdaptor)
@@ -98,23 +99,32 @@ void StabilityBin::startRun()
     isShakyProperty.unsetValue();
     start();
     accelerometerAdaptor->startSensor();
-    accelerometerAdaptor->setStandbyOverrideRequest(sessionId, true);
+    accelerometerAdaptor->setStandbyOverrideRequest(engine.sessionId(), true);
+
+    // Sampling follows the stability this bin reports to the engine.
+    engine.addPacedNode(accelerometerAdaptor);
 }
 
 void StabilityBin::stopRun()
 {
+    if (!running)
+        return;
+    running = false;
+
     stop();
+    engine.cancelTimeout(&stabilityFilter);
     if (accelerometerAdaptor)
     {
+        engine.removePacedNode(accelerometerAdaptor);
         accelerometerAdaptor->stopSensor();
         RingBufferBase* rb = accelerometerAdaptor->findBuffer("accelerometer");
         if (rb)
         {
             rb->unjoin(&accelerometerReader);
         }
-        accelerometerAdaptor->removeSession(sessionId);
+        accelerometerAdaptor->removeSession(engine.sessionId());
         SensorManager::instance().releaseDeviceAdaptor("accelerometeradaptor");
         accelerometerAdaptor = NULL;
     }
-    SensorManager::instance().releaseSensor("contextsensor", sessionId);
+    engine.release();
 }
@@ -36,6 +36,7 @@
 #include "cutterfilter.h"
 #include "avgvarfilter.h"
 #include "stabilityfilter.h"
+#include "contextengine.h"
 
 #include <ContextProvider>
 
@@ -48,7 +49,7 @@ class StabilityBin : public QObject, Bin
     Q_OBJECT
 
 public:
-    StabilityBin(ContextProvider::Service& service);
+    StabilityBin(ContextProvider::Service& service, ContextEngine& engine);
     ~StabilityBin();
 
 private Q_SLOTS:
@@ -68,7 +69,8 @@ private:
     AvgVarFilter avgVarFilter;
     StabilityFilter stabilityFilter;
 
-    int sessionId;
+    ContextEngine& engine;
+    bool running;
 
     static const int STABILITY_THRESHOLD;
     static const int UNSTABILITY_THRESHOLD;
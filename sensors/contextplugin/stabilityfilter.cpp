@@ -28,42 +28,50 @@
 
 const int StabilityFilter::defaultTimeout = 60; // seconds
 
-StabilityFilter::StabilityFilter(Property* stableProperty, Property* unstableProperty,
+StabilityFilter::StabilityFilter(ContextEngine* engine, Property* stableProperty, Property* unstableProperty,
                                  double lowThreshold, double highThreshold, double hysteresis)
     : Filter<QPair<double, double>, StabilityFilter, QPair<double, double> >(this, &StabilityFilter::interpret),
       lowThreshold(lowThreshold),
       highThreshold(highThreshold),
       hysteresis(hysteresis),
+      engine(engine),
       stableProperty(stableProperty),
       unstableProperty(unstableProperty)
 {
-    connect(&timer, SIGNAL(timeout()), this, SLOT(timeoutTriggered()));
     timeout = SensorFrameworkConfig::configuration()->value("context/stability_timeout", QVariant(defaultTimeout)).toInt() * 1000;
 }
 
 void StabilityFilter::interpret(unsigned, const QPair<double, double>* data)
 {
+    // Runs on the adaptor thread, the engine's timer and interval
+    // requests belong to the main thread so calls to it are queued.
     // To take into account hysteresis and keep it simple, compute
     // stability and instability separately
     if (data->second < lowThreshold * (1 - hysteresis)) {
-        stableProperty->setValue(true);
-        timer.stop();
+        ContextEngine::publish(stableProperty, true);
+        QMetaObject::invokeMethod(engine, "cancelTimeout", Qt::QueuedConnection,
+                                  Q_ARG(QObject*, this));
     }
     else {
-        timer.start(timeout);
+        QMetaObject::invokeMethod(engine, "setTimeout", Qt::QueuedConnection,
+                                  Q_ARG(QObject*, this), Q_ARG(QByteArray, QByteArray("timeoutTriggered")),
+                                  Q_ARG(int, timeout));
 
         if (data->second > lowThreshold * (1 + hysteresis)) {
-            stableProperty->setValue(false);
+            ContextEngine::publish(stableProperty, false);
         }
     }
 
     if (data->second < highThreshold * (1 - hysteresis)) {
-        unstableProperty->setValue(false);
+        ContextEngine::publish(unstableProperty, false);
     }
     else if (data->second > highThreshold * (1 + hysteresis)) {
-        unstableProperty->setValue(true);
+        ContextEngine::publish(unstableProperty, true);
     }
 
+    QMetaObject::invokeMethod(engine, "reportActivity", Qt::QueuedConnection,
+                              Q_ARG(double, data->second));
+
     // Propagate the data further without changing it
     source_.propagate(1, data);
 }
@@ -72,6 +80,5 @@ void StabilityFilter::timeoutTriggered()
 {
     sensordLogT() << "Stationary timeout triggered.";
 
-    stableProperty->setValue(true);
-    timer.stop();
+    ContextEngine::publish(stableProperty, true);
 }
@@ -26,11 +26,11 @@
 #define STABILITYFILTER_H
 
 #include "filter.h"
+#include "contextengine.h"
 
 #include <ContextProvider>
 
 #include <QPair>
-#include <QTimer>
 
 /*!
 
@@ -41,7 +41,8 @@
     StabilityFilter computes the Orientation.IsStable property from a
     QPair<double, double> which contains the moving average and moving
     variance of the data. StabilityFilter pushes the data forward
-    unchanged.
+    unchanged. The variance is also reported to the ContextEngine,
+    which paces sampling by it and runs the stationary timeout.
 
 */
 
@@ -52,7 +53,7 @@ class StabilityFilter : public QObject, public Filter<QPair<double, double>, Sta
     Q_OBJECT
 
 public:
-    StabilityFilter(Property* stableProperty, Property* unstableProperty,
+    StabilityFilter(ContextEngine* engine, Property* stableProperty, Property* unstableProperty,
                     double lowThreshold, double highThreshold, double hysteresis = 0.0);
 
 public Q_SLOTS:
@@ -62,10 +63,10 @@ private:
     double lowThreshold;
     double highThreshold;
     double hysteresis;
+    ContextEngine* engine;
     Property* stableProperty;
     Property* unstableProperty;
     void interpret(unsigned, const QPair<double, double>* data);
-    QTimer timer;
 
     int timeout;
     static const int defaultTimeout;
@@ -48,7 +48,7 @@ GyroscopeSensorChannel::GyroscopeSensorChannel(const QString& id) :
     outputBuffer_ = new RingBuffer<TimedXyzData>(1);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
     filterBin_->add(gyroscopeReader_, "gyroscope");
     filterBin_->add(outputBuffer_, "output");
 
@@ -57,7 +57,7 @@ GyroscopeSensorChannel::GyroscopeSensorChannel(const QString& id) :
     // Join datasources to the chain
     connectToSource(gyroscopeAdaptor_, "gyroscope", gyroscopeReader_);
 
-    marshallingBin_ = new Bin;
+    marshallingBin_ = new Bin(id);
     marshallingBin_->add(this, "sensorchannel");
 
     outputBuffer_->join(this);
@@ -114,5 +114,10 @@ bool GyroscopeSensorChannel::stop()
 void GyroscopeSensorChannel::emitData(const TimedXyzData& value)
 {
     previousSample_ = value;
-    writeToClients((const void*)(&value), sizeof(TimedXyzData));
+    writeToClients(value);
+}
+
+bool GyroscopeSensorChannel::downsamplingSupported() const
+{
+    return true;
 }
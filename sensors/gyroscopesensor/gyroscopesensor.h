@@ -62,6 +62,8 @@ public:
 
     XYZ get() const { return previousSample_; }
 
+    virtual bool downsamplingSupported() const;
+
 public Q_SLOTS:
     bool start();
     bool stop();
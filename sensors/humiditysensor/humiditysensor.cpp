@@ -48,7 +48,7 @@ HumiditySensorChannel::HumiditySensorChannel(const QString& id) :
     outputBuffer_ = new RingBuffer<TimedUnsigned>(1);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(humidityReader_, "humidity");
     filterBin_->add(outputBuffer_, "buffer");
@@ -58,7 +58,7 @@ HumiditySensorChannel::HumiditySensorChannel(const QString& id) :
     // Join datasources to the chain
     connectToSource(humidityAdaptor_, "humidity", humidityReader_);
 
-    marshallingBin_ = new Bin;
+    marshallingBin_ = new Bin(id);
     marshallingBin_->add(this, "sensorchannel");
 
     outputBuffer_->join(this);
@@ -117,6 +117,6 @@ void HumiditySensorChannel::emitData(const TimedUnsigned& value)
     if (value.value_ != previousRelativeValue_.value_) {
         previousRelativeValue_.value_ = value.value_;
 
-        writeToClients((const void*)(&value), sizeof(value));
+        writeToClients(value);
     }
 }
@@ -63,7 +63,7 @@ MagnetometerSensorChannel::MagnetometerSensorChannel(const QString& id) :
     outputBuffer_ = new RingBuffer<CalibratedMagneticFieldData>(1);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(magnetometerReader_, "magnetometer");
     filterBin_->add(outputBuffer_, "buffer");
@@ -87,7 +87,7 @@ MagnetometerSensorChannel::MagnetometerSensorChannel(const QString& id) :
     // Join datasources to the chain
     connectToSource(magChain_, "calibratedmagnetometerdata", magnetometerReader_);
 
-    marshallingBin_ = new Bin;
+    marshallingBin_ = new Bin(id);
     marshallingBin_->add(this, "sensorchannel");
 
     outputBuffer_->join(this);
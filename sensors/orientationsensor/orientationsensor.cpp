@@ -49,7 +49,7 @@ OrientationSensorChannel::OrientationSensorChannel(const QString& id) :
     outputBuffer_ = new RingBuffer<PoseData>(1);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(orientationReader_, "orientation");
     filterBin_->add(outputBuffer_, "buffer");
@@ -60,7 +60,7 @@ OrientationSensorChannel::OrientationSensorChannel(const QString& id) :
     // Join datasources to the chain
     connectToSource(orientationChain_, "orientation", orientationReader_);
 
-    marshallingBin_ = new Bin;
+    marshallingBin_ = new Bin(id);
     marshallingBin_->add(this, "sensorchannel");
 
     outputBuffer_->join(this);
@@ -116,6 +116,6 @@ void OrientationSensorChannel::emitData(const PoseData& value)
     if ((value.orientation_ != prevOrientation.orientation_) &&
         (value.orientation_ != PoseData::Undefined) )  {
         prevOrientation.orientation_ = value.orientation_;
-        writeToClients((const void *)&value, sizeof(value));
+        writeToClients(value);
     }
 }
@@ -28,6 +28,7 @@
 #include "proximitysensor.h"
 
 #include "sensormanager.h"
+#include "sysfsadaptor.h"
 #include "bin.h"
 #include "bufferreader.h"
 
@@ -38,6 +39,8 @@ ProximitySensorChannel::ProximitySensorChannel(const QString& id) :
     SensorManager& sm = SensorManager::instance();
 
     proximityAdaptor_ = sm.requestDeviceAdaptor("proximityadaptor");
+    SysfsAdaptor* sysfsAdaptor = dynamic_cast<SysfsAdaptor*>(proximityAdaptor_);
+    polled_ = sysfsAdaptor && sysfsAdaptor->mode() == SysfsAdaptor::IntervalMode;
     if (!proximityAdaptor_ ) {
         setValid(false);
         return;
@@ -48,7 +51,7 @@ ProximitySensorChannel::ProximitySensorChannel(const QString& id) :
     outputBuffer_ = new RingBuffer<ProximityData>(1);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(proximityReader_, "proximity");
     filterBin_->add(outputBuffer_, "buffer");
@@ -58,7 +61,7 @@ ProximitySensorChannel::ProximitySensorChannel(const QString& id) :
     // Join datasources to the chain
     connectToSource(proximityAdaptor_, "proximity", proximityReader_);
 
-    marshallingBin_ = new Bin;
+    marshallingBin_ = new Bin(id);
     marshallingBin_->add(this, "sensorchannel");
 
     outputBuffer_->join(this);
@@ -87,6 +90,11 @@ ProximitySensorChannel::~ProximitySensorChannel()
     }
 }
 
+bool ProximitySensorChannel::downsamplingSupported() const
+{
+    return polled_;
+}
+
 bool ProximitySensorChannel::start()
 {
     sensordLogD() << "Starting ProximitySensorChannel";
@@ -115,11 +123,9 @@ void ProximitySensorChannel::emitData(const ProximityData& value)
 {
     previousValue_.timestamp_ = value.timestamp_;
 
-    if (value.value_ != previousValue_.value_ ||
-        value.withinProximity_ != previousValue_.withinProximity_)
-    {
-        previousValue_.value_ = value.value_;
-        previousValue_.withinProximity_ = value.withinProximity_;
-        writeToClients((const void *)&value, sizeof(ProximityData));
-    }
+    bool changed = value.value_ != previousValue_.value_ ||
+                   value.withinProximity_ != previousValue_.withinProximity_;
+    previousValue_.value_ = value.value_;
+    previousValue_.withinProximity_ = value.withinProximity_;
+    writeChangeToClients(value, changed);
 }
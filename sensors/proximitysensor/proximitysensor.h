@@ -71,6 +71,8 @@ public:
 
     Proximity proximityReflectance() const { return previousValue_; }
 
+    virtual bool downsamplingSupported() const;
+
 public Q_SLOTS:
     bool start();
     bool stop();
@@ -90,6 +92,7 @@ private:
     Bin*                         filterBin_;
     Bin*                         marshallingBin_;
     DeviceAdaptor*               proximityAdaptor_;
+    bool                         polled_;
     BufferReader<ProximityData>* proximityReader_;
     RingBuffer<ProximityData>*   outputBuffer_;
     ProximityData                previousValue_;
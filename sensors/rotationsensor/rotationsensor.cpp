@@ -64,7 +64,7 @@ RotationSensorChannel::RotationSensorChannel(const QString& id) :
     outputBuffer_ = new RingBuffer<TimedXyzData>(1);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(accelerometerReader_, "accelerometer");
     filterBin_->add(rotationFilter_, "rotationfilter");
@@ -87,7 +87,7 @@ RotationSensorChannel::RotationSensorChannel(const QString& id) :
         addStandbyOverrideSource(compassChain_);
     }
 
-    marshallingBin_ = new Bin;
+    marshallingBin_ = new Bin(id);
     marshallingBin_->add(this, "sensorchannel");
 
     outputBuffer_->join(this);
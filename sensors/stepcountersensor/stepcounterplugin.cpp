@@ -30,6 +30,7 @@
 #include "stepcountersensor.h"
 #include "sensormanager.h"
 #include "logging.h"
+#include "config.h"
 
 void StepCounterPlugin::Register(class Loader&)
 {
@@ -45,5 +46,10 @@ void StepCounterPlugin::Init(class Loader& l)
 }
 
 QStringList StepCounterPlugin::Dependencies() {
-    return QString("stepcounteradaptor").split(":", QString::SkipEmptyParts);
+    QByteArray stepcounterConfiguration = SensorFrameworkConfig::configuration()->value("plugins/stepcounteradaptor").toByteArray();
+    if (stepcounterConfiguration.isEmpty()) {
+        return QString("stepdetectorchain").split(":", QString::SkipEmptyParts);
+    } else {
+        return QString("stepcounteradaptor").split(":", QString::SkipEmptyParts);
+    }
 }
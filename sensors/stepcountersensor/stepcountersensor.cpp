@@ -30,17 +30,33 @@
 #include "sensormanager.h"
 #include "bin.h"
 #include "bufferreader.h"
+#include "abstractchain.h"
 #include "datatypes/orientation.h"
 
 StepCounterSensorChannel::StepCounterSensorChannel(const QString& id) :
         AbstractSensorChannel(id),
         DataEmitter<TimedUnsigned>(1),
-        previousValue_(0,0)
+        previousValue_(0,0),
+        stepcounterAdaptor_(NULL),
+        stepdetectorChain_(NULL)
 {
     SensorManager& sm = SensorManager::instance();
 
-    stepcounterAdaptor_ = sm.requestDeviceAdaptor("stepcounteradaptor");
-    if (!stepcounterAdaptor_) {
+    // Without a hardware step counter steps are detected from the
+    // accelerometer, shared by all sessions.
+    NodeBase* source;
+    if (sm.getAdaptorTypes().contains("stepcounteradaptor")) {
+        stepcounterAdaptor_ = sm.requestDeviceAdaptor("stepcounteradaptor");
+        source = stepcounterAdaptor_;
+    } else {
+        stepdetectorChain_ = sm.requestChain("stepdetectorchain");
+        source = stepdetectorChain_;
+    }
+    if (!source || !source->isValid()) {
+        if (stepcounterAdaptor_)
+            sm.releaseDeviceAdaptor("stepcounteradaptor");
+        if (stepdetectorChain_)
+            sm.releaseChain("stepdetectorchain");
         setValid(false);
         return;
     }
@@ -50,7 +66,7 @@ StepCounterSensorChannel::StepCounterSensorChannel(const QString& id) :
     outputBuffer_ = new RingBuffer<TimedUnsigned>(1);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(stepcounterReader_, "stepcounter");
     filterBin_->add(outputBuffer_, "buffer");
@@ -58,17 +74,20 @@ StepCounterSensorChannel::StepCounterSensorChannel(const QString& id) :
     filterBin_->join("stepcounter", "source", "buffer", "sink");
 
     // Join datasources to the chain
-    connectToSource(stepcounterAdaptor_, "stepcounter", stepcounterReader_);
+    connectToSource(source, "stepcounter", stepcounterReader_);
 
-    marshallingBin_ = new Bin;
+    marshallingBin_ = new Bin(id);
     marshallingBin_->add(this, "sensorchannel");
 
     outputBuffer_->join(this);
 
-    setDescription("steps since boot");
-    setRangeSource(stepcounterAdaptor_);
-    addStandbyOverrideSource(stepcounterAdaptor_);
-    setIntervalSource(stepcounterAdaptor_);
+    if (stepcounterAdaptor_)
+        setDescription("steps since boot");
+    else
+        setDescription("steps since sensord started");
+    setRangeSource(source);
+    addStandbyOverrideSource(source);
+    setIntervalSource(source);
 
     setValid(true);
 }
@@ -78,9 +97,13 @@ StepCounterSensorChannel::~StepCounterSensorChannel()
     if (isValid()) {
         SensorManager& sm = SensorManager::instance();
 
-        disconnectFromSource(stepcounterAdaptor_, "stepcounter", stepcounterReader_);
-
-        sm.releaseDeviceAdaptor("stepcounteradaptor");
+        if (stepcounterAdaptor_) {
+            disconnectFromSource(stepcounterAdaptor_, "stepcounter", stepcounterReader_);
+            sm.releaseDeviceAdaptor("stepcounteradaptor");
+        } else {
+            disconnectFromSource(stepdetectorChain_, "stepcounter", stepcounterReader_);
+            sm.releaseChain("stepdetectorchain");
+        }
 
         delete stepcounterReader_;
         delete outputBuffer_;
@@ -96,7 +119,10 @@ bool StepCounterSensorChannel::start()
     if (AbstractSensorChannel::start()) {
         marshallingBin_->start();
         filterBin_->start();
-        stepcounterAdaptor_->startSensor();
+        if (stepcounterAdaptor_)
+            stepcounterAdaptor_->startSensor();
+        else
+            stepdetectorChain_->start();
     }
     return true;
 }
@@ -106,7 +132,10 @@ bool StepCounterSensorChannel::stop()
     sensordLogD() << "Stopping StepCounterSensorChannel";
 
     if (AbstractSensorChannel::stop()) {
-        stepcounterAdaptor_->stopSensor();
+        if (stepcounterAdaptor_)
+            stepcounterAdaptor_->stopSensor();
+        else
+            stepdetectorChain_->stop();
         filterBin_->stop();
         marshallingBin_->stop();
     }
@@ -118,6 +147,6 @@ void StepCounterSensorChannel::emitData(const TimedUnsigned& value)
     if (value.value_ != previousValue_.value_) {
         previousValue_.value_ = value.value_;
 
-        writeToClients((const void*)(&value), sizeof(value));
+        writeToClients(value);
     }
 }
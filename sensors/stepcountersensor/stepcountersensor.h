@@ -38,11 +38,14 @@
 #include "datatypes/unsigned.h"
 
 class Bin;
+class AbstractChain;
 template <class TYPE> class BufferReader;
 class FilterBase;
 
 /**
  * @brief Sensor for accessing the internal step counter sensor measurements.
+ * Steps are counted from the accelerometer by #StepDetectorChain when
+ * there is no step counter adaptor.
  *
  * Signals listeners whenever observed steps count changed.
  */
@@ -92,6 +95,7 @@ private:
     Bin*                          filterBin_;
     Bin*                          marshallingBin_;
     DeviceAdaptor*                stepcounterAdaptor_;
+    AbstractChain*                stepdetectorChain_;
     BufferReader<TimedUnsigned>*  stepcounterReader_;
     RingBuffer<TimedUnsigned>*    outputBuffer_;
 
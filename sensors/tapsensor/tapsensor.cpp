@@ -47,7 +47,7 @@ TapSensorChannel::TapSensorChannel(const QString& id) :
     outputBuffer_ = new RingBuffer<TapData>(1);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(tapReader_, "tap");
     filterBin_->add(outputBuffer_, "buffer");
@@ -57,7 +57,7 @@ TapSensorChannel::TapSensorChannel(const QString& id) :
     // Join datasources to the chain
     connectToSource(tapAdaptor_, "tap", tapReader_);
 
-    marshallingBin_ = new Bin;
+    marshallingBin_ = new Bin(id);
     marshallingBin_->add(this, "sensorchannel");
 
     outputBuffer_->join(this);
@@ -113,5 +113,5 @@ bool TapSensorChannel::stop()
 
 void TapSensorChannel::emitData(const TapData& tapData)
 {
-    writeToClients((const void *)&tapData, sizeof(TapData));
+    writeToClients(tapData);
 }
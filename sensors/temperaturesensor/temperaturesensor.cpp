@@ -48,7 +48,7 @@ TemperatureSensorChannel::TemperatureSensorChannel(const QString& id) :
     outputBuffer_ = new RingBuffer<TimedUnsigned>(1);
 
     // Create buffers for filter chain
-    filterBin_ = new Bin;
+    filterBin_ = new Bin(id);
 
     filterBin_->add(temperatureReader_, "temperature");
     filterBin_->add(outputBuffer_, "buffer");
@@ -58,7 +58,7 @@ TemperatureSensorChannel::TemperatureSensorChannel(const QString& id) :
     // Join datasources to the chain
     connectToSource(temperatureAdaptor_, "temperature", temperatureReader_);
 
-    marshallingBin_ = new Bin;
+    marshallingBin_ = new Bin(id);
     marshallingBin_->add(this, "sensorchannel");
 
     outputBuffer_->join(this);
@@ -116,6 +116,6 @@ void TemperatureSensorChannel::emitData(const TimedUnsigned& value)
     if (value.value_ != previousValue_.value_) {
         previousValue_.value_ = value.value_;
 
-        writeToClients((const void*)(&value), sizeof(value));
+        writeToClients(value);
     }
 }
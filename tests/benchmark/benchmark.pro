@@ -1,2 +1,2 @@
 TEMPLATE = subdirs
-SUBDIRS = benchmarktest fakeadaptor dummyclient
+SUBDIRS = benchmarktest fakeadaptor dummyclient pipelinebench
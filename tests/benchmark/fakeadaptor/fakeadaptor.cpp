@@ -27,14 +27,78 @@
 #include <QFile>
 #include "fakeadaptor.h"
 #include <errno.h>
+#include <time.h>
+#include <math.h>
 #include "datatypes/utils.h"
 
-FakeAdaptor::FakeAdaptor(const QString& id) : DeviceAdaptor(id), interval_(1)
+QStringList FakeAdaptor::fakeableAdaptors()
+{
+    return QStringList() << "alsadaptor" << "humidityadaptor" << "pressureadaptor"
+                         << "temperatureadaptor" << "stepcounteradaptor"
+                         << "accelerometeradaptor" << "gyroscopeadaptor"
+                         << "magnetometeradaptor" << "proximityadaptor"
+                         << "lidsensoradaptor" << "tapadaptor";
+}
+
+FakeAdaptor::FakeAdaptor(const QString& id) :
+    DeviceAdaptor(id),
+    interval_(1000),
+    burst_(1),
+    type_(Unsigned),
+    starts_(0),
+    generated_(0),
+    unsignedBuffer_(0),
+    xyzBuffer_(0),
+    magneticFieldBuffer_(0),
+    proximityBuffer_(0),
+    lidBuffer_(0),
+    tapBuffer_(0)
 {
     t = new FakeAdaptorThread(this);
 
-    buffer_ = new DeviceAdaptorRingBuffer<TimedUnsigned>(1024);
-    setAdaptedSensor("als", "Internal ambient light sensor lux values", buffer_);
+    QString name(id);
+    if (name.endsWith("adaptor"))
+        name.chop(7);
+    QString description = QString("Fake %1 values").arg(name);
+
+    if (name == "accelerometer" || name == "gyroscope") {
+        type_ = Xyz;
+        xyzBuffer_ = new DeviceAdaptorRingBuffer<TimedXyzData>(1024);
+        setAdaptedSensor(name, description, xyzBuffer_);
+    } else if (name == "magnetometer") {
+        type_ = MagneticField;
+        magneticFieldBuffer_ = new DeviceAdaptorRingBuffer<CalibratedMagneticFieldData>(1024);
+        setAdaptedSensor(name, description, magneticFieldBuffer_);
+    } else if (name == "proximity") {
+        type_ = Proximity;
+        proximityBuffer_ = new DeviceAdaptorRingBuffer<ProximityData>(1024);
+        setAdaptedSensor(name, description, proximityBuffer_);
+    } else if (name == "lidsensor") {
+        type_ = Lid;
+        lidBuffer_ = new DeviceAdaptorRingBuffer<LidData>(1024);
+        setAdaptedSensor(name, description, lidBuffer_);
+    } else if (name == "tap") {
+        type_ = Tap;
+        tapBuffer_ = new DeviceAdaptorRingBuffer<TapData>(1024);
+        setAdaptedSensor(name, description, tapBuffer_);
+    } else {
+        // als and the other single value adaptors
+        unsignedBuffer_ = new DeviceAdaptorRingBuffer<TimedUnsigned>(1024);
+        setAdaptedSensor(name, description, unsignedBuffer_);
+    }
+}
+
+FakeAdaptor::~FakeAdaptor()
+{
+    t->running = false;
+    t->wait();
+    delete t;
+    delete unsignedBuffer_;
+    delete xyzBuffer_;
+    delete magneticFieldBuffer_;
+    delete proximityBuffer_;
+    delete lidBuffer_;
+    delete tapBuffer_;
 }
 
 bool FakeAdaptor::startAdaptor()
@@ -42,15 +106,16 @@ bool FakeAdaptor::startAdaptor()
     QFile file("/tmp/sensorTestSampleRate");
 
     if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
-        qDebug() << "Failed to get rate from" << file.fileName() << "- using 1000Hz (open)";
+        qDebug() << "Failed to get rate from" << file.fileName() << "- using" << 1000000 / interval_ << "Hz (open)";
         return true;
     }
 
-    interval_ = atoi(file.readLine().data());
-    if (interval_ <= 0) {
-        qDebug() << "Failed to get rate from" << file.fileName() << "- using 1000Hz (readline)";
+    int interval = atoi(file.readLine().data());
+    if (interval <= 0) {
+        qDebug() << "Failed to get rate from" << file.fileName() << "- using" << 1000000 / interval_ << "Hz (readline)";
         return true;
     }
+    interval_ = interval * 1000;
 
     file.close();
     return true;
@@ -62,7 +127,10 @@ void FakeAdaptor::stopAdaptor()
 
 bool FakeAdaptor::startSensor()
 {
-    qDebug() << "Pushing fake ALS data with" << interval_ << " msec interval";
+    if (starts_++)
+        return true;
+
+    qDebug() << "Pushing fake" << id() << "data in bursts of" << burst_ << "with" << interval_ << "usec interval";
     // Start pushing data
     t->running = true;
     t->start();
@@ -71,22 +139,99 @@ bool FakeAdaptor::startSensor()
 
 void FakeAdaptor::stopSensor()
 {
+    if (!starts_ || --starts_)
+        return;
+
     // Stop pushing data
     t->running = false;
     t->wait();
     qDebug() << "sensor stopped";
 }
 
+void FakeAdaptor::setRate(unsigned int rate)
+{
+    if (rate)
+        interval_ = 1000000 / rate;
+}
 
-void FakeAdaptor::pushNewData(int& data)
+void FakeAdaptor::setBurst(unsigned int burst)
 {
-    TimedUnsigned* lux = buffer_->nextSlot();
+    if (burst)
+        burst_ = burst;
+}
 
-    lux->timestamp_ = Utils::getTimeStamp();
-    lux->value_ = data;
+int FakeAdaptor::generated() const
+{
+    return generated_.load();
+}
+
+void FakeAdaptor::pushSample(int data, quint64 timestamp)
+{
+    // Rotate the vector types so that orientation and compass
+    // outputs keep changing too.
+    float angle = (data % 360) * (float)M_PI / 180;
+    int x = (int)(1000 * sinf(angle));
+    int y = (int)(1000 * cosf(angle));
+    int z = (data % 200) - 100;
 
-    buffer_->commit();
-    buffer_->wakeUpReaders();
+    switch (type_) {
+    case Xyz: {
+        TimedXyzData* d = xyzBuffer_->nextSlot();
+        *d = TimedXyzData(timestamp, x, y, z);
+        xyzBuffer_->commit();
+        break;
+    }
+    case MagneticField: {
+        CalibratedMagneticFieldData* d = magneticFieldBuffer_->nextSlot();
+        *d = CalibratedMagneticFieldData(timestamp, x / 2, y / 2, z, x / 2, y / 2, z, 3);
+        magneticFieldBuffer_->commit();
+        break;
+    }
+    case Proximity: {
+        ProximityData* d = proximityBuffer_->nextSlot();
+        *d = ProximityData(timestamp, data, data & 1);
+        proximityBuffer_->commit();
+        break;
+    }
+    case Lid: {
+        LidData* d = lidBuffer_->nextSlot();
+        *d = LidData(timestamp, LidData::FrontLid, data & 1);
+        lidBuffer_->commit();
+        break;
+    }
+    case Tap: {
+        TapData* d = tapBuffer_->nextSlot();
+        *d = TapData(timestamp, (TapData::Direction)(data % 3), TapData::SingleTap);
+        tapBuffer_->commit();
+        break;
+    }
+    default: {
+        TimedUnsigned* d = unsignedBuffer_->nextSlot();
+        d->timestamp_ = timestamp;
+        d->value_ = data;
+        unsignedBuffer_->commit();
+        break;
+    }
+    }
+}
+
+void FakeAdaptor::pushNewData(int& data)
+{
+    quint64 timestamp = Utils::getTimeStamp();
+    for (unsigned int i = 0; i < burst_; ++i) {
+        pushSample(data, timestamp);
+        data++;
+    }
+    generated_.fetchAndAddRelaxed(burst_);
+
+    switch (type_) {
+    case Xyz: xyzBuffer_->wakeUpReaders(); break;
+    case MagneticField: magneticFieldBuffer_->wakeUpReaders(); break;
+    case Proximity: proximityBuffer_->wakeUpReaders(); break;
+    case Lid: lidBuffer_->wakeUpReaders(); break;
+    case Tap: tapBuffer_->wakeUpReaders(); break;
+    default: unsignedBuffer_->wakeUpReaders(); break;
+    }
 }
 
 void FakeAdaptor::init()
@@ -95,15 +240,23 @@ void FakeAdaptor::init()
 
 FakeAdaptorThread::FakeAdaptorThread(FakeAdaptor *parent) : running(false), parent_(parent)
 {
-    qDebug() << "Data pusher for ALS";
+    qDebug() << "Data pusher for" << parent->id();
 }
 
 void FakeAdaptorThread::run()
 {
     int i = 0;
+    // Sleep until absolute deadlines so the rate does not drift with
+    // the time spent pushing.
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
     while(running) {
-        QThread::msleep(parent_->interval_);
+        next.tv_nsec += (long)parent_->interval_ * 1000;
+        while (next.tv_nsec >= 1000000000) {
+            next.tv_nsec -= 1000000000;
+            ++next.tv_sec;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
         parent_->pushNewData(i);
-        i++;
     }
 }
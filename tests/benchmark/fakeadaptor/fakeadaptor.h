@@ -29,8 +29,13 @@
 #include "deviceadaptor.h"
 #include "deviceadaptorringbuffer.h"
 #include "datatypes/timedunsigned.h"
+#include "datatypes/orientationdata.h"
+#include "datatypes/liddata.h"
+#include "datatypes/tapdata.h"
 #include <QTime>
 #include <QThread>
+#include <QStringList>
+#include <QAtomicInt>
 
 class FakeAdaptor;
 
@@ -48,6 +53,15 @@ private:
 
 /**
  * @brief Adaptor faking another adaptor input with generated data
+ *
+ * Type of generated data is selected from the id the adaptor is
+ * registered with, so the same class can stand in for any of the
+ * <code>alsadaptor</code>, <code>accelerometeradaptor</code>,
+ * <code>magnetometeradaptor</code>, <code>gyroscopeadaptor</code>,
+ * <code>proximityadaptor</code>, <code>lidsensoradaptor</code>,
+ * <code>tapadaptor</code> and the other single value adaptors.
+ * Samples are pushed at #setRate() in bursts of #setBurst() samples,
+ * each burst waking the readers once.
  */
 class FakeAdaptor : public DeviceAdaptor
 {
@@ -58,6 +72,11 @@ public:
         return new FakeAdaptor(id);
     }
 
+    /**
+     * Adaptor ids this class can fake.
+     */
+    static QStringList fakeableAdaptors();
+
     bool startAdaptor();
     void stopAdaptor();
 
@@ -68,14 +87,55 @@ public:
 
     void init();
 
-    unsigned int interval_;
+    /**
+     * Set rate of bursts.
+     *
+     * @param rate bursts per second.
+     */
+    void setRate(unsigned int rate);
+
+    /**
+     * Set number of samples pushed on each burst.
+     *
+     * @param burst samples per burst.
+     */
+    void setBurst(unsigned int burst);
+
+    /**
+     * Get number of samples pushed since construction.
+     */
+    int generated() const;
+
+    unsigned int interval_; /**< interval between bursts in microseconds */
+    unsigned int burst_;    /**< samples per burst */
 
 protected:
     FakeAdaptor(const QString& id);
+    ~FakeAdaptor();
 
 private:
+    enum DataType
+    {
+        Unsigned,
+        Xyz,
+        MagneticField,
+        Proximity,
+        Lid,
+        Tap
+    };
+
+    void pushSample(int data, quint64 timestamp);
+
     FakeAdaptorThread* t;
-    DeviceAdaptorRingBuffer<TimedUnsigned>* buffer_;
+    DataType type_;
+    int starts_;
+    QAtomicInt generated_;
+    DeviceAdaptorRingBuffer<TimedUnsigned>* unsignedBuffer_;
+    DeviceAdaptorRingBuffer<TimedXyzData>* xyzBuffer_;
+    DeviceAdaptorRingBuffer<CalibratedMagneticFieldData>* magneticFieldBuffer_;
+    DeviceAdaptorRingBuffer<ProximityData>* proximityBuffer_;
+    DeviceAdaptorRingBuffer<LidData>* lidBuffer_;
+    DeviceAdaptorRingBuffer<TapData>* tapBuffer_;
 };
 
 #endif
@@ -0,0 +1,74 @@
+/**
+   @file allocationcounter.cpp
+   @brief Process wide heap allocation counter
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+*/
+
+#include "allocationcounter.h"
+#include <QAtomicInteger>
+#include <stdlib.h>
+
+// Must not allocate itself, so a plain atomic without constructor.
+static QBasicAtomicInteger<quint64> allocations = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+#ifdef __GLIBC__
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size)
+{
+    allocations.fetchAndAddRelaxed(1);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    allocations.fetchAndAddRelaxed(1);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    allocations.fetchAndAddRelaxed(1);
+    return __libc_realloc(ptr, size);
+}
+
+}
+
+bool AllocationCounter::available()
+{
+    return true;
+}
+
+#else
+
+bool AllocationCounter::available()
+{
+    return false;
+}
+
+#endif
+
+quint64 AllocationCounter::count()
+{
+    return allocations.load();
+}
@@ -0,0 +1,50 @@
+/**
+   @file allocationcounter.h
+   @brief Process wide heap allocation counter
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+*/
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+/**
+ * Counts heap allocations of the whole process by interposing the C
+ * allocator. Qt containers and operator new both end up in malloc, so
+ * this covers the daemon code as well as the libraries it uses.
+ */
+class AllocationCounter
+{
+public:
+    /**
+     * Is counting supported on this platform.
+     *
+     * @return true with glibc, false otherwise.
+     */
+    static bool available();
+
+    /**
+     * Get number of allocations since process start.
+     *
+     * @return malloc, calloc and realloc calls from all threads.
+     */
+    static quint64 count();
+};
+
+#endif
@@ -0,0 +1,125 @@
+/**
+   @file main.cpp
+   @brief In-process sensor pipeline benchmark
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+*/
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QFile>
+#include <QDir>
+#include <QtDebug>
+#include <stdio.h>
+
+#include "config.h"
+#include "pipelinebenchmark.h"
+
+/*
+ * Runs the daemon pipeline in this process with fake adaptors and prints
+ * throughput, CPU, allocation, latency and memory figures as JSON.
+ * Sensor plugins are loaded from the normal plugin directory, prefixed
+ * with $SENSORFW_LIBRARY_PATH like in sensord. No hardware, D-Bus or
+ * running sensord is needed.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark sensord data pipeline on fake adaptors.");
+    parser.addHelpOption();
+    QCommandLineOption sensorsOption("sensors", "Comma separated sensor channels, all by default.", "list",
+                                     PipelineBenchmark::supportedSensors().join(','));
+    QCommandLineOption rateOption("rate", "Adaptor bursts per second.", "hz", "100");
+    QCommandLineOption burstOption("burst", "Samples per adaptor burst.", "samples", "1");
+    QCommandLineOption sessionsOption("sessions", "Sessions per sensor channel.", "count", "1");
+    QCommandLineOption warmupOption("warmup", "Seconds to run before measuring.", "seconds", "1");
+    QCommandLineOption durationOption("duration", "Measured seconds.", "seconds", "10");
+    QCommandLineOption displayOffOption("display-off", "Measure with display off and standby override on all sessions.");
+    QCommandLineOption maxLatencyOption("max-latency", "Session delivery latency while display is off.", "ms", "0");
+    QCommandLineOption configOption("config-file", "Configuration file.", "path", "/etc/sensorfw/sensord.conf");
+    QCommandLineOption configDirOption("config-dir", "Configuration directory.", "path", "/etc/sensorfw/sensord.conf.d/");
+    QCommandLineOption outputOption("output", "Write results to file instead of stdout.", "path");
+    QCommandLineOption verboseOption("verbose", "Show sensord debug output.");
+    parser.addOption(sensorsOption);
+    parser.addOption(rateOption);
+    parser.addOption(burstOption);
+    parser.addOption(sessionsOption);
+    parser.addOption(warmupOption);
+    parser.addOption(durationOption);
+    parser.addOption(displayOffOption);
+    parser.addOption(maxLatencyOption);
+    parser.addOption(configOption);
+    parser.addOption(configDirOption);
+    parser.addOption(outputOption);
+    parser.addOption(verboseOption);
+    parser.process(app);
+
+    if (!parser.isSet(verboseOption))
+        QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");
+
+    PipelineBenchmark::Options options;
+    options.sensors = parser.value(sensorsOption).split(',', QString::SkipEmptyParts);
+    options.rate = qMax(1u, parser.value(rateOption).toUInt());
+    options.burst = qMax(1u, parser.value(burstOption).toUInt());
+    options.sessions = qMax(1u, parser.value(sessionsOption).toUInt());
+    options.warmup = qMax(0, parser.value(warmupOption).toInt());
+    options.duration = qMax(1, parser.value(durationOption).toInt());
+    options.displayOff = parser.isSet(displayOffOption);
+    options.maxLatency = parser.value(maxLatencyOption).toUInt();
+
+    // Private data socket and no D-Bus, so the benchmark can run next to
+    // a system sensord and without a bus.
+    QTemporaryDir runtimeDir;
+    if (!runtimeDir.isValid() || !QDir(runtimeDir.path()).mkpath("var/run")) {
+        qCritical() << "Failed to create runtime directory";
+        return 1;
+    }
+    qputenv("SENSORFW_SOCKET_PATH", QFile::encodeName(runtimeDir.path()));
+    qputenv("SENSORFW_NO_DBUS", "1");
+
+    SensorFrameworkConfig::loadConfig(parser.value(configOption), parser.value(configDirOption));
+
+    PipelineBenchmark::registerFakeAdaptors();
+
+    int ret = 0;
+    {
+        PipelineBenchmark benchmark(options, runtimeDir.path() + "/var/run/sensord.sock");
+        if (!benchmark.setup()) {
+            qCritical() << "No sessions could be opened";
+            ret = 1;
+        } else {
+            QByteArray json = QJsonDocument(benchmark.run()).toJson();
+            if (parser.isSet(outputOption)) {
+                QFile file(parser.value(outputOption));
+                if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+                    qCritical() << "Failed to write" << file.fileName();
+                    ret = 1;
+                }
+            } else {
+                fwrite(json.constData(), 1, json.size(), stdout);
+            }
+        }
+    }
+
+    SensorFrameworkConfig::close();
+    return ret;
+}
@@ -0,0 +1,34 @@
+QT += dbus \
+      network
+QT -= gui
+
+include(../../common-install.pri)
+
+TEMPLATE = app
+TARGET = sensorpipelinebenchmark-test
+
+CONFIG += console
+
+HEADERS += pipelinebenchmark.h \
+           allocationcounter.h \
+           ../fakeadaptor/fakeadaptor.h
+
+SOURCES += main.cpp \
+           pipelinebenchmark.cpp \
+           allocationcounter.cpp \
+           ../fakeadaptor/fakeadaptor.cpp
+
+SENSORFW_INCLUDEPATHS = ../../../include \
+                        ../../../core \
+                        ../../../datatypes \
+                        ../../../filters \
+                        ../fakeadaptor \
+                        ../../..
+
+DEPENDPATH += $$SENSORFW_INCLUDEPATHS
+INCLUDEPATH += $$SENSORFW_INCLUDEPATHS
+
+QMAKE_LIBDIR_FLAGS += -L../../../builddir/datatypes -L../../../datatypes \
+                      -L../../../builddir/core -L../../../core
+
+QMAKE_LIBDIR_FLAGS += -lsensordatatypes-qt5 -lsensorfw-qt5
@@ -0,0 +1,378 @@
+/**
+   @file pipelinebenchmark.cpp
+   @brief In-process sensor pipeline benchmark
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+*/
+
+#include "pipelinebenchmark.h"
+#include "allocationcounter.h"
+#include "fakeadaptor.h"
+#include "sensormanager.h"
+#include "sockethandler.h"
+#include "abstractsensor.h"
+#include "loader.h"
+#include "datatypes/utils.h"
+#include "datatypes/timedunsigned.h"
+#include "datatypes/orientationdata.h"
+#include "datatypes/posedata.h"
+#include "datatypes/liddata.h"
+#include "datatypes/tapdata.h"
+
+#include <QEventLoop>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QtDebug>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <string.h>
+#include <algorithm>
+
+/* Bytes reserved for partially received frames. */
+#define PENDING_RESERVE 65536
+
+/**
+ * Size of a sample each sensor channel writes to its sessions.
+ */
+static int sampleSize(const QString& sensor)
+{
+    if (sensor == "accelerometersensor" || sensor == "gyroscopesensor" ||
+        sensor == "rotationsensor")
+        return sizeof(TimedXyzData);
+    if (sensor == "magnetometersensor")
+        return sizeof(CalibratedMagneticFieldData);
+    if (sensor == "compasssensor")
+        return sizeof(CompassData);
+    if (sensor == "orientationsensor")
+        return sizeof(PoseData);
+    if (sensor == "proximitysensor")
+        return sizeof(ProximityData);
+    if (sensor == "lidsensor")
+        return sizeof(LidData);
+    if (sensor == "tapsensor")
+        return sizeof(TapData);
+    return sizeof(TimedUnsigned);
+}
+
+/**
+ * Get p:th percentile. Reorders the values.
+ */
+static quint32 percentile(QVector<quint32>& values, double p)
+{
+    if (values.isEmpty())
+        return 0;
+    int n = qMin(values.size() - 1, (int)(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + n, values.end());
+    return values[n];
+}
+
+static QJsonObject latencyObject(QVector<quint32>& latencies)
+{
+    QJsonObject latency;
+    latency["p50"] = (double)percentile(latencies, 0.50);
+    latency["p99"] = (double)percentile(latencies, 0.99);
+    latency["max"] = latencies.isEmpty() ? 0.0 : (double)*std::max_element(latencies.begin(), latencies.end());
+    return latency;
+}
+
+/**
+ * Read a kB value from /proc/self/status.
+ */
+static qint64 procStatus(const char* key)
+{
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+
+    QByteArray prefix(key);
+    prefix += ':';
+    foreach (const QByteArray& line, file.readAll().split('\n')) {
+        if (line.startsWith(prefix))
+            return line.mid(prefix.size()).trimmed().split(' ').first().toLongLong();
+    }
+    return -1;
+}
+
+static qint64 cpuTime()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (qint64)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+           + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+BenchmarkClient::BenchmarkClient(int sessionId, int sampleSize, ChannelStats* stats, QObject* parent) :
+    QObject(parent),
+    sessionId_(sessionId),
+    sampleSize_(sampleSize),
+    stats_(stats),
+    tagRead_(false),
+    recording_(false)
+{
+    pending_.reserve(PENDING_RESERVE);
+    connect(&socket_, SIGNAL(readyRead()), this, SLOT(readyRead()));
+}
+
+bool BenchmarkClient::connectToServer(const QString& socketName)
+{
+    socket_.connectToServer(socketName, QIODevice::ReadWrite);
+    if (!socket_.waitForConnected()) {
+        qWarning() << "[BenchmarkClient]: failed to connect" << socketName << ":" << socket_.errorString();
+        return false;
+    }
+
+    if (socket_.write((const char*)&sessionId_, sizeof(sessionId_)) != sizeof(sessionId_)) {
+        qWarning() << "[BenchmarkClient]: session id write failed:" << socket_.errorString();
+        return false;
+    }
+    socket_.flush();
+    return true;
+}
+
+void BenchmarkClient::setRecording(bool recording)
+{
+    recording_ = recording;
+}
+
+void BenchmarkClient::readyRead()
+{
+    pending_.append(socket_.readAll());
+
+    int offset = 0;
+    if (!tagRead_ && pending_.size()) {
+        tagRead_ = true;
+        offset = 1;
+    }
+
+    if (recording_)
+        ++stats_->wakeups;
+
+    quint64 now = Utils::getTimeStamp();
+    while (pending_.size() - offset >= (int)sizeof(unsigned int)) {
+        unsigned int count;
+        memcpy(&count, pending_.constData() + offset, sizeof(count));
+        int frameSize = sizeof(count) + count * sampleSize_;
+        if (pending_.size() - offset < frameSize)
+            break;
+
+        if (recording_) {
+            const char* sample = pending_.constData() + offset + sizeof(count);
+            for (unsigned int i = 0; i < count; ++i, sample += sampleSize_) {
+                quint64 timestamp;
+                memcpy(&timestamp, sample, sizeof(timestamp));
+                stats_->latencies.append(now > timestamp ? (quint32)(now - timestamp) : 0);
+            }
+            stats_->delivered += count;
+        }
+        offset += frameSize;
+    }
+    pending_.remove(0, offset);
+}
+
+QStringList PipelineBenchmark::supportedSensors()
+{
+    return QStringList() << "accelerometersensor" << "alssensor" << "compasssensor"
+                         << "gyroscopesensor" << "humiditysensor" << "lidsensor"
+                         << "magnetometersensor" << "orientationsensor" << "pressuresensor"
+                         << "proximitysensor" << "rotationsensor" << "stepcountersensor"
+                         << "tapsensor" << "temperaturesensor";
+}
+
+void PipelineBenchmark::registerFakeAdaptors()
+{
+    SensorManager& sm = SensorManager::instance();
+    foreach (const QString& adaptor, FakeAdaptor::fakeableAdaptors()) {
+        sm.registerDeviceAdaptor<FakeAdaptor>(adaptor);
+        Loader::instance().registerBuiltinPlugin(adaptor);
+    }
+}
+
+PipelineBenchmark::PipelineBenchmark(const Options& options, const QString& socketName) :
+    options_(options),
+    socketName_(socketName)
+{
+}
+
+PipelineBenchmark::~PipelineBenchmark()
+{
+    SensorManager& sm = SensorManager::instance();
+
+    foreach (const Session& session, sessions_) {
+        const SensorInstanceEntry* entry = sm.getSensorInstance(session.sensor);
+        if (entry && entry->sensor_)
+            entry->sensor_->stop(session.id);
+        sm.releaseSensor(session.sensor, session.id);
+        delete session.client;
+    }
+
+    foreach (FakeAdaptor* adaptor, adaptors_)
+        sm.releaseDeviceAdaptor(adaptor->id());
+}
+
+bool PipelineBenchmark::setup()
+{
+    SensorManager& sm = SensorManager::instance();
+
+    foreach (const QString& id, FakeAdaptor::fakeableAdaptors()) {
+        FakeAdaptor* adaptor = static_cast<FakeAdaptor*>(sm.requestDeviceAdaptor(id));
+        if (!adaptor)
+            continue;
+        adaptor->setRate(options_.rate);
+        adaptor->setBurst(options_.burst);
+        adaptors_.append(adaptor);
+    }
+
+    // Every session receives every sample, leave some headroom.
+    int expected = (int)qMin<qint64>((qint64)options_.rate * options_.burst * options_.duration
+                                     * options_.sessions * 5 / 4, 1 << 24);
+
+    foreach (const QString& sensor, options_.sensors) {
+        if (!sm.loadPlugin(sensor)) {
+            errors_.insert(sensor, "plugin load failed: " + sm.errorString());
+            continue;
+        }
+
+        ChannelStats& stats = stats_[sensor];
+        stats.latencies.reserve(expected);
+
+        for (unsigned int i = 0; i < options_.sessions; ++i) {
+            int id = sm.requestSensor(sensor);
+            if (id < 0) {
+                errors_.insert(sensor, "session request failed: " + sm.errorString());
+                break;
+            }
+
+            Session session = { sensor, id, new BenchmarkClient(id, sampleSize(sensor), &stats) };
+            sessions_.append(session);
+            if (!session.client->connectToServer(socketName_)) {
+                errors_.insert(sensor, "data socket connection failed");
+                break;
+            }
+            AbstractSensorChannel* channel = sm.getSensorInstance(sensor)->sensor_;
+            if (options_.displayOff)
+                channel->setStandbyOverrideRequest(id, true);
+            channel->start(id);
+        }
+    }
+
+    return !sessions_.isEmpty();
+}
+
+void PipelineBenchmark::setRecording(bool recording)
+{
+    foreach (const Session& session, sessions_)
+        session.client->setRecording(recording);
+}
+
+void PipelineBenchmark::setDisplayOn(bool on)
+{
+    SensorManager& sm = SensorManager::instance();
+    foreach (const Session& session, sessions_)
+        sm.socketHandler().setMaxLatency(session.id, on ? 0 : options_.maxLatency);
+    QMetaObject::invokeMethod(&sm, "displayStateChanged", Q_ARG(bool, on));
+}
+
+QJsonObject PipelineBenchmark::run()
+{
+    QEventLoop loop;
+
+    QTimer::singleShot(options_.warmup * 1000, &loop, SLOT(quit()));
+    loop.exec();
+
+    // Data connections are established during warmup.
+    if (options_.displayOff)
+        setDisplayOn(false);
+
+    int generatedBefore = 0;
+    foreach (FakeAdaptor* adaptor, adaptors_)
+        generatedBefore += adaptor->generated();
+    qint64 cpuBefore = cpuTime();
+    quint64 allocationsBefore = AllocationCounter::count();
+    QElapsedTimer timer;
+    timer.start();
+    setRecording(true);
+
+    QTimer::singleShot(options_.duration * 1000, &loop, SLOT(quit()));
+    loop.exec();
+
+    setRecording(false);
+    if (options_.displayOff)
+        setDisplayOn(true);
+    double elapsed = timer.nsecsElapsed() / 1e9;
+    quint64 allocations = AllocationCounter::count() - allocationsBefore;
+    qint64 cpu = cpuTime() - cpuBefore;
+    int generated = -generatedBefore;
+    foreach (FakeAdaptor* adaptor, adaptors_)
+        generated += adaptor->generated();
+
+    QJsonObject options;
+    options["sensors"] = QJsonArray::fromStringList(options_.sensors);
+    options["rate"] = (double)options_.rate;
+    options["burst"] = (double)options_.burst;
+    options["sessions"] = (double)options_.sessions;
+    options["warmup"] = options_.warmup;
+    options["duration"] = options_.duration;
+    options["displayOff"] = options_.displayOff;
+    options["maxLatency"] = (double)options_.maxLatency;
+
+    QJsonObject sensors;
+    QVector<quint32> latencies;
+    quint64 delivered = 0;
+    quint64 wakeups = 0;
+    for (QMap<QString, ChannelStats>::iterator it = stats_.begin(); it != stats_.end(); ++it) {
+        ChannelStats& stats = it.value();
+        delivered += stats.delivered;
+        wakeups += stats.wakeups;
+        latencies += stats.latencies;
+
+        QJsonObject sensor;
+        sensor["delivered"] = (double)stats.delivered;
+        sensor["samplesPerSec"] = stats.delivered / elapsed;
+        sensor["wakeups"] = (double)stats.wakeups;
+        sensor["wakeupsPerMinute"] = stats.wakeups * 60 / elapsed;
+        sensor["latencyUsec"] = latencyObject(stats.latencies);
+        sensors[it.key()] = sensor;
+    }
+
+    QJsonObject errors;
+    for (QMap<QString, QString>::const_iterator it = errors_.constBegin(); it != errors_.constEnd(); ++it)
+        errors[it.key()] = it.value();
+
+    QJsonObject result;
+    result["benchmark"] = QString("sensorfw-pipeline");
+    result["options"] = options;
+    result["elapsed"] = elapsed;
+    result["generated"] = generated;
+    result["delivered"] = (double)delivered;
+    result["samplesPerSec"] = delivered / elapsed;
+    result["wakeups"] = (double)wakeups;
+    result["wakeupsPerMinute"] = wakeups * 60 / elapsed;
+    result["cpuUsec"] = (double)cpu;
+    result["cpuUsecPerSample"] = delivered ? (double)cpu / delivered : 0.0;
+    if (AllocationCounter::available()) {
+        result["allocations"] = (double)allocations;
+        result["allocationsPerSample"] = delivered ? (double)allocations / delivered : 0.0;
+    }
+    result["latencyUsec"] = latencyObject(latencies);
+    result["rssKb"] = (double)procStatus("VmRSS");
+    result["peakRssKb"] = (double)procStatus("VmHWM");
+    result["sensors"] = sensors;
+    result["errors"] = errors;
+    return result;
+}
@@ -0,0 +1,186 @@
+/**
+   @file pipelinebenchmark.h
+   @brief In-process sensor pipeline benchmark
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+*/
+
+#ifndef PIPELINEBENCHMARK_H
+#define PIPELINEBENCHMARK_H
+
+#include <QObject>
+#include <QLocalSocket>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QMap>
+#include <QJsonObject>
+
+class FakeAdaptor;
+
+/**
+ * Delivery statistics of one sensor channel.
+ */
+struct ChannelStats
+{
+    ChannelStats() : delivered(0), wakeups(0) {}
+
+    quint64          delivered; /**< samples received by all sessions */
+    quint64          wakeups;   /**< socket reads of all sessions */
+    QVector<quint32> latencies; /**< adaptor to client latencies, usec */
+};
+
+/**
+ * Client end of one session. Reads the data socket the same way
+ * SocketReader in the client library does and timestamps every received
+ * sample.
+ */
+class BenchmarkClient : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(BenchmarkClient)
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param sessionId session to connect to.
+     * @param sampleSize size of single sample written by the channel.
+     * @param stats statistics of the channel.
+     * @param parent parent object.
+     */
+    BenchmarkClient(int sessionId, int sampleSize, ChannelStats* stats, QObject* parent = 0);
+
+    /**
+     * Connect to data socket of sensor manager.
+     *
+     * @param socketName socket path.
+     * @return was connection established.
+     */
+    bool connectToServer(const QString& socketName);
+
+    /**
+     * Enable or disable recording of received samples.
+     */
+    void setRecording(bool recording);
+
+private Q_SLOTS:
+    void readyRead();
+
+private:
+    QLocalSocket  socket_;     /**< data connection */
+    int           sessionId_;  /**< session */
+    int           sampleSize_; /**< bytes per sample */
+    ChannelStats* stats_;      /**< where to record */
+    bool          tagRead_;    /**< initial tag consumed */
+    bool          recording_;  /**< record received samples */
+    QByteArray    pending_;    /**< partially received frame */
+};
+
+/**
+ * Runs sensor channels on top of FakeAdaptor inside the benchmark
+ * process and measures delivery through the whole daemon pipeline:
+ * adaptor thread, chains and filters, sensor channel, the data pipe of
+ * SensorManager and the session socket.
+ */
+class PipelineBenchmark : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(PipelineBenchmark)
+
+public:
+    /**
+     * Benchmark parameters.
+     */
+    struct Options
+    {
+        Options() : rate(100), burst(1), sessions(1), warmup(1), duration(10),
+                    displayOff(false), maxLatency(0) {}
+
+        QStringList  sensors;    /**< sensor channels to drive */
+        unsigned int rate;       /**< adaptor bursts per second */
+        unsigned int burst;      /**< samples per burst */
+        unsigned int sessions;   /**< sessions per sensor channel */
+        int          warmup;     /**< seconds before measuring */
+        int          duration;   /**< measured seconds */
+        bool         displayOff; /**< measure with display off and standby override */
+        unsigned int maxLatency; /**< session latency while display is off, ms */
+    };
+
+    /**
+     * Sensor channels the benchmark can drive with fake adaptors.
+     */
+    static QStringList supportedSensors();
+
+    /**
+     * Register fake adaptors. Must be called before any sensor plugin
+     * is loaded.
+     */
+    static void registerFakeAdaptors();
+
+    /**
+     * Constructor.
+     *
+     * @param options benchmark parameters.
+     * @param socketName data socket path of the sensor manager.
+     */
+    PipelineBenchmark(const Options& options, const QString& socketName);
+
+    /**
+     * Destructor. Closes sessions and releases sensors.
+     */
+    ~PipelineBenchmark();
+
+    /**
+     * Load sensor plugins, open and start sessions.
+     *
+     * @return false if no session could be opened.
+     */
+    bool setup();
+
+    /**
+     * Run warmup and measurement.
+     *
+     * @return results as JSON.
+     */
+    QJsonObject run();
+
+private:
+    struct Session
+    {
+        QString          sensor;
+        int              id;
+        BenchmarkClient* client;
+    };
+
+    void setRecording(bool recording);
+
+    /**
+     * Turn the display of sensor manager on or off. Sessions must have
+     * their data connection established.
+     */
+    void setDisplayOn(bool on);
+
+    Options                     options_;    /**< parameters */
+    QString                     socketName_; /**< data socket */
+    QList<FakeAdaptor*>         adaptors_;   /**< configured fake adaptors */
+    QList<Session>              sessions_;   /**< open sessions */
+    QMap<QString, ChannelStats> stats_;      /**< statistics by sensor */
+    QMap<QString, QString>      errors_;     /**< failed sensors */
+};
+
+#endif
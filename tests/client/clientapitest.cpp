@@ -517,6 +517,37 @@ void ClientApiTest::testSessionInitiation()
     QVERIFY2(orientation && orientation->isValid(), "Could not get orientation sensor channel");
 }
 
+void ClientApiTest::testStartWithoutWait()
+{
+    foreach(const QString& sensorName, bufferingSensors)
+    {
+        AbstractSensorChannelInterface* sensor = getSensor(sensorName);
+        QScopedPointer<AbstractSensorChannelInterface> sensorTmp(sensor);
+        QVERIFY2(sensor && sensor->isValid(),QString("Could not get %1 sensor channel").arg(sensorName).toLatin1());
+
+        // Started before the data socket handshake can have completed,
+        // buffering settings must still reach the socket session.
+        TestClient client(*sensor, true);
+        int bufferSize = 5;
+        int interval = 100;
+        sensor->setInterval(interval);
+        sensor->setBufferSize(bufferSize);
+        sensor->setBufferInterval(bufferSize * interval * 10);
+        sensor->setStandbyOverride(true);
+        sensor->start();
+
+        int period = bufferSize * interval * 3;
+        qDebug() << sensorName << " started, waiting for " << period << " ms.";
+        QTest::qWait(period);
+        sensor->stop();
+
+        int frameCount = client.getFrameCount();
+        QVERIFY2(frameCount >= 1, errorMessage(sensorName, interval, frameCount, ">=", 1));
+        int dataCount = client.getDataCount();
+        QVERIFY2(dataCount < 4, errorMessage(sensorName, interval, dataCount, "<", 4));
+    }
+}
+
 void ClientApiTest::testBuffering()
 {
     foreach(const QString& sensorName, bufferingSensors)
@@ -883,6 +914,48 @@ void ClientApiTest::testDownsamplingDisabled()
     }
 }
 
+void ClientApiTest::testHistory()
+{
+    QString sensorName("accelerometersensor");
+    AbstractSensorChannelInterface* sensor1 = getSensor(sensorName);
+    AbstractSensorChannelInterface* sensor2 = getSensor(sensorName);
+    QScopedPointer<AbstractSensorChannelInterface> sensorTmp1(sensor1);
+    QScopedPointer<AbstractSensorChannelInterface> sensorTmp2(sensor2);
+    QVERIFY2(sensor1 && sensor1->isValid(),QString("Could not get %1 sensor channel").arg(sensorName).toLatin1());
+    QVERIFY2(sensor2 && sensor2->isValid(),QString("Could not get %1 sensor channel").arg(sensorName).toLatin1());
+
+    // Let the first session fill the history
+    int interval = 100;
+    sensor1->setInterval(interval);
+    sensor1->setStandbyOverride(true);
+    sensor1->start();
+    QTest::qWait(interval * 15);
+
+    // History requested before starting is queued ahead of live samples
+    SampleCollector client2(*sensor2, true);
+    QDBusReply<unsigned int> reply = sensor2->requestHistory(1);
+    QVERIFY(reply.isValid());
+    if (!reply.value())
+    {
+        sensor1->stop();
+        QSKIP("History is not enabled for accelerometersensor");
+    }
+
+    sensor2->setStandbyOverride(true);
+    sensor2->start();
+    QTest::qWait(interval * 3);
+
+    sensor1->stop();
+    sensor2->stop();
+
+    QVector<XYZ> samples = client2.getSamples2();
+    QVERIFY2(samples.size() >= (int)reply.value(), errorMessage(sensorName, interval, samples.size(), ">=", (int)reply.value()));
+    for (int i = 1; i < samples.size(); ++i)
+    {
+        QVERIFY(samples.at(i - 1).XYZData().timestamp_ <= samples.at(i).XYZData().timestamp_);
+    }
+}
+
 TestClient::TestClient(AbstractSensorChannelInterface& iface, bool listenFrames) :
     dataCount(0),
     frameCount(0),
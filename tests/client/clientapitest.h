@@ -72,6 +72,7 @@ private slots:
     // Special cases
     void testCommonAdaptorPipeline();
     void testSessionInitiation();
+    void testStartWithoutWait();
 
     // Buffering
     void testBuffering();
@@ -84,6 +85,9 @@ private slots:
     // Downsampling
     void testDownsampling();
     void testDownsamplingDisabled();
+
+    // History
+    void testHistory();
 };
 
 class TestClient : public QObject
@@ -24,6 +24,7 @@
 
 #include <QObject>
 #include <QCoreApplication>
+#include <QStringList>
 #include <QDebug>
 #include <orientationsensor_i.h>
 #include <accelerometersensor_i.h>
@@ -33,11 +34,39 @@
 #include <sensormanagerinterface.h>
 #include <datatypes/xyz.h>
 #include "testwindow.h"
+#include "sessionswarm.h"
+#include "latencyprobe.h"
 
+static int intArgument(const QStringList& args, const QString& name)
+{
+    int i = args.indexOf(name);
+    if (i < 0 || i + 1 >= args.size())
+        return 0;
+    return args.at(i + 1).toInt();
+}
+
+/*
+ * Without arguments opens a single orientation session.
+ *   -n N  open N accelerometer sessions, for session teardown stress test
+ *   -p S  probe sensord main loop latency for S seconds
+ */
 int main(int argc, char **argv)
 {
     QCoreApplication app(argc, argv);
-    TestWindow t();
-    
+    QStringList args = app.arguments();
+
+    int probeTime = intArgument(args, "-p");
+    if (probeTime > 0) {
+        LatencyProbe probe(probeTime);
+        return app.exec();
+    }
+
+    int sessions = intArgument(args, "-n");
+    if (sessions > 0) {
+        SessionSwarm swarm(sessions);
+        return app.exec();
+    }
+
+    TestWindow t;
     return app.exec();
 };
@@ -19,7 +19,7 @@ QMAKE_LIBDIR_FLAGS += -L../../qt-api  \
 QMAKE_LIBDIR_FLAGS += -lsensordatatypes-qt5 -lsensorclient-qt5
 
 # Input
-HEADERS += datareceiver.h testwindow.h
+HEADERS += datareceiver.h testwindow.h sessionswarm.h latencyprobe.h
 SOURCES += deadclient.cpp
 
 deadclienttest.files = sensord-deadclienttest.py
@@ -0,0 +1,83 @@
+/**
+   @file latencyprobe.h
+   @brief Sensord main loop latency probe for dead client stress tests
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+*/
+
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <stdio.h>
+#include <algorithm>
+#include "serviceinfo.h"
+
+/**
+ * Measures how quickly sensord main loop responds by doing cheap
+ * blocking D-Bus calls to it every 10 ms. When done prints
+ * "latency samples=N p50=X p99=Y max=Z" with times in microseconds
+ * and quits the application.
+ */
+class LatencyProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    LatencyProbe(int seconds, QObject* parent = 0) : QObject(parent)
+    {
+        connect(&timer, SIGNAL(timeout()), this, SLOT(ping()));
+        timer.start(10);
+        QTimer::singleShot(seconds * 1000, this, SLOT(report()));
+    }
+
+private slots:
+    void ping()
+    {
+        QDBusMessage msg = QDBusMessage::createMethodCall(SERVICE_NAME, OBJECT_PATH,
+                                                          "local.SensorManager", "pluginAvailable");
+        msg << QString("accelerometersensor");
+        QElapsedTimer elapsed;
+        elapsed.start();
+        QDBusConnection::systemBus().call(msg, QDBus::Block, 5000);
+        latencies.append(elapsed.nsecsElapsed() / 1000);
+    }
+
+    void report()
+    {
+        timer.stop();
+        std::sort(latencies.begin(), latencies.end());
+        int n = latencies.size();
+        printf("latency samples=%d p50=%lld p99=%lld max=%lld\n", n,
+               n ? latencies[n / 2] : 0LL,
+               n ? latencies[qMin(n - 1, n * 99 / 100)] : 0LL,
+               n ? latencies[n - 1] : 0LL);
+        fflush(stdout);
+        QCoreApplication::quit();
+    }
+
+private:
+    QTimer timer;
+    QVector<qint64> latencies;
+};
+
+#endif
@@ -19,13 +19,21 @@
 ## License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
 ##
 
-import re, string, sys, os, time, signal, unittest
+import re, string, sys, os, time, signal, unittest, subprocess
 
 appName = 'sensord-deadclient'
 timeToSleep = 10
 signalForKilling = signal.SIGKILL
 logFile = '/var/log/syslog'
 
+# Session teardown stress test. sensord needs an open file limit above
+# stressClients * stressSessionsPerClient for this.
+stressClients = 50
+stressSessionsPerClient = 100
+probeTime = 10
+maxLatencyP99 = 50000   # usec
+maxLatency = 500000     # usec
+
 def timeoutHandler(signum, frame):
     raise Exception('Tests have been running for too long')
 
@@ -71,8 +79,40 @@ class DeadClient(unittest.TestCase):
         os.kill(childPid2, signalForKilling)
         self.assert_(success)
 
+    def test_ManySessionsKilled(self):
+        print('Launching ' + repr(stressClients) + ' clients with ' + repr(stressSessionsPerClient) + ' sessions each...')
+        clients = []
+        for i in range(stressClients):
+            clients.append(subprocess.Popen([appName, '-n', repr(stressSessionsPerClient)], stdout=subprocess.PIPE))
+
+        opened = 0
+        for client in clients:
+            line = client.stdout.readline()
+            if line.startswith('ready'):
+                opened += int(line.split()[1])
+        print('Opened ' + repr(opened) + ' sessions')
+
+        # Measure main loop latency while all clients die at once.
+        probe = subprocess.Popen([appName, '-p', repr(probeTime)], stdout=subprocess.PIPE)
+        time.sleep(2)
+        print('Killing all clients with signal ' + repr(signalForKilling) + ' now...')
+        for client in clients:
+            os.kill(client.pid, signalForKilling)
+        for client in clients:
+            client.wait()
+
+        result = probe.communicate()[0]
+        print(result)
+        match = re.search(r'latency samples=(\d+) p50=(\d+) p99=(\d+) max=(\d+)', result)
+
+        self.assertEqual(opened, stressClients * stressSessionsPerClient)
+        self.assert_(match)
+        self.assert_(int(match.group(1)) > 0)
+        self.assert_(int(match.group(3)) < maxLatencyP99)
+        self.assert_(int(match.group(4)) < maxLatency)
+
 if __name__ == '__main__':
 	sys.stdout = os.fdopen(sys.stdout.fileno(), 'w', 1)
 	signal.signal(signal.SIGALRM, timeoutHandler)
-	signal.alarm(60)
+	signal.alarm(300)
 	unittest.main()
@@ -0,0 +1,66 @@
+/**
+   @file sessionswarm.h
+   @brief Client holding many sessions for dead client stress tests
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+*/
+
+#ifndef SESSIONSWARM_H
+#define SESSIONSWARM_H
+
+#include <QList>
+#include <stdio.h>
+#include <accelerometersensor_i.h>
+#include <sensormanagerinterface.h>
+
+/**
+ * Opens and starts given number of accelerometer sessions and reports
+ * on stdout how many succeeded. The sessions are meant to be torn down
+ * by killing the process.
+ */
+class SessionSwarm
+{
+public:
+    SessionSwarm(int sessions)
+    {
+        SensorManagerInterface& remoteSensorManager = SensorManagerInterface::instance();
+        remoteSensorManager.loadPlugin("accelerometersensor");
+        remoteSensorManager.registerSensorInterface<AccelerometerSensorChannelInterface>("accelerometersensor");
+
+        for (int i = 0; i < sessions; ++i) {
+            AccelerometerSensorChannelInterface* sensorIfc = AccelerometerSensorChannelInterface::interface("accelerometersensor");
+            if (!sensorIfc || !sensorIfc->isValid()) {
+                delete sensorIfc;
+                break;
+            }
+            sensorIfc->start();
+            sensorIfcs.append(sensorIfc);
+        }
+
+        printf("ready %d\n", sensorIfcs.size());
+        fflush(stdout);
+    }
+
+    ~SessionSwarm()
+    {
+        qDeleteAll(sensorIfcs);
+    }
+
+private:
+    QList<AccelerometerSensorChannelInterface*> sensorIfcs;
+};
+
+#endif
@@ -11,14 +11,26 @@ HEADERS += filtertests.h \
     ../../filters/orientationinterpreter/orientationinterpreter.h \
     ../../filters/coordinatealignfilter/coordinatealignfilter.h \
     ../../filters/declinationfilter/declinationfilter.h \
-    ../../filters/rotationfilter/rotationfilter.h 
+    ../../filters/rotationfilter/rotationfilter.h \
+    ../../filters/avgaccfilter/avgaccfilter.h \
+    ../../filters/downsamplefilter/downsamplefilter.h \
+    ../../filters/stepdetectorfilter/stepdetectorfilter.h \
+    ../../chains/compasschain/compassfilter.h \
+    ../../chains/magcalibrationchain/ellipsoidfit.h \
+    ../../chains/magcalibrationchain/magcalibrationstore.h
 
     
 SOURCES += filtertests.cpp \
     ../../filters/orientationinterpreter/orientationinterpreter.cpp \
     ../../filters/coordinatealignfilter/coordinatealignfilter.cpp \
     ../../filters/declinationfilter/declinationfilter.cpp \
-    ../../filters/rotationfilter/rotationfilter.cpp
+    ../../filters/rotationfilter/rotationfilter.cpp \
+    ../../filters/avgaccfilter/avgaccfilter.cpp \
+    ../../filters/downsamplefilter/downsamplefilter.cpp \
+    ../../filters/stepdetectorfilter/stepdetectorfilter.cpp \
+    ../../chains/compasschain/compassfilter.cpp \
+    ../../chains/magcalibrationchain/ellipsoidfit.cpp \
+    ../../chains/magcalibrationchain/magcalibrationstore.cpp
 
 INCLUDEPATH += ../../include \
     ../../ \
@@ -26,6 +38,11 @@ INCLUDEPATH += ../../include \
     ../../filters/coordinatealignfilter \
     ../../filters/declinationfilter \
     ../../filters/rotationfilter \
+    ../../filters/avgaccfilter \
+    ../../filters/downsamplefilter \
+    ../../filters/stepdetectorfilter \
+    ../../chains/compasschain \
+    ../../chains/magcalibrationchain \
     ../../core \
     ../../datatypes
     
@@ -38,9 +38,24 @@
 #include "orientationinterpreter.h"
 #include "declinationfilter.h"
 #include "rotationfilter.h"
+#include "avgaccfilter.h"
+#include "downsamplefilter.h"
+#include "stepdetectorfilter.h"
+#include "pipeline.h"
 #include "filtertests.h"
 #include "config.h"
+#include "fastmath.h"
+#include "windowstats.h"
+#include "fixedpoint.h"
+#include "sampledecimator.h"
+#include "compassfilter.h"
+#include "ellipsoidfit.h"
+#include "magcalibrationstore.h"
 #include <QSettings>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QVector>
+#include <math.h>
 
 void FilterApiTest::initTestCase()
 {
@@ -488,4 +503,829 @@ void FilterApiTest::testRotationFilter()
     delete rotationFilter;
 }
 
+/**
+ * Sweeps accelerometer range and checks that whole degree angles computed
+ * with FastMath match libm. A difference of one degree is accepted only
+ * when the exact angle lies on a rounding boundary.
+ */
+void FilterApiTest::testFastMath()
+{
+    const double RADIANS_TO_DEGREES = 180.0 / M_PI;
+    int mismatches = 0;
+
+    for (int x = -2000; x <= 2000; x += 37) {
+        for (int y = -2000; y <= 2000; y += 41) {
+            for (int z = -2000; z <= 2000; z += 43) {
+                double exact = atan((double)x / sqrt((double)y * y + (double)z * z)) * RADIANS_TO_DEGREES;
+                float hyp = FastMath::sqrt((float)y * y + (float)z * z);
+                int fast = FastMath::roundToInt(FastMath::atan2(x, hyp) * RADIANS_TO_DEGREES);
+                int reference = (int)round(exact);
+
+                if (fast != reference) {
+                    QVERIFY2(abs(fast - reference) == 1, "FastMath angle off by more than one degree");
+                    QVERIFY2(fabs(fabs(exact - floor(exact)) - 0.5) < 0.001, "FastMath angle differs away from rounding boundary");
+                    ++mismatches;
+                }
+            }
+        }
+    }
+    qDebug() << "Rounding boundary mismatches:" << mismatches;
+
+    for (int i = -3600; i <= 3600; ++i) {
+        float angle = i * M_PI / 900;
+        float s, c;
+        FastMath::sincos(angle, s, c);
+        QVERIFY(fabs(s - sin(angle)) < 1e-5);
+        QVERIFY(fabs(c - cos(angle)) < 1e-5);
+    }
+
+    for (int i = 1; i < 100000; ++i) {
+        float value = i * 0.37f;
+        QVERIFY(fabs(FastMath::rsqrt(value) * sqrt(value) - 1.0) < 1e-5);
+    }
+
+    QCOMPARE(FastMath::atan2(0.0f, 0.0f), 0.0f);
+    QCOMPARE(FastMath::sqrt(0.0f), 0.0f);
+}
+
+/**
+ * Feeds samples from a distorted and offset sphere to the ellipsoid fit
+ * and checks that the resulting calibration maps them back to a sphere.
+ */
+void FilterApiTest::testEllipsoidFit()
+{
+    const double softIron[3][3] = {
+        { 1.2,  0.1,  0.0  },
+        { 0.1,  0.8,  0.05 },
+        { 0.0,  0.05, 1.0  }
+    };
+    const double hardIron[3] = { 300, -150, 80 };
+    const double radius = 500;
+
+    EllipsoidFit fit;
+    MagCalibration calibration;
+
+    // Sample from a single direction only, fit should not be trusted.
+    for (int i = 0; i < 100; ++i)
+        fit.addSample(hardIron[0] + 600, hardIron[1], hardIron[2]);
+    QVERIFY(!fit.solve(calibration));
+
+    fit.reset();
+    qsrand(1);
+    for (int i = 0; i < 20000; ++i) {
+        double u = 2.0 * qrand() / RAND_MAX - 1;
+        double t = 2 * M_PI * qrand() / RAND_MAX;
+        double d[3] = { sqrt(1 - u * u) * cos(t) * radius, sqrt(1 - u * u) * sin(t) * radius, u * radius };
+        double raw[3];
+        for (int j = 0; j < 3; ++j)
+            raw[j] = hardIron[j] + softIron[j][0] * d[0] + softIron[j][1] * d[1] + softIron[j][2] * d[2] + qrand() % 11 - 5;
+        fit.addSample(raw[0], raw[1], raw[2]);
+    }
+
+    QCOMPARE(fit.coverage(), (int)EllipsoidFit::BUCKETS);
+    QVERIFY(fit.solve(calibration));
+    QCOMPARE(calibration.level, 3);
+    for (int i = 0; i < 3; ++i)
+        QVERIFY(fabs(calibration.offset[i] - hardIron[i]) < 5);
+
+    double shortest = 1e9;
+    double longest = 0;
+    for (int i = 0; i < 1000; ++i) {
+        double u = 2.0 * qrand() / RAND_MAX - 1;
+        double t = 2 * M_PI * qrand() / RAND_MAX;
+        double d[3] = { sqrt(1 - u * u) * cos(t) * radius, sqrt(1 - u * u) * sin(t) * radius, u * radius };
+        int raw[3];
+        for (int j = 0; j < 3; ++j)
+            raw[j] = (int)round(hardIron[j] + softIron[j][0] * d[0] + softIron[j][1] * d[1] + softIron[j][2] * d[2]);
+        calibration.apply(raw[0], raw[1], raw[2]);
+        double length = sqrt((double)raw[0] * raw[0] + (double)raw[1] * raw[1] + (double)raw[2] * raw[2]);
+        shortest = qMin(shortest, length);
+        longest = qMax(longest, length);
+    }
+    QVERIFY((longest - shortest) / longest < 0.02);
+}
+
+void FilterApiTest::testEllipsoidFitPartialCoverage()
+{
+    const double softIron[3][3] = {
+        { 1.2,  0.1,  0.0  },
+        { 0.1,  0.8,  0.05 },
+        { 0.0,  0.05, 1.0  }
+    };
+    const double previous[3] = { 250, -100, 40 };
+    const double hardIron[3] = { 300, -150, 80 };
+    const double radius = 500;
+
+    EllipsoidFit fit;
+    MagCalibration calibration;
+
+    // Device is only turned within the upper hemisphere, and the hard iron
+    // offset changes early on. Buckets must keep feeding the fit so that it
+    // follows the new offset instead of freezing on the first samples.
+    qsrand(1);
+    for (int i = 0; i < 20000; ++i) {
+        const double* offset = (i < 2000) ? previous : hardIron;
+        double u = 1.0 * qrand() / RAND_MAX;
+        double t = 2 * M_PI * qrand() / RAND_MAX;
+        double d[3] = { sqrt(1 - u * u) * cos(t) * radius, sqrt(1 - u * u) * sin(t) * radius, u * radius };
+        double raw[3];
+        for (int j = 0; j < 3; ++j)
+            raw[j] = offset[j] + softIron[j][0] * d[0] + softIron[j][1] * d[1] + softIron[j][2] * d[2] + qrand() % 11 - 5;
+        fit.addSample(raw[0], raw[1], raw[2]);
+    }
+
+    QVERIFY(fit.coverage() < (int)EllipsoidFit::BUCKETS);
+    QVERIFY(fit.solve(calibration));
+    QVERIFY(calibration.level >= 2);
+    for (int i = 0; i < 3; ++i)
+        QVERIFY(fabs(calibration.offset[i] - hardIron[i]) < 15);
+}
+
+/**
+ * A device left on a table for hours keeps feeding the same few buckets.
+ * The fit must stay finite and keep the calibration learned before.
+ */
+void FilterApiTest::testEllipsoidFitStationary()
+{
+    const double hardIron[3] = { 300, -150, 80 };
+    const double radius = 500;
+
+    EllipsoidFit fit;
+    MagCalibration calibration;
+
+    qsrand(1);
+    for (int i = 0; i < 20000; ++i) {
+        double u = 2.0 * qrand() / RAND_MAX - 1;
+        double t = 2 * M_PI * qrand() / RAND_MAX;
+        fit.addSample(hardIron[0] + sqrt(1 - u * u) * cos(t) * radius + qrand() % 11 - 5,
+                      hardIron[1] + sqrt(1 - u * u) * sin(t) * radius + qrand() % 11 - 5,
+                      hardIron[2] + u * radius + qrand() % 11 - 5);
+    }
+    QVERIFY(fit.solve(calibration));
+
+    // Three hours at 50 Hz.
+    for (int i = 0; i < 3 * 3600 * 50; ++i) {
+        fit.addSample(hardIron[0] + radius + qrand() % 11 - 5,
+                      hardIron[1] + qrand() % 11 - 5,
+                      hardIron[2] + qrand() % 11 - 5);
+    }
+
+    QVERIFY(fit.solve(calibration));
+    QVERIFY(calibration.level >= 2);
+    for (int i = 0; i < 3; ++i)
+        QVERIFY(fabs(calibration.offset[i] - hardIron[i]) < 15);
+}
+
+void FilterApiTest::testMagCalibrationStore()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.path() + "/state/magcalibration.state";
+
+    MagCalibrationStore store(path, "magnetometeradaptor/test/magcalibrationchain");
+    MagCalibrationStore other(path, "othermagnetometer/test/magcalibrationchain");
+    MagCalibration loaded;
+
+    // Nothing stored yet.
+    QVERIFY(!store.load(loaded));
+
+    MagCalibration calibration;
+    calibration.offset[0] = 300;
+    calibration.offset[1] = -150;
+    calibration.offset[2] = 80;
+    calibration.matrix[0][1] = calibration.matrix[1][0] = 0.05;
+    calibration.radius = 490;
+    calibration.level = 3;
+    QVERIFY(store.save(calibration));
+
+    MagCalibration otherCalibration;
+    otherCalibration.radius = 400;
+    otherCalibration.level = 2;
+    QVERIFY(other.save(otherCalibration));
+
+    QVERIFY(store.load(loaded));
+    QCOMPARE(loaded.level, 3);
+    QCOMPARE(loaded.radius, 490.0);
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(loaded.offset[i], calibration.offset[i]);
+        for (int j = 0; j < 3; ++j)
+            QCOMPARE(loaded.matrix[i][j], calibration.matrix[i][j]);
+    }
+    QVERIFY(other.load(loaded));
+    QCOMPARE(loaded.level, 2);
+
+    // Level 0 removes only own entry.
+    QVERIFY(store.save(MagCalibration()));
+    QVERIFY(!store.load(loaded));
+    QVERIFY(other.load(loaded));
+
+    // Implausible soft iron matrix is rejected.
+    calibration.matrix[0][0] = 3;
+    QVERIFY(store.save(calibration));
+    QVERIFY(!store.load(loaded));
+
+    // Unknown format is ignored.
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("garbage");
+    file.close();
+    QVERIFY(!other.load(loaded));
+}
+
+typedef Pipeline<AvgAccStage, Pipeline<DownsampleStage> > AccelerometerPipeline;
+
+static QVector<TimedXyzData> accelerometerSamples(int count)
+{
+    QVector<TimedXyzData> samples;
+    for (int i = 0; i < count; ++i)
+        samples.append(TimedXyzData(i * 20000, (i * 37) % 2001 - 1000, (i * 41) % 2001 - 1000, (i * 43) % 2001 - 1000));
+    return samples;
+}
+
+/**
+ * Fused pipeline must produce the same output as the equivalent runtime
+ * filter graph.
+ */
+void FilterApiTest::testFusedPipeline()
+{
+    QVector<TimedXyzData> input = accelerometerSamples(100);
+
+    FilterBase* avgacc = AvgAccFilter::factoryMethod();
+    FilterBase* downsample = DownsampleFilter::factoryMethod();
+    static_cast<AvgAccFilter*>(avgacc)->setFactor(0.24);
+    static_cast<DownsampleFilter*>(downsample)->setBufferSize(3);
+    static_cast<DownsampleFilter*>(downsample)->setTimeout(3000);
+
+    CollectingSink<TimedXyzData> dynamicOutput;
+    QVERIFY(avgacc->source("source")->join(downsample->sink("sink")));
+    QVERIFY(downsample->source("source")->join(&dynamicOutput));
+
+    FusedFilter<AccelerometerPipeline> fused;
+    fused.pipeline().stage().setFactor(0.24);
+    fused.pipeline().next().stage().setBufferSize(3);
+    fused.pipeline().next().stage().setTimeout(3000);
+
+    CollectingSink<TimedXyzData> fusedOutput;
+    QVERIFY(fused.source("source")->join(&fusedOutput));
+
+    SinkTyped<TimedXyzData>* dynamicInput = dynamic_cast<SinkTyped<TimedXyzData>*>(avgacc->sink("sink"));
+    SinkTyped<TimedXyzData>* fusedInput = dynamic_cast<SinkTyped<TimedXyzData>*>(fused.sink("sink"));
+    QVERIFY(dynamicInput && fusedInput);
+
+    // Runtime filters handle one sample per call.
+    for (int i = 0; i < input.size(); ++i)
+        dynamicInput->collect(1, &input[i]);
+    fusedInput->collect(input.size(), input.constData());
+
+    QCOMPARE(fusedOutput.values_.size(), input.size() / 3);
+    QCOMPARE(fusedOutput.values_.size(), dynamicOutput.values_.size());
+    for (int i = 0; i < fusedOutput.values_.size(); ++i) {
+        QCOMPARE(fusedOutput.values_[i].timestamp_, dynamicOutput.values_[i].timestamp_);
+        QCOMPARE(fusedOutput.values_[i].x_, dynamicOutput.values_[i].x_);
+        QCOMPARE(fusedOutput.values_[i].y_, dynamicOutput.values_[i].y_);
+        QCOMPARE(fusedOutput.values_[i].z_, dynamicOutput.values_[i].z_);
+    }
+
+    delete avgacc;
+    delete downsample;
+}
+
+void FilterApiTest::benchmarkFusedPipeline_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::newRow("runtime graph") << 0;
+    QTest::newRow("fused") << 1;
+    QTest::newRow("fused batch") << 2;
+}
+
+/**
+ * Compares compass chain accelerometer preprocessing as runtime filter
+ * graph and as fused pipeline, 1024 samples per iteration.
+ */
+void FilterApiTest::benchmarkFusedPipeline()
+{
+    QFETCH(int, method);
+
+    QVector<TimedXyzData> input = accelerometerSamples(1024);
+
+    FilterBase* avgacc = AvgAccFilter::factoryMethod();
+    FilterBase* downsample = DownsampleFilter::factoryMethod();
+    static_cast<DownsampleFilter*>(downsample)->setBufferSize(4);
+    avgacc->source("source")->join(downsample->sink("sink"));
+
+    FusedFilter<AccelerometerPipeline> fused;
+    fused.pipeline().next().stage().setBufferSize(4);
+
+    CollectingSink<TimedXyzData> output;
+    downsample->source("source")->join(&output);
+    fused.source("source")->join(&output);
+
+    SinkTyped<TimedXyzData>* sink = dynamic_cast<SinkTyped<TimedXyzData>*>(method ? fused.sink("sink") : avgacc->sink("sink"));
+    QVERIFY(sink);
+
+    QBENCHMARK {
+        output.values_.clear();
+        if (method == 2) {
+            sink->collect(input.size(), input.constData());
+        } else {
+            for (int i = 0; i < input.size(); ++i)
+                sink->collect(1, &input[i]);
+        }
+    }
+    QCOMPARE(output.values_.size(), input.size() / 4);
+
+    delete avgacc;
+    delete downsample;
+}
+
+void FilterApiTest::benchmarkFastMath_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::newRow("libm") << 0;
+    QTest::newRow("fastmath") << 1;
+    QTest::newRow("fastmath batch") << 2;
+}
+
+/**
+ * Measures the angle computation done by the orientation and rotation
+ * filters for 1024 samples. Run with -tickcounter and divide the result
+ * by 1024 to get cycles per sample.
+ */
+void FilterApiTest::benchmarkFastMath()
+{
+    QFETCH(int, method);
+
+    const int count = 1024;
+    QVector<float> x(count);
+    QVector<float> hyp(count);
+    QVector<float> angle(count);
+    for (int i = 0; i < count; ++i) {
+        x[i] = (i * 37) % 2001 - 1000;
+        float y = (i * 41) % 2001 - 1000;
+        float z = (i * 43) % 2001 - 1000;
+        hyp[i] = y * y + z * z;
+    }
+
+    QBENCHMARK {
+        switch (method) {
+            case 0:
+                for (int i = 0; i < count; ++i)
+                    angle[i] = atan(x[i] / sqrt(hyp[i]));
+                break;
+            case 1:
+                for (int i = 0; i < count; ++i)
+                    angle[i] = FastMath::atan2(x[i], FastMath::sqrt(hyp[i]));
+                break;
+            default:
+                FastMath::rsqrt(hyp.constData(), angle.data(), count);
+                for (int i = 0; i < count; ++i)
+                    angle[i] *= hyp[i];
+                FastMath::atan2(x.constData(), angle.constData(), angle.data(), count);
+                break;
+        }
+    }
+}
+
+/**
+ * Moving variance of a window far from zero must stay as accurate as
+ * computing it from the window, unlike the sum of squares form.
+ */
+void FilterApiTest::testWindowStats()
+{
+    const int size = 60;
+    const int count = 1000000;
+    WindowStats<double> stats(size);
+    QVector<double> window(size);
+
+    qsrand(1);
+    for (int i = 0; i < count; ++i) {
+        double value = 10000 + (qrand() % 2001 - 1000) * 0.01;
+        window[i % size] = value;
+        stats.add(value);
+    }
+
+    double mean = 0;
+    for (int i = 0; i < size; ++i)
+        mean += window[i];
+    mean /= size;
+    double variance = 0;
+    for (int i = 0; i < size; ++i)
+        variance += (window[i] - mean) * (window[i] - mean);
+    variance /= size - 1;
+
+    QVERIFY(stats.isFull());
+    QVERIFY(fabs(stats.mean() - mean) < 1e-9);
+    QVERIFY(fabs(stats.variance() - variance) / variance < 1e-9);
+
+    // Integer sums are exact, min and max follow the window.
+    WindowStats<int> ints(3);
+    ints.add(5);
+    ints.add(-7);
+    ints.add(4);
+    ints.add(10);
+    QCOMPARE(ints.sum(), 7.0);
+    QCOMPARE(ints.min(), -7);
+    QCOMPARE(ints.max(), 10);
+    ints.removeOldest();
+    QCOMPARE(ints.count(), 2);
+    QCOMPARE(ints.sum(), 14.0);
+    QCOMPARE(ints.variance(), 18.0);
+
+    // Batch larger than the window replaces it.
+    const int batch[5] = { 1, 2, 3, 4, 5 };
+    ints.add(batch, 5);
+    QCOMPARE(ints.oldest(), 3);
+    QCOMPARE(ints.mean(), 4.0);
+    QCOMPARE(ints.variance(), 1.0);
+}
+
+void FilterApiTest::benchmarkWindowStats_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::newRow("sum of squares") << 0;
+    QTest::newRow("windowstats") << 1;
+    QTest::newRow("windowstats batch") << 2;
+}
+
+/**
+ * Measures moving mean and variance over a window of 60 samples, the
+ * stability detection setup, for 1024 samples per iteration.
+ */
+void FilterApiTest::benchmarkWindowStats()
+{
+    QFETCH(int, method);
+
+    const int size = 60;
+    const int count = 1024;
+    QVector<double> input(count);
+    for (int i = 0; i < count; ++i)
+        input[i] = 1000 + (i * 37) % 201 - 100;
+
+    QVector<double> window(size);
+    double sum = 0;
+    double squareSum = 0;
+    double variance = 0;
+    WindowStats<double> stats(size);
+
+    QBENCHMARK {
+        switch (method) {
+            case 0:
+                for (int i = 0; i < count; ++i) {
+                    double old = window[i % size];
+                    sum += input[i] - old;
+                    squareSum += input[i] * input[i] - old * old;
+                    window[i % size] = input[i];
+                    variance += (size * squareSum - sum * sum) / (size * (size - 1));
+                }
+                break;
+            case 1:
+                for (int i = 0; i < count; ++i) {
+                    stats.add(input[i]);
+                    variance += stats.variance();
+                }
+                break;
+            default:
+                stats.add(input.constData(), count);
+                variance += stats.variance();
+                break;
+        }
+    }
+    QVERIFY(variance >= 0);
+}
+
+static double alignMatrix[3][3] = {
+    { 0.6,   -0.8,  0.01 },
+    { 0.8,    0.6, -0.02 },
+    { 0.003, 0.01,  1.05 }
+};
+
+/**
+ * Feeds the same magnetometer and accelerometer samples to a compass
+ * filter and returns the last heading.
+ */
+static int compassHeading(CompassFilter* filter, double roll, double pitch, double yaw)
+{
+    // Rotate earth frame gravity and field into device frame.
+    const double earth[2][3] = { { 0, 0, -1000 }, { 200, 0, 450 } };
+    double device[2][3];
+    for (int v = 0; v < 2; ++v) {
+        const double* e = earth[v];
+        double a[3] = { e[0] * cos(yaw) + e[1] * sin(yaw), -e[0] * sin(yaw) + e[1] * cos(yaw), e[2] };
+        double b[3] = { a[0] * cos(pitch) - a[2] * sin(pitch), a[1], a[0] * sin(pitch) + a[2] * cos(pitch) };
+        device[v][0] = b[0];
+        device[v][1] = b[1] * cos(roll) + b[2] * sin(roll);
+        device[v][2] = -b[1] * sin(roll) + b[2] * cos(roll);
+    }
+
+    SinkTyped<CalibratedMagneticFieldData>* magSink = dynamic_cast<SinkTyped<CalibratedMagneticFieldData>*>(filter->sink("magsink"));
+    SinkTyped<AccelerationData>* accSink = dynamic_cast<SinkTyped<AccelerationData>*>(filter->sink("accsink"));
+    CollectingSink<CompassData> output;
+    filter->source("magnorthangle")->join(&output);
+
+    for (int i = 0; i < 80; ++i) {
+        int n = i % 5 - 2;
+        CalibratedMagneticFieldData mag;
+        mag.x_ = (int)round(device[1][1]) + n;
+        mag.y_ = (int)round(device[1][0]);
+        mag.z_ = (int)round(device[1][2]);
+        AccelerationData acc(i * 20000, (int)round(device[0][1]), (int)round(device[0][0]) + n, (int)round(-device[0][2]));
+        magSink->collect(1, &mag);
+        accSink->collect(1, &acc);
+    }
+    filter->source("magnorthangle")->unjoin(&output);
+    return output.values_.last().degrees_;
+}
+
+/**
+ * Golden output test of the fixed point paths against the floating
+ * point ones. Integer outputs may differ by one unit, angles by one
+ * degree on rounding boundaries.
+ */
+void FilterApiTest::testFixedPoint()
+{
+    const double RADIANS_TO_DEGREES = 180.0 / M_PI;
+
+    QCOMPARE(FixedPoint::sqrt(1000000), 1000u);
+    QCOMPARE(FixedPoint::truncate(-3 * FixedPoint::One - 1), -3);
+    QCOMPARE(FixedPoint::round(-3 * FixedPoint::One - FixedPoint::One / 2), -4);
+    QCOMPARE(FixedPoint::atan2(0, 0), 0);
+
+    for (int x = -2000; x <= 2000; x += 37) {
+        for (int y = -2000; y <= 2000; y += 41) {
+            for (int z = -2000; z <= 2000; z += 43) {
+                double exact = atan2((double)x, sqrt((double)y * y + (double)z * z)) * RADIANS_TO_DEGREES;
+                int reference = (int)round(exact);
+                int fixed = OrientationInterpreter::tiltAngle(x, y, z, true);
+                if (fixed != reference) {
+                    QVERIFY2(abs(fixed - reference) == 1, "Fixed point angle off by more than one degree");
+                    QVERIFY2(fabs(fabs(exact - floor(exact)) - 0.5) < 0.01, "Fixed point angle differs away from rounding boundary");
+                }
+            }
+        }
+    }
+
+    QVector<TimedXyzData> input = accelerometerSamples(10000);
+
+    CoordinateAlignStage align;
+    CoordinateAlignStage fixedAlign;
+    align.setMatrix(TMatrix(alignMatrix));
+    fixedAlign.setMatrix(TMatrix(alignMatrix));
+    fixedAlign.setFixedPoint(true);
+
+    AvgAccStage avg;
+    AvgAccStage fixedAvg;
+    avg.setFactor(0.24);
+    fixedAvg.setFactor(0.24);
+    fixedAvg.setFixedPoint(true);
+
+    for (int i = 0; i < input.size(); ++i) {
+        TimedXyzData a, b;
+        align.apply(input[i], a);
+        fixedAlign.apply(input[i], b);
+        QVERIFY(abs(a.x_ - b.x_) <= 1 && abs(a.y_ - b.y_) <= 1 && abs(a.z_ - b.z_) <= 1);
+
+        avg.apply(input[i], a);
+        fixedAvg.apply(input[i], b);
+        QVERIFY(abs(a.x_ - b.x_) <= 1 && abs(a.y_ - b.y_) <= 1 && abs(a.z_ - b.z_) <= 1);
+    }
+
+    // Heading is smoothed without regard to wrap around, so headings
+    // near south are left out.
+    qsrand(3);
+    for (int i = 0; i < 500; ++i) {
+        double roll = (qrand() % 140 - 70) / RADIANS_TO_DEGREES;
+        double pitch = (qrand() % 160 - 80) / RADIANS_TO_DEGREES;
+        double yaw = (qrand() % 340 - 170) / RADIANS_TO_DEGREES;
+
+        CompassFilter* compass = static_cast<CompassFilter*>(CompassFilter::factoryMethod());
+        CompassFilter* fixedCompass = static_cast<CompassFilter*>(CompassFilter::factoryMethod());
+        compass->setFixedPoint(false);
+        fixedCompass->setFixedPoint(true);
+
+        int difference = abs(compassHeading(compass, roll, pitch, yaw) - compassHeading(fixedCompass, roll, pitch, yaw));
+        QVERIFY2(qMin(difference, 360 - difference) <= 1, "Fixed point heading off by more than one degree");
+
+        delete compass;
+        delete fixedCompass;
+    }
+}
+
+void FilterApiTest::benchmarkFixedPoint_data()
+{
+    QTest::addColumn<int>("filter");
+    QTest::addColumn<bool>("fixed");
+    QTest::newRow("alignment float") << 0 << false;
+    QTest::newRow("alignment fixed") << 0 << true;
+    QTest::newRow("averaging float") << 1 << false;
+    QTest::newRow("averaging fixed") << 1 << true;
+    QTest::newRow("orientation float") << 2 << false;
+    QTest::newRow("orientation fixed") << 2 << true;
+    QTest::newRow("compass float") << 3 << false;
+    QTest::newRow("compass fixed") << 3 << true;
+}
+
+/**
+ * Measures each filter with fixed point on and off for 1024 samples.
+ * Run with -tickcounter and divide the result by 1024 to get cycles
+ * per sample.
+ */
+void FilterApiTest::benchmarkFixedPoint()
+{
+    QFETCH(int, filter);
+    QFETCH(bool, fixed);
+
+    QVector<TimedXyzData> input = accelerometerSamples(1024);
+    QVector<TimedXyzData> output(input.size());
+    QVector<int> angles(input.size());
+
+    CoordinateAlignStage align;
+    align.setMatrix(TMatrix(alignMatrix));
+    align.setFixedPoint(fixed);
+    AvgAccStage avg;
+    avg.setFixedPoint(fixed);
+
+    CompassFilter* compass = static_cast<CompassFilter*>(CompassFilter::factoryMethod());
+    compass->setFixedPoint(fixed);
+    SinkTyped<CalibratedMagneticFieldData>* magSink = dynamic_cast<SinkTyped<CalibratedMagneticFieldData>*>(compass->sink("magsink"));
+    SinkTyped<AccelerationData>* accSink = dynamic_cast<SinkTyped<AccelerationData>*>(compass->sink("accsink"));
+    CalibratedMagneticFieldData mag;
+    mag.x_ = 200;
+    mag.z_ = 450;
+    magSink->collect(1, &mag);
+
+    QBENCHMARK {
+        switch (filter) {
+            case 0:
+                for (int i = 0; i < input.size(); ++i)
+                    align.apply(input[i], output[i]);
+                break;
+            case 1:
+                for (int i = 0; i < input.size(); ++i)
+                    avg.apply(input[i], output[i]);
+                break;
+            case 2:
+                for (int i = 0; i < input.size(); ++i) {
+                    const TimedXyzData& d = input[i];
+                    angles[i] = OrientationInterpreter::tiltAngle(d.x_, d.y_, d.z_, fixed);
+                }
+                break;
+            default:
+                for (int i = 0; i < input.size(); ++i)
+                    accSink->collect(1, &input[i]);
+                break;
+        }
+    }
+
+    delete compass;
+}
+
+/**
+ * The node runs at the fastest request, never faster, and sessions
+ * configured together re-evaluate the node once.
+ */
+void FilterApiTest::testIntervalRequests()
+{
+    IntervalNode node;
+
+    QVERIFY(node.setIntervalRequest(1, 20));
+    QVERIFY(node.setIntervalRequest(2, 250));
+    QCOMPARE(node.interval_, 20u);
+    QVERIFY(node.setIntervalRequest(3, 30));
+    QCOMPARE(node.interval_, 20u);
+    QVERIFY(!node.setIntervalRequest(4, 5));
+    QCOMPARE(node.interval_, 20u);
+
+    node.removeIntervalRequest(1);
+    QCOMPARE(node.interval_, 30u);
+    node.removeIntervalRequest(3);
+    QCOMPARE(node.interval_, 250u);
+
+    int changes = node.changes_;
+    {
+        NodeBase::RequestBatch batch;
+        node.setIntervalRequest(5, 100);
+        node.setIntervalRequest(6, 50);
+        node.removeIntervalRequest(2);
+        QCOMPARE(node.changes_, changes);
+        QCOMPARE(node.interval_, 250u);
+    }
+    QCOMPARE(node.changes_, changes + 1);
+    QCOMPARE(node.interval_, 50u);
+}
+
+/**
+ * Requests between the supported intervals run at the longest supported
+ * interval below them and never faster than the fastest request.
+ */
+void FilterApiTest::testIntervalArbitration()
+{
+    DiscreteIntervalNode node;
+
+    QVERIFY(node.setIntervalRequest(1, 30));
+    QCOMPARE(node.interval_, 20u);
+    QVERIFY(node.setIntervalRequest(2, 2000));
+    QCOMPARE(node.interval_, 20u);
+    QVERIFY(!node.setIntervalRequest(3, 5));
+
+    node.removeIntervalRequest(1);
+    QCOMPARE(node.interval_, 100u);
+    QVERIFY(node.setIntervalRequest(1, 50));
+    QCOMPARE(node.interval_, 50u);
+}
+
+/**
+ * A consumer slower than the stream gets samples at its own period on
+ * average, keeps the phase of the first sample despite timestamp jitter
+ * and starts over after a gap.
+ */
+void FilterApiTest::testSampleDecimator()
+{
+    // Faster or equal consumers get every sample.
+    SampleDecimator all;
+    for (int i = 0; i < 10; ++i)
+        QVERIFY(all.isDue(i * 20000, 20, 20));
+
+    // 30 ms out of 20 ms is not a whole multiple, it averages out.
+    SampleDecimator decimator;
+    QList<quint64> picked;
+    for (quint64 i = 0; i < 300; ++i) {
+        quint64 timestamp = 1000000 + i * 20000;
+        if (decimator.isDue(timestamp, 30, 20))
+            picked.append(timestamp);
+    }
+    QCOMPARE(picked.size(), 200);
+    QCOMPARE(picked.first(), (quint64)1000000);
+
+    // Jitter of up to a quarter period does not move the phase.
+    decimator.reset();
+    picked.clear();
+    for (quint64 i = 0; i < 400; ++i) {
+        quint64 timestamp = 1000000 + i * 10000 + (i % 3 == 0 ? 2500 : 0) - (i % 5 == 0 ? 2500 : 0);
+        if (decimator.isDue(timestamp, 30, 10))
+            picked.append(timestamp);
+    }
+    QVERIFY(qAbs(picked.size() - 134) <= 1);
+    for (int i = 1; i < picked.size(); ++i) {
+        qint64 phase = ((qint64)(picked[i] - 1000000) + 15000) % 30000 - 15000;
+        QVERIFY2(qAbs(phase) <= 5000, "picked sample drifted from the phase of the first one");
+    }
+
+    // After a gap the next sample is picked and the phase starts from it.
+    QVERIFY(decimator.isDue(picked.last() + 10000000, 30, 10));
+    QVERIFY(!decimator.isDue(picked.last() + 10010000, 30, 10));
+    QVERIFY(decimator.isDue(picked.last() + 10030000, 30, 10));
+}
+
+/**
+ * Walk at given cadence for given time. Magnitude of acceleration
+ * swings 300 mG around gravity once per step.
+ *
+ * @return number of steps reported.
+ */
+static int walk(StepDetectorStage& stage, int seconds, double cadence, unsigned int interval)
+{
+    TimedXyzData in[StepDetectorStage::BatchSize];
+    TimedUnsigned out[StepDetectorStage::BatchSize];
+    int reported = 0;
+    int n = 0;
+    int count = seconds * 1000 / interval;
+    for (int i = 0; i < count; ++i) {
+        double t = i * interval / 1000.0;
+        double magnitude = 1000 + 300 * sin(2 * M_PI * cadence * t);
+        in[n++] = TimedXyzData(1000000 + (quint64)i * interval * 1000,
+                               (int)(0.1 * magnitude), (int)(0.2 * magnitude), (int)(0.97 * magnitude));
+        if (n == StepDetectorStage::BatchSize || i == count - 1) {
+            reported += stage.process(n, in, out);
+            n = 0;
+        }
+    }
+    return reported;
+}
+
+void FilterApiTest::testStepDetector()
+{
+    // Two steps per second for ten seconds at the chain's default interval.
+    StepDetectorStage walking;
+    int steps = walk(walking, 10, 2, 20);
+    QVERIFY2(steps >= 19 && steps <= 20, QString("Detected %1 steps").arg(steps).toLatin1());
+    QCOMPARE(walking.steps(), (unsigned)steps);
+
+    // Steps closer than the minimum interval are rejected.
+    StepDetectorStage limited;
+    limited.setMinInterval(800);
+    steps = walk(limited, 10, 2, 20);
+    QVERIFY2(steps >= 9 && steps <= 10, QString("Detected %1 steps").arg(steps).toLatin1());
+    QCOMPARE(limited.steps(), (unsigned)steps);
+
+    // Standing still is not walking.
+    StepDetectorStage still;
+    QCOMPARE(walk(still, 10, 0, 20), 0);
+
+    // A new detector continues from the count of the previous one.
+    StepDetectorStage resumed;
+    resumed.setSteps(walking.steps());
+    steps = walk(resumed, 10, 2, 20);
+    QCOMPARE(resumed.steps(), walking.steps() + steps);
+}
+
 QTEST_MAIN(FilterApiTest)
@@ -36,6 +36,7 @@
 #include "source.h"
 #include "orientationdata.h"
 #include "posedata.h"
+#include <QVector>
 
 class FilterApiTest : public QObject
 {
@@ -51,6 +52,26 @@ private slots:
     void testDeclinationFilter();
     void testOrientationInterpretationFilter();
     void testRotationFilter();
+    void testFastMath();
+    void testEllipsoidFit();
+    void testEllipsoidFitPartialCoverage();
+    void testEllipsoidFitStationary();
+    void testMagCalibrationStore();
+    void testFusedPipeline();
+    void benchmarkFusedPipeline_data();
+    void benchmarkFusedPipeline();
+    void benchmarkFastMath_data();
+    void benchmarkFastMath();
+    void testWindowStats();
+    void benchmarkWindowStats_data();
+    void benchmarkWindowStats();
+    void testFixedPoint();
+    void benchmarkFixedPoint_data();
+    void benchmarkFixedPoint();
+    void testIntervalRequests();
+    void testIntervalArbitration();
+    void testSampleDecimator();
+    void testStepDetector();
 
     void cleanup() {}
     void cleanupTestCase() {}
@@ -173,5 +194,65 @@ private:
     int index_;
 };
 
+/**
+ * CollectingSink stores everything it receives.
+ */
+template <class TYPE>
+class CollectingSink : public SinkTyped<TYPE>
+{
+public:
+    void collect(int n, const TYPE* values) {
+        for (int i = 0; i < n; ++i)
+            values_.append(values[i]);
+    }
+
+    QVector<TYPE> values_;
+};
+
+/**
+ * IntervalNode records the interval set by interval request evaluation.
+ */
+class IntervalNode : public NodeBase
+{
+public:
+    IntervalNode() : NodeBase("intervalnode"), interval_(0), changes_(0) {
+        introduceAvailableInterval(DataRange(10, 1000, 0));
+    }
+
+    unsigned int interval() const { return interval_; }
+
+    bool setInterval(unsigned int value, int) {
+        interval_ = value;
+        ++changes_;
+        return true;
+    }
+
+    RingBufferBase* findBuffer(const QString&) const { return NULL; }
+
+    unsigned int interval_;
+    int changes_;
+};
+
+class DiscreteIntervalNode : public NodeBase
+{
+public:
+    DiscreteIntervalNode() : NodeBase("discreteintervalnode"), interval_(0) {
+        introduceAvailableInterval(DataRange(10, 10, 0));
+        introduceAvailableInterval(DataRange(20, 20, 0));
+        introduceAvailableInterval(DataRange(50, 50, 0));
+        introduceAvailableInterval(DataRange(100, 100, 0));
+    }
+
+    unsigned int interval() const { return interval_; }
+
+    bool setInterval(unsigned int value, int) {
+        interval_ = value;
+        return true;
+    }
+
+    RingBufferBase* findBuffer(const QString&) const { return NULL; }
+
+    unsigned int interval_;
+};
 
 #endif // FILTERAPITEST_H
@@ -0,0 +1,217 @@
+/**
+   @file sensorfw-top.cpp
+   @brief Live view of sensord node and session statistics
+
+   <p>
+   This file is part of Sensord.
+
+   Sensord is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   Sensord is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with Sensord.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+*/
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QLocalSocket>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMap>
+#include <QPair>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#define STATS_SOCKET_NAME "/var/run/sensord-stats.sock"
+#define CONNECT_TIMEOUT 1000
+
+/* Metric name, node label, name label. */
+typedef QPair<QString, QPair<QString, QString> > MetricKey;
+typedef QMap<MetricKey, qint64> Metrics;
+
+static QString argument(const QStringList& args, const QString& name, const QString& defaultValue)
+{
+    int i = args.indexOf(name);
+    if (i < 0 || i + 1 >= args.size())
+        return defaultValue;
+    return args.at(i + 1);
+}
+
+static QString socketPath()
+{
+    QByteArray env = qgetenv("SENSORFW_SOCKET_PATH");
+    return QString::fromLocal8Bit(env + STATS_SOCKET_NAME);
+}
+
+/**
+ * Read one snapshot from the statistics socket.
+ */
+static bool fetch(const QString& path, QByteArray& text)
+{
+    QLocalSocket socket;
+    socket.connectToServer(path, QIODevice::ReadOnly);
+    if (!socket.waitForConnected(CONNECT_TIMEOUT)) {
+        fprintf(stderr, "Failed to connect to %s: %s\n",
+                qPrintable(path), qPrintable(socket.errorString()));
+        return false;
+    }
+    text.clear();
+    while (socket.state() == QLocalSocket::ConnectedState || socket.bytesAvailable()) {
+        if (!socket.bytesAvailable() && !socket.waitForReadyRead(CONNECT_TIMEOUT))
+            break;
+        text += socket.readAll();
+    }
+    return true;
+}
+
+static QString unescape(const QString& value)
+{
+    QString text;
+    for (int i = 0; i < value.size(); ++i) {
+        if (value[i] == QLatin1Char('\\') && i + 1 < value.size()) {
+            ++i;
+            text += value[i] == QLatin1Char('n') ? QLatin1Char('\n') : value[i];
+        } else {
+            text += value[i];
+        }
+    }
+    return text;
+}
+
+/**
+ * Parse lines of form <tt>metric{node="...",name="..."} value</tt>.
+ */
+static Metrics parse(const QByteArray& text)
+{
+    Metrics metrics;
+    foreach (const QByteArray& rawLine, text.split('\n')) {
+        QString line = QString::fromUtf8(rawLine);
+        int open = line.indexOf(QLatin1String("{node=\""));
+        int separator = line.indexOf(QLatin1String("\",name=\""), open);
+        int close = line.lastIndexOf(QLatin1String("\"} "));
+        if (open <= 0 || separator < 0 || close < separator)
+            continue;
+        QString node = unescape(line.mid(open + 7, separator - open - 7));
+        QString name = unescape(line.mid(separator + 8, close - separator - 8));
+        bool ok;
+        qint64 value = line.mid(close + 3).toLongLong(&ok);
+        if (ok)
+            metrics.insert(qMakePair(line.left(open), qMakePair(node, name)), value);
+    }
+    return metrics;
+}
+
+/**
+ * Rate of a wrapping 32 bit counter.
+ */
+static double rate(const Metrics& current, const Metrics& previous, const MetricKey& key, double seconds)
+{
+    if (!previous.contains(key) || seconds <= 0)
+        return 0;
+    unsigned int delta = (unsigned int)current.value(key) - (unsigned int)previous.value(key);
+    return delta / seconds;
+}
+
+static MetricKey key(const char* metric, const MetricKey& other)
+{
+    return qMakePair(QString(metric), other.second);
+}
+
+static void print(const Metrics& current, const Metrics& previous, double seconds)
+{
+    printf("%-24s %-12s %10s %8s\n", "READER", "", "SAMPLES/s", "CPU%");
+    for (Metrics::const_iterator it = current.constBegin(); it != current.constEnd(); ++it) {
+        if (it.key().first != "sensorfw_reader_samples_total")
+            continue;
+        double cpu = rate(current, previous, key("sensorfw_reader_cpu_us_total", it.key()), seconds) / 10000.0;
+        printf("%-24s %-12s %10.1f %8.1f\n", qPrintable(it.key().second.first), "",
+               rate(current, previous, it.key(), seconds), cpu);
+    }
+
+    printf("\n%-24s %-24s %10s %10s\n", "BUFFER", "", "WRITES/s", "DROPS/s");
+    for (Metrics::const_iterator it = current.constBegin(); it != current.constEnd(); ++it) {
+        if (it.key().first != "sensorfw_buffer_written_total")
+            continue;
+        printf("%-24s %-24s %10.1f %10.1f\n", qPrintable(it.key().second.first), qPrintable(it.key().second.second),
+               rate(current, previous, it.key(), seconds),
+               rate(current, previous, key("sensorfw_buffer_dropped_total", it.key()), seconds));
+    }
+
+    printf("\n%-24s %-36s %10s\n", "SOURCE", "", "SAMPLES/s");
+    for (Metrics::const_iterator it = current.constBegin(); it != current.constEnd(); ++it) {
+        if (it.key().first != "sensorfw_source_samples_total")
+            continue;
+        printf("%-24s %-36s %10.1f\n", qPrintable(it.key().second.first), qPrintable(it.key().second.second),
+               rate(current, previous, it.key(), seconds));
+    }
+
+    printf("\n%-24s %-8s %10s %10s %10s %10s\n", "SESSION", "ID", "IN/s", "OUT/s", "DROPS/s", "QUEUED");
+    for (Metrics::const_iterator it = current.constBegin(); it != current.constEnd(); ++it) {
+        if (it.key().first != "sensorfw_session_received_total")
+            continue;
+        printf("%-24s %-8s %10.1f %10.1f %10.1f %10lld\n", qPrintable(it.key().second.first), qPrintable(it.key().second.second),
+               rate(current, previous, it.key(), seconds),
+               rate(current, previous, key("sensorfw_session_sent_total", it.key()), seconds),
+               rate(current, previous, key("sensorfw_session_dropped_total", it.key()), seconds),
+               current.value(key("sensorfw_session_queued_bytes", it.key())));
+    }
+
+    printf("\nPipe backlog: %lld\n",
+           current.value(qMakePair(QString("sensorfw_pipe_queued_batches"), qMakePair(QString("sensormanager"), QString("pipe")))));
+}
+
+/*
+ * Shows per node rates of a running sensord.
+ *   -d S   refresh every S seconds, default 1
+ *   -n N   exit after N refreshes
+ *   -s P   statistics socket path
+ *   -r     print raw statistics once
+ */
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+
+    QString path = argument(args, "-s", socketPath());
+    double delay = qMax(argument(args, "-d", "1").toDouble(), 0.1);
+    int iterations = argument(args, "-n", "0").toInt();
+    bool tty = isatty(STDOUT_FILENO);
+
+    QByteArray text;
+    if (args.contains("-r")) {
+        if (!fetch(path, text))
+            return 1;
+        fwrite(text.constData(), 1, text.size(), stdout);
+        return 0;
+    }
+
+    Metrics previous;
+    QElapsedTimer timer;
+    for (int i = 0; !iterations || i <= iterations; ++i) {
+        if (!fetch(path, text))
+            return 1;
+        double seconds = timer.isValid() ? timer.restart() / 1000.0 : 0;
+        if (!timer.isValid())
+            timer.start();
+        Metrics current = parse(text);
+
+        if (i > 0) {
+            if (tty)
+                printf("\033[H\033[2J");
+            print(current, previous, seconds);
+            fflush(stdout);
+        }
+        previous = current;
+        if (!iterations || i < iterations)
+            QThread::msleep((unsigned long)(delay * 1000));
+    }
+    return 0;
+}
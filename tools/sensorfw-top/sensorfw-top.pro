@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET = sensorfw-top
+
+QT += network
+QT -= gui
+CONFIG += console
+
+SOURCES += sensorfw-top.cpp
+
+target.path = /usr/bin
+INSTALLS += target